@@ -15,17 +15,25 @@
 #include "lite/api/cxx_api.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstdio>
 #include <memory>
+#include <random>
 #include <set>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "lite/api/paddle_use_passes.h"
+#include "lite/core/memory_pool.h"
+#include "lite/core/version.h"
 #include "lite/utils/io.h"
 #ifdef ENABLE_ARM_FP16
 #include "lite/backends/arm/math/fp16/type_trans_fp16.h"
 #endif
+#ifdef LITE_WITH_OPENCL
+#include "lite/backends/opencl/cl_runtime.h"
+#endif
 
 namespace paddle {
 namespace lite {
@@ -80,6 +88,167 @@ bool IsQuantizedMode(const std::shared_ptr<cpp::ProgramDesc> &program_desc) {
   return is_quantized_model;
 }
 
+namespace {
+
+// Add the host places and the int8 places of the quantized models to
+// `valid_places`, which are used to optimize passes.
+std::vector<Place> InnerPlaces(
+    const std::shared_ptr<cpp::ProgramDesc> &program_desc,
+    const std::vector<Place> &valid_places) {
+  std::vector<Place> inner_places = valid_places;
+  for (auto &valid_place : valid_places) {
+    if (valid_place.target == TARGET(kOpenCL)) continue;
+    inner_places.emplace_back(
+        Place(TARGET(kHost), valid_place.precision, valid_place.layout));
+  }
+
+  if (IsQuantizedMode(program_desc)) {
+    for (auto &valid_place : valid_places) {
+      if (valid_place.target == TARGET(kARM)) {
+        inner_places.insert(inner_places.begin(),
+                            Place{TARGET(kARM), PRECISION(kInt8)});
+      }
+      if (valid_place.target == TARGET(kX86)) {
+        inner_places.insert(inner_places.begin(),
+                            Place{TARGET(kX86), PRECISION(kInt8)});
+      }
+    }
+  }
+  // XPU target must make sure to insert in front of others.
+  if (IsQuantizedMode(program_desc)) {
+    for (auto &valid_place : valid_places) {
+      if (valid_place.target == TARGET(kXPU)) {
+        inner_places.insert(inner_places.begin(),
+                            Place{TARGET(kXPU), PRECISION(kInt8)});
+      }
+    }
+  }
+  return inner_places;
+}
+
+// FNV-1a hash, which is used to fingerprint the models for the optimized
+// model cache.
+const uint64_t kFNVOffsetBasis = 14695981039346656037ULL;
+const uint64_t kFNVPrime = 1099511628211ULL;
+
+uint64_t HashBytes(const char *data, size_t size, uint64_t hash) {
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ static_cast<uint8_t>(data[i])) * kFNVPrime;
+  }
+  return hash;
+}
+
+uint64_t HashString(const std::string &str, uint64_t hash) {
+  // Hash the size too, so that the concatenated fields can't collide.
+  uint64_t size = str.size();
+  hash = HashBytes(reinterpret_cast<const char *>(&size), sizeof(size), hash);
+  return HashBytes(str.data(), str.size(), hash);
+}
+
+uint64_t HashFile(const std::string &path, uint64_t hash) {
+  hash = HashString(path.substr(path.find_last_of("/\\") + 1), hash);
+  FILE *fp = fopen(path.c_str(), "rb");
+  if (!fp) return hash;
+  std::vector<char> buffer(1 << 20);
+  size_t size = 0;
+  while ((size = fread(buffer.data(), 1, buffer.size(), fp)) > 0) {
+    hash = HashBytes(buffer.data(), size, hash);
+  }
+  fclose(fp);
+  return hash;
+}
+
+uint64_t HashStrings(const std::vector<std::string> &strs, uint64_t hash) {
+  hash = HashString(std::to_string(strs.size()), hash);
+  for (auto &str : strs) {
+    hash = HashString(str, hash);
+  }
+  return hash;
+}
+
+// The optimized model is keyed by the model contents, the library version
+// and all the options of the config which change the optimization: the
+// places, the passes (including the discarded ones), the quantization, the
+// sparse and the NNAdapter options, a new one is generated if any of them
+// changes. The XPU options aren't included since they only take effect at
+// runtime.
+std::string OptimizedModelCacheKey(const lite_api::CxxConfig &config,
+                                   const std::vector<Place> &valid_places,
+                                   const std::vector<std::string> &passes,
+                                   lite_api::LiteModelType model_type) {
+  uint64_t hash = kFNVOffsetBasis;
+  if (config.is_model_from_memory()) {
+    hash = HashString(config.get_model_buffer().get_program(), hash);
+    hash = HashString(config.get_model_buffer().get_params(), hash);
+  } else if (!config.model_file().empty() && !config.param_file().empty()) {
+    hash = HashFile(config.model_file(), hash);
+    hash = HashFile(config.param_file(), hash);
+  } else if (model_type == lite_api::LiteModelType::kNaiveBuffer ||
+             !IsDir(config.model_dir())) {
+    hash = HashFile(config.model_dir(), hash);
+  } else {
+    auto files = ListFile(config.model_dir());
+    std::sort(files.begin(), files.end());
+    for (auto &file : files) {
+      hash = HashFile(config.model_dir() + "/" + file, hash);
+    }
+  }
+  // The layout preprocess pass is enabled by the model dir.
+  hash = HashString(
+      std::to_string(config.model_dir().find("OPENCL_PRE_PRECESS") !=
+                     std::string::npos),
+      hash);
+  for (auto &place : valid_places) {
+    hash = HashString(place.DebugString(), hash);
+  }
+  hash = HashStrings(passes, hash);
+  hash = HashStrings(config.get_discarded_passes(), hash);
+  hash = HashString(std::to_string(config.quant_model()) + ":" +
+                        std::to_string(static_cast<int>(config.quant_type())),
+                    hash);
+  hash = HashString(std::to_string(config.sparse_model()) + ":" +
+                        std::to_string(config.sparse_threshold()),
+                    hash);
+  // The NNAdapter options, the config files are hashed by their contents.
+  hash = HashStrings(config.nnadapter_device_names(), hash);
+  hash = HashString(config.nnadapter_context_properties(), hash);
+  hash = HashString(config.nnadapter_model_cache_dir(), hash);
+  for (auto &it : config.nnadapter_model_cache_buffers()) {
+    hash = HashString(it.first + ":" + std::to_string(it.second.size()), hash);
+    hash = HashBytes(it.second.data(), it.second.size(), hash);
+  }
+  for (auto &it : config.nnadapter_dynamic_shape_info()) {
+    hash = HashString(it.first, hash);
+    for (auto &shape : it.second) {
+      std::string dims;
+      for (auto dim : shape) {
+        dims += std::to_string(dim) + ",";
+      }
+      hash = HashString(dims, hash);
+    }
+  }
+  for (auto &path :
+       {config.nnadapter_subgraph_partition_config_path(),
+        config.nnadapter_mixed_precision_quantization_config_path()}) {
+    hash = path.empty() ? HashString(path, hash) : HashFile(path, hash);
+  }
+  hash = HashString(config.nnadapter_subgraph_partition_config_buffer(), hash);
+  hash = HashString(
+      config.nnadapter_mixed_precision_quantization_config_buffer(), hash);
+  hash = HashString(std::to_string(config.metal_use_mps()) + ":" +
+                        std::to_string(config.metal_use_aggressive()),
+                    hash);
+#ifdef LITE_WITH_OPENCL
+  hash = HashString(
+      std::to_string(static_cast<int>(CLRuntime::Global()->get_precision())),
+      hash);
+#endif
+  hash = HashString(version(), hash);
+  return string_format("%016llx", static_cast<unsigned long long>(hash));
+}
+
+}  // namespace
+
 void Predictor::SaveModel(const std::string &dir,
                           lite_api::LiteModelType model_type,
                           bool record_info) {
@@ -357,6 +526,19 @@ void Predictor::Build(const lite_api::CxxConfig &config,
                       const std::vector<Place> &valid_places,
                       const std::vector<std::string> &passes,
                       lite_api::LiteModelType model_type) {
+  std::string cache_file;
+  const auto &cache_dir = config.optimized_model_cache_dir();
+  if (!cache_dir.empty()) {
+    cache_file =
+        cache_dir + "/" +
+        OptimizedModelCacheKey(config, valid_places, passes, model_type);
+    if (IsFileExists(cache_file + ".nb")) {
+      LOG(INFO) << "Load the optimized model from " << cache_file << ".nb";
+      BuildFromOptimizedModel(cache_file + ".nb", valid_places);
+      return;
+    }
+  }
+
   if (config.is_model_from_memory()) {
     LOG(INFO) << "Load model from memory.";
     Build(config.model_dir(),
@@ -377,7 +559,46 @@ void Predictor::Build(const lite_api::CxxConfig &config,
           model_type,
           config);
   }
+
+  if (!cache_file.empty()) {
+    // Save to a temporary file and rename it, so that the predictors which
+    // are built concurrently never load an incomplete model.
+    MkDirRecur(cache_dir);
+    std::string tmp_file =
+        cache_file + ".tmp" + std::to_string(std::random_device()());
+    SaveModelNaive(tmp_file, *exec_scope_, *program_desc_);
+    if (std::rename((tmp_file + ".nb").c_str(), (cache_file + ".nb").c_str())) {
+      LOG(WARNING) << "Failed to save the optimized model to " << cache_file
+                   << ".nb";
+      std::remove((tmp_file + ".nb").c_str());
+    } else {
+      LOG(INFO) << "Saved the optimized model to " << cache_file << ".nb";
+    }
+  }
 }
+
+void Predictor::BuildFromOptimizedModel(
+    const std::string &model_file, const std::vector<Place> &valid_places) {
+  LoadModelNaiveFromFile(model_file, scope_.get(), program_desc_.get());
+  // The kernels have been picked, the same as Clone, the runtime program is
+  // created from the kernel types saved in the program desc.
+  valid_places_ = InnerPlaces(program_desc_, valid_places);
+  Program program(program_desc_, scope_, valid_places_);
+  exec_scope_ = program.exec_scope();
+  program_.reset(new RuntimeProgram(program_desc_, exec_scope_, kRootBlockIdx));
+  if (program_desc_->HasVersion()) {
+    program_->set_version(program_desc_->Version());
+  }
+  program_generated_ = true;
+  PrepareFeedFetch();
+  // The same as Build, verify the op versions of the saved model against the
+  // kernels of this library.
+  CheckPaddleOpVersions(program_desc_);
+#ifdef ENABLE_ARM_FP16
+  WeightFP32ToFP16();
+#endif
+}
+
 void Predictor::Build(const std::string &model_path,
                       const std::string &model_file,
                       const std::string &param_file,
@@ -418,34 +639,7 @@ void Predictor::Build(const std::shared_ptr<cpp::ProgramDesc> &program_desc,
                       const lite_api::CxxConfig &config) {
   program_desc_ = program_desc;
   // `inner_places` is used to optimize passes
-  std::vector<Place> inner_places = valid_places;
-  for (auto &valid_place : valid_places) {
-    if (valid_place.target == TARGET(kOpenCL)) continue;
-    inner_places.emplace_back(
-        Place(TARGET(kHost), valid_place.precision, valid_place.layout));
-  }
-
-  if (IsQuantizedMode(program_desc_)) {
-    for (auto &valid_place : valid_places) {
-      if (valid_place.target == TARGET(kARM)) {
-        inner_places.insert(inner_places.begin(),
-                            Place{TARGET(kARM), PRECISION(kInt8)});
-      }
-      if (valid_place.target == TARGET(kX86)) {
-        inner_places.insert(inner_places.begin(),
-                            Place{TARGET(kX86), PRECISION(kInt8)});
-      }
-    }
-  }
-  // XPU target must make sure to insert in front of others.
-  if (IsQuantizedMode(program_desc_)) {
-    for (auto &valid_place : valid_places) {
-      if (valid_place.target == TARGET(kXPU)) {
-        inner_places.insert(inner_places.begin(),
-                            Place{TARGET(kXPU), PRECISION(kInt8)});
-      }
-    }
-  }
+  std::vector<Place> inner_places = InnerPlaces(program_desc_, valid_places);
   Program program(program_desc_, scope_, inner_places);
   valid_places_ = inner_places;
 
@@ -605,6 +799,8 @@ bool Predictor::TryShrinkMemory() {
       continue;
     }
   }
+  // Give the cached host memory back beyond the retained budget.
+  HostMemoryPool::Global().Shrink();
   return true;
 }
 
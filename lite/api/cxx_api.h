@@ -102,6 +102,11 @@ class LITE_API Predictor {
       const std::vector<std::string>& passes = {},
       lite_api::LiteModelType model_type = lite_api::LiteModelType::kProtobuf);
 
+  // Build from an optimized model saved by the optimized model cache, the
+  // optimization and the kernel picking are skipped.
+  void BuildFromOptimizedModel(const std::string& model_file,
+                               const std::vector<Place>& valid_places);
+
   void Build(
       const std::string& model_path,
       const std::string& model_file_path,
@@ -215,6 +220,27 @@ class LITE_API Predictor {
   /// \return a boolean variable.
   bool TryShrinkMemory();
 
+  // Run the independent ops concurrently, see
+  // RuntimeProgram::EnableInterOpParallel().
+  void EnableInterOpParallel(int inter_op_threads,
+                             int intra_op_threads,
+                             lite_api::PowerMode mode) {
+    program_->EnableInterOpParallel(inter_op_threads, intra_op_threads, mode);
+  }
+
+  // See RuntimeProgram::EnableFrozenShape().
+  void EnableFrozenShape() { program_->EnableFrozenShape(); }
+
+  // See RuntimeProgram::MapEmbeddingTables().
+  void MapEmbeddingTables(const std::string& dir, bool fp16) {
+    program_->MapEmbeddingTables(dir, fp16);
+  }
+
+  // Get the bytes of memory held by the activations in exec scope.
+  size_t GetActivationMemorySize() const {
+    return exec_scope_->LocalTensorsMemorySize();
+  }
+
   // Get offset-th col of feed inputs.
   lite::Tensor* GetInput(size_t offset);
   // get input by name.
@@ -346,6 +372,8 @@ class CxxPaddleApiImpl : public lite_api::PaddlePredictor {
   /// \return a boolean variable.
   bool TryShrinkMemory() override;
 
+  size_t GetActivationMemorySize() const override;
+
   std::shared_ptr<lite_api::PaddlePredictor> Clone() override;
 
   std::shared_ptr<lite_api::PaddlePredictor> Clone(
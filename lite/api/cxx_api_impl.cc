@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "lite/api/cxx_api.h"
+#include <algorithm>
 #include <memory>
 #include <mutex>  //NOLINT
 #include <string>
@@ -37,13 +38,23 @@
 #endif
 #include "lite/backends/x86/mklml.h"
 #endif
+#if (defined LITE_WITH_X86) && !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
+#include "lite/backends/x86/jit/autotune.h"
+#endif
 namespace paddle {
 namespace lite {
 
 void CxxPaddleApiImpl::Init(const lite_api::CxxConfig &config) {
   config_ = config;
   mode_ = config.power_mode();
-  threads_ = config.threads();
+  // The threads are divided among the concurrent ops, which can't share
+  // the thread pool.
+#ifdef LITE_USE_THREAD_POOL
+  int inter_op_threads = 1;
+#else
+  int inter_op_threads = std::max(config.inter_op_threads(), 1);
+#endif
+  threads_ = std::max(config.threads() / inter_op_threads, 1);
   raw_predictor_->SetTargetConfigs(config.target_configs());
 #ifdef LITE_WITH_XPU
   CHECK(config.target_configs().at(TARGET(kXPU)).get()) << "no xpu config set";
@@ -131,9 +142,15 @@ void CxxPaddleApiImpl::Init(const lite_api::CxxConfig &config) {
   raw_predictor_->ConfigMetalContext(config);
 #endif
 
+#if (defined LITE_WITH_X86) && !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
+  if (config.x86_jit_autotune()) {
+    jit::Autotuner::Global().Enable(config.x86_jit_autotune_file());
+  }
+#endif
+
 #if (defined LITE_WITH_X86) && (defined PADDLE_WITH_MKLML) && \
     !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
-  int num_threads = config.x86_math_num_threads();
+  int num_threads = config.x86_math_num_threads() / inter_op_threads;
   int real_num_threads = num_threads > 1 ? num_threads : 1;
 #ifdef LITE_WITH_STATIC_MKL
   MKL_Set_Num_Threads(real_num_threads);
@@ -148,6 +165,23 @@ void CxxPaddleApiImpl::Init(const lite_api::CxxConfig &config) {
           << real_num_threads;
 #endif
 
+  if (inter_op_threads > 1) {
+    int intra_op_threads = threads_;
+#if (defined LITE_WITH_X86) && (defined PADDLE_WITH_MKLML) && \
+    !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
+    intra_op_threads = real_num_threads;
+#endif
+    raw_predictor_->EnableInterOpParallel(
+        inter_op_threads, intra_op_threads, mode_);
+  }
+  if (!config.embedding_table_dir().empty() || config.embedding_table_fp16()) {
+    raw_predictor_->MapEmbeddingTables(config.embedding_table_dir(),
+                                       config.embedding_table_fp16());
+  }
+  if (config.frozen_shape()) {
+    raw_predictor_->EnableFrozenShape();
+  }
+
 #ifdef LITE_WITH_XPU
   auto preferred_inputs = config.preferred_inputs_for_warmup();
   for (auto &preferred_input : preferred_inputs) {
@@ -197,6 +231,7 @@ void CxxPaddleApiImpl::Init(const lite_api::CxxConfig &config) {
 }
 
 CxxPaddleApiImpl::~CxxPaddleApiImpl() {
+  WaitAsyncRuns();
 #ifdef LITE_USE_THREAD_POOL
   ThreadPool::ReleaseThreadPool();
 #endif
@@ -285,6 +320,10 @@ bool CxxPaddleApiImpl::TryShrinkMemory() {
   return raw_predictor_->TryShrinkMemory();
 }
 
+size_t CxxPaddleApiImpl::GetActivationMemorySize() const {
+  return raw_predictor_->GetActivationMemorySize();
+}
+
 void CxxPaddleApiImpl::SetStream(TargetType target, void *stream) {
   raw_predictor_->SetStream(target, stream);
 }
@@ -303,5 +342,9 @@ std::shared_ptr<PaddlePredictor> CreatePaddlePredictor(
   return x;
 }
 
+PredictorPool::PredictorPool(const CxxConfig &config, size_t size) {
+  Init(CreatePaddlePredictor<CxxConfig>(config), size);
+}
+
 }  // namespace lite_api
 }  // namespace paddle
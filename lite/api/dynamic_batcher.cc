@@ -0,0 +1,398 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include "lite/api/paddle_api.h"
+#include "lite/utils/log/cp_logging.h"
+
+namespace paddle {
+namespace lite_api {
+
+struct DynamicBatcher::Request {
+  std::vector<BatchTensor> inputs;
+  int64_t num_samples{0};
+  std::chrono::steady_clock::time_point enqueue_time;
+  std::promise<std::vector<BatchTensor>> promise;
+};
+
+namespace {
+
+int64_t ShapeProduction(const shape_t& shape, size_t begin = 0) {
+  int64_t res = 1;
+  for (size_t i = begin; i < shape.size(); i++) {
+    res *= shape[i];
+  }
+  return res;
+}
+
+// The samples of a dense tensor are the rows of dim 0, and the samples of a
+// LoD tensor are the sequences of the top level LoD.
+int64_t NumSamples(const BatchTensor& tensor) {
+  return tensor.lod.empty() ? tensor.shape[0]
+                            : static_cast<int64_t>(tensor.lod[0].size()) - 1;
+}
+
+bool Coalescible(const std::vector<BatchTensor>& a,
+                 const std::vector<BatchTensor>& b) {
+  for (size_t i = 0; i < a.size(); i++) {
+    if (a[i].precision != b[i].precision ||
+        a[i].shape.size() != b[i].shape.size() ||
+        a[i].lod.size() != b[i].lod.size()) {
+      return false;
+    }
+    for (size_t j = 1; j < a[i].shape.size(); j++) {
+      if (a[i].shape[j] != b[i].shape[j]) return false;
+    }
+  }
+  return true;
+}
+
+// The precisions whose elements can be merged by `MutableHostData`.
+bool Batchable(PrecisionType precision) {
+  switch (precision) {
+    case PRECISION(kFloat):
+    case PRECISION(kFP64):
+    case PRECISION(kInt8):
+    case PRECISION(kUInt8):
+    case PRECISION(kInt16):
+    case PRECISION(kInt32):
+    case PRECISION(kInt64):
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Only the request which owns `promise` fails, the worker thread goes on
+// serving the others.
+void Fail(std::promise<std::vector<BatchTensor>>* promise,
+          const std::string& error) {
+#ifdef LITE_WITH_EXCEPTION
+  promise->set_exception(
+      std::make_exception_ptr(std::invalid_argument(error)));
+#else
+  LOG(ERROR) << error;
+  promise->set_value(std::vector<BatchTensor>());
+#endif
+}
+
+// Returns the reason why `inputs` can't be served, or an empty string.
+std::string CheckInputs(const std::vector<BatchTensor>& inputs,
+                        size_t num_inputs) {
+  if (inputs.size() != num_inputs) {
+    return "The request should have one tensor for each input of the model.";
+  }
+  int64_t num_samples = 0;
+  for (size_t i = 0; i < inputs.size(); i++) {
+    const auto& input = inputs[i];
+    std::string name = "input " + std::to_string(i);
+    if (!Batchable(input.precision)) {
+      return "Unsupported precision " + PrecisionToStr(input.precision) +
+             " of " + name + " for dynamic batching.";
+    }
+    if (input.shape.empty()) return "The " + name + " is a scalar.";
+    size_t bytes = ShapeProduction(input.shape) *
+                   PrecisionTypeLength(input.precision);
+    if (input.data.size() != bytes) {
+      return "The data size of " + name + " doesn't match its shape.";
+    }
+    if (!input.lod.empty() &&
+        (input.lod.back().empty() ||
+         input.lod.back().back() != static_cast<uint64_t>(input.shape[0]))) {
+      return "The LoD of " + name + " doesn't match its dim 0.";
+    }
+    if (i == 0) {
+      num_samples = NumSamples(input);
+      if (num_samples <= 0) return "The request has no samples.";
+    } else if (NumSamples(input) != num_samples) {
+      return "All the inputs of a request should have the same samples.";
+    }
+  }
+  return "";
+}
+
+// Returns the reason why the batched `output` of `total_samples` samples
+// can't be split back to the requests, or an empty string.
+std::string CheckOutput(const Tensor& output,
+                        int64_t total_samples,
+                        bool split) {
+  auto target = output.target();
+  if (target != TARGET(kHost) && target != TARGET(kX86) &&
+      target != TARGET(kARM)) {
+    return "Dynamic batching only supports the outputs on host, but got " +
+           TargetToStr(target) + ".";
+  }
+  if (PrecisionTypeLength(output.precision()) == 0) {
+    return "Unsupported output precision " +
+           PrecisionToStr(output.precision()) + " for dynamic batching.";
+  }
+  if (!split) return "";
+  auto shape = output.shape();
+  if (shape.empty()) return "Can't split a scalar output.";
+  auto lod = output.lod();
+  if ((lod.empty() ||
+       lod[0].size() != static_cast<size_t>(total_samples) + 1) &&
+      shape[0] % total_samples != 0) {
+    return "The dim 0 of the output " + std::to_string(shape[0]) +
+           " can't be split into " + std::to_string(total_samples) +
+           " samples.";
+  }
+  return "";
+}
+
+void* MutableHostData(Tensor* tensor, PrecisionType precision) {
+  switch (precision) {
+    case PRECISION(kFloat):
+      return tensor->mutable_data<float>();
+    case PRECISION(kFP64):
+      return tensor->mutable_data<double>();
+    case PRECISION(kInt8):
+      return tensor->mutable_data<int8_t>();
+    case PRECISION(kUInt8):
+      return tensor->mutable_data<uint8_t>();
+    case PRECISION(kInt16):
+      return tensor->mutable_data<int16_t>();
+    case PRECISION(kInt32):
+      return tensor->mutable_data<int32_t>();
+    case PRECISION(kInt64):
+      return tensor->mutable_data<int64_t>();
+    default:
+      LOG(FATAL) << "Unsupported precision " << PrecisionToStr(precision)
+                 << " for dynamic batching.";
+  }
+  return nullptr;
+}
+
+// Copy the samples [begin, end) of the batched output which has
+// `total_samples` samples, the output should have passed `CheckOutput`.
+BatchTensor SliceOutput(const Tensor& output,
+                        int64_t total_samples,
+                        int64_t begin,
+                        int64_t end) {
+  BatchTensor res;
+  res.shape = output.shape();
+  res.precision = output.precision();
+  auto lod = output.lod();
+  uint64_t row_begin = begin;
+  uint64_t row_end = end;
+  if (begin == 0 && end == total_samples) {
+    // The batch holds only one request, return the whole output.
+    res.lod = lod;
+    size_t bytes =
+        ShapeProduction(res.shape) * PrecisionTypeLength(res.precision);
+    const uint8_t* src = static_cast<const uint8_t*>(output.data<void>());
+    res.data.assign(src, src + bytes);
+    return res;
+  }
+  if (!lod.empty() &&
+      lod[0].size() == static_cast<size_t>(total_samples) + 1) {
+    res.lod.resize(lod.size());
+    for (size_t level = 0; level < lod.size(); level++) {
+      const auto& offsets = lod[level];
+      for (uint64_t i = row_begin; i <= row_end; i++) {
+        res.lod[level].push_back(offsets[i] - offsets[row_begin]);
+      }
+      row_end = offsets[row_end];
+      row_begin = offsets[row_begin];
+    }
+  } else {
+    int64_t rows = res.shape[0] / total_samples;
+    row_begin = begin * rows;
+    row_end = end * rows;
+  }
+  res.shape[0] = row_end - row_begin;
+  size_t row_bytes =
+      ShapeProduction(res.shape, 1) * PrecisionTypeLength(res.precision);
+  const uint8_t* src = static_cast<const uint8_t*>(output.data<void>());
+  res.data.assign(src + row_begin * row_bytes, src + row_end * row_bytes);
+  return res;
+}
+
+}  // namespace
+
+DynamicBatcher::DynamicBatcher(std::shared_ptr<PaddlePredictor> predictor,
+                               const DynamicBatchingConfig& config)
+    : predictor_(predictor), config_(config) {
+  CHECK(predictor_) << "The predictor of DynamicBatcher should not be null.";
+  CHECK_GT(config_.max_batch_size, 0);
+  CHECK_GE(config_.max_queue_delay_us, 0);
+  num_inputs_ = predictor_->GetInputNames().size();
+  num_outputs_ = predictor_->GetOutputNames().size();
+  worker_ = std::thread(&DynamicBatcher::Loop, this);
+}
+
+DynamicBatcher::~DynamicBatcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  queue_cv_.notify_all();
+  worker_.join();
+}
+
+std::future<std::vector<BatchTensor>> DynamicBatcher::Submit(
+    std::vector<BatchTensor> inputs) {
+  std::unique_ptr<Request> request(new Request);
+  auto future = request->promise.get_future();
+  // An invalid request fails here instead of on the worker thread, where it
+  // would abort the batch it is coalesced with.
+  auto error = CheckInputs(inputs, num_inputs_);
+  if (!error.empty()) {
+    Fail(&request->promise, error);
+    return future;
+  }
+  request->num_samples = NumSamples(inputs[0]);
+  request->inputs = std::move(inputs);
+  request->enqueue_time = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CHECK(!stop_) << "The DynamicBatcher has been stopped.";
+    queue_.push_back(std::move(request));
+  }
+  queue_cv_.notify_one();
+  return future;
+}
+
+int64_t DynamicBatcher::ReadySamples() const {
+  const auto& head = queue_.front()->inputs;
+  int64_t samples = 0;
+  for (const auto& request : queue_) {
+    if (Coalescible(head, request->inputs)) {
+      samples += request->num_samples;
+    }
+  }
+  return samples;
+}
+
+void DynamicBatcher::CollectBatch(
+    std::vector<std::unique_ptr<Request>>* batch) {
+  // The oldest request always runs, even if it's larger than
+  // `max_batch_size`, the following ones are coalesced while they fit.
+  int64_t samples = queue_.front()->num_samples;
+  batch->push_back(std::move(queue_.front()));
+  queue_.pop_front();
+  const auto& head = batch->front()->inputs;
+  for (auto it = queue_.begin();
+       it != queue_.end() && samples < config_.max_batch_size;) {
+    if (Coalescible(head, (*it)->inputs) &&
+        samples + (*it)->num_samples <= config_.max_batch_size) {
+      samples += (*it)->num_samples;
+      batch->push_back(std::move(*it));
+      it = queue_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+void DynamicBatcher::Loop() {
+  while (true) {
+    std::vector<std::unique_ptr<Request>> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      queue_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      // Stopped and all the queued requests are done.
+      if (queue_.empty()) break;
+      auto deadline = queue_.front()->enqueue_time +
+                      std::chrono::microseconds(config_.max_queue_delay_us);
+      queue_cv_.wait_until(lock, deadline, [this] {
+        return stop_ || ReadySamples() >= config_.max_batch_size;
+      });
+      CollectBatch(&batch);
+    }
+    RunBatch(&batch);
+  }
+}
+
+void DynamicBatcher::RunBatch(std::vector<std::unique_ptr<Request>>* batch) {
+#ifdef LITE_WITH_EXCEPTION
+  try {
+#endif
+    std::vector<int64_t> offsets{0};
+    for (const auto& request : *batch) {
+      offsets.push_back(offsets.back() + request->num_samples);
+    }
+    for (size_t i = 0; i < num_inputs_; i++) {
+      const auto& head = batch->front()->inputs[i];
+      shape_t shape = head.shape;
+      shape[0] = 0;
+      lod_t lod(head.lod.size(), std::vector<uint64_t>({0}));
+      for (const auto& request : *batch) {
+        const auto& input = request->inputs[i];
+        shape[0] += input.shape[0];
+        for (size_t level = 0; level < lod.size(); level++) {
+          const auto& level_lod = input.lod[level];
+          uint64_t shift = lod[level].back() - level_lod.front();
+          for (size_t j = 1; j < level_lod.size(); j++) {
+            lod[level].push_back(level_lod[j] + shift);
+          }
+        }
+      }
+      auto tensor = predictor_->GetInput(i);
+      tensor->Resize(shape);
+      tensor->SetLoD(lod);
+      auto* dst =
+          static_cast<uint8_t*>(MutableHostData(tensor.get(), head.precision));
+      for (const auto& request : *batch) {
+        const auto& data = request->inputs[i].data;
+        std::memcpy(dst, data.data(), data.size());
+        dst += data.size();
+      }
+    }
+
+    predictor_->Run();
+
+    bool split = batch->size() > 1;
+    std::vector<std::unique_ptr<const Tensor>> outputs;
+    for (size_t i = 0; i < num_outputs_; i++) {
+      outputs.push_back(predictor_->GetOutput(i));
+      auto error = CheckOutput(*outputs.back(), offsets.back(), split);
+      if (error.empty()) continue;
+      if (split) {
+        // The outputs don't map to the samples, the requests are run one by
+        // one so that each of them gets its own whole outputs.
+        for (auto& request : *batch) {
+          std::vector<std::unique_ptr<Request>> single;
+          single.push_back(std::move(request));
+          RunBatch(&single);
+        }
+      } else {
+        Fail(&batch->front()->promise, error);
+      }
+      return;
+    }
+    for (size_t k = 0; k < batch->size(); k++) {
+      std::vector<BatchTensor> results;
+      for (const auto& output : outputs) {
+        results.push_back(
+            SliceOutput(*output, offsets.back(), offsets[k], offsets[k + 1]));
+      }
+      (*batch)[k]->promise.set_value(std::move(results));
+    }
+#ifdef LITE_WITH_EXCEPTION
+  } catch (...) {
+    for (const auto& request : *batch) {
+      if (request) request->promise.set_exception(std::current_exception());
+    }
+  }
+#endif
+}
+
+}  // namespace lite_api
+}  // namespace paddle
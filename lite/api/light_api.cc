@@ -15,6 +15,7 @@
 #include "lite/api/light_api.h"
 #include <algorithm>
 #include <map>
+#include "lite/core/memory_pool.h"
 #ifdef ENABLE_ARM_FP16
 #include "lite/backends/arm/math/fp16/funcs_fp16.h"
 #endif
@@ -22,6 +23,28 @@
 namespace paddle {
 namespace lite {
 
+LightPredictor::LightPredictor(
+    const std::shared_ptr<Scope>& root_scope,
+    const std::shared_ptr<cpp::ProgramDesc>& program_desc,
+    bool use_low_precision,
+    const std::vector<std::string>& var_names)
+    : scope_(root_scope), program_desc_(program_desc) {
+  CHECK(scope_) << "The scope to be shared should not be nullptr.";
+  CHECK(program_desc_) << "The program desc should not be nullptr.";
+  use_low_precision_ = use_low_precision;
+  // The weights have been dequantized and converted by the predictor being
+  // cloned, so only the runtime program is built here.
+  BuildRuntimeProgram(program_desc_, use_low_precision_);
+  auto* exec_scope = program_->exec_scope();
+  for (auto& var_name : var_names) {
+    exec_scope->LocalVar(var_name);
+    auto* tensor = scope_->Var(var_name)->GetMutable<lite::Tensor>();
+    auto* sub_tensor = exec_scope->Var(var_name)->GetMutable<lite::Tensor>();
+    sub_tensor->CopyDataFrom(*tensor);
+  }
+  PrepareFeedFetch();
+}
+
 void LightPredictor::Build(const std::string& lite_model_file) {
   LoadModelNaiveFromFile(lite_model_file, scope_.get(), program_desc_.get());
   // For weight quantization of post training, load the int8/16 weights
@@ -507,6 +530,8 @@ bool LightPredictor::TryShrinkMemory() {
       continue;
     }
   }
+  // Give the cached host memory back beyond the retained budget.
+  HostMemoryPool::Global().Shrink();
   return true;
 }
 void LightPredictor::ClearTensorArray(
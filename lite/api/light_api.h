@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <map>
 #include <memory>
+#include <mutex>  //NOLINT
 #include <string>
 #include <utility>
 #include <vector>
@@ -74,6 +75,23 @@ class LITE_API LightPredictor {
     Build(model_dir, model_buffer, param_buffer, model_type, model_from_memory);
   }
 
+  // NOTE: This constructor can only be called in LightPredictor->Clone, the
+  // persistable variables in `root_scope` are shared with the predictor
+  // being cloned except the ones in `var_names`.
+  LightPredictor(const std::shared_ptr<Scope>& root_scope,
+                 const std::shared_ptr<cpp::ProgramDesc>& program_desc,
+                 bool use_low_precision,
+                 const std::vector<std::string>& var_names = {});
+
+  // Create a predictor sharing the persistable variables with this one,
+  // the variables in `var_names` are copied into the private scope of the
+  // new predictor.
+  std::unique_ptr<LightPredictor> Clone(
+      const std::vector<std::string>& var_names = {}) {
+    return std::unique_ptr<LightPredictor>(new LightPredictor(
+        scope_, program_desc_, use_low_precision_, var_names));
+  }
+
   void Run() {
     CheckInputValid();
     program_->Run();
@@ -88,6 +106,29 @@ class LITE_API LightPredictor {
   bool TryShrinkMemory();
   bool use_low_precision_ = false;
 
+  // Run the independent ops concurrently, see
+  // RuntimeProgram::EnableInterOpParallel().
+  void EnableInterOpParallel(int inter_op_threads,
+                             int intra_op_threads,
+                             lite_api::PowerMode mode) {
+    program_->EnableInterOpParallel(inter_op_threads, intra_op_threads, mode);
+  }
+
+  // See RuntimeProgram::EnableFrozenShape().
+  void EnableFrozenShape() { program_->EnableFrozenShape(); }
+
+  // See RuntimeProgram::MapEmbeddingTables().
+  void MapEmbeddingTables(const std::string& dir, bool fp16) {
+    program_->MapEmbeddingTables(dir, fp16);
+  }
+
+  const RuntimeProgram& runtime_program() const { return *program_; }
+
+  // Get the bytes of memory held by the activations in exec scope.
+  size_t GetActivationMemorySize() const {
+    return program_->exec_scope()->LocalTensorsMemorySize();
+  }
+
   // Get offset-th col of feed inputs.
   Tensor* GetInput(size_t offset);
   // get input by name.
@@ -191,10 +232,23 @@ class LightPredictorImpl : public lite_api::PaddlePredictor {
   /// \return a boolean variable.
   bool TryShrinkMemory() override;
 
+  size_t GetActivationMemorySize() const override;
+
   bool use_low_precision_ = false;
 
+  const lite_api::MobileConfig& config() const { return config_; }
+  const LightPredictor* raw_predictor() const { return raw_predictor_.get(); }
+
  private:
+  // Apply the settings of `config_` which are made to the runtime program
+  // after it's built, they are applied to the clones again.
+  void ConfigRawPredictor();
+
   std::unique_ptr<lite::LightPredictor> raw_predictor_;
+  lite_api::MobileConfig config_;
+  int inter_op_threads_{1};
+  int intra_op_threads_{1};
+  std::mutex mutex_;
 };
 
 }  // namespace lite
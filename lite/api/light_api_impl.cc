@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "lite/api/light_api.h"
+#include <algorithm>
 #include <string>
 #include "lite/api/paddle_api.h"
 #include "lite/core/version.h"
@@ -28,6 +29,9 @@
     !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
 #include "lite/backends/x86/mklml.h"
 #endif
+#if (defined LITE_WITH_X86) && !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
+#include "lite/backends/x86/jit/autotune.h"
+#endif
 
 namespace paddle {
 namespace lite {
@@ -59,8 +63,18 @@ void LightPredictorImpl::Init(const lite_api::MobileConfig& config) {
                                             use_low_precision));
   }
 
+  config_ = config;
   mode_ = config.power_mode();
-  threads_ = config.threads();
+  // The threads are divided among the concurrent ops, which can't share
+  // the thread pool.
+#ifdef LITE_USE_THREAD_POOL
+  int inter_op_threads = 1;
+#else
+  int inter_op_threads = std::max(config.inter_op_threads(), 1);
+#endif
+  threads_ = std::max(config.threads() / inter_op_threads, 1);
+  inter_op_threads_ = inter_op_threads;
+  intra_op_threads_ = threads_;
 #ifdef LITE_USE_THREAD_POOL
   int thread_num = ThreadPool::Init(threads_);
   if (thread_num > 1) {
@@ -68,30 +82,15 @@ void LightPredictorImpl::Init(const lite_api::MobileConfig& config) {
   }
 #endif
 
-#ifdef LITE_WITH_METAL
-  raw_predictor_->ConfigMetalContext(config);
-#endif
-
-#if defined(LITE_ON_MODEL_OPTIMIZE_TOOL) || defined(LITE_WITH_PYTHON) || \
-    defined(LITE_WITH_NNADAPTER)
-  // Use scope to store the model-level configuration for the subgraph kernel
-  Context<TargetType::kNNAdapter>::SetNNAdapterDeviceNames(
-      raw_predictor_->scope(), config.nnadapter_device_names());
-  Context<TargetType::kNNAdapter>::SetNNAdapterContextProperties(
-      raw_predictor_->scope(), config.nnadapter_context_properties());
-  Context<TargetType::kNNAdapter>::SetNNAdapterContextCallback(
-      raw_predictor_->scope(), config.nnadapter_context_callback());
-  Context<TargetType::kNNAdapter>::SetNNAdapterModelCacheDir(
-      raw_predictor_->scope(), config.nnadapter_model_cache_dir());
-  Context<TargetType::kNNAdapter>::SetNNAdapterModelCacheBuffers(
-      raw_predictor_->scope(), config.nnadapter_model_cache_buffers());
-  Context<TargetType::kNNAdapter>::SetNNAdapterDynamicShapeInfo(
-      raw_predictor_->scope(), config.nnadapter_dynamic_shape_info());
+#if (defined LITE_WITH_X86) && !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
+  if (config.x86_jit_autotune()) {
+    jit::Autotuner::Global().Enable(config.x86_jit_autotune_file());
+  }
 #endif
 
 #if (defined LITE_WITH_X86) && (defined PADDLE_WITH_MKLML) && \
     !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
-  int num_threads = config.x86_math_num_threads();
+  int num_threads = config.x86_math_num_threads() / inter_op_threads;
   int real_num_threads = num_threads > 1 ? num_threads : 1;
 #ifdef LITE_WITH_STATIC_MKL
   MKL_Set_Num_Threads(real_num_threads);
@@ -102,9 +101,52 @@ void LightPredictorImpl::Init(const lite_api::MobileConfig& config) {
              "number of threads is:"
           << real_num_threads;
 #endif
+
+#if (defined LITE_WITH_X86) && (defined PADDLE_WITH_MKLML) && \
+    !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
+  intra_op_threads_ = real_num_threads;
+#endif
+  ConfigRawPredictor();
+}
+
+void LightPredictorImpl::ConfigRawPredictor() {
+#ifdef LITE_WITH_METAL
+  raw_predictor_->ConfigMetalContext(config_);
+#endif
+
+#if defined(LITE_ON_MODEL_OPTIMIZE_TOOL) || defined(LITE_WITH_PYTHON) || \
+    defined(LITE_WITH_NNADAPTER)
+  // Use scope to store the model-level configuration for the subgraph kernel
+  Context<TargetType::kNNAdapter>::SetNNAdapterDeviceNames(
+      raw_predictor_->scope(), config_.nnadapter_device_names());
+  Context<TargetType::kNNAdapter>::SetNNAdapterContextProperties(
+      raw_predictor_->scope(), config_.nnadapter_context_properties());
+  Context<TargetType::kNNAdapter>::SetNNAdapterContextCallback(
+      raw_predictor_->scope(), config_.nnadapter_context_callback());
+  Context<TargetType::kNNAdapter>::SetNNAdapterModelCacheDir(
+      raw_predictor_->scope(), config_.nnadapter_model_cache_dir());
+  Context<TargetType::kNNAdapter>::SetNNAdapterModelCacheBuffers(
+      raw_predictor_->scope(), config_.nnadapter_model_cache_buffers());
+  Context<TargetType::kNNAdapter>::SetNNAdapterDynamicShapeInfo(
+      raw_predictor_->scope(), config_.nnadapter_dynamic_shape_info());
+#endif
+
+  if (inter_op_threads_ > 1) {
+    raw_predictor_->EnableInterOpParallel(
+        inter_op_threads_, intra_op_threads_, mode_);
+  }
+  if (!config_.embedding_table_dir().empty() ||
+      config_.embedding_table_fp16()) {
+    raw_predictor_->MapEmbeddingTables(config_.embedding_table_dir(),
+                                       config_.embedding_table_fp16());
+  }
+  if (config_.frozen_shape()) {
+    raw_predictor_->EnableFrozenShape();
+  }
 }
 
 LightPredictorImpl::~LightPredictorImpl() {
+  WaitAsyncRuns();
 #ifdef LITE_USE_THREAD_POOL
   ThreadPool::ReleaseThreadPool();
 #endif
@@ -141,14 +183,31 @@ void LightPredictorImpl::Run() {
 }
 
 std::shared_ptr<lite_api::PaddlePredictor> LightPredictorImpl::Clone() {
-  LOG(FATAL) << "The Clone API is not supported in LigthPredictor";
-  return nullptr;
+  return Clone(std::vector<std::string>());
 }
 
 std::shared_ptr<lite_api::PaddlePredictor> LightPredictorImpl::Clone(
     const std::vector<std::string>& var_names) {
-  LOG(FATAL) << "The Clone API is not supported in LigthPredictor";
-  return nullptr;
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto predictor = std::make_shared<LightPredictorImpl>();
+  predictor->raw_predictor_ = raw_predictor_->Clone(var_names);
+  predictor->use_low_precision_ = use_low_precision_;
+  predictor->config_ = config_;
+  predictor->mode_ = mode_;
+  predictor->threads_ = threads_;
+  predictor->inter_op_threads_ = inter_op_threads_;
+  predictor->intra_op_threads_ = intra_op_threads_;
+  // The post-build settings of the runtime program aren't copied by the
+  // raw predictor.
+  predictor->ConfigRawPredictor();
+#ifdef LITE_USE_THREAD_POOL
+  // Keep pace with ThreadPool::ReleaseThreadPool in the destructor.
+  int thread_num = ThreadPool::Init(threads_);
+  if (thread_num > 1) {
+    ThreadPool::AcquireThreadPool();
+  }
+#endif
+  return predictor;
 }
 
 std::string LightPredictorImpl::GetVersion() const { return lite::version(); }
@@ -171,6 +230,10 @@ bool LightPredictorImpl::TryShrinkMemory() {
   return raw_predictor_->TryShrinkMemory();
 }
 
+size_t LightPredictorImpl::GetActivationMemorySize() const {
+  return raw_predictor_->GetActivationMemorySize();
+}
+
 }  // namespace lite
 
 namespace lite_api {
@@ -183,5 +246,9 @@ std::shared_ptr<PaddlePredictor> CreatePaddlePredictor(
   return x;
 }
 
+PredictorPool::PredictorPool(const MobileConfig& config, size_t size) {
+  Init(CreatePaddlePredictor<MobileConfig>(config), size);
+}
+
 }  // namespace lite_api
 }  // namespace paddle
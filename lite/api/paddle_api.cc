@@ -18,6 +18,7 @@
 
 #include "lite/core/context.h"
 #include "lite/core/device_info.h"
+#include "lite/core/memory_pool.h"
 #include "lite/core/target_wrapper.h"
 #include "lite/core/tensor.h"
 
@@ -36,6 +37,10 @@
 #include "lite/backends/metal/target_wrapper.h"
 #endif
 
+#if (defined LITE_WITH_X86) && !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
+#include "lite/backends/x86/math/packed_weight_cache.h"
+#endif
+
 namespace paddle {
 namespace lite_api {
 
@@ -76,6 +81,28 @@ int GetOpenCLDeviceType() {
   return -1;
 }
 
+void EnableHostMemoryPool(const MemoryPoolConfig &config) {
+  lite::HostMemoryPool::Global().Enable(config);
+}
+
+void DisableHostMemoryPool() { lite::HostMemoryPool::Global().Disable(); }
+
+void TrimHostMemoryPool(size_t budget_bytes) {
+  lite::HostMemoryPool::Global().Trim(budget_bytes);
+}
+
+MemoryPoolStats GetHostMemoryPoolStats() {
+  return lite::HostMemoryPool::Global().stats();
+}
+
+size_t GetPackedWeightMemorySize() {
+#if (defined LITE_WITH_X86) && !(defined LITE_ON_MODEL_OPTIMIZE_TOOL)
+  return lite::x86::math::PackedWeightCache::Global().memory_size();
+#else
+  return 0;
+#endif
+}
+
 Tensor::Tensor(void *raw) : raw_tensor_(raw) {}
 
 // TODO(Superjomn) refine this by using another `const void* const_raw`;
@@ -102,6 +129,10 @@ const T *Tensor::data() const {
 void Tensor::ShareExternalMemory(void *data,
                                  size_t memory_size,
                                  TargetType target) {
+  if (data == nullptr) {
+    tensor(raw_tensor_)->ResetBuffer(std::make_shared<lite::Buffer>(), 0);
+    return;
+  }
   auto buf =
       std::make_shared<lite::Buffer>(lite::Buffer(data, target, memory_size));
   tensor(raw_tensor_)->ResetBuffer(buf, memory_size);
@@ -248,6 +279,133 @@ std::vector<std::string> PaddlePredictor::GetParamNames() {
   return null_result;
 }
 
+namespace {
+
+// Executes the asynchronous runs of one predictor in order on a dedicated
+// thread.
+class AsyncWorker {
+ public:
+  AsyncWorker()
+      : queue_(std::make_shared<Queue>()),
+        thread_(&AsyncWorker::Loop, queue_) {}
+
+  ~AsyncWorker() {
+    if (thread_.get_id() == std::this_thread::get_id()) {
+      // Released by one of its own runs, e.g. the callback drops the last
+      // reference to the predictor, which can't wait for the thread. Drain
+      // the pending runs here before the predictor goes, and let the thread
+      // exit on its own, it only holds the queue.
+      while (auto task = queue_->Pop(false)) task();
+      queue_->Stop();
+      thread_.detach();
+      return;
+    }
+    queue_->Stop();
+    thread_.join();
+  }
+
+  void Push(std::function<void()> task) { queue_->Push(std::move(task)); }
+
+ private:
+  class Queue {
+   public:
+    void Push(std::function<void()> task) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+      }
+      cv_.notify_one();
+    }
+
+    // Pop the next task, waiting for one if `wait` until it's stopped. An
+    // empty task is returned if there is none.
+    std::function<void()> Pop(bool wait) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      if (wait) cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      if (tasks_.empty()) return nullptr;
+      auto task = std::move(tasks_.front());
+      tasks_.pop_front();
+      return task;
+    }
+
+    void Stop() {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+      }
+      cv_.notify_one();
+    }
+
+   private:
+    std::deque<std::function<void()>> tasks_;
+    bool stop_{false};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+  };
+
+  // Drain the pending tasks before stopping.
+  static void Loop(std::shared_ptr<Queue> queue) {
+    while (auto task = queue->Pop(true)) task();
+  }
+
+  std::shared_ptr<Queue> queue_;
+  std::thread thread_;
+};
+
+// The workers of the predictors which have issued asynchronous runs. All the
+// accesses, including pushing the runs, are serialized by `AsyncWorkersMutex`
+// so that the worker of one predictor is created once and never used after
+// it's released.
+std::map<const PaddlePredictor *, std::unique_ptr<AsyncWorker>>
+    &AsyncWorkers() {
+  static auto *workers =
+      new std::map<const PaddlePredictor *, std::unique_ptr<AsyncWorker>>();
+  return *workers;
+}
+
+std::mutex &AsyncWorkersMutex() {
+  static auto *mutex = new std::mutex();
+  return *mutex;
+}
+
+}  // namespace
+
+std::future<void> PaddlePredictor::RunAsync(std::function<void()> callback) {
+  // std::function requires a copyable target, so the task is shared.
+  auto task = std::make_shared<std::packaged_task<void()>>([this, callback] {
+    Run();
+    if (callback) callback();
+  });
+  auto future = task->get_future();
+  std::lock_guard<std::mutex> lock(AsyncWorkersMutex());
+  auto &worker = AsyncWorkers()[this];
+  if (!worker) {
+    worker.reset(new AsyncWorker);
+  }
+  worker->Push([task] { (*task)(); });
+  return future;
+}
+
+void PaddlePredictor::WaitAsyncRuns() {
+  std::unique_ptr<AsyncWorker> worker;
+  {
+    std::lock_guard<std::mutex> lock(AsyncWorkersMutex());
+    auto it = AsyncWorkers().find(this);
+    if (it == AsyncWorkers().end()) return;
+    worker = std::move(it->second);
+    AsyncWorkers().erase(it);
+  }
+  // Drain the pending runs out of the lock, they may issue new runs of the
+  // other predictors.
+  worker.reset();
+}
+
+size_t PaddlePredictor::GetActivationMemorySize() const {
+  LOG(FATAL) << "The GetActivationMemorySize API is not supported by this "
+                "predictor.";
+  return 0;
+}
+
 void PaddlePredictor::SaveOptimizedModel(const std::string &model_dir,
                                          LiteModelType model_type,
                                          bool record_info) {
@@ -260,6 +418,63 @@ std::shared_ptr<PaddlePredictor> CreatePaddlePredictor(const ConfigT &) {
   return std::shared_ptr<PaddlePredictor>();
 }
 
+void PredictorPool::Init(std::shared_ptr<PaddlePredictor> main_predictor,
+                         size_t size) {
+  CHECK_GT(size, 0u) << "The size of predictor pool should be positive.";
+  CHECK(main_predictor) << "Failed to create the predictor.";
+  predictors_.reserve(size);
+  predictors_.push_back(main_predictor);
+  // The cloned predictors share the persistable weights with the main one.
+  for (size_t i = 1; i < size; i++) {
+    predictors_.push_back(main_predictor->Clone());
+  }
+  for (size_t i = size; i > 0; i--) {
+    idle_predictors_.push_back(i - 1);
+  }
+}
+
+PaddlePredictor *PredictorPool::Retrieve(size_t idx) {
+  CHECK_LT(idx, predictors_.size()) << "The index " << idx
+                                    << " is out of the range of pool size "
+                                    << predictors_.size();
+  return predictors_[idx].get();
+}
+
+std::shared_ptr<PaddlePredictor> PredictorPool::Borrow() {
+  size_t idx = idle_predictors_.back();
+  idle_predictors_.pop_back();
+  return std::shared_ptr<PaddlePredictor>(
+      predictors_[idx].get(),
+      [this, idx](PaddlePredictor *) { GiveBack(idx); });
+}
+
+void PredictorPool::GiveBack(size_t idx) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    idle_predictors_.push_back(idx);
+  }
+  idle_cv_.notify_one();
+}
+
+std::shared_ptr<PaddlePredictor> PredictorPool::Acquire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_cv_.wait(lock, [this] { return !idle_predictors_.empty(); });
+  return Borrow();
+}
+
+std::shared_ptr<PaddlePredictor> PredictorPool::TryAcquire() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (idle_predictors_.empty()) return nullptr;
+  return Borrow();
+}
+
+size_t PredictorPool::GetActivationMemorySize(size_t idx) const {
+  CHECK_LT(idx, predictors_.size()) << "The index " << idx
+                                    << " is out of the range of pool size "
+                                    << predictors_.size();
+  return predictors_[idx]->GetActivationMemorySize();
+}
+
 ConfigBase::ConfigBase(PowerMode mode, int threads) {
 #ifdef LITE_WITH_ARM
   lite::DeviceInfo::Init();
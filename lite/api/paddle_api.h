@@ -19,10 +19,15 @@
 
 #ifndef PADDLE_LITE_API_H_  // NOLINT
 #define PADDLE_LITE_API_H_
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <functional>
+#include <future>  // NOLINT
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 #include "paddle_place.h"  // NOLINT
@@ -51,6 +56,24 @@ LITE_API bool IsOpenCLBackendValid(bool check_fp16_valid = false);
 // UNKNOWN:0, QUALCOMM_ADRENO:1, ARM_MALI:2, IMAGINATION_POWERVR:3, OTHERS:4,
 LITE_API int GetOpenCLDeviceType();
 
+// Enable the caching pool behind the host(kHost, kX86 and kARM) memory
+// allocation, which is shared by all the predictors of this process.
+LITE_API void EnableHostMemoryPool(
+    const MemoryPoolConfig& config = MemoryPoolConfig());
+// Disable the pool and return its cached memory to the system.
+LITE_API void DisableHostMemoryPool();
+// Return the cached memory of the pool to the system until at most
+// `budget_bytes` are cached.
+LITE_API void TrimHostMemoryPool(size_t budget_bytes = 0);
+LITE_API MemoryPoolStats GetHostMemoryPoolStats();
+
+// Get the bytes of the weights packed by the x86 GEMM kernels at their first
+// run, which are shared by all the predictors of this process. It's 0 if
+// the x86 kernels aren't built. The packed copies are looked up by the
+// address of the weights, so the weights mustn't be rewritten in place once
+// the predictors have run, the changes aren't seen by the kernels.
+LITE_API size_t GetPackedWeightMemorySize();
+
 struct LITE_API Tensor {
   explicit Tensor(void* raw);
   explicit Tensor(const void* raw);
@@ -69,6 +92,8 @@ struct LITE_API Tensor {
   // Share external memory. Note: ensure that the data pointer is in a valid
   // state
   // during the prediction process.
+  // Passing a nullptr `data` stops sharing the external memory, and the
+  // tensor will allocate its own memory in the following `mutable_data`.
   void ShareExternalMemory(void* data, size_t memory_size, TargetType target);
 
   template <typename T, TargetType type = TargetType::kHost>
@@ -106,6 +131,14 @@ class LITE_API PaddlePredictor {
   virtual std::unique_ptr<const Tensor> GetOutput(int i) const = 0;
 
   virtual void Run() = 0;
+
+  /// Run the predictor on its internal worker thread and return at once,
+  /// the runs of one predictor are executed in the order they are issued.
+  /// `callback`, if any, is invoked on the worker thread after the run. The
+  /// inputs must not be modified and the outputs must not be read until the
+  /// returned future is ready.
+  std::future<void> RunAsync(std::function<void()> callback = nullptr);
+
   virtual std::shared_ptr<PaddlePredictor> Clone() = 0;
   virtual std::shared_ptr<PaddlePredictor> Clone(
       const std::vector<std::string>& var_names) = 0;
@@ -122,6 +155,10 @@ class LITE_API PaddlePredictor {
   /// Release all tmp tensor to compress the size of the memory pool.
   virtual bool TryShrinkMemory() = 0;
 
+  /// Get the bytes of memory held by the activations(non-persistable
+  /// tensors) of this predictor, the shared weights are not included.
+  virtual size_t GetActivationMemorySize() const;
+
   // Get Input by name
   virtual std::unique_ptr<Tensor> GetInputByName(const std::string& name) = 0;
 
@@ -143,6 +180,12 @@ class LITE_API PaddlePredictor {
   virtual ~PaddlePredictor() = default;
 
  protected:
+  /// Wait for the pending asynchronous runs and stop the worker thread. The
+  /// derived predictors must call it first in their destructors, so that no
+  /// run is left on a partly destroyed predictor. The workers are kept
+  /// outside of the predictor to keep its layout unchanged.
+  void WaitAsyncRuns();
+
   int threads_{1};
   lite_api::PowerMode mode_{lite_api::LITE_POWER_NO_BIND};
 };
@@ -177,7 +220,13 @@ class LITE_API ConfigBase {
   // The buffers for loading the compiled NNAdapter models from memory.
   std::map<std::string, std::vector<char>> nnadapter_model_cache_buffers_{};
   int device_id_{0};
+  int inter_op_threads_{1};
+  bool frozen_shape_{false};
+  std::string embedding_table_dir_;
+  bool embedding_table_fp16_{false};
   int x86_math_num_threads_ = 1;
+  bool x86_jit_autotune_{false};
+  std::string x86_jit_autotune_file_;
 
   std::string metal_path_;
   bool metal_use_mps_{false};
@@ -196,6 +245,31 @@ class LITE_API ConfigBase {
   // set Thread
   void set_threads(int threads);
   int threads() const { return threads_; }
+  // Run the independent ops concurrently on `threads` threads, the threads
+  // set by set_threads() (ARM) or set_x86_math_num_threads() (x86) are
+  // divided among them for the intra-op parallelism. It's only supported
+  // by the CPU kernels.
+  void set_inter_op_threads(int threads) { inter_op_threads_ = threads; }
+  int inter_op_threads() const { return inter_op_threads_; }
+  // Replay the kernels without the shape inference until the input shapes
+  // are changed, which reduces the dispatch overhead of the small models.
+  // The output shapes of the ops must only depend on the input shapes.
+  void set_frozen_shape(bool frozen_shape) { frozen_shape_ = frozen_shape; }
+  bool frozen_shape() const { return frozen_shape_; }
+  // Save the embedding tables of the lookup ops to the files in `dir` and
+  // map them read-only, so that the worker processes running the same model
+  // share one copy of the tables. The files are reused if they're saved from
+  // the tables of the same content, otherwise they're rebuilt.
+  void set_embedding_table_dir(const std::string& dir) {
+    embedding_table_dir_ = dir;
+  }
+  const std::string& embedding_table_dir() const {
+    return embedding_table_dir_;
+  }
+  // Store the embedding tables of the x86 lookup_table kernels in fp16, which
+  // halves their memory. The model shouldn't be saved after that.
+  void set_embedding_table_fp16(bool fp16) { embedding_table_fp16_ = fp16; }
+  bool embedding_table_fp16() const { return embedding_table_fp16_; }
   // set Power_mode
   void set_power_mode(PowerMode mode);
   PowerMode power_mode() const { return mode_; }
@@ -331,6 +405,21 @@ class LITE_API ConfigBase {
   // set x86_math_num_threads
   void set_x86_math_num_threads(int threads);
   int x86_math_num_threads() const;
+  // Time the candidate functions of the x86 jit kernels at the first use and
+  // choose the fastest ones, which are shared by the whole process. The
+  // decisions are loaded from and appended to `decision_file` if it's set,
+  // so the next runs on the same host skip the tuning. The file records the
+  // instruction sets and the cpu model of the host, and is reset on the
+  // other hosts.
+  void set_x86_jit_autotune(bool enable,
+                            const std::string& decision_file = "") {
+    x86_jit_autotune_ = enable;
+    x86_jit_autotune_file_ = decision_file;
+  }
+  bool x86_jit_autotune() const { return x86_jit_autotune_; }
+  const std::string& x86_jit_autotune_file() const {
+    return x86_jit_autotune_file_;
+  }
 
   void set_metal_lib_path(const std::string& path);
   void set_metal_use_mps(bool flag);
@@ -400,6 +489,7 @@ class LITE_API CxxConfig : public ConfigBase {
   std::string nnadapter_subgraph_partition_config_buffer_;
   std::string mixed_precision_quantization_config_path_;
   std::string mixed_precision_quantization_config_buffer_;
+  std::string optimized_model_cache_dir_;
 
  public:
   void set_valid_places(const std::vector<Place>& x) { valid_places_ = x; }
@@ -532,6 +622,18 @@ class LITE_API CxxConfig : public ConfigBase {
       const {
     return mixed_precision_quantization_config_buffer_;
   }
+
+  // Save the optimized model into `cache_dir` when the predictor is created,
+  // and load it from there the next time, the optimization is skipped. The
+  // saved models are keyed by the model, the library version and all the
+  // options changing the optimization, such as the valid places, the passes,
+  // the discarded passes, the quantization and the NNAdapter options.
+  void set_optimized_model_cache_dir(const std::string& cache_dir) {
+    optimized_model_cache_dir_ = cache_dir;
+  }
+  const std::string& optimized_model_cache_dir() const {
+    return optimized_model_cache_dir_;
+  }
 };
 
 /// MobileConfig is the config for the light weight predictor, it will skip
@@ -596,6 +698,114 @@ class LITE_API MobileConfig : public ConfigBase {
 template <typename ConfigT>
 LITE_API std::shared_ptr<PaddlePredictor> CreatePaddlePredictor(const ConfigT&);
 
+/// PredictorPool holds `size` predictors of one model for concurrent
+/// serving, all of them share one copy of the persistable weights and each
+/// one owns its activations. A predictor should be used by one thread at a
+/// time, which can be borrowed from the pool by `Acquire`.
+class LITE_API PredictorPool {
+ public:
+  explicit PredictorPool(const CxxConfig& config, size_t size = 1);
+  explicit PredictorPool(const MobileConfig& config, size_t size = 1);
+  PredictorPool(const PredictorPool&) = delete;
+  PredictorPool& operator=(const PredictorPool&) = delete;
+
+  /// Get the idx-th predictor of the pool.
+  PaddlePredictor* Retrieve(size_t idx);
+
+  /// Borrow an idle predictor, block until one is available. The predictor
+  /// is given back to the pool when the returned pointer is released, so the
+  /// returned pointer must not outlive the pool.
+  std::shared_ptr<PaddlePredictor> Acquire();
+
+  /// Borrow an idle predictor without blocking, return nullptr if all of
+  /// the predictors are in use.
+  std::shared_ptr<PaddlePredictor> TryAcquire();
+
+  size_t size() const { return predictors_.size(); }
+
+  /// Get the bytes of activation memory held by the idx-th predictor.
+  size_t GetActivationMemorySize(size_t idx) const;
+
+ private:
+  void Init(std::shared_ptr<PaddlePredictor> main_predictor, size_t size);
+  std::shared_ptr<PaddlePredictor> Borrow();
+  void GiveBack(size_t idx);
+
+  std::vector<std::shared_ptr<PaddlePredictor>> predictors_;
+  std::vector<size_t> idle_predictors_;
+  std::mutex mutex_;
+  std::condition_variable idle_cv_;
+};
+
+/// A host tensor owned by the caller of DynamicBatcher, `data` holds the raw
+/// bytes of all the elements of `shape` in `precision`.
+struct LITE_API BatchTensor {
+  shape_t shape;
+  lod_t lod;
+  PrecisionType precision{PrecisionType::kFloat};
+  std::vector<uint8_t> data;
+};
+
+struct LITE_API DynamicBatchingConfig {
+  /// Max number of samples of one batched run. The samples of a dense input
+  /// are the rows of dim 0, and the samples of a LoD input are the sequences
+  /// of the top level LoD.
+  int max_batch_size{8};
+  /// Max time in microseconds a request waits in the queue for the following
+  /// requests to be coalesced with it.
+  int max_queue_delay_us{1000};
+};
+
+/// DynamicBatcher serves the requests submitted from any thread with one
+/// predictor. The queued requests are coalesced along dim 0 (LoD inputs are
+/// concatenated by sequences) up to `max_batch_size` samples or until the
+/// oldest one has waited `max_queue_delay_us`, then one batched `Run` is
+/// executed and the outputs are split back to the requests. Requests with
+/// different inner dims, precisions or LoD levels are never coalesced.
+/// The predictor is owned by the batcher's worker thread, it must not be
+/// used elsewhere while the batcher is alive.
+class LITE_API DynamicBatcher {
+ public:
+  explicit DynamicBatcher(
+      std::shared_ptr<PaddlePredictor> predictor,
+      const DynamicBatchingConfig& config = DynamicBatchingConfig());
+  DynamicBatcher(const DynamicBatcher&) = delete;
+  DynamicBatcher& operator=(const DynamicBatcher&) = delete;
+  /// Wait for the queued requests to finish and stop the worker thread.
+  ~DynamicBatcher();
+
+  /// Enqueue one request whose inputs are in the order of
+  /// `GetInputNames()`, the future gets the outputs of this request in the
+  /// order of `GetOutputNames()`. The inputs should be host tensors of
+  /// float, fp64, int8, uint8, int16, int32 or int64 with the same samples.
+  /// A request which can't be served fails alone: its future holds an
+  /// `std::invalid_argument` with LITE_WITH_EXCEPTION, otherwise the error is
+  /// logged and the future gets no outputs.
+  std::future<std::vector<BatchTensor>> Submit(std::vector<BatchTensor> inputs);
+
+ private:
+  struct Request;
+
+  void Loop();
+  // Samples of the queued requests which can be coalesced with the oldest
+  // one, should be called with `mutex_` held.
+  int64_t ReadySamples() const;
+  void CollectBatch(std::vector<std::unique_ptr<Request>>* batch);
+  // A batch whose outputs can't be split by samples is rerun request by
+  // request.
+  void RunBatch(std::vector<std::unique_ptr<Request>>* batch);
+
+  std::shared_ptr<PaddlePredictor> predictor_;
+  DynamicBatchingConfig config_;
+  size_t num_inputs_{0};
+  size_t num_outputs_{0};
+  std::deque<std::unique_ptr<Request>> queue_;
+  bool stop_{false};
+  std::mutex mutex_;
+  std::condition_variable queue_cv_;
+  std::thread worker_;
+};
+
 }  // namespace lite_api
 }  // namespace paddle
 
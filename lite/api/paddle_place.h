@@ -290,5 +290,27 @@ struct LITE_API CustomAllocator {
   void (*free)(void* ptr) = nullptr;
 };
 
+// Options of the caching pool behind the host(kHost, kX86 and kARM) memory
+// allocation.
+struct LITE_API MemoryPoolConfig {
+  // Max bytes of the cached free blocks, the blocks freed beyond it are
+  // returned to the system at once.
+  size_t max_cached_bytes{static_cast<size_t>(256) << 20};
+  // Max bytes of the cached free blocks kept by `TryShrinkMemory`.
+  size_t shrink_retained_bytes{0};
+};
+
+struct LITE_API MemoryPoolStats {
+  // Bytes of the blocks in use.
+  size_t live_bytes{0};
+  // Bytes of the free blocks cached for reuse.
+  size_t cached_bytes{0};
+  // Peak of `live_bytes`.
+  size_t peak_live_bytes{0};
+  // Number of the allocations, and those served by the cached blocks.
+  size_t num_allocs{0};
+  size_t num_cache_hits{0};
+};
+
 }  // namespace lite_api
 }  // namespace paddle
@@ -74,6 +74,9 @@ USE_MIR_PASS(lite_instance_norm_activation_fuse_pass);
 USE_MIR_PASS(ssd_boxes_calc_offline_pass);
 USE_MIR_PASS(fix_mismatched_precision_pass);
 USE_MIR_PASS(lite_flatten_fc_fuse_pass);
+USE_MIR_PASS(lite_horizontal_fc_fuse_pass);
+USE_MIR_PASS(kv_cache_attention_fuse_pass);
+USE_MIR_PASS(lite_embedding_seq_pool_fuse_pass);
 USE_MIR_PASS(lite_fc_prelu_fuse_pass);
 USE_MIR_PASS(lite_greater_than_cast_fuse_pass);
 USE_MIR_PASS(assign_value_calc_offline_pass);
@@ -118,6 +121,11 @@ USE_MIR_PASS(fill_constant_calc_offline_pass);
 USE_MIR_PASS(unsqueeze_calc_offline_pass);
 USE_MIR_PASS(scale_calc_offline_pass);
 USE_MIR_PASS(reshape_calc_offline_pass);
+USE_MIR_PASS(constant_folding_pass);
+USE_MIR_PASS(common_subexpression_elimination_pass);
+USE_MIR_PASS(dead_code_elimination_pass);
+USE_MIR_PASS(transpose_sinking_pass);
+USE_MIR_PASS(sequence_padding_elimination_pass);
 USE_MIR_PASS(keepdims_convert_pass);
 USE_MIR_PASS(op_fusion_minimal_set_pass);
 USE_MIR_PASS(lite_sigmoid_elementmul_fuse_pass);
@@ -323,19 +323,36 @@ void BindLiteTensor(py::module *m) {
     return res;
   };
 
-  py::class_<Tensor> tensor(*m, "Tensor");
+  py::class_<Tensor> tensor(
+      *m, "Tensor", py::buffer_protocol(), py::dynamic_attr());
+
+  // Tensors on host can be viewed by `numpy.asarray(tensor)` or
+  // `memoryview(tensor)` without copying.
+  tensor.def_buffer([](Tensor &self) -> py::buffer_info {
+    return TensorToPyBufferInfo(self);
+  });
 
   tensor.def("resize", &Tensor::Resize)
-      .def("numpy", [](Tensor &self) { return TensorToPyArray(self); })
+      .def("numpy",
+           [](py::object self, bool copy) {
+             return TensorToPyArray(self, copy);
+           },
+           py::arg("copy") = true)
       .def("shape", &Tensor::shape)
       .def("target", &Tensor::target)
       .def("precision", &Tensor::precision)
       .def("lod", &Tensor::lod)
       .def("set_lod", &Tensor::SetLoD)
       .def("from_numpy",
-           SetTensorFromPyArray,
+           [](py::object self,
+              const py::object &array,
+              const TargetType &place,
+              bool zero_copy) {
+             SetTensorObjectFromPyArray(self, array, place, zero_copy);
+           },
            py::arg("array"),
-           py::arg("place") = TargetType::kHost);
+           py::arg("place") = TargetType::kHost,
+           py::arg("zero_copy") = false);
 
 #define DO_GETTER_ONCE(data_type__, name__)                           \
   tensor.def(#name__, [=](Tensor &self) -> std::vector<data_type__> { \
@@ -375,15 +392,29 @@ void BindLiteTensor(py::module *m) {
 
 #ifndef LITE_ON_TINY_PUBLISH
 void BindLiteCxxPredictor(py::module *m) {
-  py::class_<CxxPaddleApiImpl>(*m, "CxxPredictor")
+  py::class_<CxxPaddleApiImpl>(*m, "CxxPredictor", py::dynamic_attr())
       .def(py::init<>())
-      .def("get_input", &CxxPaddleApiImpl::GetInput)
-      .def("get_output", &CxxPaddleApiImpl::GetOutput)
+      .def("get_input",
+           [](py::object self, int i) {
+             auto &predictor = self.cast<CxxPaddleApiImpl &>();
+             return WrapInputTensor(self,
+                                    predictor.GetInput(i),
+                                    predictor.GetInputNames().at(i));
+           })
+      .def("get_output", &CxxPaddleApiImpl::GetOutput, py::keep_alive<0, 1>())
       .def("get_output_names", &CxxPaddleApiImpl::GetOutputNames)
       .def("get_input_names", &CxxPaddleApiImpl::GetInputNames)
-      .def("get_input_by_name", &CxxPaddleApiImpl::GetInputByName)
-      .def("get_output_by_name", &CxxPaddleApiImpl::GetOutputByName)
-      .def("run", &CxxPaddleApiImpl::Run)
+      .def("get_input_by_name",
+           [](py::object self, const std::string &name) {
+             auto &predictor = self.cast<CxxPaddleApiImpl &>();
+             return WrapInputTensor(self, predictor.GetInputByName(name), name);
+           })
+      .def("get_output_by_name",
+           &CxxPaddleApiImpl::GetOutputByName,
+           py::keep_alive<0, 1>())
+      .def("run",
+           &CxxPaddleApiImpl::Run,
+           py::call_guard<py::gil_scoped_release>())
       .def("get_version", &CxxPaddleApiImpl::GetVersion)
       .def("save_optimized_pb_model",
            [](CxxPaddleApiImpl &self, const std::string &output_dir) {
@@ -400,15 +431,29 @@ void BindLiteCxxPredictor(py::module *m) {
 #endif
 
 void BindLiteLightPredictor(py::module *m) {
-  py::class_<LightPredictorImpl>(*m, "LightPredictor")
+  py::class_<LightPredictorImpl>(*m, "LightPredictor", py::dynamic_attr())
       .def(py::init<>())
-      .def("get_input", &LightPredictorImpl::GetInput)
-      .def("get_output", &LightPredictorImpl::GetOutput)
+      .def("get_input",
+           [](py::object self, int i) {
+             auto &predictor = self.cast<LightPredictorImpl &>();
+             return WrapInputTensor(self,
+                                    predictor.GetInput(i),
+                                    predictor.GetInputNames().at(i));
+           })
+      .def("get_output", &LightPredictorImpl::GetOutput, py::keep_alive<0, 1>())
       .def("get_input_names", &LightPredictorImpl::GetInputNames)
       .def("get_output_names", &LightPredictorImpl::GetOutputNames)
-      .def("get_input_by_name", &LightPredictorImpl::GetInputByName)
-      .def("get_output_by_name", &LightPredictorImpl::GetOutputByName)
-      .def("run", &LightPredictorImpl::Run)
+      .def("get_input_by_name",
+           [](py::object self, const std::string &name) {
+             auto &predictor = self.cast<LightPredictorImpl &>();
+             return WrapInputTensor(self, predictor.GetInputByName(name), name);
+           })
+      .def("get_output_by_name",
+           &LightPredictorImpl::GetOutputByName,
+           py::keep_alive<0, 1>())
+      .def("run",
+           &LightPredictorImpl::Run,
+           py::call_guard<py::gil_scoped_release>())
       .def("get_version", &LightPredictorImpl::GetVersion);
 }
 
@@ -16,6 +16,7 @@
 #define LITE_API_PYTHON_PYBIND_TENSOR_PY_H_
 #include <pybind11/numpy.h>
 #include <pybind11/stl.h>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <map>
@@ -69,12 +70,48 @@ inline std::string TensorDTypeToPyDTypeStr(PrecisionType type) {
   return "";
 }
 
+////////////////////////////////////////////////////////////////
+// Function Name: TensorToPyBufferInfo
+// Usage: Describe tensor's host data with python buffer protocol,
+//        the buffer is a view of tensor and no data is copied.
+////////////////////////////////////////////////////////////////
+inline py::buffer_info TensorToPyBufferInfo(const Tensor &tensor) {
+  CHECK(tensor.IsInitialized()) << "The tensor has not been initialized.";
+  auto target = tensor.target();
+  CHECK(target == TargetType::kHost || target == TargetType::kX86 ||
+        target == TargetType::kARM)
+      << "Only host tensor can be exported as python buffer, but got "
+      << lite_api::TargetToStr(target);
+  const auto &tensor_dims = tensor.shape();
+  py::ssize_t sizeof_dtype = lite_api::PrecisionTypeLength(tensor.precision());
+  std::vector<py::ssize_t> py_dims(tensor_dims.size());
+  std::vector<py::ssize_t> py_strides(tensor_dims.size());
+  py::ssize_t numel = 1;
+  for (int i = tensor_dims.size() - 1; i >= 0; --i) {
+    py_dims[i] = static_cast<py::ssize_t>(tensor_dims[i]);
+    py_strides[i] = sizeof_dtype * numel;
+    numel *= py_dims[i];
+  }
+  return py::buffer_info(
+      const_cast<void *>(tensor.data<void>()),
+      sizeof_dtype,
+      TensorDTypeToPyDTypeStr(tensor.precision()),
+      static_cast<py::ssize_t>(tensor_dims.size()),
+      py_dims,
+      py_strides);
+}
+
 ////////////////////////////////////////////////////////////////
 // Function Name: TensorToPyArray
-// Usage: Transform tensor's data into numpy array
+// Usage: Transform the data of the tensor object `self` into
+//        numpy array. Unless `need_deep_copy` is set, the returned
+//        array of a host tensor is a view of tensor's data, based
+//        on `self` to keep the tensor and its predictor alive, but
+//        its content is only valid until the next `run`.
 ////////////////////////////////////////////////////////////////
-inline py::array TensorToPyArray(const Tensor &tensor,
-                                 bool need_deep_copy = false) {
+inline py::array TensorToPyArray(const py::object &self,
+                                 bool need_deep_copy = true) {
+  const auto &tensor = self.cast<const Tensor &>();
   const auto &tensor_dims = tensor.shape();
   auto tensor_dtype = tensor.precision();
   size_t sizeof_dtype = lite_api::PrecisionTypeLength(tensor_dtype);
@@ -119,12 +156,51 @@ inline py::array TensorToPyArray(const Tensor &tensor,
   }
 
   tensor_buf_ptr = static_cast<const void *>(tensor.data<int8_t>());
-  auto base = py::cast(std::move(tensor));
+  if (need_deep_copy) {
+    // py::array allocates and copies the data when no base is given.
+    return py::array(py::dtype(py_dtype_str.c_str()),
+                     py_dims,
+                     py_strides,
+                     const_cast<void *>(tensor_buf_ptr));
+  }
   return py::array(py::dtype(py_dtype_str.c_str()),
                    py_dims,
                    py_strides,
                    const_cast<void *>(tensor_buf_ptr),
-                   base);
+                   self);
+}
+
+////////////////////////////////////////////////////////////////
+// Function Name: WrapInputTensor
+// Usage: Return the python object of the input tensor `name`.
+//        The tensor objects are temporary wrappers of the tensors
+//        owned by the predictor, so they hold the predictor object
+//        and the name of the input they refer to.
+////////////////////////////////////////////////////////////////
+inline py::object WrapInputTensor(const py::object &predictor,
+                                  std::unique_ptr<Tensor> tensor,
+                                  const std::string &name) {
+  auto obj = py::cast(std::move(tensor));
+  obj.attr("_predictor") = predictor;
+  obj.attr("_input_name") = py::str(name);
+  return obj;
+}
+
+////////////////////////////////////////////////////////////////
+// Function Name: SharedPyArrays
+// Usage: Return the numpy arrays shared by the input tensors of
+//        the predictor of `tensor`, keyed by the input names. The
+//        dict is held by the predictor object, so that an array
+//        stays alive as long as it backs the input tensor, no
+//        matter which wrapper it was passed to.
+////////////////////////////////////////////////////////////////
+inline py::dict SharedPyArrays(const py::object &tensor) {
+  py::object owner = tensor;
+  if (py::hasattr(tensor, "_predictor")) owner = tensor.attr("_predictor");
+  if (!py::hasattr(owner, "_shared_arrays")) {
+    owner.attr("_shared_arrays") = py::dict();
+  }
+  return owner.attr("_shared_arrays").cast<py::dict>();
 }
 
 ////////////////////////////////////////////////////////////////
@@ -154,40 +230,103 @@ void SetTensorFromPyArrayT(
 }
 
 ////////////////////////////////////////////////////////////////
-// Function Name: SetTensorFromPyArrayT
-// Usage: Create a tensor from input numpy array
+// Function Name: ShareTensorWithPyArrayT
+// Usage: Let tensor alias the memory of a c-contiguous numpy
+//        array without copying. Return false if the array can
+//        not be shared, and the caller should fall back to copy.
+////////////////////////////////////////////////////////////////
+template <typename T>
+bool ShareTensorWithPyArrayT(Tensor *self,
+                             const py::array &array,
+                             const TargetType &place) {
+  if (place != TargetType::kHost && place != TargetType::kX86 &&
+      place != TargetType::kARM) {
+    return false;
+  }
+  if (!(array.flags() & py::array::c_style) || array.nbytes() == 0 ||
+      reinterpret_cast<uintptr_t>(array.data()) % alignof(T) != 0) {
+    return false;
+  }
+  std::vector<int64_t> dims;
+  dims.reserve(array.ndim());
+  for (decltype(array.ndim()) i = 0; i < array.ndim(); ++i) {
+    dims.push_back(static_cast<int64_t>(array.shape()[i]));
+  }
+  self->Resize(dims);
+  self->ShareExternalMemory(const_cast<void *>(array.data()),
+                            static_cast<size_t>(array.nbytes()),
+                            TargetType::kHost);
+  self->SetPrecision(lite_api::PrecisionTypeTrait<T>::Type());
+  return true;
+}
+
+////////////////////////////////////////////////////////////////
+// Function Name: SetTensorFromPyArray
+// Usage: Create a tensor from input numpy array. If `zero_copy`
+//        is set, the tensor aliases the memory of the array when
+//        it is c-contiguous and located on host, the array must be
+//        kept alive and unchanged until `run` returns. Return true
+//        if the memory of the array is shared.
 // Todo: float16 and uint16_t inputs are not supported on
 //       Paddle-Lite, while these two precision type are supported
 //       on PaddlePaddle.
 ////////////////////////////////////////////////////////////////
-void SetTensorFromPyArray(Tensor *self,
+bool SetTensorFromPyArray(Tensor *self,
                           const py::object &obj,
-                          const TargetType &place) {
+                          const TargetType &place,
+                          bool zero_copy = false) {
   auto array = obj.cast<py::array>();
-  if (py::isinstance<py::array_t<float>>(array)) {
-    SetTensorFromPyArrayT<float>(self, array, place);
-  } else if (py::isinstance<py::array_t<int>>(array)) {
-    SetTensorFromPyArrayT<int>(self, array, place);
-  } else if (py::isinstance<py::array_t<int64_t>>(array)) {
-    SetTensorFromPyArrayT<int64_t>(self, array, place);
-  } else if (py::isinstance<py::array_t<double>>(array)) {
-    SetTensorFromPyArrayT<double>(self, array, place);
-  } else if (py::isinstance<py::array_t<int8_t>>(array)) {
-    SetTensorFromPyArrayT<int8_t>(self, array, place);
-  } else if (py::isinstance<py::array_t<int16_t>>(array)) {
-    SetTensorFromPyArrayT<int16_t>(self, array, place);
-  } else if (py::isinstance<py::array_t<uint8_t>>(array)) {
-    SetTensorFromPyArrayT<uint8_t>(self, array, place);
-  } else if (py::isinstance<py::array_t<bool>>(array)) {
-    SetTensorFromPyArrayT<bool>(self, array, place);
-  } else {
-    // obj may be any type, obj.cast<py::array>() may be failed,
-    // then the array.dtype will be string of unknown meaning,
-    LOG(FATAL) << "Input object type error or incompatible array data type. "
-                  "tensor.from_numpy(numpy.array, PrecisionType) supports "
-                  "numpy array input in  bool, float32, "
-                  "float64, int8, int16, int32, int64 or uint8, please check "
-                  "your input or input array data type.";
+#define SET_TENSOR_FROM_PY_ARRAY(T)                                     \
+  if (py::isinstance<py::array_t<T>>(array)) {                          \
+    if (zero_copy && ShareTensorWithPyArrayT<T>(self, array, place)) { \
+      return true;                                                      \
+    }                                                                   \
+    SetTensorFromPyArrayT<T>(self, array, place);                       \
+    return false;                                                       \
+  }
+
+  SET_TENSOR_FROM_PY_ARRAY(float)
+  SET_TENSOR_FROM_PY_ARRAY(int)
+  SET_TENSOR_FROM_PY_ARRAY(int64_t)
+  SET_TENSOR_FROM_PY_ARRAY(double)
+  SET_TENSOR_FROM_PY_ARRAY(int8_t)
+  SET_TENSOR_FROM_PY_ARRAY(int16_t)
+  SET_TENSOR_FROM_PY_ARRAY(uint8_t)
+  SET_TENSOR_FROM_PY_ARRAY(bool)
+#undef SET_TENSOR_FROM_PY_ARRAY
+
+  // obj may be any type, obj.cast<py::array>() may be failed,
+  // then the array.dtype will be string of unknown meaning,
+  LOG(FATAL) << "Input object type error or incompatible array data type. "
+                "tensor.from_numpy(numpy.array, PrecisionType) supports "
+                "numpy array input in  bool, float32, "
+                "float64, int8, int16, int32, int64 or uint8, please check "
+                "your input or input array data type.";
+  return false;
+}
+
+////////////////////////////////////////////////////////////////
+// Function Name: SetTensorObjectFromPyArray
+// Usage: Set the python tensor object from input numpy array as
+//        SetTensorFromPyArray. The shared array is held in
+//        SharedPyArrays(tensor), and the tensor stops sharing the
+//        previous array before it's set again, so that a following
+//        copy does not write into that array.
+////////////////////////////////////////////////////////////////
+inline void SetTensorObjectFromPyArray(const py::object &tensor,
+                                       const py::object &obj,
+                                       const TargetType &place,
+                                       bool zero_copy) {
+  auto *self = tensor.cast<Tensor *>();
+  auto shared_arrays = SharedPyArrays(tensor);
+  py::object key = py::str("");
+  if (py::hasattr(tensor, "_input_name")) key = tensor.attr("_input_name");
+  if (shared_arrays.contains(key)) {
+    self->ShareExternalMemory(nullptr, 0, TargetType::kHost);
+    PyDict_DelItem(shared_arrays.ptr(), key.ptr());
+  }
+  if (SetTensorFromPyArray(self, obj, place, zero_copy)) {
+    shared_arrays[key] = obj;
   }
 }
 
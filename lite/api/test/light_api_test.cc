@@ -99,5 +99,47 @@ TEST(LightAPI, loadNaiveBuffer) {
   }
 }
 
+TEST(LightAPI, clone_keeps_config) {
+  if (FLAGS_optimized_model.empty()) {
+    FLAGS_optimized_model = "lite_naive_model";
+  }
+  // The frozen-shape mode isn't supported with the inter-op parallelism, so
+  // they are checked separately.
+  for (bool frozen_shape : {false, true}) {
+    lite_api::MobileConfig config;
+    config.set_model_dir(FLAGS_optimized_model);
+    config.set_threads(2);
+    config.set_inter_op_threads(frozen_shape ? 1 : 2);
+    config.set_frozen_shape(frozen_shape);
+    config.set_embedding_table_fp16(true);
+    LightPredictorImpl predictor;
+    predictor.Init(config);
+    auto clone =
+        std::static_pointer_cast<LightPredictorImpl>(predictor.Clone());
+
+    bool inter_op_parallel =
+        predictor.raw_predictor()->runtime_program().inter_op_parallel();
+    for (auto* impl : {&predictor, clone.get()}) {
+      const auto& program = impl->raw_predictor()->runtime_program();
+      EXPECT_EQ(impl->config().inter_op_threads(), config.inter_op_threads());
+      EXPECT_EQ(impl->config().frozen_shape(), frozen_shape);
+      EXPECT_TRUE(impl->config().embedding_table_fp16());
+      EXPECT_EQ(program.frozen_shape(), frozen_shape);
+      EXPECT_EQ(program.inter_op_parallel(), inter_op_parallel);
+    }
+
+    auto input_tensor = clone->GetInput(0);
+    input_tensor->Resize({100, 100});
+    auto* data = input_tensor->mutable_data<float>();
+    for (int i = 0; i < 100 * 100; i++) {
+      data[i] = i;
+    }
+    clone->Run();
+    const float* out = clone->GetOutput(0)->data<float>();
+    EXPECT_NEAR(out[0], 50.2132, 1e-3);
+    EXPECT_NEAR(out[1], -28.8729, 1e-3);
+  }
+}
+
 }  // namespace lite
 }  // namespace paddle
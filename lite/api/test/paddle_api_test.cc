@@ -15,6 +15,14 @@
 #include "lite/api/paddle_api.h"
 #include <gflags/gflags.h>
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <future>  // NOLINT
+#include <stdexcept>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "lite/utils/io.h"
 #include "lite/utils/log/cp_logging.h"
 
@@ -110,6 +118,320 @@ TEST(CxxApi, share_external_data) {
   EXPECT_NEAR(out[1], -28.8729, 1e-3);
 }
 
+// The threads are divided among the concurrent ops, the outputs are the
+// same as the ones of the sequential run.
+TEST(CxxApi, inter_op_parallel) {
+  std::vector<std::vector<float>> outs;
+  for (int inter_op_threads : {1, 2}) {
+    lite_api::CxxConfig config;
+    config.set_model_dir(FLAGS_model_dir);
+    config.set_valid_places({
+        Place{TARGET(kX86), PRECISION(kFloat)},
+        Place{TARGET(kARM), PRECISION(kFloat)},
+    });
+    config.set_threads(4);
+    config.set_x86_math_num_threads(4);
+    config.set_inter_op_threads(inter_op_threads);
+    auto predictor = lite_api::CreatePaddlePredictor(config);
+
+    std::vector<float> out;
+    for (int64_t batch : {100, 3, 100}) {
+      auto input_tensor = predictor->GetInput(0);
+      input_tensor->Resize(std::vector<int64_t>({batch, 100}));
+      auto* data = input_tensor->mutable_data<float>();
+      for (int i = 0; i < batch * 100; i++) {
+        data[i] = i;
+      }
+      predictor->Run();
+      auto output = predictor->GetOutput(0);
+      int64_t out_size = 1;
+      for (auto dim : output->shape()) out_size *= dim;
+      out.insert(out.end(),
+                 output->data<float>(),
+                 output->data<float>() + out_size);
+    }
+    outs.push_back(out);
+  }
+  ASSERT_EQ(outs[1].size(), outs[0].size());
+  for (size_t i = 0; i < outs[0].size(); i++) {
+    EXPECT_NEAR(outs[1][i], outs[0][i], 1e-5);
+  }
+}
+
+TEST(CxxApi, run_async) {
+  lite_api::CxxConfig config;
+  config.set_model_dir(FLAGS_model_dir);
+  config.set_valid_places({
+      Place{TARGET(kX86), PRECISION(kFloat)},
+      Place{TARGET(kARM), PRECISION(kFloat)},
+  });
+
+  auto predictor = lite_api::CreatePaddlePredictor(config);
+  auto input_tensor = predictor->GetInput(0);
+  input_tensor->Resize(std::vector<int64_t>({100, 100}));
+  auto* data = input_tensor->mutable_data<float>();
+  for (int i = 0; i < 100 * 100; i++) {
+    data[i] = i;
+  }
+
+  bool callback_called = false;
+  auto future =
+      predictor->RunAsync([&callback_called]() { callback_called = true; });
+  future.get();
+  EXPECT_TRUE(callback_called);
+
+  auto* out = predictor->GetOutput(0)->data<float>();
+  EXPECT_NEAR(out[0], 50.2132, 1e-3);
+  EXPECT_NEAR(out[1], -28.8729, 1e-3);
+
+  // The first asynchronous runs of several predictors issued concurrently
+  // share no state, and each predictor gets exactly one worker.
+  std::vector<std::shared_ptr<PaddlePredictor>> clones;
+  for (int i = 0; i < 4; i++) {
+    clones.push_back(predictor->Clone());
+    auto clone_input = clones.back()->GetInput(0);
+    clone_input->Resize(std::vector<int64_t>({100, 100}));
+    auto* clone_data = clone_input->mutable_data<float>();
+    std::copy(data, data + 100 * 100, clone_data);
+  }
+  std::atomic<int> runs{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; t++) {
+    threads.emplace_back([&clones, &runs, t] {
+      std::vector<std::future<void>> futures;
+      for (int i = 0; i < 4; i++) {
+        futures.push_back(clones[(t + i) % clones.size()]->RunAsync(
+            [&runs] { runs++; }));
+      }
+      for (auto& future : futures) future.get();
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(runs.load(), 32);
+  clones.clear();
+}
+
+TEST(CxxApi, release_in_async_callback) {
+  lite_api::CxxConfig config;
+  config.set_model_dir(FLAGS_model_dir);
+  config.set_valid_places({
+      Place{TARGET(kX86), PRECISION(kFloat)},
+      Place{TARGET(kARM), PRECISION(kFloat)},
+  });
+
+  auto predictor = lite_api::CreatePaddlePredictor(config);
+  auto input_tensor = predictor->GetInput(0);
+  input_tensor->Resize(std::vector<int64_t>({100, 100}));
+  auto* data = input_tensor->mutable_data<float>();
+  std::fill(data, data + 100 * 100, 1.f);
+
+  // The first callback drops the last reference to the predictor on the
+  // worker thread once the second run is pending, which still runs before
+  // the predictor is destroyed.
+  auto* raw_predictor = predictor.get();
+  std::promise<void> queued;
+  auto queued_future = queued.get_future();
+  bool second_called = false;
+  auto first = raw_predictor->RunAsync([&predictor, &queued_future] {
+    queued_future.wait();
+    predictor.reset();
+  });
+  auto second =
+      raw_predictor->RunAsync([&second_called] { second_called = true; });
+  queued.set_value();
+  first.get();
+  second.get();
+  EXPECT_FALSE(predictor);
+  EXPECT_TRUE(second_called);
+}
+
+TEST(CxxApi, predictor_pool) {
+  lite_api::CxxConfig config;
+  config.set_model_dir(FLAGS_model_dir);
+  config.set_valid_places({
+      Place{TARGET(kX86), PRECISION(kFloat)},
+      Place{TARGET(kARM), PRECISION(kFloat)},
+  });
+
+  const size_t pool_size = 4;
+  lite_api::PredictorPool pool(config, pool_size);
+  ASSERT_EQ(pool.size(), pool_size);
+
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < pool_size * 2; t++) {
+    workers.emplace_back([&pool]() {
+      auto predictor = pool.Acquire();
+      auto input_tensor = predictor->GetInput(0);
+      input_tensor->Resize(std::vector<int64_t>({100, 100}));
+      auto* data = input_tensor->mutable_data<float>();
+      for (int i = 0; i < 100 * 100; i++) {
+        data[i] = i;
+      }
+      predictor->Run();
+      auto* out = predictor->GetOutput(0)->data<float>();
+      EXPECT_NEAR(out[0], 50.2132, 1e-3);
+      EXPECT_NEAR(out[1], -28.8729, 1e-3);
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  // Every predictor owns its activations, and the ones which have run hold
+  // the activation memory.
+  size_t total_memory = 0;
+  for (size_t i = 0; i < pool_size; i++) {
+    LOG(INFO) << "predictor " << i << " activation memory: "
+              << pool.GetActivationMemorySize(i);
+    total_memory += pool.GetActivationMemorySize(i);
+    for (size_t j = 0; j < i; j++) {
+      EXPECT_NE(pool.Retrieve(i), pool.Retrieve(j));
+    }
+  }
+  EXPECT_GT(total_memory, 0u);
+  auto first = pool.TryAcquire();
+  ASSERT_TRUE(first != nullptr);
+}
+
+TEST(CxxApi, dynamic_batching) {
+  lite_api::CxxConfig config;
+  config.set_model_dir(FLAGS_model_dir);
+  config.set_valid_places({
+      Place{TARGET(kX86), PRECISION(kFloat)},
+      Place{TARGET(kARM), PRECISION(kFloat)},
+  });
+
+  // Run the rows as one batch to get the expected outputs.
+  const int rows = 100;
+  const int cols = 100;
+  auto predictor = lite_api::CreatePaddlePredictor(config);
+  auto input_tensor = predictor->GetInput(0);
+  input_tensor->Resize(std::vector<int64_t>({rows, cols}));
+  auto* data = input_tensor->mutable_data<float>();
+  for (int i = 0; i < rows * cols; i++) {
+    data[i] = i;
+  }
+  predictor->Run();
+  auto expected = predictor->GetOutput(0);
+  auto expected_shape = expected->shape();
+  const float* expected_data = expected->data<float>();
+  int64_t out_cols = expected_shape[1];
+
+  DynamicBatchingConfig batching_config;
+  batching_config.max_batch_size = 16;
+  batching_config.max_queue_delay_us = 2000;
+  DynamicBatcher batcher(predictor->Clone(), batching_config);
+
+  // Submit every row as a single request.
+  std::vector<std::future<std::vector<BatchTensor>>> futures;
+  for (int r = 0; r < rows; r++) {
+    BatchTensor row;
+    row.shape = {1, cols};
+    row.data.resize(cols * sizeof(float));
+    auto* row_data = reinterpret_cast<float*>(row.data.data());
+    for (int c = 0; c < cols; c++) {
+      row_data[c] = r * cols + c;
+    }
+    futures.push_back(batcher.Submit({row}));
+  }
+  for (int r = 0; r < rows; r++) {
+    auto outputs = futures[r].get();
+    ASSERT_EQ(outputs.size(), 1u);
+    ASSERT_EQ(outputs[0].shape, std::vector<int64_t>({1, out_cols}));
+    auto* out = reinterpret_cast<const float*>(outputs[0].data.data());
+    for (int64_t c = 0; c < out_cols; c++) {
+      EXPECT_NEAR(out[c], expected_data[r * out_cols + c], 1e-3);
+    }
+  }
+
+  // A request the worker can't merge fails alone, the following requests are
+  // still served.
+  BatchTensor bool_row;
+  bool_row.shape = {1, cols};
+  bool_row.precision = PrecisionType::kBool;
+  bool_row.data.resize(cols);
+  auto failed = batcher.Submit({bool_row});
+  BatchTensor first_row;
+  first_row.shape = {1, cols};
+  first_row.data.assign(reinterpret_cast<const uint8_t*>(data),
+                        reinterpret_cast<const uint8_t*>(data + cols));
+  auto served = batcher.Submit({first_row});
+#ifdef LITE_WITH_EXCEPTION
+  EXPECT_THROW(failed.get(), std::invalid_argument);
+#else
+  EXPECT_TRUE(failed.get().empty());
+#endif
+  auto outputs = served.get();
+  ASSERT_EQ(outputs.size(), 1u);
+  auto* out = reinterpret_cast<const float*>(outputs[0].data.data());
+  for (int64_t c = 0; c < out_cols; c++) {
+    EXPECT_NEAR(out[c], expected_data[c], 1e-3);
+  }
+}
+
+std::vector<std::string> ListCachedModels(const std::string& cache_dir) {
+  std::vector<std::string> models;
+  for (auto& file : lite::ListFile(cache_dir)) {
+    if (file.size() > 3 && file.substr(file.size() - 3) == ".nb") {
+      models.push_back(file);
+    }
+  }
+  return models;
+}
+
+TEST(CxxApi, optimized_model_cache) {
+  const std::string cache_dir = FLAGS_model_dir + ".opt_cache";
+  lite::MkDirRecur(cache_dir);
+  for (auto& file : ListCachedModels(cache_dir)) {
+    std::remove((cache_dir + "/" + file).c_str());
+  }
+  auto run = [](const CxxConfig& config) {
+    auto predictor = CreatePaddlePredictor(config);
+    auto input_tensor = predictor->GetInput(0);
+    input_tensor->Resize(std::vector<int64_t>({100, 100}));
+    auto* data = input_tensor->mutable_data<float>();
+    for (int i = 0; i < 100 * 100; i++) {
+      data[i] = i;
+    }
+    predictor->Run();
+    auto output = predictor->GetOutput(0);
+    return std::vector<float>(output->data<float>(),
+                              output->data<float>() + 2);
+  };
+  CxxConfig config;
+  config.set_model_dir(FLAGS_model_dir);
+  config.set_valid_places({
+      Place{TARGET(kX86), PRECISION(kFloat)},
+      Place{TARGET(kARM), PRECISION(kFloat)},
+  });
+  config.set_optimized_model_cache_dir(cache_dir);
+
+  // The first predictor saves the optimized model, and the second one loads
+  // it and gets the same outputs.
+  auto saved = run(config);
+  auto models = ListCachedModels(cache_dir);
+  ASSERT_EQ(models.size(), 1u);
+  auto loaded = run(config);
+  EXPECT_EQ(ListCachedModels(cache_dir), models);
+  ASSERT_EQ(loaded.size(), saved.size());
+  EXPECT_NEAR(loaded[0], 50.2132, 1e-3);
+  EXPECT_NEAR(loaded[1], -28.8729, 1e-3);
+  EXPECT_EQ(loaded, saved);
+
+  // The options changing the optimization miss the saved model.
+  CxxConfig discarded_config = config;
+  discarded_config.add_discarded_pass("lite_fc_fuse_pass");
+  run(discarded_config);
+  EXPECT_EQ(ListCachedModels(cache_dir).size(), 2u);
+  CxxConfig sparse_config = config;
+  sparse_config.set_sparse_model(true);
+  run(sparse_config);
+  EXPECT_EQ(ListCachedModels(cache_dir).size(), 3u);
+  // The same options hit it again.
+  run(discarded_config);
+  EXPECT_EQ(ListCachedModels(cache_dir).size(), 3u);
+}
+
 // Demo1 for Mobile Devices :Load model from file and run
 #ifdef LITE_WITH_ARM
 TEST(LightApi, run) {
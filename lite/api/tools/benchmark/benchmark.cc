@@ -14,13 +14,19 @@
 
 #include "lite/api/tools/benchmark/benchmark.h"
 #include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cmath>
+#include <condition_variable>  // NOLINT(build/c++11)
 #include <cstdio>
 #include <fstream>
 #include <iomanip>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <numeric>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 #ifdef __ANDROID__
@@ -57,7 +63,11 @@ int Benchmark(int argc, char** argv) {
   auto input_shapes = lite::GetShapes(FLAGS_input_shape);
 
   // Run
-  Run(model_file, input_shapes);
+  if (FLAGS_concurrency > 0 || !FLAGS_concurrency_sweep.empty()) {
+    RunLoad(model_file, input_shapes);
+  } else {
+    Run(model_file, input_shapes);
+  }
 
   return 0;
 }
@@ -76,6 +86,30 @@ std::shared_ptr<PaddlePredictor> CreatePredictor(
   return predictor;
 }
 
+void SetInputs(std::shared_ptr<PaddlePredictor> predictor,
+               const std::vector<std::vector<int64_t>>& input_shapes) {
+  auto input_types = lite::Split(FLAGS_input_data_type, ":");
+  auto paths = lite::Split(FLAGS_input_data_path, ":");
+  for (size_t i = 0; i < input_shapes.size(); i++) {
+    auto input_tensor = predictor->GetInput(i);
+    std::string path;
+
+    if (FLAGS_input_data_path.empty()) {
+      path = "";
+    } else {
+      path = paths[i];
+    }
+
+    if ((i < input_types.size()) && (input_types[i] == "int64")) {
+      setInputValue<int64_t>(input_tensor, input_shapes[i], path);
+    } else if ((i < input_types.size()) && (input_types[i] == "int32")) {
+      setInputValue<int32_t>(input_tensor, input_shapes[i], path);
+    } else {  // default input_type float32
+      setInputValue<float>(input_tensor, input_shapes[i], path);
+    }
+  }
+}
+
 void RunImpl(std::shared_ptr<PaddlePredictor> predictor, PerfData* perf_data) {
   lite::Timer timer;
   timer.Start();
@@ -133,30 +167,9 @@ void Run(const std::string& model_file,
 #endif
   perf_data.set_init_time(timer.Stop());
 
-  // Get input types
-  auto input_types = lite::Split(FLAGS_input_data_type, ":");
-
   // Set inputs
   if (FLAGS_validation_set.empty()) {
-    auto paths = lite::Split(FLAGS_input_data_path, ":");
-    for (size_t i = 0; i < input_shapes.size(); i++) {
-      auto input_tensor = predictor->GetInput(i);
-      std::string path;
-
-      if (FLAGS_input_data_path.empty()) {
-        path = "";
-      } else {
-        path = paths[i];
-      }
-
-      if ((i < input_types.size()) && (input_types[i] == "int64")) {
-        setInputValue<int64_t>(input_tensor, input_shapes[i], path);
-      } else if ((i < input_types.size()) && (input_types[i] == "int32")) {
-        setInputValue<int32_t>(input_tensor, input_shapes[i], path);
-      } else {  // default input_type float32
-        setInputValue<float>(input_tensor, input_shapes[i], path);
-      }
-    }
+    SetInputs(predictor, input_shapes);
   } else {
 #ifdef __ANDROID__
     config = LoadConfigTxt(FLAGS_config_path);
@@ -346,5 +359,299 @@ void Run(const std::string& model_file,
   StoreBenchmarkResult(ss.str());
 }
 
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+float ElapsedMs(Clock::time_point begin, Clock::time_point end) {
+  return std::chrono::duration<float, std::milli>(end - begin).count();
+}
+
+// Blocks the threads until `count` of them arrive, and returns the time when
+// the last one arrives, so that all of the threads start the next phase at
+// the same time point.
+class Barrier {
+ public:
+  explicit Barrier(int count) : count_(count) {}
+
+  Clock::time_point Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    int generation = generation_;
+    if (++arrived_ == count_) {
+      arrived_ = 0;
+      generation_++;
+      release_time_ = Clock::now();
+      cv_.notify_all();
+    } else {
+      cv_.wait(lock, [&] { return generation != generation_; });
+    }
+    return release_time_;
+  }
+
+ private:
+  const int count_;
+  int arrived_{0};
+  int generation_{0};
+  Clock::time_point release_time_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+// The nearest-rank percentile of the sorted values.
+float Percentile(const std::vector<float>& sorted, float percent) {
+  if (sorted.empty()) return 0.f;
+  size_t rank = static_cast<size_t>(std::ceil(percent / 100 * sorted.size()));
+  return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+LoadResult RunLoadLevel(const std::string& model_file,
+                        const std::vector<std::vector<int64_t>>& input_shapes,
+                        int concurrency,
+                        Clock::time_point origin) {
+  LoadResult result;
+  result.concurrency = concurrency;
+  result.first_run_time.resize(concurrency);
+
+  // Load
+  auto load_begin = Clock::now();
+  std::vector<std::shared_ptr<PaddlePredictor>> predictors;
+  predictors.push_back(CreatePredictor(model_file));
+  for (int i = 1; i < concurrency; i++) {
+    predictors.push_back(predictors[0]->Clone());
+  }
+  for (auto& predictor : predictors) {
+    SetInputs(predictor, input_shapes);
+  }
+  auto load_end = Clock::now();
+
+  // The workers and this thread meet after the first runs and the warmups.
+  Barrier barrier(concurrency + 1);
+  auto duration = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(FLAGS_duration));
+  auto interval =
+      FLAGS_request_rate > 0
+          ? std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>(1. / FLAGS_request_rate))
+          : Clock::duration::zero();
+  std::atomic<int64_t> next_request(0);
+  std::vector<std::vector<float>> latencies(concurrency);
+  std::vector<std::thread> workers;
+  for (int i = 0; i < concurrency; i++) {
+    workers.emplace_back([&, i]() {
+      auto predictor = predictors[i];
+      auto begin = Clock::now();
+      predictor->Run();
+      result.first_run_time[i] = ElapsedMs(begin, Clock::now());
+      barrier.Wait();
+      for (int j = 0; j < FLAGS_warmup; j++) {
+        predictor->Run();
+      }
+      auto steady_begin = barrier.Wait();
+      auto steady_end = steady_begin + duration;
+      while (true) {
+        Clock::time_point issued;
+        if (FLAGS_request_rate > 0) {
+          // Open loop: the request is issued at its scheduled time, the
+          // latency includes the time waiting for a free predictor.
+          issued = steady_begin + next_request++ * interval;
+          if (issued >= steady_end) break;
+          std::this_thread::sleep_until(issued);
+        } else {
+          issued = Clock::now();
+          if (issued >= steady_end) break;
+        }
+        predictor->Run();
+        latencies[i].push_back(ElapsedMs(issued, Clock::now()));
+      }
+    });
+  }
+  auto first_run_end = barrier.Wait();
+  auto steady_begin = barrier.Wait();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  auto steady_end = Clock::now();
+
+  result.phases = {{"load", ElapsedMs(origin, load_begin),
+                    ElapsedMs(origin, load_end)},
+                   {"first_run", ElapsedMs(origin, load_end),
+                    ElapsedMs(origin, first_run_end)},
+                   {"warmup", ElapsedMs(origin, first_run_end),
+                    ElapsedMs(origin, steady_begin)},
+                   {"steady", ElapsedMs(origin, steady_begin),
+                    ElapsedMs(origin, steady_end)}};
+  for (auto& worker_latencies : latencies) {
+    result.latency.insert(result.latency.end(),
+                          worker_latencies.begin(),
+                          worker_latencies.end());
+  }
+  std::sort(result.latency.begin(), result.latency.end());
+  return result;
+}
+
+float PhaseTime(const LoadResult& result, const std::string& name) {
+  for (auto& phase : result.phases) {
+    if (phase.name == name) return phase.end_time - phase.begin_time;
+  }
+  return 0.f;
+}
+
+float Throughput(const LoadResult& result) {
+  float steady_time = PhaseTime(result, "steady");
+  return steady_time > 0 ? result.latency.size() * 1000.f / steady_time : 0.f;
+}
+
+void StoreLoadResultAsJson(
+    const std::string& model_file,
+    const std::vector<LoadResult>& results,
+    const std::vector<std::pair<float, int64_t>>& timeline,
+    float peak_memory_usage) {
+  std::ofstream fs(FLAGS_json_path);
+  if (!fs.is_open()) {
+    std::cerr << "Fail to open json file: " << FLAGS_json_path << std::endl;
+    return;
+  }
+  fs << "{\n";
+  fs << "  \"version\": \"" << lite::version() << "\",\n";
+  fs << "  \"optimized_model_file\": \"" << model_file << "\",\n";
+  fs << "  \"input_shape\": \"" << FLAGS_input_shape << "\",\n";
+  fs << "  \"backend\": \"" << FLAGS_backend << "\",\n";
+  fs << "  \"threads\": " << FLAGS_threads << ",\n";
+  fs << "  \"power_mode\": " << FLAGS_power_mode << ",\n";
+  fs << "  \"warmup\": " << FLAGS_warmup << ",\n";
+  fs << "  \"request_rate\": " << std::max(FLAGS_request_rate, 0.) << ",\n";
+  fs << "  \"duration\": " << FLAGS_duration << ",\n";
+  fs << "  \"levels\": [";
+  for (size_t i = 0; i < results.size(); i++) {
+    auto& result = results[i];
+    auto& latency = result.latency;
+    fs << (i > 0 ? "," : "") << "\n    {\n";
+    fs << "      \"concurrency\": " << result.concurrency << ",\n";
+    fs << "      \"requests\": " << latency.size() << ",\n";
+    fs << "      \"throughput\": " << Throughput(result) << ",\n";
+    fs << "      \"phases\": [";
+    for (size_t j = 0; j < result.phases.size(); j++) {
+      auto& phase = result.phases[j];
+      fs << (j > 0 ? ", " : "") << "{\"name\": \"" << phase.name
+         << "\", \"begin_ms\": " << phase.begin_time
+         << ", \"end_ms\": " << phase.end_time << "}";
+    }
+    fs << "],\n";
+    fs << "      \"first_run_ms\": [";
+    for (size_t j = 0; j < result.first_run_time.size(); j++) {
+      fs << (j > 0 ? ", " : "") << result.first_run_time[j];
+    }
+    fs << "],\n";
+    float avg = latency.empty()
+                    ? 0.f
+                    : std::accumulate(latency.begin(), latency.end(), 0.f) /
+                          latency.size();
+    fs << "      \"latency_ms\": {\"min\": "
+       << (latency.empty() ? 0.f : latency.front()) << ", \"avg\": " << avg
+       << ", \"p50\": " << Percentile(latency, 50)
+       << ", \"p90\": " << Percentile(latency, 90)
+       << ", \"p99\": " << Percentile(latency, 99)
+       << ", \"p99.9\": " << Percentile(latency, 99.9)
+       << ", \"max\": " << (latency.empty() ? 0.f : latency.back()) << "}\n";
+    fs << "    }";
+  }
+  fs << "\n  ],\n";
+  fs << "  \"peak_rss_kb\": " << peak_memory_usage << ",\n";
+  fs << "  \"rss_timeline\": [";
+  for (size_t i = 0; i < timeline.size(); i++) {
+    fs << (i > 0 ? ", " : "") << "[" << timeline[i].first << ", "
+       << timeline[i].second << "]";
+  }
+  fs << "]\n";
+  fs << "}\n";
+  fs.close();
+}
+
+}  // namespace
+
+void RunLoad(const std::string& model_file,
+             const std::vector<std::vector<int64_t>>& input_shapes) {
+  auto levels = GetConcurrencyLevels();
+
+  // The resident set size in KB sampled at the time in ms.
+  std::vector<std::pair<float, int64_t>> timeline;
+  float peak_memory_usage = 0;
+#ifdef __linux__
+  profile::ResourceUsageMonitor resource_monter(FLAGS_memory_check_interval_ms);
+#endif
+  auto origin = Clock::now();
+#ifdef __linux__
+  if (FLAGS_enable_memory_profile) resource_monter.Start();
+#endif
+  std::vector<LoadResult> results;
+  for (auto concurrency : levels) {
+    results.push_back(
+        RunLoadLevel(model_file, input_shapes, concurrency, origin));
+  }
+#ifdef __linux__
+  if (FLAGS_enable_memory_profile) {
+    peak_memory_usage = resource_monter.GetPeakMemUsageInKB();
+    resource_monter.Stop();
+    for (auto& sample : resource_monter.GetMemUsageTimeline()) {
+      timeline.emplace_back(sample.time_ms, sample.rss_kb);
+    }
+  }
+#endif
+
+  std::stringstream ss;
+  ss.precision(3);
+  ss << "\n======= Model Info =======\n";
+  ss << "optimized_model_file: " << model_file << std::endl;
+  ss << "input_shape: " << FLAGS_input_shape << std::endl;
+  ss << "\n======= Runtime Info =======\n";
+  ss << "benchmark_bin version: " << lite::version() << std::endl;
+  ss << "threads: " << FLAGS_threads << std::endl;
+  ss << "power_mode: " << FLAGS_power_mode << std::endl;
+  ss << "warmup: " << FLAGS_warmup << std::endl;
+  ss << "duration(sec): " << FLAGS_duration << std::endl;
+  if (FLAGS_request_rate > 0) {
+    ss << "request_rate(qps): " << FLAGS_request_rate << std::endl;
+  } else {
+    ss << "request_rate(qps): closed loop" << std::endl;
+  }
+  ss << "backend: " << FLAGS_backend << std::endl;
+  ss << std::fixed << std::left;
+  for (auto& result : results) {
+    auto& latency = result.latency;
+    ss << "\n======= Load Info (concurrency = " << result.concurrency
+       << ") =======\n";
+    ss << "requests   = " << latency.size() << std::endl;
+    ss << "throughput = " << Throughput(result) << " qps" << std::endl;
+    ss << "Phase time(unit: ms):\n";
+    for (auto& phase : result.phases) {
+      ss << std::setw(10) << phase.name << " = "
+         << phase.end_time - phase.begin_time << std::endl;
+    }
+    ss << "first run max = "
+       << *std::max_element(result.first_run_time.begin(),
+                            result.first_run_time.end())
+       << std::endl;
+    ss << "Latency(unit: ms):\n";
+    ss << "min   = " << std::setw(12)
+       << (latency.empty() ? 0.f : latency.front()) << std::endl;
+    ss << "p50   = " << std::setw(12) << Percentile(latency, 50) << std::endl;
+    ss << "p90   = " << std::setw(12) << Percentile(latency, 90) << std::endl;
+    ss << "p99   = " << std::setw(12) << Percentile(latency, 99) << std::endl;
+    ss << "p99.9 = " << std::setw(12) << Percentile(latency, 99.9)
+       << std::endl;
+    ss << "max   = " << std::setw(12)
+       << (latency.empty() ? 0.f : latency.back()) << std::endl;
+  }
+  if (FLAGS_enable_memory_profile) {
+    ss << "\nMemory Usage(unit: MB):\n";
+    ss << "peak  = " << std::setw(12) << peak_memory_usage / 1024 << std::endl;
+  }
+  std::cout << ss.str() << std::endl;
+  StoreBenchmarkResult(ss.str());
+  if (!FLAGS_json_path.empty()) {
+    StoreLoadResultAsJson(model_file, results, timeline, peak_memory_usage);
+  }
+}
+
 }  // namespace lite_api
 }  // namespace paddle
@@ -17,8 +17,10 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
 #include <fstream>
 #include <iomanip>
+#include <limits>
 #include <memory>
 #include <numeric>
 #include <string>
@@ -93,9 +95,35 @@ class PerfData {
   std::vector<float> run_time_;
 };
 
+// A phase of a concurrency level of the load generator mode, the time is in
+// milliseconds since the load generator starts.
+struct LoadPhase {
+  std::string name;
+  float begin_time;
+  float end_time;
+};
+
+// The result of a concurrency level of the load generator mode, the time is
+// in milliseconds.
+struct LoadResult {
+  int concurrency{0};
+  // load: creating the first predictor, cloning the others and setting the
+  // inputs. first_run: the first run of each predictor. warmup: the
+  // --warmup runs of each predictor. steady: the --duration seconds in
+  // which the requests are measured.
+  std::vector<LoadPhase> phases;
+  std::vector<float> first_run_time;
+  // The latencies of the requests of the steady state, including the time
+  // queued in the open loop.
+  std::vector<float> latency;
+};
+
 int Benchmark(int argc, char** argv);
 void Run(const std::string& model_file,
          const std::vector<std::vector<int64_t>>& input_shape);
+// The load generator mode, see --concurrency.
+void RunLoad(const std::string& model_file,
+             const std::vector<std::vector<int64_t>>& input_shapes);
 
 #ifdef __ANDROID__
 std::string GetDeviceInfo() {
@@ -155,6 +183,22 @@ void StoreOutputTensor(const std::stringstream& data, std::string path) {
   fs.close();
 }
 
+// The concurrency levels of the load generator mode, from --concurrency_sweep
+// if it's set, otherwise --concurrency. The levels which aren't positive
+// integers are 0.
+std::vector<int> GetConcurrencyLevels() {
+  if (FLAGS_concurrency_sweep.empty()) return {FLAGS_concurrency};
+  std::vector<int> levels;
+  for (auto& level : lite::Split(FLAGS_concurrency_sweep, ",")) {
+    char* end = nullptr;
+    int64_t value = strtoll(level.c_str(), &end, 10);
+    bool valid = !level.empty() && *end == '\0' && value > 0 &&
+                 value <= std::numeric_limits<int>::max();
+    levels.push_back(valid ? static_cast<int>(value) : 0);
+  }
+  return levels;
+}
+
 bool CheckFlagsValid() {
   bool ret = true;
   bool is_opt_model =
@@ -203,6 +247,29 @@ bool CheckFlagsValid() {
       ret = false;
     }
   }
+  bool is_load_mode =
+      FLAGS_concurrency > 0 || !FLAGS_concurrency_sweep.empty();
+  if (is_load_mode) {
+    if (!FLAGS_validation_set.empty()) {
+      std::cerr << "--validation_set is not supported by the load generator "
+                   "mode!"
+                << std::endl;
+      ret = false;
+    }
+    auto levels = GetConcurrencyLevels();
+    if (levels.empty() ||
+        *std::min_element(levels.begin(), levels.end()) <= 0) {
+      std::cerr << "Option invalid: --concurrency_sweep="
+                << FLAGS_concurrency_sweep
+                << "\nThe concurrency levels should be positive integers."
+                << std::endl;
+      ret = false;
+    }
+    if (FLAGS_duration <= 0) {
+      std::cerr << "--duration should be positive!" << std::endl;
+      ret = false;
+    }
+  }
 
   return ret;
 }
@@ -18,6 +18,8 @@
 #include <malloc.h>
 #include <sys/resource.h>
 #include <sys/time.h>
+#include <unistd.h>
+#include <cstdio>
 #endif
 
 namespace paddle {
@@ -40,6 +42,15 @@ MemoryUsage GetMemoryUsage() {
   if (getrusage(RUSAGE_SELF, &res) == 0) {
     result.max_rss_kb = res.ru_maxrss;
   }
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if (statm != nullptr) {
+    long size = 0;      // NOLINT
+    long resident = 0;  // NOLINT
+    if (fscanf(statm, "%ld %ld", &size, &resident) == 2) {
+      result.rss_kb = resident * (sysconf(_SC_PAGESIZE) / 1024);
+    }
+    fclose(statm);
+  }
 #if defined(__GLIBC__) && __GLIBC_MINOR__ >= 33
   const auto mem = mallinfo2();
 #else
@@ -53,6 +64,7 @@ MemoryUsage GetMemoryUsage() {
 
 void MemoryUsage::AllStatsToStream(std::ostream* stream) const {
   *stream << "max resident set size = " << max_rss_kb / 1024.0
+          << " MB, resident set size = " << rss_kb / 1024.0
           << " MB, total malloc-ed size = "
           << total_allocated_bytes / 1024.0 / 1024.0
           << " MB, in-use allocated/mmapped size = "
@@ -31,6 +31,7 @@ struct MemoryUsage {
 
   MemoryUsage()
       : max_rss_kb(kValueNotSet),
+        rss_kb(kValueNotSet),
         total_allocated_bytes(kValueNotSet),
         in_use_allocated_bytes(kValueNotSet) {}
 
@@ -39,6 +40,10 @@ struct MemoryUsage {
   // referred as resident set size (rss). This is an alias to rusage::ru_maxrss.
   int64_t max_rss_kb;
 
+  // The current resident set size (in kilobytes), which goes down when the
+  // memory is released, read from /proc/self/statm.
+  int64_t rss_kb;
+
   // Total non-mmapped space allocated from system in bytes. This is an alias to
   // mallinfo::arena.
   size_t total_allocated_bytes;
@@ -50,6 +55,7 @@ struct MemoryUsage {
   MemoryUsage operator+(MemoryUsage const& obj) const {
     MemoryUsage res;
     res.max_rss_kb = max_rss_kb + obj.max_rss_kb;
+    res.rss_kb = rss_kb + obj.rss_kb;
     res.total_allocated_bytes =
         total_allocated_bytes + obj.total_allocated_bytes;
     res.in_use_allocated_bytes =
@@ -60,6 +66,7 @@ struct MemoryUsage {
   MemoryUsage operator-(MemoryUsage const& obj) const {
     MemoryUsage res;
     res.max_rss_kb = max_rss_kb - obj.max_rss_kb;
+    res.rss_kb = rss_kb - obj.rss_kb;
     res.total_allocated_bytes =
         total_allocated_bytes - obj.total_allocated_bytes;
     res.in_use_allocated_bytes =
@@ -44,13 +44,20 @@ void ResourceUsageMonitor::Start() {
   }
   std::cout << "start monitoring memory!" << std::endl;
   stop_signal_ = false;
-  check_memory_thd_.reset(new std::thread(([this]() {
+  timeline_.clear();
+  auto start = std::chrono::steady_clock::now();
+  check_memory_thd_.reset(new std::thread(([this, start]() {
     // Note we retrieve the memory usage at the very beginning of the thread.
     while (true) {
       const auto mem_info = sampler_->GetMemoryUsage();
       if (mem_info.max_rss_kb > peak_max_rss_kb_) {
         peak_max_rss_kb_ = mem_info.max_rss_kb;
       }
+      timeline_.push_back(
+          {std::chrono::duration<float, std::milli>(
+               std::chrono::steady_clock::now() - start)
+               .count(),
+           mem_info.rss_kb});
       std::cout << std::fixed << "cpu usage ratio: " << std::setprecision(1)
                 << sampler_->GetCpuUsageRatio(getpid()) * 100 << "%"
                 << std::endl;
@@ -16,8 +16,10 @@
 #define LITE_API_TOOLS_PROFILING_RESOURCE_USAGE_MONITOR_H_
 
 #include <unistd.h>
+#include <chrono>  // NOLINT(build/c++11)
 #include <memory>
 #include <thread>  // NOLINT(build/c++11)
+#include <vector>
 #include "cpu_usage_info.h"
 #include "memory_info.h"
 
@@ -56,6 +58,12 @@ class ResourceUsageMonitor {
 
   static constexpr float kInvalidMemUsageKB = -1.0f;
 
+  // A sample of the resident set size, taken `time_ms` after Start.
+  struct MemUsageSample {
+    float time_ms;
+    int64_t rss_kb;
+  };
+
   explicit ResourceUsageMonitor(int sampling_interval_ms = 10)
       : ResourceUsageMonitor(sampling_interval_ms,
                              std::unique_ptr<Sampler>(new Sampler())) {}
@@ -78,6 +86,11 @@ class ResourceUsageMonitor {
     return peak_max_rss_kb_;
   }
 
+  // The resident set sizes sampled since Start, only valid after Stop.
+  const std::vector<MemUsageSample>& GetMemUsageTimeline() const {
+    return timeline_;
+  }
+
   ResourceUsageMonitor(ResourceUsageMonitor&) = delete;
   ResourceUsageMonitor& operator=(const ResourceUsageMonitor&) = delete;
   ResourceUsageMonitor(ResourceUsageMonitor&&) = delete;
@@ -92,6 +105,7 @@ class ResourceUsageMonitor {
   const int sampling_interval_;
   std::unique_ptr<std::thread> check_memory_thd_ = nullptr;
   int64_t peak_max_rss_kb_ = kInvalidMemUsageKB;
+  std::vector<MemUsageSample> timeline_;
 };
 
 }  // namespace paddle
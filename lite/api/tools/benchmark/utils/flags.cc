@@ -59,6 +59,13 @@ DEFINE_bool(enable_op_time_profile, false, enable_op_time_profile_msg);
 DEFINE_bool(enable_memory_profile, false, enable_memory_profile_msg);
 DEFINE_int32(memory_check_interval_ms, 5, memory_check_interval_ms_msg);
 
+// Load generator options
+DEFINE_int32(concurrency, 0, concurrency_msg);
+DEFINE_string(concurrency_sweep, "", concurrency_sweep_msg);
+DEFINE_double(request_rate, 0, request_rate_msg);
+DEFINE_double(duration, 10, duration_msg);
+DEFINE_string(json_path, "", json_path_msg);
+
 // Configuration options
 DEFINE_string(config_path, "", config_path_msg);
 
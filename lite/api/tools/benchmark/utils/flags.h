@@ -120,6 +120,30 @@ static const char memory_check_interval_ms_msg[] =
     "footprint checks. This is only used when "
     "--enable_memory_profile is set to true. Not supported yet.";
 
+// Load generator options
+static const char concurrency_msg[] =
+    "Run in the load generator mode with the number of predictors running "
+    "concurrently, each of them is a clone of the first one and runs in its "
+    "own thread. The load generator mode is off if it's 0.";
+static const char concurrency_sweep_msg[] =
+    "Run in the load generator mode with each of the concurrency levels, "
+    "separated by comma, such as 1,2,4,8, to get the throughput of each "
+    "level. It overrides --concurrency.";
+static const char request_rate_msg[] =
+    "The requests per second issued to all the predictors in the load "
+    "generator mode. The requests are issued at fixed intervals no matter "
+    "whether the previous ones are completed (open loop), and the latency "
+    "includes the time queued. Non-positive values mean each predictor "
+    "runs back to back (closed loop).";
+static const char duration_msg[] =
+    "The duration in seconds of the steady state of each concurrency level "
+    "in the load generator mode.";
+static const char json_path_msg[] =
+    "Save the result of the load generator mode to the file as json, "
+    "including the latency percentiles, the throughput, the time of each "
+    "phase and the resident set size timeline if --enable_memory_profile "
+    "is set.";
+
 // Configuration options
 static const char config_path_msg[] = "Configuration options.";
 
@@ -161,6 +185,13 @@ DECLARE_bool(enable_op_time_profile);
 DECLARE_bool(enable_memory_profile);
 DECLARE_int32(memory_check_interval_ms);
 
+// Load generator options
+DECLARE_int32(concurrency);
+DECLARE_string(concurrency_sweep);
+DECLARE_double(request_rate);
+DECLARE_double(duration);
+DECLARE_string(json_path);
+
 // Configuration options
 DECLARE_string(config_path);
 
@@ -0,0 +1,143 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/host/math/kv_cache_attention.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "lite/core/parallel_defines.h"
+
+namespace paddle {
+namespace lite {
+namespace host {
+namespace math {
+
+namespace {
+
+// Compute the scores of the query over `len` keys, and return the maximum.
+inline float attention_scores(const float* query,
+                              const float* keys,
+                              const float* mask,
+                              int64_t mask_stride,
+                              int len,
+                              int head_dim,
+                              float alpha,
+                              float max_score,
+                              float* scores) {
+  for (int j = 0; j < len; j++) {
+    const float* key = keys + static_cast<int64_t>(j) * head_dim;
+    float dot = 0.f;
+    for (int d = 0; d < head_dim; d++) {
+      dot += query[d] * key[d];
+    }
+    float score = alpha * dot;
+    if (mask) score += mask[j * mask_stride];
+    scores[j] = score;
+    max_score = std::max(max_score, score);
+  }
+  return max_score;
+}
+
+// Accumulate the values weighted by the probabilities to the output.
+inline void attention_values(const float* probs,
+                             const float* values,
+                             int len,
+                             int v_dim,
+                             float* out) {
+  for (int j = 0; j < len; j++) {
+    const float* value = values + static_cast<int64_t>(j) * v_dim;
+    float prob = probs[j];
+    for (int d = 0; d < v_dim; d++) {
+      out[d] += prob * value[d];
+    }
+  }
+}
+
+}  // namespace
+
+void kv_cache_attention(const float* q,
+                        const float* past_k,
+                        const float* past_v,
+                        const float* k,
+                        const float* v,
+                        const float* mask,
+                        const int64_t* mask_offsets,
+                        int64_t mask_q_stride,
+                        int64_t mask_k_stride,
+                        float* scores,
+                        float* out,
+                        int num,
+                        int q_len,
+                        int past_len,
+                        int new_len,
+                        int head_dim,
+                        int v_dim,
+                        float alpha) {
+  int seq_len = past_len + new_len;
+  LITE_PARALLEL_BEGIN(n, tid, num) {
+    int64_t past_offset = static_cast<int64_t>(n) * past_len;
+    int64_t new_offset = static_cast<int64_t>(n) * new_len;
+    const float* past_k_n = past_k + past_offset * head_dim;
+    const float* past_v_n = past_v + past_offset * v_dim;
+    const float* k_n = k + new_offset * head_dim;
+    const float* v_n = v + new_offset * v_dim;
+    float* scores_n = scores + static_cast<int64_t>(n) * seq_len;
+    for (int i = 0; i < q_len; i++) {
+      int64_t row = static_cast<int64_t>(n) * q_len + i;
+      const float* query = q + row * head_dim;
+      const float* mask_i =
+          mask ? mask + mask_offsets[n] + i * mask_q_stride : nullptr;
+      float max_score = attention_scores(query,
+                                         past_k_n,
+                                         mask_i,
+                                         mask_k_stride,
+                                         past_len,
+                                         head_dim,
+                                         alpha,
+                                         -std::numeric_limits<float>::max(),
+                                         scores_n);
+      max_score = attention_scores(
+          query,
+          k_n,
+          mask_i ? mask_i + past_len * mask_k_stride : nullptr,
+          mask_k_stride,
+          new_len,
+          head_dim,
+          alpha,
+          max_score,
+          scores_n + past_len);
+
+      float sum = 0.f;
+      for (int j = 0; j < seq_len; j++) {
+        scores_n[j] = std::exp(scores_n[j] - max_score);
+        sum += scores_n[j];
+      }
+      float inv_sum = 1.f / sum;
+      for (int j = 0; j < seq_len; j++) {
+        scores_n[j] *= inv_sum;
+      }
+
+      float* out_i = out + row * v_dim;
+      std::fill(out_i, out_i + v_dim, 0.f);
+      attention_values(scores_n, past_v_n, past_len, v_dim, out_i);
+      attention_values(scores_n + past_len, v_n, new_len, v_dim, out_i);
+    }
+  }
+  LITE_PARALLEL_END();
+}
+
+}  // namespace math
+}  // namespace host
+}  // namespace lite
+}  // namespace paddle
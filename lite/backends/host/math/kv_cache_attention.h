@@ -0,0 +1,56 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+
+namespace paddle {
+namespace lite {
+namespace host {
+namespace math {
+
+// The attention over the keys and values of two segments along the sequence
+// axis, the past ones followed by the new ones, so they needn't be
+// concatenated:
+//   out[n] = softmax(alpha * q[n] * [past_k[n]; k[n]]^T + mask[n]) *
+//            [past_v[n]; v[n]]
+// q is [num, q_len, head_dim], past_k and past_v are [num, past_len, ...],
+// k and v are [num, new_len, ...] and out is [num, q_len, v_dim].
+// The mask of (n, i, j) is mask[mask_offsets[n] + i * mask_q_stride +
+// j * mask_k_stride], and mask can be nullptr.
+// scores is the workspace of num * (past_len + new_len) floats.
+void kv_cache_attention(const float* q,
+                        const float* past_k,
+                        const float* past_v,
+                        const float* k,
+                        const float* v,
+                        const float* mask,
+                        const int64_t* mask_offsets,
+                        int64_t mask_q_stride,
+                        int64_t mask_k_stride,
+                        float* scores,
+                        float* out,
+                        int num,
+                        int q_len,
+                        int past_len,
+                        int new_len,
+                        int head_dim,
+                        int v_dim,
+                        float alpha);
+
+}  // namespace math
+}  // namespace host
+}  // namespace lite
+}  // namespace paddle
@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "lite/backends/host/math/sequence_padding.h"
+#include <algorithm>
+#include <vector>
+#include "lite/backends/host/math/sequence_view.h"
 
 namespace paddle {
 namespace lite {
@@ -22,47 +25,39 @@ namespace math {
 template <typename T>
 void CopyValidData(lite::Tensor* dst_tensor,
                    const lite::Tensor* src_tensor,
-                   const std::vector<uint64_t>& seq_offsets,
-                   int pad_seq_len,
-                   int step_width,
+                   const SequenceView& seq_view,
+                   const SequenceView& pad_view,
                    bool norm_by_len,
-                   CopyType type,
-                   PadLayout layout) {
-  int seq_num = seq_offsets.size() - 1;
+                   CopyType type) {
   const T* src_data = src_tensor->template data<T>();
   T* dst_data = dst_tensor->template mutable_data<T>();
-
-  int seq_cpy_gap = step_width;
-  int pad_cpy_gap =
-      layout == kBatchLengthWidth ? step_width : seq_num * step_width;
-  for (int seq_idx = 0; seq_idx < seq_num; ++seq_idx) {
-    int valid_seq_len = seq_offsets[seq_idx + 1] - seq_offsets[seq_idx];
-    CHECK_GE(pad_seq_len, valid_seq_len) << "The padded sequence length can "
-                                            "not be less than its original "
-                                            "length.";
-    int seq_data_offset = seq_offsets[seq_idx] * step_width;
-    int pad_data_offset = layout == kBatchLengthWidth
-                              ? seq_idx * pad_seq_len * step_width
-                              : seq_idx * step_width;
+  const auto& src_view = type == kSeqToPad ? seq_view : pad_view;
+  const auto& dst_view = type == kSeqToPad ? pad_view : seq_view;
+  CopySequences<T>(src_data, src_view, dst_data, dst_view);
+  if (!norm_by_len) return;
+
+  int64_t step_width = dst_view.width;
+  for (size_t seq_idx = 0; seq_idx < dst_view.size(); ++seq_idx) {
+    uint64_t valid_seq_len = dst_view.lengths[seq_idx];
     float scale = 1.0f / static_cast<float>(valid_seq_len);
-
-    for (int step_idx = 0; step_idx < valid_seq_len; ++step_idx) {
-      const T* src =
-          src_data + (type == kSeqToPad ? seq_data_offset : pad_data_offset);
-      T* dst =
-          dst_data + (type == kSeqToPad ? pad_data_offset : seq_data_offset);
-      memcpy(dst, src, step_width * sizeof(T));
-      if (norm_by_len) {
-        for (int i = 0; i < step_width; ++i) {
-          *(dst + i) *= scale;
-        }
+    for (uint64_t step_idx = 0; step_idx < valid_seq_len; ++step_idx) {
+      T* dst = dst_data + dst_view.row(seq_idx, step_idx) * step_width;
+      for (int64_t i = 0; i < step_width; ++i) {
+        dst[i] *= scale;
       }
-      seq_data_offset += seq_cpy_gap;
-      pad_data_offset += pad_cpy_gap;
     }
   }
 }
 
+static std::vector<uint64_t> SequenceLengths(
+    const std::vector<uint64_t>& seq_offsets) {
+  std::vector<uint64_t> lengths(seq_offsets.size() - 1);
+  for (size_t i = 0; i < lengths.size(); ++i) {
+    lengths[i] = seq_offsets[i + 1] - seq_offsets[i];
+  }
+  return lengths;
+}
+
 template <typename T>
 static void fast_mem_init(void* dest,
                           size_t dest_size,
@@ -111,26 +106,40 @@ class PaddingLoDTensorFunctor<lite::TargetType::kHost, T> {
         << "The numel of 'pad_value' can only be 1 or be equal to the "
            "'step_width'.";
 
-    // fill padding value
+    auto seq_view = LoDSequences(seq_offsets, step_width);
+    auto pad_view = PaddedSequences(
+        SequenceLengths(seq_offsets), pad_seq_len, step_width, layout);
+
+    // fill padding value, only the padded steps are filled if the padded
+    // tensor is made of the padded sequences exactly
     T* pad_data = pad_tensor->template mutable_data<T>();
     const T* pad_value_data = pad_value.data<T>();
-    if (pad_value.numel() == 1) {
-      fast_mem_init<T>(
-          pad_data, pad_tensor->numel(), pad_value_data, sizeof(T));
+    if (pad_tensor->numel() != pad_view.rows * step_width) {
+      if (pad_value.numel() == 1) {
+        fast_mem_init<T>(
+            pad_data, pad_tensor->numel(), pad_value_data, sizeof(T));
+      } else {
+        for (int i = 0; i < pad_tensor->numel(); i += step_width) {
+          memcpy(pad_data + i, pad_value_data, step_width * sizeof(T));
+        }
+      }
     } else {
-      for (int i = 0; i < pad_tensor->numel(); i += step_width) {
-        memcpy(pad_data + i, pad_value_data, step_width * sizeof(T));
+      for (size_t seq_idx = 0; seq_idx < pad_view.size(); ++seq_idx) {
+        for (uint64_t step_idx = pad_view.lengths[seq_idx];
+             step_idx < static_cast<uint64_t>(pad_seq_len);
+             ++step_idx) {
+          T* dst = pad_data + pad_view.row(seq_idx, step_idx) * step_width;
+          if (pad_value.numel() == 1) {
+            std::fill(dst, dst + step_width, pad_value_data[0]);
+          } else {
+            memcpy(dst, pad_value_data, step_width * sizeof(T));
+          }
+        }
       }
     }
 
-    CopyValidData<T>(pad_tensor,
-                     &seq_tensor,
-                     seq_offsets,
-                     pad_seq_len,
-                     step_width,
-                     norm_by_times,
-                     kSeqToPad,
-                     layout);
+    CopyValidData<T>(
+        pad_tensor, &seq_tensor, seq_view, pad_view, norm_by_times, kSeqToPad);
   }
 };
 
@@ -159,14 +168,11 @@ class UnpaddingLoDTensorFunctor<lite::TargetType::kHost, T> {
               step_width,
               layout);
 
-    CopyValidData<T>(seq_tensor,
-                     &pad_tensor,
-                     seq_offsets,
-                     pad_seq_len,
-                     step_width,
-                     norm_by_times,
-                     kPadToSeq,
-                     layout);
+    auto seq_view = LoDSequences(seq_offsets, step_width);
+    auto pad_view = PaddedSequences(
+        SequenceLengths(seq_offsets), pad_seq_len, step_width, layout);
+    CopyValidData<T>(
+        seq_tensor, &pad_tensor, seq_view, pad_view, norm_by_times, kPadToSeq);
   }
 };
 
@@ -0,0 +1,186 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstring>
+#include <vector>
+#include "lite/backends/host/math/sequence_padding.h"
+#include "lite/core/tensor.h"
+#include "lite/utils/log/cp_logging.h"
+
+namespace paddle {
+namespace lite {
+namespace host {
+namespace math {
+
+/*
+ * The sequences stored in a tensor of `rows` rows and `width` elements per
+ * row: the step t of the sequence i is the row `offsets[i] + t * stride`.
+ *
+ *  LoD tensor [total_length, width]:
+ *    offsets = lod[0][:-1], stride = 1
+ *  padded tensor [num_sequences, padded_length, width] (kBatchLengthWidth):
+ *    offsets[i] = i * padded_length, stride = 1
+ *  padded tensor [padded_length, num_sequences, width] (kLengthBatchWidth):
+ *    offsets[i] = i, stride = num_sequences
+ *
+ * The views are used to move the sequences between the layouts with the
+ * fewest copies, and to find out when the layouts coincide, so that the
+ * output can share the storage of the input instead.
+ */
+struct SequenceView {
+  std::vector<uint64_t> offsets;
+  std::vector<uint64_t> lengths;
+  int64_t stride{1};
+  int64_t rows{0};
+  int64_t width{1};
+
+  size_t size() const { return lengths.size(); }
+
+  int64_t row(size_t seq, uint64_t step) const {
+    return static_cast<int64_t>(offsets[seq] + step * stride);
+  }
+
+  // Whether all of the rows belong to the sequences, i.e. there is no
+  // padding.
+  bool IsDense() const {
+    uint64_t total = 0;
+    for (auto length : lengths) total += length;
+    return static_cast<int64_t>(total) == rows;
+  }
+};
+
+inline SequenceView LoDSequences(const std::vector<uint64_t>& lod,
+                                 int64_t width) {
+  CHECK(!lod.empty());
+  SequenceView view;
+  view.offsets.assign(lod.begin(), lod.end() - 1);
+  view.lengths.resize(view.offsets.size());
+  for (size_t i = 0; i < view.lengths.size(); ++i) {
+    view.lengths[i] = lod[i + 1] - lod[i];
+  }
+  view.rows = static_cast<int64_t>(lod.back() - lod.front());
+  view.width = width;
+  return view;
+}
+
+inline SequenceView PaddedSequences(const std::vector<uint64_t>& lengths,
+                                    int64_t padded_length,
+                                    int64_t width,
+                                    PadLayout layout = kBatchLengthWidth) {
+  SequenceView view;
+  int64_t num = static_cast<int64_t>(lengths.size());
+  view.lengths = lengths;
+  view.offsets.resize(lengths.size());
+  for (int64_t i = 0; i < num; ++i) {
+    CHECK_LE(lengths[i], static_cast<uint64_t>(padded_length))
+        << "The padded sequence length can not be less than its original "
+           "length.";
+    view.offsets[i] = layout == kBatchLengthWidth ? i * padded_length : i;
+  }
+  view.stride = layout == kBatchLengthWidth ? 1 : num;
+  view.rows = num * padded_length;
+  view.width = width;
+  return view;
+}
+
+// Whether the tensors of the views can share the storage: both are dense,
+// and every step of every sequence lies on the same row.
+inline bool IsSameLayout(const SequenceView& a, const SequenceView& b) {
+  if (a.rows != b.rows || a.width != b.width || a.size() != b.size() ||
+      !a.IsDense() || !b.IsDense()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a.lengths[i] != b.lengths[i]) return false;
+    if (a.lengths[i] == 0) continue;
+    if (a.offsets[i] != b.offsets[i]) return false;
+    if (a.lengths[i] > 1 && a.stride != b.stride) return false;
+  }
+  return true;
+}
+
+// Copy the sequences of `src` to the rows of `dst`, the runs of the
+// sequences which are contiguous in both views are copied at once.
+template <typename T>
+void CopySequences(const T* src,
+                   const SequenceView& src_view,
+                   T* dst,
+                   const SequenceView& dst_view) {
+  CHECK_EQ(src_view.size(), dst_view.size());
+  CHECK_EQ(src_view.width, dst_view.width);
+  const int64_t width = src_view.width;
+  const bool contiguous = src_view.stride == 1 && dst_view.stride == 1;
+  size_t i = 0;
+  while (i < src_view.size()) {
+    uint64_t length = src_view.lengths[i];
+    CHECK_EQ(length, dst_view.lengths[i]);
+    if (contiguous) {
+      uint64_t rows = length;
+      size_t j = i + 1;
+      while (j < src_view.size() &&
+             src_view.lengths[j] == dst_view.lengths[j] &&
+             src_view.offsets[j] == src_view.offsets[i] + rows &&
+             dst_view.offsets[j] == dst_view.offsets[i] + rows) {
+        rows += src_view.lengths[j++];
+      }
+      if (rows > 0) {
+        memcpy(dst + dst_view.offsets[i] * width,
+               src + src_view.offsets[i] * width,
+               rows * width * sizeof(T));
+      }
+      i = j;
+      continue;
+    }
+    for (uint64_t t = 0; t < length; ++t) {
+      memcpy(dst + dst_view.row(i, t) * width,
+             src + src_view.row(i, t) * width,
+             width * sizeof(T));
+    }
+    ++i;
+  }
+}
+
+// Let `dst` share the storage of `src`, keeping the dims and the LoD of
+// `dst`.
+inline void ShareSequences(const lite::Tensor& src, lite::Tensor* dst) {
+  CHECK_EQ(src.numel(), dst->numel());
+  auto dims = dst->dims();
+  auto lod = dst->lod();
+  dst->ShareDataWith(src);
+  dst->Resize(dims);
+  dst->set_lod(lod);
+}
+
+// Give `dst` its own storage again if it shared the storage of `src` in the
+// previous run, so that writing `dst` doesn't overwrite `src`.
+inline void DetachSequences(const lite::Tensor& src, lite::Tensor* dst) {
+  if (!dst->IsInitialized() || !src.IsInitialized() ||
+      dst->raw_data() != src.raw_data()) {
+    return;
+  }
+  auto dims = dst->dims();
+  auto lod = dst->lod();
+  auto target = dst->target();
+  dst->ShareDataWith(lite::Tensor());
+  dst->Resize(dims);
+  dst->set_lod(lod);
+  dst->set_target(target);
+}
+
+}  // namespace math
+}  // namespace host
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,153 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "lite/backends/x86/jit/autotune.h"
+#if !defined(_WIN32) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#endif
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include "lite/backends/x86/cpu_info.h"
+#include "lite/utils/log/cp_logging.h"
+
+namespace paddle {
+namespace lite {
+namespace jit {
+
+namespace {
+
+const char kHostHeader[] = "#host";
+
+// The brand string of the cpu, e.g. "Intel(R)_Xeon(R)_Gold_6148_CPU_@_2.40GHz"
+// with the spaces replaced, or "unknown" if it isn't available.
+std::string CpuModel() {
+  std::string model;
+#if !defined(_WIN32) && (defined(__x86_64__) || defined(__i386__))
+  unsigned int regs[12];
+  if (__get_cpuid_max(0x80000000, nullptr) >= 0x80000004) {
+    for (unsigned int i = 0; i < 3; i++) {
+      __get_cpuid(0x80000002 + i,
+                  &regs[i * 4],
+                  &regs[i * 4 + 1],
+                  &regs[i * 4 + 2],
+                  &regs[i * 4 + 3]);
+    }
+    char brand[sizeof(regs) + 1];
+    std::memcpy(brand, regs, sizeof(regs));
+    brand[sizeof(regs)] = '\0';
+    for (const char* c = brand; *c; c++) {
+      if (*c == ' ') {
+        if (!model.empty() && model.back() != '_') model.push_back('_');
+      } else {
+        model.push_back(*c);
+      }
+    }
+    while (!model.empty() && model.back() == '_') model.pop_back();
+  }
+#endif
+  return model.empty() ? "unknown" : model;
+}
+
+}  // namespace
+
+Autotuner& Autotuner::Global() {
+  static auto* x = new Autotuner;
+  return *x;
+}
+
+std::string Autotuner::HostIdentity() {
+  static const std::string identity = []() {
+    const std::pair<x86::cpu_isa_t, const char*> isas[] = {
+        {x86::sse42, "sse42"},
+        {x86::avx, "avx"},
+        {x86::avx2, "avx2"},
+        {x86::avx512f, "avx512f"},
+        {x86::avx512_core, "avx512_core"},
+        {x86::avx512_core_vnni, "avx512_core_vnni"},
+        {x86::avx512_mic, "avx512_mic"},
+        {x86::avx512_mic_4ops, "avx512_mic_4ops"}};
+    std::string res = "isa=";
+    for (auto& isa : isas) {
+      if (x86::MayIUse(isa.first)) {
+        res += isa.second;
+        res += ",";
+      }
+    }
+    if (res.back() == ',') res.pop_back();
+    return res + ";cpu=" + CpuModel();
+  }();
+  return identity;
+}
+
+void Autotuner::Enable(const std::string& decision_file) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  decision_file_ = decision_file;
+  if (!decision_file_.empty()) {
+    // The first line is the identity of the host: #host <identity>, then one
+    // decision per line: <key> <impl_type>, the latter lines override the
+    // former ones.
+    std::ifstream fin(decision_file_);
+    std::string header, identity;
+    fin >> header >> identity;
+    if (header == kHostHeader && identity == HostIdentity()) {
+      std::string key, impl_type;
+      int num_decisions = 0;
+      while (fin >> key >> impl_type) {
+        decisions_[key] = impl_type;
+        num_decisions++;
+      }
+      VLOG(3) << "Loaded " << num_decisions << " jit decisions from "
+              << decision_file_;
+    } else {
+      if (!header.empty()) {
+        LOG(WARNING) << "The jit decisions in " << decision_file_
+                     << " are tuned on another host, they are discarded and "
+                        "tuned again.";
+      }
+      fin.close();
+      std::ofstream fout(decision_file_, std::ios::trunc);
+      if (!fout) {
+        LOG(WARNING) << "Failed to save the jit decisions to "
+                     << decision_file_;
+      }
+      fout << kHostHeader << " " << HostIdentity() << "\n";
+    }
+  }
+  enabled_ = true;
+}
+
+bool Autotuner::Find(const std::string& key, std::string* impl_type) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = decisions_.find(key);
+  if (it == decisions_.end()) return false;
+  *impl_type = it->second;
+  return true;
+}
+
+void Autotuner::Record(const std::string& key, const std::string& impl_type) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  decisions_[key] = impl_type;
+  if (decision_file_.empty()) return;
+  std::ofstream fout(decision_file_, std::ios::app);
+  if (!fout) {
+    LOG(WARNING) << "Failed to save the jit decisions to " << decision_file_;
+    return;
+  }
+  fout << key << " " << impl_type << "\n";
+}
+
+}  // namespace jit
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,131 @@
+/* Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <map>
+#include <mutex>  // NOLINT
+#include <random>
+#include <string>
+#include <vector>
+
+namespace paddle {
+namespace lite {
+namespace jit {
+
+// Choose the fastest of the candidate functions of a kernel for each
+// attribute by timing them at the first use, instead of the default one
+// tuned offline. The decisions are shared by the whole process, and can be
+// saved to a file, so that the next runs on the same host load them and
+// skip the tuning.
+class Autotuner {
+ public:
+  static Autotuner& Global();
+
+  // The instruction sets and the cpu model of the host, the decision file
+  // is only valid on the hosts with the same identity.
+  static std::string HostIdentity();
+
+  // Load the decisions from `decision_file` if it exists and is saved on a
+  // host with the same identity, otherwise the file is reset, and append the
+  // new decisions to it.
+  void Enable(const std::string& decision_file = "");
+  void Disable() { enabled_ = false; }
+  bool enabled() const { return enabled_; }
+
+  // Return false if the kernel with the attribute isn't tuned yet.
+  bool Find(const std::string& key, std::string* impl_type);
+  void Record(const std::string& key, const std::string& impl_type);
+
+ private:
+  Autotuner() = default;
+
+  std::atomic<bool> enabled_{false};
+  std::mutex mutex_;
+  std::string decision_file_;
+  // The implementation type of the fastest function of each kernel and
+  // attribute.
+  std::map<std::string, std::string> decisions_;
+};
+
+// Run `func` repeatedly for at least 1ms after the warmup, and return the
+// average time in microseconds.
+template <typename Func>
+double TimeFunc(Func func) {
+  const int kWarmup = 3;
+  const double kMinTotalUs = 1000.0;
+  for (int i = 0; i < kWarmup; i++) {
+    func();
+  }
+  int repeats = 0;
+  double total_us = 0;
+  auto start = std::chrono::steady_clock::now();
+  while (total_us < kMinTotalUs) {
+    func();
+    repeats++;
+    total_us = std::chrono::duration<double, std::micro>(
+                   std::chrono::steady_clock::now() - start)
+                   .count();
+  }
+  return total_us / repeats;
+}
+
+template <typename T>
+std::vector<T> RandomVector(int n) {
+  std::mt19937 engine(n);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  std::vector<T> res(n);
+  for (auto& x : res) {
+    x = static_cast<T>(dist(engine));
+  }
+  return res;
+}
+
+// Time a candidate function on random inputs of the attribute. Only the
+// functions of the vectors with the length attribute are supported, the
+// others always use the default best function.
+template <typename Func, typename Attr>
+struct FuncBenchmark {
+  static constexpr bool kSupported = false;
+  static double Run(Func func, const Attr& attr) { return 0; }
+};
+
+// XYZNTuple and AXYNTuple
+template <typename T>
+struct FuncBenchmark<void (*)(const T*, const T*, T*, int), int> {
+  static constexpr bool kSupported = true;
+  static double Run(void (*func)(const T*, const T*, T*, int), const int& n) {
+    auto x = RandomVector<T>(n);
+    auto y = RandomVector<T>(n);
+    std::vector<T> z(n);
+    return TimeFunc([&]() { func(x.data(), y.data(), z.data(), n); });
+  }
+};
+
+// XYNTuple and XRNTuple
+template <typename T>
+struct FuncBenchmark<void (*)(const T*, T*, int), int> {
+  static constexpr bool kSupported = true;
+  static double Run(void (*func)(const T*, T*, int), const int& n) {
+    auto x = RandomVector<T>(n);
+    std::vector<T> y(n);
+    return TimeFunc([&]() { func(x.data(), y.data(), n); });
+  }
+};
+
+}  // namespace jit
+}  // namespace lite
+}  // namespace paddle
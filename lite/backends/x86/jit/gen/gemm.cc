@@ -0,0 +1,189 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#include "lite/backends/x86/jit/gen/gemm.h"
+#include <stddef.h>  // offsetof
+#include <memory>
+#include <type_traits>
+#include "lite/backends/x86/jit/registry.h"
+
+namespace paddle {
+namespace lite {
+namespace jit {
+namespace gen {
+
+Xbyak::Address GemmJitCode::rowA(int i, int k_offset) {
+  reg64_t& base = i < 3 ? reg_ptr_a0 : (i < 6 ? reg_ptr_a3 : reg_ptr_a6);
+  switch (i % 3) {
+    case 0:
+      return ptr[base + k_offset];
+    case 1:
+      return ptr[base + reg_lda + k_offset];
+    default:
+      return ptr[base + reg_lda * 2 + k_offset];
+  }
+}
+
+template <typename JMM>
+void GemmJitCode::genMicroKernel() {
+  const bool is_zmm = std::is_same<JMM, Xbyak::Zmm>::value;
+  const int num_regs = is_zmm ? 32 : 16;
+  const int block = is_zmm ? ZMM_FLOAT_BLOCK : YMM_FLOAT_BLOCK;
+  const int block_len = sizeof(float) * block;
+  const int nb = nr_ / block;
+  CHECK_EQ(nr_ % block, 0);
+  CHECK_LE(mr_, 8);
+  // mr x nb accumulators, nb registers of B and one of the broadcast A
+  CHECK_LE(mr_ * nb + nb + 1, num_regs);
+  auto acc = [&](int i, int j) { return JMM(i * nb + j); };
+  auto vb = [&](int j) { return JMM(mr_ * nb + j); };
+  JMM va(mr_ * nb + nb);
+  // vxorps of zmm needs AVX512DQ
+  auto zero = [&](const JMM& r) {
+    if (is_zmm) {
+      vpxord(r, r, r);
+    } else {
+      vxorps(r, r, r);
+    }
+  };
+
+  mov(reg_ptr_a0, ptr[param1 + offsetof(gemm_t, a)]);
+  mov(reg_ptr_b, ptr[param1 + offsetof(gemm_t, packed_b)]);
+  mov(reg_ptr_c, ptr[param1 + offsetof(gemm_t, c)]);
+  mov(reg_lda, ptr[param1 + offsetof(gemm_t, lda)]);
+  mov(reg_ldc, ptr[param1 + offsetof(gemm_t, ldc)]);
+  mov(reg_k, ptr[param1 + offsetof(gemm_t, k)]);
+  if (with_bias_) {
+    mov(reg_ptr_bias, ptr[param1 + offsetof(gemm_t, bias)]);
+  }
+  if (with_residual_) {
+    mov(reg_ptr_residual, ptr[param1 + offsetof(gemm_t, residual)]);
+    mov(reg_ldr, ptr[param1 + offsetof(gemm_t, ldr)]);
+    shl(reg_ldr, 2);
+  }
+  // leading dimensions in bytes
+  shl(reg_lda, 2);
+  shl(reg_ldc, 2);
+  if (mr_ > 3) {
+    lea(reg_ptr_a3, ptr[reg_ptr_a0 + reg_lda * 2]);
+    add(reg_ptr_a3, reg_lda);
+  }
+  if (mr_ > 6) {
+    lea(reg_ptr_a6, ptr[reg_ptr_a3 + reg_lda * 2]);
+    add(reg_ptr_a6, reg_lda);
+  }
+  for (int i = 0; i < mr_; ++i) {
+    for (int j = 0; j < nb; ++j) {
+      zero(acc(i, j));
+    }
+  }
+
+  // C += A(:, k) * B(k, :) along K
+  Label l_k;
+  L(l_k);
+  for (int j = 0; j < nb; ++j) {
+    vmovups(vb(j), ptr[reg_ptr_b + j * block_len]);
+  }
+  for (int i = 0; i < mr_; ++i) {
+    vbroadcastss(va, rowA(i, 0));
+    for (int j = 0; j < nb; ++j) {
+      vfmadd231ps(acc(i, j), vb(j), va);
+    }
+  }
+  add(reg_ptr_b, nr_ * sizeof(float));
+  add(reg_ptr_a0, sizeof(float));
+  if (mr_ > 3) {
+    add(reg_ptr_a3, sizeof(float));
+  }
+  if (mr_ > 6) {
+    add(reg_ptr_a6, sizeof(float));
+  }
+  dec(reg_k);
+  jnz(l_k, T_NEAR);
+
+  // epilogue: bias, residual and activation, then store
+  if (with_relu_) {
+    zero(va);
+  }
+  if (with_bias_) {
+    for (int j = 0; j < nb; ++j) {
+      vmovups(vb(j), ptr[reg_ptr_bias + j * block_len]);
+    }
+  }
+  if (with_residual_) {
+    mov(reg_ptr_tmp, reg_ptr_residual);
+  }
+  for (int i = 0; i < mr_; ++i) {
+    for (int j = 0; j < nb; ++j) {
+      if (with_bias_) {
+        vaddps(acc(i, j), acc(i, j), vb(j));
+      }
+      if (with_residual_) {
+        vaddps(acc(i, j), acc(i, j), ptr[reg_ptr_tmp + j * block_len]);
+      }
+      if (with_relu_) {
+        vmaxps(acc(i, j), acc(i, j), va);
+      }
+      vmovups(ptr[reg_ptr_c + j * block_len], acc(i, j));
+    }
+    if (i + 1 < mr_) {
+      if (with_residual_) {
+        add(reg_ptr_tmp, reg_ldr);
+      }
+      add(reg_ptr_c, reg_ldc);
+    }
+  }
+}
+
+void GemmJitCode::genCode() {
+  preCode();
+  if (nr_ % ZMM_FLOAT_BLOCK == 0 && x86::MayIUse(x86::avx512f)) {
+    genMicroKernel<Xbyak::Zmm>();
+  } else {
+    genMicroKernel<Xbyak::Ymm>();
+  }
+  postCode();
+}
+
+class GemmCreator : public JitCodeCreator<gemm_attr_t> {
+ public:
+  bool CanBeUsed(const gemm_attr_t& attr) const override {
+    if (attr.mr < 1 || (attr.act != kVIdentity && attr.act != kVRelu)) {
+      return false;
+    }
+    if (x86::MayIUse(x86::avx512f) && attr.nr == 2 * ZMM_FLOAT_BLOCK) {
+      return attr.mr <= 8;
+    }
+    return x86::MayIUse(x86::avx2) && attr.nr == 2 * YMM_FLOAT_BLOCK &&
+           attr.mr <= 6;
+  }
+  size_t CodeSize(const gemm_attr_t& attr) const override {
+    return 512 + 64 * attr.mr * (attr.nr / YMM_FLOAT_BLOCK + 1);
+  }
+  std::unique_ptr<GenBase> CreateJitCode(
+      const gemm_attr_t& attr) const override {
+    CHECK_GT(attr.mr, 0);
+    CHECK_GT(attr.nr, 0);
+    return make_unique<GemmJitCode>(attr, CodeSize(attr));
+  }
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace lite
+}  // namespace paddle
+
+namespace gen = paddle::lite::jit::gen;
+
+REGISTER_JITKERNEL_GEN_LITE(kGemm, gen::GemmCreator);
@@ -0,0 +1,91 @@
+/* Copyright (c) 2018 PaddlePaddle Authors. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License. */
+
+#pragma once
+
+#include <string>
+#include "lite/backends/x86/jit/gen/jitcode.h"
+#include "lite/utils/log/cp_logging.h"
+#include "lite/utils/string.h"
+
+namespace paddle {
+namespace lite {
+namespace jit {
+namespace gen {
+
+// The register blocked microkernel of gemm_t: the mr x nr block of C is kept
+// in the vector registers along K, then the bias, residual and activation
+// are applied before it's stored. nr is two ymm on AVX2 or two zmm on
+// AVX-512, and mr is limited by the number of the vector registers.
+class GemmJitCode : public JitCode {
+ public:
+  explicit GemmJitCode(const gemm_attr_t& attr,
+                       size_t code_size = 256 * 1024,
+                       void* code_ptr = nullptr)
+      : JitCode(code_size, code_ptr),
+        mr_(attr.mr),
+        nr_(attr.nr),
+        with_bias_(attr.with_bias),
+        with_residual_(attr.with_residual),
+        with_relu_(attr.act == kVRelu) {
+    CHECK(attr.act == kVIdentity || attr.act == kVRelu)
+        << "Only support identity and relu epilogue yet";
+    this->genCode();
+  }
+
+  std::string name() const override {
+    std::string base = "GemmJitCode";
+    base = base + "_MR" + paddle::lite::to_string(mr_) + "_NR" +
+           paddle::lite::to_string(nr_);
+    if (with_bias_) {
+      base += "_Bias";
+    }
+    if (with_residual_) {
+      base += "_Residual";
+    }
+    if (with_relu_) {
+      base += "_Relu";
+    }
+    return base;
+  }
+  void genCode() override;
+
+ private:
+  template <typename JMM>
+  void genMicroKernel();
+  // The address of the k-th element of the i-th row of A.
+  Xbyak::Address rowA(int i, int k_offset);
+
+  int mr_, nr_;
+  bool with_bias_, with_residual_, with_relu_;
+
+  // rcx and rdi are left for the first argument on Windows and Linux.
+  reg64_t reg_ptr_a0{rax};  // rows 0~2
+  reg64_t reg_ptr_a3{rbx};  // rows 3~5
+  reg64_t reg_ptr_a6{rdx};  // rows 6~7
+  reg64_t reg_ptr_b{rsi};
+  reg64_t reg_ptr_c{r8};
+  reg64_t reg_ptr_bias{r9};
+  reg64_t reg_ptr_residual{r10};
+  reg64_t reg_lda{r11};
+  reg64_t reg_ldc{r12};
+  reg64_t reg_ldr{r13};
+  reg64_t reg_k{r14};
+  reg64_t reg_ptr_tmp{r15};
+};
+
+}  // namespace gen
+}  // namespace jit
+}  // namespace lite
+}  // namespace paddle
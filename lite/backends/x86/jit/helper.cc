@@ -60,6 +60,7 @@ const char* to_string(KernelType kt) {
     ONE_CASE(kStrideASum);
     ONE_CASE(kSoftmax);
     ONE_CASE(kEmbSeqPool);
+    ONE_CASE(kGemm);
     ONE_CASE(kSgd);
     default:
       LOG(FATAL) << "Not support type: %d, or forget to add it.";
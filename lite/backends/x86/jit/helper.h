@@ -15,16 +15,15 @@
 #pragma once
 
 #include <iostream>
-#include <map>
 #include <string>
 #include <utility>  // for std::move
 #include <vector>
+#include "lite/backends/x86/jit/autotune.h"
 #include "lite/backends/x86/jit/gen_base.h"
 #include "lite/backends/x86/jit/kernel_base.h"
 #include "lite/backends/x86/jit/kernel_key.h"
 #include "lite/backends/x86/jit/kernel_pool.h"
 #include "lite/utils/log/cp_logging.h"
-#include "lite/utils/macros.h"
 
 namespace paddle {
 namespace lite {
@@ -38,30 +37,26 @@ GetJitCode(const typename KernelTuple::attr_type& attr) {
   using Attr = typename KernelTuple::attr_type;
   int64_t key = JitCodeKey<Attr>(attr);
   auto& codes = JitCodePool<KernelTuple::kernel_type>::Instance();
-  if (codes.Has(key)) {
-    return codes.AllKernels().at(key).get();
-  }
-
-  // creator is not related with attr, so can use KernelKey as key
-  KernelKey kkey(KernelTuple::kernel_type, PlaceType());
-  // pool: (KernelKey(type, place), vector<GenCreatorPtr>)
-  auto& creator_map = JitCodeCreatorPool::Instance().AllCreators();
-  auto iter = creator_map.find(kkey);
-  if (iter != creator_map.end()) {
-    auto& creators = iter->second;
-    for (auto& cur : creators) {
-      auto i = dynamic_cast<const JitCodeCreator<Attr>*>(cur.get());
-      if (i && i->CanBeUsed(attr)) {
-        auto p = i->CreateJitCode(attr);
-        if (p) {
-          auto res = p.get();
-          codes.Insert(key, std::move(p));
-          return res;
+  return codes.FindOrCreate(key, [&attr]() -> std::unique_ptr<GenBase> {
+    // creator is not related with attr, so can use KernelKey as key
+    KernelKey kkey(KernelTuple::kernel_type, PlaceType());
+    // pool: (KernelKey(type, place), vector<GenCreatorPtr>)
+    auto& creator_map = JitCodeCreatorPool::Instance().AllCreators();
+    auto iter = creator_map.find(kkey);
+    if (iter != creator_map.end()) {
+      auto& creators = iter->second;
+      for (auto& cur : creators) {
+        auto i = dynamic_cast<const JitCodeCreator<Attr>*>(cur.get());
+        if (i && i->CanBeUsed(attr)) {
+          auto p = i->CreateJitCode(attr);
+          if (p) {
+            return p;
+          }
         }
       }
     }
-  }
-  return nullptr;
+    return nullptr;
+  });
 }
 
 template <typename KernelTuple, typename PlaceType>
@@ -168,18 +163,59 @@ typename KernelTuple::func_type GetDefaultBestFunc(
     const typename KernelTuple::attr_type& attr) {
   auto funcs = GetAllCandidateFuncs<KernelTuple, PlaceType>(attr);
   CHECK_GE(funcs.size(), 1UL);
-  // Here could do some runtime benchmark of this attr and return the best one.
-  // But yet just get the first one as the default best one,
-  // which is searched in order and tuned by offline.
+  // Get the first one as the default best one, which is searched in order and
+  // tuned by offline. The runtime benchmark of this attr is done by
+  // GetTunedBestFunc if the Autotuner is enabled.
   return funcs[0];
 }
 
+// Time all the candidates with the attribute and return the fastest one, the
+// decision is recorded to the Autotuner, so it's reused by the next runs.
+// Fall back to the default best function if the kernel can't be timed.
+template <typename KernelTuple, typename PlaceType = lite::fluid::CPUPlace>
+typename KernelTuple::func_type GetTunedBestFunc(
+    const typename KernelTuple::attr_type& attr) {
+  using Attr = typename KernelTuple::attr_type;
+  using Benchmark = FuncBenchmark<typename KernelTuple::func_type, Attr>;
+  auto funcs = GetAllCandidateFuncsWithTypes<KernelTuple, PlaceType>(attr);
+  CHECK_GE(funcs.size(), 1UL);
+  if (funcs.size() == 1 || !Benchmark::kSupported) {
+    return funcs[0].second;
+  }
+
+  std::string key =
+      std::string(to_string(KernelTuple::kernel_type)) + "/fp" +
+      std::to_string(sizeof(typename KernelTuple::data_type) * 8) + "/" +
+      std::to_string(JitCodeKey<Attr>(attr));
+  auto& tuner = Autotuner::Global();
+  std::string impl_type;
+  if (tuner.Find(key, &impl_type)) {
+    for (auto& func : funcs) {
+      if (func.first == impl_type) return func.second;
+    }
+  }
+  size_t best = 0;
+  double best_us = -1;
+  for (size_t i = 0; i < funcs.size(); i++) {
+    double us = Benchmark::Run(funcs[i].second, attr);
+    VLOG(4) << key << " " << funcs[i].first << ": " << us << " us";
+    if (best_us < 0 || us < best_us) {
+      best = i;
+      best_us = us;
+    }
+  }
+  tuner.Record(key, funcs[best].first);
+  return funcs[best].second;
+}
+
+// The best functions of all the attributes of a kernel, which are shared by
+// all the threads. The lookups only take a read lock.
 template <typename KernelTuple, typename PlaceType>
 class KernelFuncs {
  public:
   KernelFuncs() = default;
   static KernelFuncs& Cache() {
-    static LITE_THREAD_LOCAL KernelFuncs<KernelTuple, PlaceType> g_func_cache;
+    static KernelFuncs<KernelTuple, PlaceType> g_func_cache;
     return g_func_cache;
   }
 
@@ -188,13 +224,16 @@ class KernelFuncs {
       const typename KernelTuple::attr_type& attr) {
     // Maybe here is not good enough, not all kernels should have jitcode
     int64_t key = JitCodeKey<typename KernelTuple::attr_type>(attr);
-    if (Has(key)) {
-      return funcs_.at(key);
+    typename KernelTuple::func_type func;
+    if (funcs_.Find(key, &func)) {
+      return func;
     }
-    // If do not have this attr in cache then get the default best
-    auto func = GetDefaultBestFunc<KernelTuple, PlaceType>(attr);
-    Insert(key, func);
-    return func;
+    // If do not have this attr in cache then get the default best or the
+    // tuned best, the racing threads get the same one.
+    func = Autotuner::Global().enabled()
+               ? GetTunedBestFunc<KernelTuple, PlaceType>(attr)
+               : GetDefaultBestFunc<KernelTuple, PlaceType>(attr);
+    return funcs_.Insert(key, func);
   }
 
   typename KernelTuple::func_type operator[](
@@ -202,14 +241,8 @@ class KernelFuncs {
     return At(attr);
   }
 
- protected:
-  bool Has(int64_t key) const { return funcs_.find(key) != funcs_.end(); }
-  void Insert(int64_t key, typename KernelTuple::func_type func) {
-    funcs_.emplace(key, func);
-  }
-
  private:
-  std::map<int64_t, typename KernelTuple::func_type> funcs_;
+  ReadMostlyMap<int64_t, typename KernelTuple::func_type> funcs_;
 };
 
 const char* to_string(KernelType kt);
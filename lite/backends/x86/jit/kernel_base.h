@@ -25,6 +25,7 @@ typedef enum {
   // sort by alphabet
   kCRFDecoding = 1,
   kEmbSeqPool = 2,
+  kGemm,
   kGRUH1,
   kGRUHtPart1,
   kGRUHtPart2,
@@ -294,6 +295,43 @@ struct MatMulTuple {
   typedef void (*func_type)(const T*, const T*, T*, const matmul_attr_t*);
 };
 
+// c(mr, nr) = act(a(mr, k) * b(k, nr) + bias(nr) + residual(mr, nr)),
+// b is one panel of the weight packed by every nr columns.
+typedef struct {
+  const void* a;
+  const void* packed_b;
+  void* c;
+  const void* bias{nullptr};
+  const void* residual{nullptr};
+  int64_t lda, ldc, ldr;  // leading dimensions in elements
+  int64_t k;
+} gemm_t;
+
+typedef struct gemm_attr_s {
+  int mr, nr;
+  bool with_bias, with_residual;
+  KernelType act;  // kVIdentity or the activation kernels, like kVRelu
+  gemm_attr_s() = default;
+  explicit gemm_attr_s(int _mr,
+                       int _nr,
+                       bool _with_bias = false,
+                       bool _with_residual = false,
+                       KernelType _act = kVIdentity)
+      : mr(_mr),
+        nr(_nr),
+        with_bias(_with_bias),
+        with_residual(_with_residual),
+        act(_act) {}
+} gemm_attr_t;
+
+template <typename T>
+struct GemmTuple {
+  static constexpr KernelType kernel_type = kGemm;
+  typedef T data_type;
+  typedef gemm_attr_t attr_type;
+  typedef void (*func_type)(gemm_t*, const gemm_attr_t*);
+};
+
 template <typename T>
 struct CRFDecodingTuple {
   static constexpr KernelType kernel_type = kCRFDecoding;
@@ -56,6 +56,16 @@ int64_t JitCodeKey<matmul_attr_t>(const matmul_attr_t& attr) {
   return XXH64(&attr, sizeof(int) * 3, 0);  // m, n, k
 }
 
+template <>
+int64_t JitCodeKey<gemm_attr_t>(const gemm_attr_t& attr) {
+  int keys[5] = {attr.mr,
+                 attr.nr,
+                 static_cast<int>(attr.with_bias),
+                 static_cast<int>(attr.with_residual),
+                 static_cast<int>(attr.act)};
+  return XXH64(keys, sizeof(int) * 5, 0);
+}
+
 template <>
 int64_t JitCodeKey<emb_seq_pool_attr_t>(const emb_seq_pool_attr_t& attr) {
   return attr.table_width;
@@ -14,42 +14,155 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
 #include <memory>  // for unique_ptr
+#include <mutex>   // NOLINT
 #include <string>
 #include <unordered_map>
 #include <utility>  // for move
 #include <vector>
+#include "lite/backends/x86/fluid/rw_lock.h"
 #include "lite/backends/x86/jit/gen_base.h"
 #include "lite/backends/x86/jit/kernel_base.h"
 #include "lite/backends/x86/jit/kernel_key.h"
-#include "lite/utils/macros.h"
 
 namespace paddle {
 namespace lite {
 namespace jit {
 
+// A map shared by all the threads, which is read-mostly. The items are
+// spread over a fixed number of shards, each of which is guarded by its own
+// read-write lock, so that the lookups of the different shards never wait
+// for each other and the lookups of the same shard only wait for the rare
+// inserts. The values are never changed once inserted, so the items found by
+// a thread are also kept in a cache of the thread, which is read without any
+// lock, and the locked shards are only read for the misses of it (the
+// RWLock is a plain mutex on Windows).
+template <typename Key, typename Value>
+class ReadMostlyMap {
+  typedef std::unordered_map<Key, Value> Map;
+
+ public:
+  ReadMostlyMap() : id_(NextId()) {}
+
+  bool Find(const Key& key, Value* value) const {
+    auto& cache = LocalCache();
+    auto cached = cache.find(key);
+    if (cached != cache.end()) {
+      *value = cached->second;
+      return true;
+    }
+    auto& shard = GetShard(key);
+    {
+      fluid::AutoRDLock lock(&shard.lock);
+      auto it = shard.map.find(key);
+      if (it == shard.map.end()) return false;
+      *value = it->second;
+    }
+    cache.emplace(key, *value);
+    return true;
+  }
+
+  // Insert `value` if `key` is not found, and return the value in the map.
+  Value Insert(const Key& key, const Value& value) {
+    auto& shard = GetShard(key);
+    fluid::AutoWRLock lock(&shard.lock);
+    return shard.map.emplace(key, value).first->second;
+  }
+
+  size_t size() const {
+    size_t size = 0;
+    for (auto& shard : shards_) {
+      fluid::AutoRDLock lock(&shard.lock);
+      size += shard.map.size();
+    }
+    return size;
+  }
+
+ private:
+  static constexpr size_t kNumShards = 16;
+
+  // The ids tell the maps apart in the caches of the threads, even if a map
+  // is created at the address of a destroyed one.
+  static uint64_t NextId() {
+    static std::atomic<uint64_t> next_id{0};
+    return next_id++;
+  }
+
+  // The items of this map found by the calling thread.
+  Map& LocalCache() const {
+    thread_local std::unordered_map<uint64_t, Map> caches;
+    return caches[id_];
+  }
+
+  struct Shard {
+    mutable fluid::RWLock lock;
+    Map map;
+  };
+
+  const Shard& GetShard(const Key& key) const {
+    // The hash of the integers is the identity in most of the standard
+    // libraries, mix the high bits in since the keys are packed attributes.
+    uint64_t hash = static_cast<uint64_t>(std::hash<Key>()(key));
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return shards_[hash % kNumShards];
+  }
+
+  Shard& GetShard(const Key& key) {
+    return const_cast<Shard&>(
+        static_cast<const ReadMostlyMap*>(this)->GetShard(key));
+  }
+
+  const uint64_t id_;
+  Shard shards_[kNumShards];
+};
+
+// The generated codes of all the attributes of a kernel type, which are
+// shared by all the threads.
 template <KernelType KT>
 class JitCodePool {
   typedef std::unique_ptr<GenBase> GenBasePtr;
-  typedef std::unordered_map<int64_t, GenBasePtr> JitCodeMap;
 
  public:
   JitCodePool() = default;
   static JitCodePool& Instance() {
-    static LITE_THREAD_LOCAL JitCodePool<KT> g_jit_codes;
+    static JitCodePool<KT> g_jit_codes;
     return g_jit_codes;
   }
 
-  const JitCodeMap& AllKernels() { return codes_; }
-
-  bool Has(int64_t key) const { return codes_.find(key) != codes_.end(); }
+  // Return nullptr if the code of `key` isn't generated.
+  const GenBase* Find(int64_t key) const {
+    const GenBase* code = nullptr;
+    codes_.Find(key, &code);
+    return code;
+  }
 
-  void Insert(int64_t key, GenBasePtr value) {
-    codes_.emplace(key, std::move(value));
+  // Generate the code of `key` with `create` if it isn't generated, the code
+  // is generated only once even if many threads ask for it at the same time.
+  template <typename CreateFunc>
+  const GenBase* FindOrCreate(int64_t key, CreateFunc create) {
+    const GenBase* code = Find(key);
+    if (code) return code;
+    std::lock_guard<std::mutex> lock(mutex_);
+    code = Find(key);
+    if (code) return code;
+    GenBasePtr new_code = create();
+    if (!new_code) return nullptr;
+    code = codes_.Insert(key, new_code.get());
+    owned_codes_.emplace_back(std::move(new_code));
+    return code;
   }
 
+  size_t size() const { return codes_.size(); }
+
  private:
-  JitCodeMap codes_;
+  ReadMostlyMap<int64_t, const GenBase*> codes_;
+  std::mutex mutex_;
+  std::vector<GenBasePtr> owned_codes_;
 };
 
 class JitCodeCreatorPool {
@@ -408,6 +408,36 @@ void MatMul(const T* A, const T* B, T* C, const matmul_attr_t* attr) {
   }
 }
 
+// C(mr,nr) = act(A(mr,K) * B(K,nr) + bias + residual), B is packed as K*nr
+template <typename T>
+void Gemm(gemm_t* gemm, const gemm_attr_t* attr) {
+  auto* a = reinterpret_cast<const T*>(gemm->a);
+  auto* b = reinterpret_cast<const T*>(gemm->packed_b);
+  auto* c = reinterpret_cast<T*>(gemm->c);
+  auto* bias = reinterpret_cast<const T*>(gemm->bias);
+  auto* residual = reinterpret_cast<const T*>(gemm->residual);
+  auto act = getActFunc<T>(attr->act);
+  int nr = attr->nr;
+  for (int i = 0; i < attr->mr; ++i) {
+    const T* pa = a + i * gemm->lda;
+    T* pc = c + i * gemm->ldc;
+    for (int j = 0; j < nr; ++j) {
+      T sum = static_cast<T>(0);
+      for (int64_t k = 0; k < gemm->k; ++k) {
+        sum += pa[k] * b[k * nr + j];
+      }
+      if (attr->with_bias) {
+        sum += bias[j];
+      }
+      if (attr->with_residual) {
+        sum += residual[i * gemm->ldr + j];
+      }
+      pc[j] = sum;
+    }
+    act(pc, pc, nr);
+  }
+}
+
 template <typename T>
 void HMax(const T* x, T* res, int n) {
   res[0] = x[0];
@@ -589,6 +619,7 @@ DECLARE_REFER_KERNEL(LayerNorm);
 DECLARE_REFER_KERNEL(NCHW16CMulNC);
 DECLARE_REFER_KERNEL(SeqPool);
 DECLARE_REFER_KERNEL(MatMul);
+DECLARE_REFER_KERNEL(Gemm);
 DECLARE_REFER_KERNEL(Softmax);
 DECLARE_REFER_KERNEL(EmbSeqPool);
 DECLARE_REFER_KERNEL(Sgd);
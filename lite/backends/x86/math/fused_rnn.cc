@@ -0,0 +1,459 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/math/fused_rnn.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include "lite/utils/env.h"
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+bool FusedRnnEnabled() { return GetIntFromEnv("paddle_fused_rnn", 1) != 0; }
+
+namespace {
+
+int NumBlocks(int frame_size) {
+  return (frame_size + kRnnBlock - 1) / kRnnBlock;
+}
+
+// Pack the [frame_size, gates * frame_size] weight into
+// [block][frame_size][gates * kRnnBlock], the columns out of the frame are
+// padded with zeros. weight(k, n) returns the element at the row k and the
+// column n.
+template <typename GetWeight>
+void PackBlocks(int frame_size,
+                int gates,
+                GetWeight weight,
+                std::vector<float>* packed) {
+  int blocks = NumBlocks(frame_size);
+  int width = gates * kRnnBlock;
+  packed->assign(static_cast<size_t>(blocks) * frame_size * width, 0.f);
+  for (int b = 0; b < blocks; b++) {
+    for (int k = 0; k < frame_size; k++) {
+      float* dst = packed->data() +
+                   (static_cast<size_t>(b) * frame_size + k) * width;
+      for (int g = 0; g < gates; g++) {
+        for (int j = 0; j < kRnnBlock; j++) {
+          int col = b * kRnnBlock + j;
+          if (col < frame_size) {
+            dst[g * kRnnBlock + j] = weight(k, g * frame_size + col);
+          }
+        }
+      }
+    }
+  }
+}
+
+// acc[kRows][kWidth] += h[kRows][depth] * w[depth][kWidth], the
+// accumulators stay in the registers. The rows of w and acc have the
+// leading dimension ld.
+template <int kRows, int kWidth>
+void BlockGemm(const float* h,
+               int ldh,
+               const float* w,
+               int ld,
+               int depth,
+               float* acc) {
+#ifdef __AVX__
+  constexpr int kVecs = kWidth / kRnnBlock;
+  __m256 sum[kRows][kVecs];
+  for (int r = 0; r < kRows; r++) {
+    for (int v = 0; v < kVecs; v++) {
+      sum[r][v] = _mm256_loadu_ps(acc + r * ld + v * kRnnBlock);
+    }
+  }
+  for (int k = 0; k < depth; k++) {
+    const float* wk = w + k * ld;
+    __m256 wv[kVecs];
+    for (int v = 0; v < kVecs; v++) {
+      wv[v] = _mm256_loadu_ps(wk + v * kRnnBlock);
+    }
+    for (int r = 0; r < kRows; r++) {
+      __m256 hk = _mm256_broadcast_ss(h + r * ldh + k);
+      for (int v = 0; v < kVecs; v++) {
+#ifdef __FMA__
+        sum[r][v] = _mm256_fmadd_ps(hk, wv[v], sum[r][v]);
+#else
+        sum[r][v] = _mm256_add_ps(sum[r][v], _mm256_mul_ps(hk, wv[v]));
+#endif
+      }
+    }
+  }
+  for (int r = 0; r < kRows; r++) {
+    for (int v = 0; v < kVecs; v++) {
+      _mm256_storeu_ps(acc + r * ld + v * kRnnBlock, sum[r][v]);
+    }
+  }
+#else
+  for (int k = 0; k < depth; k++) {
+    const float* wk = w + k * ld;
+    for (int r = 0; r < kRows; r++) {
+      float hk = h[r * ldh + k];
+      float* acc_r = acc + r * ld;
+      for (int j = 0; j < kWidth; j++) {
+        acc_r[j] += hk * wk[j];
+      }
+    }
+  }
+#endif
+}
+
+// At most 16 columns of the accumulators of a tile fit in the registers, the
+// wider blocks are computed by the slices of 16 columns.
+template <int kWidth>
+void BlockGemm(const float* h,
+               int ldh,
+               int rows,
+               const float* w,
+               int depth,
+               float* acc) {
+  constexpr int kSlice = kWidth < 2 * kRnnBlock ? kWidth : 2 * kRnnBlock;
+  for (int s = 0; s < kWidth; s += kSlice) {
+    switch (rows) {
+      case 1:
+        BlockGemm<1, kSlice>(h, ldh, w + s, kWidth, depth, acc + s);
+        break;
+      case 2:
+        BlockGemm<2, kSlice>(h, ldh, w + s, kWidth, depth, acc + s);
+        break;
+      case 3:
+        BlockGemm<3, kSlice>(h, ldh, w + s, kWidth, depth, acc + s);
+        break;
+      case 4:
+        BlockGemm<4, kSlice>(h, ldh, w + s, kWidth, depth, acc + s);
+        break;
+      default:
+        LOG(FATAL) << "Unsupported rows of the tile: " << rows;
+    }
+  }
+}
+
+// dst = src + bias for the first `cols` elements and zeros for the rest,
+// bias may be nullptr.
+void LoadBlock(const float* src, const float* bias, int cols, float* dst) {
+  for (int j = 0; j < kRnnBlock; j++) {
+    dst[j] = j < cols ? src[j] + (bias ? bias[j] : 0.f) : 0.f;
+  }
+}
+
+// n is a multiple of kRnnBlock.
+void Activate(float* x, int n, detail::ActivationType type) {
+#ifdef __AVX__
+  for (int i = 0; i < n; i += kRnnBlock) {
+    _mm256_storeu_ps(
+        x + i, detail::forward::activation(_mm256_loadu_ps(x + i), type));
+  }
+#else
+  for (int i = 0; i < n; i++) {
+    x[i] = detail::forward::activation(x[i], type);
+  }
+#endif
+}
+
+// The sequences sorted by their lengths in the descending order, so the
+// sequences still running at a step are always the first ones of a tile.
+std::vector<int> SortByLength(const RnnSequences& sequences) {
+  CHECK_EQ(sequences.offset.size(), sequences.length.size());
+  std::vector<int> order(sequences.length.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return sequences.length[a] > sequences.length[b];
+  });
+  return order;
+}
+
+// The rows of the inputs and the outputs of the sorted sequences at `step`,
+// returns the number of the sequences which are still running.
+int StepRows(const RnnSequences& sequences,
+             const std::vector<int>& order,
+             int64_t step,
+             std::vector<int64_t>* rows) {
+  int active = 0;
+  for (int seq : order) {
+    int64_t length = sequences.length[seq];
+    if (length <= step) break;
+    int64_t t = sequences.is_reverse ? length - 1 - step : step;
+    (*rows)[active++] = sequences.offset[seq] + t * sequences.stride;
+  }
+  return active;
+}
+
+}  // namespace
+
+void FusedGRU::Pack(const float* gate_weight,
+                    const float* state_weight,
+                    int frame_size) {
+  CHECK_GT(frame_size, 0);
+  frame_size_ = frame_size;
+  PackBlocks(frame_size,
+             2,
+             [&](int k, int n) { return gate_weight[k * 2 * frame_size + n]; },
+             &gate_weight_);
+  PackBlocks(frame_size,
+             1,
+             [&](int k, int n) { return state_weight[k * frame_size + n]; },
+             &state_weight_);
+}
+
+void FusedGRU::Run(const float* input,
+                   const float* bias,
+                   const float* h0,
+                   const RnnSequences& sequences,
+                   detail::ActivationType active_node,
+                   detail::ActivationType active_gate,
+                   bool origin_mode,
+                   float* hidden) const {
+  CHECK(packed()) << "The weights of FusedGRU are not packed.";
+  const int frame_size = frame_size_;
+  const int blocks = NumBlocks(frame_size);
+  const int padded = blocks * kRnnBlock;
+  auto order = SortByLength(sequences);
+  const int num_seqs = order.size();
+  if (num_seqs == 0) return;
+
+  // The hidden state, the update gate and the reset hidden state of the
+  // sorted sequences.
+  std::vector<float> h(num_seqs * padded, 0.f);
+  std::vector<float> u(num_seqs * padded, 0.f);
+  std::vector<float> rh(num_seqs * padded, 0.f);
+  if (h0) {
+    for (int i = 0; i < num_seqs; i++) {
+      std::memcpy(h.data() + i * padded,
+                  h0 + static_cast<int64_t>(order[i]) * frame_size,
+                  frame_size * sizeof(float));
+    }
+  }
+
+  std::vector<int64_t> rows(num_seqs);
+  const int64_t steps = sequences.length[order[0]];
+  for (int64_t t = 0; t < steps; t++) {
+    const int active = StepRows(sequences, order, t, &rows);
+    const bool zero_state = t == 0 && !h0;
+
+// The update and reset gates.
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int b = 0; b < blocks; b++) {
+      const int col0 = b * kRnnBlock;
+      const int cols = std::min(kRnnBlock, frame_size - col0);
+      const float* weight =
+          gate_weight_.data() + static_cast<size_t>(b) * frame_size * 2 *
+                                    kRnnBlock;
+      float acc[kRnnTileRows * 2 * kRnnBlock];
+      for (int r0 = 0; r0 < active; r0 += kRnnTileRows) {
+        const int tile = std::min(kRnnTileRows, active - r0);
+        for (int r = 0; r < tile; r++) {
+          const float* x = input + rows[r0 + r] * 3 * frame_size;
+          for (int g = 0; g < 2; g++) {
+            int col = g * frame_size + col0;
+            LoadBlock(x + col,
+                      bias ? bias + col : nullptr,
+                      cols,
+                      acc + (r * 2 + g) * kRnnBlock);
+          }
+        }
+        if (!zero_state) {
+          BlockGemm<2 * kRnnBlock>(
+              h.data() + r0 * padded, padded, tile, weight, frame_size, acc);
+        }
+        for (int r = 0; r < tile; r++) {
+          float* acc_r = acc + r * 2 * kRnnBlock;
+          Activate(acc_r, 2 * kRnnBlock, active_gate);
+          int i = (r0 + r) * padded + col0;
+          for (int j = 0; j < kRnnBlock; j++) {
+            u[i + j] = acc_r[j];
+            rh[i + j] = acc_r[kRnnBlock + j] * h[i + j];
+          }
+        }
+      }
+    }
+
+// The candidate and the output. Each block only updates its own columns of
+// the hidden state, which are not read by the others.
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int b = 0; b < blocks; b++) {
+      const int col0 = b * kRnnBlock;
+      const int cols = std::min(kRnnBlock, frame_size - col0);
+      const float* weight =
+          state_weight_.data() + static_cast<size_t>(b) * frame_size *
+                                     kRnnBlock;
+      float acc[kRnnTileRows * kRnnBlock];
+      for (int r0 = 0; r0 < active; r0 += kRnnTileRows) {
+        const int tile = std::min(kRnnTileRows, active - r0);
+        for (int r = 0; r < tile; r++) {
+          int col = 2 * frame_size + col0;
+          LoadBlock(input + rows[r0 + r] * 3 * frame_size + col,
+                    bias ? bias + col : nullptr,
+                    cols,
+                    acc + r * kRnnBlock);
+        }
+        if (!zero_state) {
+          BlockGemm<kRnnBlock>(
+              rh.data() + r0 * padded, padded, tile, weight, frame_size, acc);
+        }
+        for (int r = 0; r < tile; r++) {
+          float* acc_r = acc + r * kRnnBlock;
+          Activate(acc_r, kRnnBlock, active_node);
+          float* out = hidden + rows[r0 + r] * frame_size + col0;
+          int i = (r0 + r) * padded + col0;
+          for (int j = 0; j < cols; j++) {
+            float update = u[i + j];
+            float prev = h[i + j];
+            float cand = acc_r[j];
+            float output = origin_mode
+                               ? update * prev + cand - update * cand
+                               : prev - update * prev + update * cand;
+            h[i + j] = output;
+            out[j] = output;
+          }
+        }
+      }
+    }
+  }
+}
+
+void FusedLSTM::Pack(const float* weight, int frame_size, bool trans) {
+  CHECK_GT(frame_size, 0);
+  frame_size_ = frame_size;
+  PackBlocks(frame_size,
+             4,
+             [&](int k, int n) {
+               return trans ? weight[n * frame_size + k]
+                            : weight[k * 4 * frame_size + n];
+             },
+             &weight_);
+}
+
+void FusedLSTM::Run(const float* input,
+                    const float* bias,
+                    const float* h0,
+                    const float* c0,
+                    const RnnSequences& sequences,
+                    detail::ActivationType active_gate,
+                    detail::ActivationType active_cell,
+                    detail::ActivationType active_cand,
+                    float* hidden,
+                    float* last_h,
+                    float* last_c) const {
+  CHECK(packed()) << "The weights of FusedLSTM are not packed.";
+  const int frame_size = frame_size_;
+  const int blocks = NumBlocks(frame_size);
+  const int padded = blocks * kRnnBlock;
+  auto order = SortByLength(sequences);
+  const int num_seqs = order.size();
+  if (num_seqs == 0) return;
+
+  // The hidden state of the previous step and the current step, and the
+  // cell state of the sorted sequences.
+  std::vector<float> h(num_seqs * padded, 0.f);
+  std::vector<float> h_next(num_seqs * padded, 0.f);
+  std::vector<float> c(num_seqs * padded, 0.f);
+  for (int i = 0; i < num_seqs; i++) {
+    int64_t src = static_cast<int64_t>(order[i]) * frame_size;
+    if (h0) {
+      std::memcpy(h.data() + i * padded, h0 + src, frame_size * sizeof(float));
+    }
+    if (c0) {
+      std::memcpy(c.data() + i * padded, c0 + src, frame_size * sizeof(float));
+    }
+  }
+
+  std::vector<int64_t> rows(num_seqs);
+  const int64_t steps = sequences.length[order[0]];
+  for (int64_t t = 0; t < steps; t++) {
+    const int active = StepRows(sequences, order, t, &rows);
+    const bool zero_state = t == 0 && !h0;
+
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+    for (int b = 0; b < blocks; b++) {
+      const int col0 = b * kRnnBlock;
+      const int cols = std::min(kRnnBlock, frame_size - col0);
+      const float* weight =
+          weight_.data() + static_cast<size_t>(b) * frame_size * 4 * kRnnBlock;
+      float acc[kRnnTileRows * 4 * kRnnBlock];
+      float cell[kRnnBlock];
+      for (int r0 = 0; r0 < active; r0 += kRnnTileRows) {
+        const int tile = std::min(kRnnTileRows, active - r0);
+        for (int r = 0; r < tile; r++) {
+          const float* x = input + rows[r0 + r] * 4 * frame_size;
+          for (int g = 0; g < 4; g++) {
+            int col = g * frame_size + col0;
+            LoadBlock(x + col,
+                      bias ? bias + col : nullptr,
+                      cols,
+                      acc + (r * 4 + g) * kRnnBlock);
+          }
+        }
+        if (!zero_state) {
+          BlockGemm<4 * kRnnBlock>(
+              h.data() + r0 * padded, padded, tile, weight, frame_size, acc);
+        }
+        for (int r = 0; r < tile; r++) {
+          float* gate_i = acc + r * 4 * kRnnBlock;
+          float* gate_f = gate_i + kRnnBlock;
+          float* gate_c = gate_f + kRnnBlock;
+          float* gate_o = gate_c + kRnnBlock;
+          Activate(gate_i, 2 * kRnnBlock, active_gate);
+          Activate(gate_c, kRnnBlock, active_cand);
+          Activate(gate_o, kRnnBlock, active_gate);
+          int i = (r0 + r) * padded + col0;
+          float* c_r = c.data() + i;
+          for (int j = 0; j < kRnnBlock; j++) {
+            c_r[j] = gate_f[j] * c_r[j] + gate_i[j] * gate_c[j];
+            cell[j] = c_r[j];
+          }
+          Activate(cell, kRnnBlock, active_cell);
+          float* h_r = h_next.data() + i;
+          for (int j = 0; j < kRnnBlock; j++) {
+            h_r[j] = gate_o[j] * cell[j];
+          }
+          std::memcpy(hidden + rows[r0 + r] * frame_size + col0,
+                      h_r,
+                      cols * sizeof(float));
+        }
+      }
+    }
+    // The finished sequences keep their last states in `h`.
+    std::memcpy(h.data(), h_next.data(), active * padded * sizeof(float));
+  }
+
+  for (int i = 0; i < num_seqs; i++) {
+    int64_t dst = static_cast<int64_t>(order[i]) * frame_size;
+    if (last_h) {
+      std::memcpy(
+          last_h + dst, h.data() + i * padded, frame_size * sizeof(float));
+    }
+    if (last_c) {
+      std::memcpy(
+          last_c + dst, c.data() + i * padded, frame_size * sizeof(float));
+    }
+  }
+}
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
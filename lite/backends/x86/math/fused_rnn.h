@@ -0,0 +1,122 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "lite/backends/x86/math/activation_functions.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// The sequences run by the fused recurrent engines: the step t of the
+// sequence s is the row `offset[s] + t * stride` of the inputs and the
+// outputs. The LoD sequences have the stride 1, and the padded
+// [time_step, batch] sequences have offset[s] = s and the stride batch.
+struct RnnSequences {
+  std::vector<int64_t> offset;
+  std::vector<int64_t> length;
+  int64_t stride{1};
+  // Run the steps from the last one to the first one.
+  bool is_reverse{false};
+};
+
+/*
+ * The fused recurrent engines pack the recurrent weights once into blocks of
+ * kRnnBlock hidden units, so that all of the gates of a block are computed
+ * together and activated while they are still hot. At each step, every block
+ * of the weights is loaded once and applied to all of the running sequences
+ * by tiles of kRnnTileRows rows. The sequences are sorted by their lengths,
+ * so the running ones are always the first ones and their states stay in one
+ * buffer across the steps, without reordering the inputs and outputs.
+ */
+constexpr int kRnnBlock = 8;
+constexpr int kRnnTileRows = 4;
+
+// Whether the gru and rnn kernels run with the fused engines, which is read
+// from the env var paddle_fused_rnn when the kernels are prepared. It's on
+// by default, and 0 keeps the batch computing.
+bool FusedRnnEnabled();
+
+// The GRU of the gru op.
+class FusedGRU {
+ public:
+  // gate_weight: [frame_size, 2 * frame_size] of the update and reset gates,
+  // state_weight: [frame_size, frame_size] of the candidate.
+  void Pack(const float* gate_weight,
+            const float* state_weight,
+            int frame_size);
+  bool packed() const { return frame_size_ > 0; }
+
+  // input: the projected gates, [rows, 3 * frame_size] in the order of the
+  // update gate, the reset gate and the candidate.
+  // bias: [3 * frame_size] added to the input, nullptr for none.
+  // h0: [num_sequences, frame_size], nullptr for zeros.
+  // hidden: [rows, frame_size].
+  void Run(const float* input,
+           const float* bias,
+           const float* h0,
+           const RnnSequences& sequences,
+           detail::ActivationType active_node,
+           detail::ActivationType active_gate,
+           bool origin_mode,
+           float* hidden) const;
+
+ private:
+  int frame_size_{0};
+  // [block][frame_size][update, reset]
+  std::vector<float> gate_weight_;
+  // [block][frame_size][candidate]
+  std::vector<float> state_weight_;
+};
+
+// The LSTM of the rnn op, without the peepholes and the cell clip.
+class FusedLSTM {
+ public:
+  // weight: [frame_size, 4 * frame_size] of the input, forget, cell and
+  // output gates, or [4 * frame_size, frame_size] if `trans`.
+  void Pack(const float* weight, int frame_size, bool trans);
+  bool packed() const { return frame_size_ > 0; }
+
+  // input: the projected gates, [rows, 4 * frame_size].
+  // bias: [4 * frame_size] added to the input, nullptr for none.
+  // h0, c0: [num_sequences, frame_size], nullptr for zeros.
+  // hidden: [rows, frame_size].
+  // last_h, last_c: [num_sequences, frame_size] of the states after the last
+  // steps, may be nullptr.
+  void Run(const float* input,
+           const float* bias,
+           const float* h0,
+           const float* c0,
+           const RnnSequences& sequences,
+           detail::ActivationType active_gate,
+           detail::ActivationType active_cell,
+           detail::ActivationType active_cand,
+           float* hidden,
+           float* last_h,
+           float* last_c) const;
+
+ private:
+  int frame_size_{0};
+  // [block][frame_size][input, forget, cell, output]
+  std::vector<float> weight_;
+};
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
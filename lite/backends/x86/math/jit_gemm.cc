@@ -0,0 +1,180 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/math/jit_gemm.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include "lite/backends/x86/cpu_info.h"
+#include "lite/backends/x86/jit/helper.h"
+#include "lite/backends/x86/jit/kernels.h"
+#include "lite/backends/x86/jit/macro.h"
+#include "lite/backends/x86/math/packed_weight_cache.h"
+#include "lite/utils/log/cp_logging.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+namespace {
+
+// Keep the same as the register blocking of jit/gen/gemm.cc.
+const int kMaxPanelWidth = 2 * ZMM_FLOAT_BLOCK;
+const int kMaxPanelRows = 8;
+
+int JitGemmPanelRows() { return MayIUse(avx512f) ? 8 : 6; }
+
+}  // namespace
+
+bool JitGemmAvailable() {
+  static const bool available =
+      jit::GetJitCode<jit::GemmTuple<float>, fluid::CPUPlace>(
+          jit::gemm_attr_t(JitGemmPanelRows(), JitGemmPanelWidth())) !=
+      nullptr;
+  return available;
+}
+
+bool JitGemmPreferred(int m) {
+  if (!JitGemmAvailable()) {
+    return false;
+  }
+#ifdef PADDLE_WITH_MKLML
+  return m <= 16;
+#else
+  return true;
+#endif
+}
+
+int JitGemmPanelWidth() {
+  return MayIUse(avx512f) ? 2 * ZMM_FLOAT_BLOCK : 2 * YMM_FLOAT_BLOCK;
+}
+
+int64_t JitGemmPackedSize(int k, int n) {
+  const int nr = JitGemmPanelWidth();
+  return static_cast<int64_t>(k) * ((n + nr - 1) / nr) * nr;
+}
+
+void JitGemmPackWeight(const float* b, int k, int n, int ldb, float* packed) {
+  const int nr = JitGemmPanelWidth();
+  for (int j = 0; j < n; j += nr) {
+    const int cols = std::min(nr, n - j);
+    for (int kk = 0; kk < k; ++kk) {
+      std::memcpy(packed,
+                  b + static_cast<int64_t>(kk) * ldb + j,
+                  sizeof(float) * cols);
+      std::memset(packed + cols, 0, sizeof(float) * (nr - cols));
+      packed += nr;
+    }
+  }
+}
+
+std::shared_ptr<const lite::Tensor> JitGemmPackedWeight(const lite::Tensor& b,
+                                                        int k,
+                                                        int n) {
+  CHECK_EQ(b.numel(), static_cast<int64_t>(k) * n);
+  std::string format = "jit_gemm_k" + std::to_string(k) + "_n" +
+                       std::to_string(n) + "_nr" +
+                       std::to_string(JitGemmPanelWidth());
+  return PackedWeightCache::Global().GetOrPack(
+      b, format, [&](lite::Tensor* packed) {
+        packed->Resize({JitGemmPackedSize(k, n)});
+        JitGemmPackWeight(
+            b.data<float>(), k, n, n, packed->mutable_data<float>());
+      });
+}
+
+void JitGemm(int m,
+             int n,
+             int k,
+             const float* a,
+             int lda,
+             const float* packed_b,
+             float* c,
+             int ldc,
+             const float* bias,
+             const float* residual,
+             int ldr,
+             jit::KernelType act) {
+  CHECK_GT(k, 0);
+  const int nr = JitGemmPanelWidth();
+  const int mr = JitGemmPanelRows();
+  const bool with_bias = bias != nullptr;
+  const bool with_residual = residual != nullptr;
+  const jit::gemm_attr_t full_attr(mr, nr, with_bias, with_residual, act);
+  const jit::gemm_attr_t tail_attr(
+      std::max(m % mr, 1), nr, with_bias, with_residual, act);
+  auto& funcs =
+      jit::KernelFuncs<jit::GemmTuple<float>, fluid::CPUPlace>::Cache();
+  auto full_func = funcs.At(full_attr);
+  auto tail_func = m % mr ? funcs.At(tail_attr) : full_func;
+
+  const int num_panels = (n + nr - 1) / nr;
+#ifdef PADDLE_WITH_MKLML
+#pragma omp parallel for
+#endif
+  for (int p = 0; p < num_panels; ++p) {
+    const int j = p * nr;
+    const int cols = std::min(nr, n - j);
+    // The partial panel is computed in the buffers of the full width.
+    float bias_buf[kMaxPanelWidth];
+    float c_buf[kMaxPanelRows * kMaxPanelWidth];
+    if (cols < nr && with_bias) {
+      std::memset(bias_buf, 0, sizeof(bias_buf));
+      std::memcpy(bias_buf, bias + j, sizeof(float) * cols);
+    }
+    jit::gemm_t gemm;
+    gemm.packed_b = packed_b + static_cast<int64_t>(j) * k;
+    gemm.k = k;
+    gemm.lda = lda;
+    for (int i = 0; i < m; i += mr) {
+      const int rows = std::min(mr, m - i);
+      const auto& attr = rows == mr ? full_attr : tail_attr;
+      auto func = rows == mr ? full_func : tail_func;
+      float* pc = c + static_cast<int64_t>(i) * ldc + j;
+      const float* pr =
+          with_residual ? residual + static_cast<int64_t>(i) * ldr + j
+                        : nullptr;
+      gemm.a = a + static_cast<int64_t>(i) * lda;
+      if (cols == nr) {
+        gemm.c = pc;
+        gemm.ldc = ldc;
+        gemm.bias = with_bias ? bias + j : nullptr;
+        gemm.residual = pr;
+        gemm.ldr = ldr;
+        func(&gemm, &attr);
+        continue;
+      }
+      if (with_residual) {
+        for (int r = 0; r < rows; ++r) {
+          std::memcpy(c_buf + r * nr, pr + r * ldr, sizeof(float) * cols);
+        }
+      }
+      gemm.c = c_buf;
+      gemm.ldc = nr;
+      gemm.bias = with_bias ? bias_buf : nullptr;
+      gemm.residual = c_buf;
+      gemm.ldr = nr;
+      func(&gemm, &attr);
+      for (int r = 0; r < rows; ++r) {
+        std::memcpy(pc + r * ldc, c_buf + r * nr, sizeof(float) * cols);
+      }
+    }
+  }
+}
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
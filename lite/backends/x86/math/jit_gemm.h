@@ -0,0 +1,74 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include "lite/backends/x86/jit/kernel_base.h"
+#include "lite/core/tensor.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// The GEMM built on the jit microkernels of jit::kGemm, it doesn't rely on
+// any BLAS library and saves the library overhead of the small M.
+// The weight is packed into the panels of k x JitGemmPanelWidth() once, and
+// the bias, residual and activation are fused into the microkernels.
+
+// Whether the microkernels can be generated on this machine, otherwise
+// JitGemm falls back to the slow refer kernel.
+bool JitGemmAvailable();
+
+// Whether JitGemm should take the place of the BLAS library for m rows: the
+// microkernels have no library overhead, but MKL does better on the large m.
+bool JitGemmPreferred(int m);
+
+// The number of the columns of a packed panel on this machine.
+int JitGemmPanelWidth();
+
+// The number of the floats of the packed weight b(k, n).
+int64_t JitGemmPackedSize(int k, int n);
+
+// Pack the row-major b(k, n) into the panels, the last panel is padded with
+// zeros. `packed` should have JitGemmPackedSize(k, n) floats.
+void JitGemmPackWeight(const float* b, int k, int n, int ldb, float* packed);
+
+// Get the packed copy of the persistable weight b(k, n) from the
+// PackedWeightCache, it's shared by the kernels using the same weight.
+std::shared_ptr<const lite::Tensor> JitGemmPackedWeight(const lite::Tensor& b,
+                                                        int k,
+                                                        int n);
+
+// c(m, n) = act(a(m, k) * b(k, n) + bias(n) + residual(m, n)), b is packed by
+// JitGemmPackWeight, bias and residual are optional. Only kVIdentity and
+// kVRelu are generated as jit code, the others run the refer kernel.
+void JitGemm(int m,
+             int n,
+             int k,
+             const float* a,
+             int lda,
+             const float* packed_b,
+             float* c,
+             int ldc,
+             const float* bias = nullptr,
+             const float* residual = nullptr,
+             int ldr = 0,
+             jit::KernelType act = jit::kVIdentity);
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
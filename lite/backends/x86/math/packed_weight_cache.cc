@@ -0,0 +1,69 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/backends/x86/math/packed_weight_cache.h"
+#include "lite/utils/log/cp_logging.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+PackedWeightCache& PackedWeightCache::Global() {
+  static PackedWeightCache* x = new PackedWeightCache;
+  return *x;
+}
+
+std::shared_ptr<const lite::Tensor> PackedWeightCache::GetOrPack(
+    const lite::Tensor& weight,
+    const std::string& format,
+    const PackFunc& pack) {
+  CHECK(weight.persistable()) << "Only the persistable weight can be packed";
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& entry = packed_[std::make_pair(weight.raw_data(), format)];
+  auto packed = entry.lock();
+  if (!packed) {
+    packed = std::make_shared<lite::Tensor>();
+    pack(packed.get());
+    entry = packed;
+    VLOG(3) << "Packed the weight " << weight.dims() << " in " << format
+            << ", " << packed->memory_size() << " bytes, "
+            << MemorySizeLocked() << " bytes of the packed weights in total";
+  }
+  return packed;
+}
+
+size_t PackedWeightCache::memory_size() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return MemorySizeLocked();
+}
+
+size_t PackedWeightCache::MemorySizeLocked() {
+  size_t size = 0;
+  for (auto it = packed_.begin(); it != packed_.end();) {
+    auto packed = it->second.lock();
+    if (packed) {
+      size += packed->memory_size();
+      ++it;
+    } else {
+      it = packed_.erase(it);
+    }
+  }
+  return size;
+}
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,69 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include "lite/core/tensor.h"
+
+namespace paddle {
+namespace lite {
+namespace x86 {
+namespace math {
+
+// The packed copies of the persistable GEMM weights, so that the kernels
+// don't repack the raw weights on every run. The copies are keyed by the
+// buffer of the weight and the packed format, hence the kernels of the
+// cloned predictors, which share the weights, share the copies as well.
+// A copy is released along with the last kernel holding it.
+//
+// The content of the weight isn't a part of the key, which would cost a
+// pass over the weight for every kernel. So a weight rewritten in place
+// keeps its stale copy until all the kernels holding it are released.
+class PackedWeightCache {
+ public:
+  using PackFunc = std::function<void(lite::Tensor* packed)>;
+
+  static PackedWeightCache& Global();
+
+  // Get the copy of `weight` packed in `format`, which should also identify
+  // the shape of the packed copy. `pack` is only called at the first time.
+  std::shared_ptr<const lite::Tensor> GetOrPack(const lite::Tensor& weight,
+                                                const std::string& format,
+                                                const PackFunc& pack);
+
+  // The number of the bytes of all the alive packed copies, it's reported by
+  // lite_api::GetPackedWeightMemorySize().
+  size_t memory_size();
+
+ private:
+  PackedWeightCache() = default;
+
+  // Also drop the entries of the released copies, `mutex_` should be held.
+  size_t MemorySizeLocked();
+
+  std::mutex mutex_;
+  std::map<std::pair<const void*, std::string>, std::weak_ptr<lite::Tensor>>
+      packed_;
+};
+
+}  // namespace math
+}  // namespace x86
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,156 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/inter_op_executor.h"
+#include <map>
+#include <set>
+#include "lite/utils/log/cp_logging.h"
+
+namespace paddle {
+namespace lite {
+
+InterOpExecutor::InterOpExecutor(int num_threads,
+                                 std::function<void()> thread_init)
+    : thread_init_(thread_init) {
+  for (int i = 1; i < num_threads; i++) {
+    workers_.emplace_back([this] { WorkLoop(); });
+  }
+}
+
+InterOpExecutor::~InterOpExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  ready_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void InterOpExecutor::Build(
+    const std::vector<std::vector<std::string>>& reads,
+    const std::vector<std::vector<std::string>>& writes,
+    const std::vector<bool>& barriers) {
+  int num_tasks = static_cast<int>(reads.size());
+  CHECK_EQ(writes.size(), reads.size());
+  CHECK_EQ(barriers.size(), reads.size());
+  std::vector<std::set<int>> predecessors(num_tasks);
+  std::map<std::string, int> last_writer;
+  std::map<std::string, std::vector<int>> last_readers;
+  // The tasks after the last barrier.
+  std::vector<int> since_barrier;
+  int last_barrier = -1;
+  for (int i = 0; i < num_tasks; i++) {
+    auto& preds = predecessors[i];
+    if (barriers[i]) {
+      preds.insert(since_barrier.begin(), since_barrier.end());
+      if (last_barrier >= 0) preds.insert(last_barrier);
+      last_barrier = i;
+      since_barrier.clear();
+      last_writer.clear();
+      last_readers.clear();
+      continue;
+    }
+    if (last_barrier >= 0) preds.insert(last_barrier);
+    since_barrier.push_back(i);
+    for (auto& name : reads[i]) {
+      auto it = last_writer.find(name);
+      if (it != last_writer.end()) preds.insert(it->second);
+    }
+    for (auto& name : writes[i]) {
+      auto it = last_writer.find(name);
+      if (it != last_writer.end()) preds.insert(it->second);
+      for (auto reader : last_readers[name]) {
+        preds.insert(reader);
+      }
+    }
+    for (auto& name : reads[i]) {
+      last_readers[name].push_back(i);
+    }
+    for (auto& name : writes[i]) {
+      last_writer[name] = i;
+      last_readers[name].clear();
+    }
+  }
+
+  successors_.assign(num_tasks, {});
+  num_predecessors_.assign(num_tasks, 0);
+  for (int i = 0; i < num_tasks; i++) {
+    predecessors[i].erase(i);
+    num_predecessors_[i] = static_cast<int>(predecessors[i].size());
+    for (auto pred : predecessors[i]) {
+      successors_[pred].push_back(i);
+    }
+  }
+}
+
+void InterOpExecutor::Run(const std::function<void(int)>& task) {
+  int num_tasks = static_cast<int>(successors_.size());
+  if (num_tasks == 0) return;
+  std::unique_lock<std::mutex> lock(mutex_);
+  task_ = &task;
+  pending_ = num_predecessors_;
+  ready_.clear();
+  // The ready tasks are run in the LIFO order, push them reversely so that
+  // the tasks in the front are run first.
+  for (int i = num_tasks - 1; i >= 0; i--) {
+    if (pending_[i] == 0) ready_.push_back(i);
+  }
+  remaining_ = num_tasks;
+  ready_cv_.notify_all();
+  Drain(&lock, true);
+  task_ = nullptr;
+}
+
+void InterOpExecutor::WorkLoop() {
+  if (thread_init_) thread_init_();
+  std::unique_lock<std::mutex> lock(mutex_);
+  Drain(&lock, false);
+}
+
+void InterOpExecutor::Drain(std::unique_lock<std::mutex>* lock,
+                            bool is_caller) {
+  while (true) {
+    ready_cv_.wait(*lock, [&] {
+      return !ready_.empty() || (is_caller ? remaining_ == 0 : stop_);
+    });
+    if (ready_.empty()) return;
+    int i = ready_.back();
+    ready_.pop_back();
+    lock->unlock();
+    (*task_)(i);
+    lock->lock();
+    int num_ready = 0;
+    for (auto it = successors_[i].rbegin(); it != successors_[i].rend();
+         ++it) {
+      if (--pending_[*it] == 0) {
+        ready_.push_back(*it);
+        num_ready++;
+      }
+    }
+    // Keep one of the new ready tasks for the current thread, and wake up
+    // the others for the rest.
+    for (int j = 1; j < num_ready; j++) {
+      ready_cv_.notify_one();
+    }
+    if (--remaining_ == 0) {
+      // Wake up the caller.
+      ready_cv_.notify_all();
+    }
+  }
+}
+
+}  // namespace lite
+}  // namespace paddle
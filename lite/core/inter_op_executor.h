@@ -0,0 +1,82 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace lite {
+
+/*
+ * Run the independent tasks, e.g. the instructions of a program,
+ * concurrently.
+ *
+ * The dependencies are built from the variables read and written by the
+ * tasks: a task waits for the last writers of its inputs (read after
+ * write), and for the last writer and readers of its outputs (write after
+ * write and write after read), so the variables reused by the memory
+ * optimization are safe. A barrier task waits for all the previous tasks
+ * and blocks all the following ones.
+ *
+ * The calling thread runs the tasks too, so `num_threads - 1` workers are
+ * created. `thread_init` is called once in each worker, e.g. to set the
+ * number of threads for the intra-op parallelism.
+ */
+class InterOpExecutor {
+ public:
+  explicit InterOpExecutor(int num_threads,
+                           std::function<void()> thread_init = nullptr);
+  ~InterOpExecutor();
+
+  void Build(const std::vector<std::vector<std::string>>& reads,
+             const std::vector<std::vector<std::string>>& writes,
+             const std::vector<bool>& barriers);
+
+  // Run `task` for each task index and return after all of them are done.
+  void Run(const std::function<void(int)>& task);
+
+  int num_threads() const { return static_cast<int>(workers_.size()) + 1; }
+  const std::vector<std::vector<int>>& successors() const {
+    return successors_;
+  }
+
+ private:
+  void WorkLoop();
+  // Run the ready tasks, the caller returns after all of the tasks are
+  // done, and the workers return after `stop_` is set.
+  void Drain(std::unique_lock<std::mutex>* lock, bool is_caller);
+
+  std::vector<std::vector<int>> successors_;
+  std::vector<int> num_predecessors_;
+
+  std::vector<std::thread> workers_;
+  std::function<void()> thread_init_;
+  std::mutex mutex_;
+  std::condition_variable ready_cv_;
+  // The states of the current run, guarded by `mutex_`.
+  const std::function<void(int)>* task_{nullptr};
+  std::vector<int> pending_;
+  std::vector<int> ready_;
+  int remaining_{0};
+  bool stop_{false};
+};
+
+}  // namespace lite
+}  // namespace paddle
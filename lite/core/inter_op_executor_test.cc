@@ -0,0 +1,95 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "lite/core/inter_op_executor.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace paddle {
+namespace lite {
+
+TEST(InterOpExecutor, Dependencies) {
+  // 0: a = f()      1: b = g(a)     2: c = h(a)
+  // 3: a = k()      4: d = m(b, c)
+  std::vector<std::vector<std::string>> reads{{}, {"a"}, {"a"}, {}, {"b", "c"}};
+  std::vector<std::vector<std::string>> writes{
+      {"a"}, {"b"}, {"c"}, {"a"}, {"d"}};
+  InterOpExecutor executor(4);
+  executor.Build(reads, writes, std::vector<bool>(5, false));
+  auto& successors = executor.successors();
+  ASSERT_EQ(successors.size(), 5UL);
+  // Read after write.
+  EXPECT_EQ(successors[0], std::vector<int>({1, 2, 3}));
+  // Write after read.
+  EXPECT_EQ(successors[1], std::vector<int>({3, 4}));
+  EXPECT_EQ(successors[2], std::vector<int>({3, 4}));
+  EXPECT_TRUE(successors[3].empty());
+  EXPECT_TRUE(successors[4].empty());
+}
+
+TEST(InterOpExecutor, Barrier) {
+  std::vector<std::vector<std::string>> reads{{}, {}, {}, {}};
+  std::vector<std::vector<std::string>> writes{{"a"}, {"b"}, {}, {"c"}};
+  InterOpExecutor executor(2);
+  executor.Build(reads, writes, {false, false, true, false});
+  auto& successors = executor.successors();
+  EXPECT_EQ(successors[0], std::vector<int>({2}));
+  EXPECT_EQ(successors[1], std::vector<int>({2}));
+  EXPECT_EQ(successors[2], std::vector<int>({3}));
+}
+
+TEST(InterOpExecutor, Run) {
+  // `kNumChains` independent chains, each of which has `kLength` tasks.
+  const int kNumChains = 8;
+  const int kLength = 16;
+  std::vector<std::vector<std::string>> reads;
+  std::vector<std::vector<std::string>> writes;
+  for (int i = 0; i < kNumChains * kLength; i++) {
+    auto name = "x" + std::to_string(i % kNumChains);
+    reads.push_back({name});
+    writes.push_back({name});
+  }
+  InterOpExecutor executor(4);
+  executor.Build(reads, writes, std::vector<bool>(reads.size(), false));
+  EXPECT_EQ(executor.num_threads(), 4);
+
+  for (int iter = 0; iter < 10; iter++) {
+    std::vector<int> steps(kNumChains, 0);
+    std::vector<int> runs(reads.size(), 0);
+    std::atomic<int> running(0);
+    std::atomic<int> max_running(0);
+    executor.Run([&](int i) {
+      int cur = ++running;
+      int prev = max_running.load();
+      while (prev < cur && !max_running.compare_exchange_weak(prev, cur)) {
+      }
+      // The tasks of a chain are run in order.
+      EXPECT_EQ(steps[i % kNumChains], i / kNumChains);
+      steps[i % kNumChains]++;
+      runs[i]++;
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      --running;
+    });
+    for (auto step : steps) EXPECT_EQ(step, kLength);
+    for (auto run : runs) EXPECT_EQ(run, 1);
+    EXPECT_GT(max_running.load(), 1);
+    EXPECT_LE(max_running.load(), 4);
+  }
+}
+
+}  // namespace lite
+}  // namespace paddle
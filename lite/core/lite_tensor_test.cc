@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <cstring>
 #include "lite/core/tensor.h"
 
@@ -53,5 +54,30 @@ TEST(tensor, shared_memory) {
   test_shared_memory_tensor<int8_t, TargetType::kHost>();
 }
 
+TEST(tensor, copy_data_from_shared) {
+  TensorLite src;
+  src.Resize({2, 3});
+  auto* src_data = src.mutable_data<float>();
+  for (int i = 0; i < 6; i++) src_data[i] = i;
+
+  // The copy into a tensor sharing the buffer, or into a view of it, leaves
+  // the other tensors as they are.
+  TensorLite owner;
+  owner.Resize({4, 3});
+  auto* owner_data = owner.mutable_data<float>();
+  std::fill(owner_data, owner_data + 12, -1.f);
+  TensorLite shared;
+  shared.ShareDataWith(owner);
+  shared.CopyDataFrom(src);
+  TensorLite view = owner.Slice<float>(2, 4);
+  view.CopyDataFrom(src);
+  for (int i = 0; i < 12; i++) EXPECT_EQ(owner.data<float>()[i], -1.f);
+  for (auto* tensor : {&shared, &view}) {
+    ASSERT_EQ(tensor->dims(), src.dims());
+    EXPECT_NE(tensor->raw_data(), src.raw_data());
+    for (int i = 0; i < 6; i++) EXPECT_EQ(tensor->data<float>()[i], i);
+  }
+}
+
 }  // namespace lite
 }  // namespace paddle
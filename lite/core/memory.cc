@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "lite/core/memory.h"
+#include "lite/core/memory_pool.h"
 
 #ifdef LITE_WITH_METAL
 #include "lite/backends/metal/target_wrapper.h"
@@ -32,7 +33,10 @@ void* TargetMalloc(TargetType target, size_t size) {
       case TargetType::kHost:
       case TargetType::kX86:
       case TargetType::kARM:
-        data = TargetWrapper<TARGET(kHost)>::Malloc(size);
+        data = HostMemoryPool::Global().Malloc(size);
+        if (!data) {
+          data = TargetWrapper<TARGET(kHost)>::Malloc(size);
+        }
         break;
 #ifdef LITE_WITH_OPENCL
       case TargetType::kOpenCL:
@@ -65,7 +69,9 @@ void TargetFree(TargetType target, void* data, std::string free_flag) {
       case TargetType::kHost:
       case TargetType::kX86:
       case TargetType::kARM:
-        TargetWrapper<TARGET(kHost)>::Free(data);
+        if (!HostMemoryPool::Global().Free(data)) {
+          TargetWrapper<TARGET(kHost)>::Free(data);
+        }
         break;
 
 #ifdef LITE_WITH_OPENCL
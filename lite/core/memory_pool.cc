@@ -0,0 +1,127 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/memory_pool.h"
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include "lite/core/target_wrapper.h"
+
+namespace paddle {
+namespace lite {
+
+size_t HostMemoryPool::SizeClass(size_t size) {
+  // Every power-of-two range is divided into 4 to 8 classes, so at most 25%
+  // of a block is wasted.
+  size_t step = host::MALLOC_ALIGN;
+  while ((step << 3) < size) {
+    step <<= 1;
+  }
+  return (size + step - 1) / step * step;
+}
+
+void HostMemoryPool::Enable(const MemoryPoolConfig& config) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    enabled_ = true;
+  }
+  Trim(config.max_cached_bytes);
+}
+
+void HostMemoryPool::Disable() {
+  enabled_ = false;
+  Trim(0);
+}
+
+void* HostMemoryPool::Malloc(size_t size) {
+  if (!enabled_ || size == 0) return nullptr;
+  size_t size_class = SizeClass(size);
+  void* ptr = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cached_blocks_.find(size_class);
+    if (it != cached_blocks_.end()) {
+      ptr = it->second;
+      cached_blocks_.erase(it);
+      stats_.cached_bytes -= size_class;
+      stats_.num_cache_hits++;
+    }
+  }
+  if (!ptr) {
+    ptr = TargetWrapper<TARGET(kHost)>::Malloc(size_class);
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  live_blocks_[ptr] = size_class;
+  num_live_blocks_ = live_blocks_.size();
+  stats_.num_allocs++;
+  stats_.live_bytes += size_class;
+  stats_.peak_live_bytes =
+      (std::max)(stats_.peak_live_bytes, stats_.live_bytes);
+  return ptr;
+}
+
+bool HostMemoryPool::Free(void* ptr) {
+  if (num_live_blocks_ == 0) return false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = live_blocks_.find(ptr);
+    if (it == live_blocks_.end()) return false;
+    size_t size_class = it->second;
+    live_blocks_.erase(it);
+    num_live_blocks_ = live_blocks_.size();
+    stats_.live_bytes -= size_class;
+    if (enabled_ &&
+        stats_.cached_bytes + size_class <= config_.max_cached_bytes) {
+      cached_blocks_.emplace(size_class, ptr);
+      stats_.cached_bytes += size_class;
+      return true;
+    }
+  }
+  TargetWrapper<TARGET(kHost)>::Free(ptr);
+  return true;
+}
+
+void HostMemoryPool::Trim(size_t budget_bytes) {
+  std::vector<void*> released;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (stats_.cached_bytes > budget_bytes && !cached_blocks_.empty()) {
+      auto it = std::prev(cached_blocks_.end());
+      stats_.cached_bytes -= it->first;
+      released.push_back(it->second);
+      cached_blocks_.erase(it);
+    }
+  }
+  for (auto* ptr : released) {
+    TargetWrapper<TARGET(kHost)>::Free(ptr);
+  }
+}
+
+void HostMemoryPool::Shrink() {
+  size_t budget_bytes = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_bytes = config_.shrink_retained_bytes;
+  }
+  Trim(budget_bytes);
+}
+
+MemoryPoolStats HostMemoryPool::stats() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+}  // namespace lite
+}  // namespace paddle
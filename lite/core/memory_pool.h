@@ -0,0 +1,75 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <atomic>
+#include <map>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include "lite/api/paddle_place.h"
+
+namespace paddle {
+namespace lite {
+
+using lite_api::MemoryPoolConfig;
+using lite_api::MemoryPoolStats;
+
+// A size-class caching pool behind `TargetMalloc` of the host targets. The
+// requested sizes are rounded up to the size classes, and the freed blocks
+// are cached by class for the following allocations, up to
+// `max_cached_bytes`. It's disabled by default.
+class HostMemoryPool {
+ public:
+  static HostMemoryPool& Global() {
+    static auto* pool = new HostMemoryPool;
+    return *pool;
+  }
+
+  void Enable(const MemoryPoolConfig& config);
+  // Stop caching and release all the cached blocks, the live blocks are
+  // still returned to the pool when they are freed.
+  void Disable();
+  bool enabled() const { return enabled_; }
+
+  // Return nullptr if the pool is disabled.
+  void* Malloc(size_t size);
+  // Return false if `ptr` is not allocated by the pool.
+  bool Free(void* ptr);
+
+  // Release the cached blocks, the largest first, until at most
+  // `budget_bytes` are cached.
+  void Trim(size_t budget_bytes);
+  // Trim to `shrink_retained_bytes`, called by `TryShrinkMemory`.
+  void Shrink();
+
+  MemoryPoolStats stats();
+
+  static size_t SizeClass(size_t size);
+
+ private:
+  HostMemoryPool() = default;
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<size_t> num_live_blocks_{0};
+  std::mutex mutex_;
+  MemoryPoolConfig config_;
+  // The size class of each block in use.
+  std::unordered_map<void*, size_t> live_blocks_;
+  // The free blocks ordered by size class.
+  std::multimap<size_t, void*> cached_blocks_;
+  MemoryPoolStats stats_;
+};
+
+}  // namespace lite
+}  // namespace paddle
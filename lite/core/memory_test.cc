@@ -14,6 +14,7 @@
 
 #include "lite/core/memory.h"
 #include <gtest/gtest.h>
+#include "lite/core/memory_pool.h"
 
 namespace paddle {
 namespace lite {
@@ -30,5 +31,48 @@ TEST(memory, test) {
 #endif
 }
 
+TEST(memory, host_memory_pool) {
+  auto& pool = HostMemoryPool::Global();
+  MemoryPoolConfig config;
+  config.max_cached_bytes = 1 << 20;
+  pool.Enable(config);
+
+  size_t size = 1000;
+  size_t size_class = HostMemoryPool::SizeClass(size);
+  ASSERT_GE(size_class, size);
+  ASSERT_LE(size_class, size + size / 4);
+
+  auto* buf = TargetMalloc(TARGET(kX86), size);
+  ASSERT_TRUE(buf);
+  EXPECT_EQ(pool.stats().live_bytes, size_class);
+  TargetFree(TARGET(kX86), buf);
+  EXPECT_EQ(pool.stats().live_bytes, 0u);
+  EXPECT_EQ(pool.stats().cached_bytes, size_class);
+
+  // The cached block is reused by the allocation of the same size class.
+  auto hits = pool.stats().num_cache_hits;
+  auto* reused = TargetMalloc(TARGET(kHost), size - 10);
+  EXPECT_EQ(reused, buf);
+  EXPECT_EQ(pool.stats().num_cache_hits, hits + 1);
+  EXPECT_EQ(pool.stats().cached_bytes, 0u);
+  TargetFree(TARGET(kHost), reused);
+
+  // The blocks beyond `max_cached_bytes` are not cached.
+  auto* large = TargetMalloc(TARGET(kX86), 2 << 20);
+  TargetFree(TARGET(kX86), large);
+  EXPECT_EQ(pool.stats().cached_bytes, size_class);
+  EXPECT_GE(pool.stats().peak_live_bytes, static_cast<size_t>(2 << 20));
+
+  pool.Trim(0);
+  EXPECT_EQ(pool.stats().cached_bytes, 0u);
+
+  // The blocks allocated before disabling are still freed by the pool.
+  buf = TargetMalloc(TARGET(kX86), size);
+  pool.Disable();
+  TargetFree(TARGET(kX86), buf);
+  EXPECT_EQ(pool.stats().live_bytes, 0u);
+  EXPECT_EQ(pool.stats().cached_bytes, 0u);
+}
+
 }  // namespace lite
 }  // namespace paddle
@@ -0,0 +1,236 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/elimination/common_subexpression_elimination_pass.h"
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+#include "lite/core/optimizer/mir/pattern_matcher.h"
+#include "lite/core/optimizer/mir/ssa_graph_utils.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+// The ops which have side effects, random outputs or sub-blocks.
+const std::set<std::string> kIneliminableOps({"feed",
+                                              "fetch",
+                                              "while",
+                                              "conditional_block",
+                                              "increment",
+                                              "print",
+                                              "write_to_array",
+                                              "dropout",
+                                              "uniform_random",
+                                              "gaussian_random",
+                                              "randint",
+                                              "sampling_id",
+                                              "subgraph"});
+
+// The attributes which have no effect on the computation.
+const std::set<std::string> kIgnoredAttrs({"op_callstack",
+                                           "op_namescope",
+                                           "op_role",
+                                           "op_role_var",
+                                           "op_device",
+                                           "with_quant_attr"});
+
+}  // namespace
+
+void CommonSubexpressionEliminationPass::Apply(
+    const std::unique_ptr<SSAGraph>& graph) {
+  auto extra_produced = ExtraProducedVars(graph.get());
+  // The kept ops of each input key.
+  std::map<InputKey, std::vector<Node*>> candidates;
+  int num_removed = 0;
+  for (auto* node : graph->StmtTopologicalOrder()) {
+    if (!node->IsStmt() || !IsEliminable(*node, extra_produced)) continue;
+    auto& kept_nodes = candidates[GetInputKey(*node)];
+    Node* to_keep = nullptr;
+    for (auto* kept_node : kept_nodes) {
+      if (AttrsIdentical(*kept_node, *node) &&
+          OutputsMatched(*kept_node, *node)) {
+        to_keep = kept_node;
+        break;
+      }
+    }
+    if (to_keep == nullptr) {
+      kept_nodes.push_back(node);
+      continue;
+    }
+    VLOG(4) << "Remove the duplicated " << node->AsStmt().op_type();
+    Eliminate(graph.get(), to_keep, node);
+    num_removed++;
+  }
+  if (num_removed > 0) {
+    LOG(INFO) << "common subexpression elimination: removed " << num_removed
+              << " ops";
+  }
+}
+
+CommonSubexpressionEliminationPass::InputKey
+CommonSubexpressionEliminationPass::GetInputKey(const Node& node) {
+  const auto* op_info = node.stmt()->op_info();
+  // The var nodes rather than the var names are compared, since a var written
+  // more than once has a node for each version.
+  std::map<std::string, const Node*> input_nodes;
+  for (auto* in : node.inlinks) {
+    input_nodes[in->arg()->name] = in;
+  }
+  auto argnames = op_info->input_argnames();
+  std::sort(argnames.begin(), argnames.end());
+  InputKey key;
+  key.first = op_info->Type();
+  for (auto& argname : argnames) {
+    key.first += ";" + argname;
+    for (auto& name : op_info->Input(argname)) {
+      auto it = input_nodes.find(name);
+      key.second.push_back(it == input_nodes.end() ? nullptr : it->second);
+    }
+    key.second.push_back(nullptr);
+  }
+  return key;
+}
+
+bool CommonSubexpressionEliminationPass::AttrsIdentical(const Node& node0,
+                                                        const Node& node1) {
+  using AttrType = cpp::OpDesc::AttrType;
+  const auto* op_info0 = node0.stmt()->op_info();
+  const auto* op_info1 = node1.stmt()->op_info();
+  std::map<std::string, AttrType> attr_types0;
+  std::map<std::string, AttrType> attr_types1;
+  for (auto& pair : op_info0->attr_types()) {
+    if (!kIgnoredAttrs.count(pair.first)) attr_types0.insert(pair);
+  }
+  for (auto& pair : op_info1->attr_types()) {
+    if (!kIgnoredAttrs.count(pair.first)) attr_types1.insert(pair);
+  }
+  if (attr_types0 != attr_types1) return false;
+  for (auto& pair : attr_types0) {
+    const std::string& attr_name = pair.first;
+    switch (pair.second) {
+#define ATTR_COMPARE(attr_type, cpp_type)         \
+  case AttrType::attr_type:                       \
+    if (op_info0->GetAttr<cpp_type>(attr_name) != \
+        op_info1->GetAttr<cpp_type>(attr_name))   \
+      return false;                               \
+    break
+
+      ATTR_COMPARE(INT, int32_t);
+      ATTR_COMPARE(FLOAT, float);
+      ATTR_COMPARE(STRING, std::string);
+      ATTR_COMPARE(INTS, std::vector<int32_t>);
+      ATTR_COMPARE(FLOATS, std::vector<float>);
+      ATTR_COMPARE(STRINGS, std::vector<std::string>);
+      ATTR_COMPARE(BOOLEAN, bool);
+      ATTR_COMPARE(LONG, int64_t);
+      ATTR_COMPARE(LONGS, std::vector<int64_t>);
+#undef ATTR_COMPARE
+
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+bool CommonSubexpressionEliminationPass::OutputsMatched(const Node& node0,
+                                                        const Node& node1) {
+  const auto* op_info0 = node0.stmt()->op_info();
+  const auto* op_info1 = node1.stmt()->op_info();
+  auto argnames0 = op_info0->output_argnames();
+  auto argnames1 = op_info1->output_argnames();
+  std::sort(argnames0.begin(), argnames0.end());
+  std::sort(argnames1.begin(), argnames1.end());
+  if (argnames0 != argnames1) return false;
+  for (auto& argname : argnames0) {
+    if (op_info0->Output(argname).size() != op_info1->Output(argname).size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CommonSubexpressionEliminationPass::IsEliminable(
+    const Node& node, const std::set<std::string>& extra_produced) {
+  const auto* op_info = node.stmt()->op_info();
+  auto op_type = op_info->Type();
+  if (kIneliminableOps.count(op_type) || op_info->HasAttr("sub_block") ||
+      node.outlinks.empty()) {
+    return false;
+  }
+  std::set<std::string> input_names;
+  for (auto* in : node.inlinks) {
+    input_names.insert(in->arg()->name);
+  }
+  for (auto* out : node.outlinks) {
+    const auto& name = out->arg()->name;
+    // The in-place ops, the persistable outputs and the model outputs are
+    // kept.
+    if (input_names.count(name) || out->arg()->is_weight ||
+        out->arg()->is_persist) {
+      return false;
+    }
+    for (auto* consumer : out->outlinks) {
+      if (consumer->AsStmt().op_type() == "fetch") return false;
+    }
+    if (extra_produced.count(name)) return false;
+  }
+  return true;
+}
+
+void CommonSubexpressionEliminationPass::Eliminate(SSAGraph* graph,
+                                                   Node* to_keep,
+                                                   Node* to_remove) {
+  std::map<std::string, Node*> keep_nodes;
+  for (auto* out : to_keep->outlinks) {
+    keep_nodes[out->arg()->name] = out;
+  }
+  std::map<std::string, Node*> remove_nodes;
+  for (auto* out : to_remove->outlinks) {
+    remove_nodes[out->arg()->name] = out;
+  }
+  const auto* keep_info = to_keep->stmt()->op_info();
+  const auto* remove_info = to_remove->stmt()->op_info();
+  std::set<const Node*> nodes2rm{to_remove};
+  for (auto& argname : keep_info->output_argnames()) {
+    auto keep_names = keep_info->Output(argname);
+    auto remove_names = remove_info->Output(argname);
+    for (size_t i = 0; i < keep_names.size(); i++) {
+      auto* keep_node = keep_nodes[keep_names[i]];
+      auto* remove_node = remove_nodes[remove_names[i]];
+      CHECK(keep_node && remove_node);
+      nodes2rm.insert(remove_node);
+      for (auto* consumer : remove_node->outlinks) {
+        auto op_desc = *consumer->stmt()->op_info();
+        op_desc.UpdateAllInputs(remove_names[i], keep_names[i]);
+        consumer->stmt()->ResetOp(op_desc, graph->valid_places());
+        DirectedLink(keep_node, consumer);
+      }
+    }
+  }
+  GraphSafeRemoveNodes(graph, nodes2rm);
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(common_subexpression_elimination_pass,
+                  paddle::lite::mir::CommonSubexpressionEliminationPass)
+    .BindTargets({TARGET(kAny)})
+    .ExcludeTargets({TARGET(kXPU), TARGET(kNNAdapter)});
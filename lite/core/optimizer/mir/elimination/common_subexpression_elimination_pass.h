@@ -0,0 +1,56 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "lite/core/optimizer/mir/pass.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+/*
+ * Remove the ops which compute the same outputs as a previous op, that is,
+ * they have the same op type, attributes and input vars. The consumers of
+ * the removed outputs are relinked to the outputs of the kept op. The
+ * removed ops are visited along the topological order, so the duplicated
+ * chains like `shape`->`slice`->`concat` are removed as a whole.
+ */
+class CommonSubexpressionEliminationPass : public mir::StmtPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override;
+
+ private:
+  // The op type with the input argument names, and the input var nodes in
+  // the order of the arguments.
+  using InputKey = std::pair<std::string, std::vector<const Node*>>;
+
+  InputKey GetInputKey(const Node& node);
+  bool AttrsIdentical(const Node& node0, const Node& node1);
+  bool OutputsMatched(const Node& node0, const Node& node1);
+  // `extra_produced` holds the vars written by the control flow ops.
+  bool IsEliminable(const Node& node,
+                    const std::set<std::string>& extra_produced);
+  void Eliminate(SSAGraph* graph, Node* to_keep, Node* to_remove);
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
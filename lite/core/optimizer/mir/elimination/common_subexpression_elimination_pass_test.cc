@@ -0,0 +1,122 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/pass_tester.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+const std::vector<Place> kPlaces{Place{TARGET(kX86), PRECISION(kFloat)},
+                                 Place{TARGET(kHost), PRECISION(kAny)}};
+
+void AddScale(PassTester* tester,
+              const std::string& x,
+              const std::string& out,
+              float scale) {
+  auto* op_desc = tester->AddOp("scale", {{"X", {x}}}, {{"Out", {out}}});
+  op_desc->SetAttr<float>("scale", scale);
+  op_desc->SetAttr<float>("bias", 0.5f);
+  op_desc->SetAttr<bool>("bias_after_scale", true);
+}
+
+void AddAdd(PassTester* tester,
+            const std::string& x,
+            const std::string& y,
+            const std::string& out) {
+  auto* op_desc = tester->AddOp(
+      "elementwise_add", {{"X", {x}}, {"Y", {y}}}, {{"Out", {out}}});
+  op_desc->SetAttr<int>("axis", -1);
+}
+
+void FillInput(PassTester* tester) {
+  auto* x = tester->GetTensor("x");
+  x->Resize({2, 4});
+  auto* x_data = x->mutable_data<float>();
+  for (int i = 0; i < 8; i++) {
+    x_data[i] = 0.25f * i - 1.f;
+  }
+}
+
+// out = (s0 + s1) + (t0 + t1) + s2, where s1 duplicates s0, and the chain
+// t1 duplicates t0 once s1 is replaced by s0. s2 has another scale.
+void BuildDuplicatedChains(PassTester* tester) {
+  AddScale(tester, "x", "s0", 2.f);
+  AddScale(tester, "x", "s1", 2.f);
+  AddScale(tester, "x", "s2", 3.f);
+  AddScale(tester, "s0", "t0", 4.f);
+  AddScale(tester, "s1", "t1", 4.f);
+  AddAdd(tester, "s0", "s1", "a0");
+  AddAdd(tester, "t0", "t1", "a1");
+  AddAdd(tester, "a0", "a1", "a2");
+  AddAdd(tester, "a2", "s2", "out");
+  tester->Build();
+  FillInput(tester);
+}
+
+TEST(CommonSubexpressionEliminationPass, remove_duplicated_chains) {
+  PassTester origin(kPlaces);
+  BuildDuplicatedChains(&origin);
+  origin.Run();
+
+  PassTester eliminated(kPlaces);
+  BuildDuplicatedChains(&eliminated);
+  eliminated.Apply("common_subexpression_elimination_pass");
+  EXPECT_EQ(eliminated.CountStmts("scale"), 3);
+  EXPECT_EQ(eliminated.CountStmts("elementwise_add"), 4);
+  // The consumers of the removed outputs are linked to the kept ones.
+  for (auto& node : eliminated.graph()->nodes()) {
+    if (!node.IsStmt()) continue;
+    for (auto* in : node.inlinks) {
+      EXPECT_NE(in->arg()->name, "s1");
+      EXPECT_NE(in->arg()->name, "t1");
+    }
+  }
+  eliminated.Run();
+
+  auto* expected = origin.GetTensor("out");
+  auto* out = eliminated.GetTensor("out");
+  ASSERT_EQ(out->dims(), expected->dims());
+  for (int64_t i = 0; i < out->numel(); i++) {
+    EXPECT_NEAR(out->data<float>()[i], expected->data<float>()[i], 1e-6);
+  }
+}
+
+TEST(CommonSubexpressionEliminationPass, keep_fetched_outputs) {
+  PassTester tester(kPlaces);
+  AddScale(&tester, "x", "s0", 2.f);
+  AddScale(&tester, "x", "s1", 2.f);
+  AddAdd(&tester, "s0", "x", "out");
+  tester.AddOp("fetch", {{"X", {"s1"}}}, {{"Out", {"fetch"}}})
+      ->SetAttr<int>("col", 0);
+  tester.Build();
+  tester.Apply("common_subexpression_elimination_pass");
+  EXPECT_EQ(tester.CountStmts("scale"), 2);
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(elementwise_add);
+USE_LITE_OP(scale);
+USE_LITE_OP(fetch);
+USE_LITE_KERNEL(elementwise_add, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(scale, kX86, kFloat, kNCHW, def);
+USE_MIR_PASS(common_subexpression_elimination_pass);
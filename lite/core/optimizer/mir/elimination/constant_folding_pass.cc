@@ -0,0 +1,245 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/elimination/constant_folding_pass.h"
+#include <set>
+#include <string>
+#include <utility>
+#include "lite/core/context.h"
+#include "lite/core/optimizer/mir/pattern_matcher.h"
+#include "lite/core/optimizer/mir/ssa_graph_utils.h"
+#include "lite/utils/timer.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+// The ops which have side effects, random outputs or sub-blocks.
+const std::set<std::string> kUnfoldableOps({"feed",
+                                            "fetch",
+                                            "while",
+                                            "conditional_block",
+                                            "increment",
+                                            "print",
+                                            "dropout",
+                                            "uniform_random",
+                                            "gaussian_random",
+                                            "randint",
+                                            "sampling_id",
+                                            "subgraph"});
+
+// The folded outputs can't exceed both of the limits, so that the model
+// isn't bloated by the ops like `expand` and `fill_constant`.
+const size_t kMaxFoldedBytes = 1024 * 1024;
+const size_t kMaxFoldedRatio = 4;
+
+lite::Tensor* FindTensor(Scope* scope, const std::string& name) {
+  auto* var = scope->FindVar(name);
+  if (var == nullptr || !var->IsType<lite::Tensor>()) return nullptr;
+  return var->GetMutable<lite::Tensor>();
+}
+
+size_t TensorBytes(const lite::Tensor& tensor) {
+  return tensor.dims().production() * PrecisionTypeLength(tensor.precision());
+}
+
+// The kernels that can be run on the host at optimize time.
+std::vector<Place> HostPlaces() {
+  std::vector<TargetType> targets{TARGET(kHost)};
+#ifdef LITE_WITH_X86
+  targets.push_back(TARGET(kX86));
+#endif
+#ifdef LITE_WITH_ARM
+  targets.push_back(TARGET(kARM));
+#endif
+  std::vector<Place> places;
+  for (auto target : targets) {
+    for (auto precision : {PRECISION(kFloat),
+                           PRECISION(kInt32),
+                           PRECISION(kInt64),
+                           PRECISION(kBool),
+                           PRECISION(kAny)}) {
+      places.emplace_back(target, precision, DATALAYOUT(kNCHW));
+    }
+  }
+  return places;
+}
+
+}  // namespace
+
+void ConstantFoldingPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+  folded_ops_.clear();
+  folded_time_us_.clear();
+#ifdef LITE_ON_MODEL_OPTIMIZE_TOOL
+  // The kernels registered in opt are fake ones which compute nothing, the
+  // folding is left to the predictors loading the optimized model.
+  VLOG(4) << "Skip constant folding in the model optimize tool.";
+  return;
+#endif
+  for (auto* node : graph->StmtTopologicalOrder()) {
+    if (!node->IsStmt() || !IsFoldable(graph.get(), node)) continue;
+    auto kernel = PickHostKernel(node);
+    if (!kernel) {
+      VLOG(4) << "No host kernel to fold " << node->AsStmt().op_type();
+      continue;
+    }
+    if (!Fold(node, std::move(kernel))) continue;
+
+    // Remove the op and the inputs which are not used by other ops.
+    std::set<const Node*> nodes2rm;
+    nodes2rm.insert(node);
+    for (auto* in : node->inlinks) {
+      if (in->outlinks.size() == 1) nodes2rm.insert(in);
+    }
+    for (auto* out : node->outlinks) {
+      out->arg()->is_weight = true;
+      out->arg()->is_persist = true;
+    }
+    GraphSafeRemoveNodes(graph.get(), nodes2rm);
+  }
+
+  if (folded_ops_.empty()) return;
+  int total_ops = 0;
+  double total_time_us = 0;
+  for (auto& it : folded_ops_) {
+    total_ops += it.second;
+    total_time_us += folded_time_us_[it.first];
+    LOG(INFO) << "constant folding: " << it.first << " x " << it.second
+              << ", " << folded_time_us_[it.first] << " us";
+  }
+  LOG(INFO) << "constant folding: removed " << total_ops << " ops, "
+            << total_time_us << " us of runtime in total";
+}
+
+bool ConstantFoldingPass::IsFoldable(SSAGraph* graph, Node* node) {
+  auto& stmt = node->AsStmt();
+  const auto* op_info = stmt.op_info();
+  auto op_type = op_info->Type();
+  if (kUnfoldableOps.count(op_type) || op_info->HasAttr("sub_block") ||
+      op_type.find("fake_") == 0 || op_type.find("__xpu__") == 0) {
+    return false;
+  }
+  if (node->inlinks.empty() || node->outlinks.empty()) return false;
+
+  auto* scope = stmt.op()->scope();
+  for (auto* in : node->inlinks) {
+    if (!in->IsArg() || !in->inlinks.empty()) return false;
+    auto* tensor = FindTensor(scope, in->arg()->name);
+    if (tensor == nullptr || !tensor->persistable() ||
+        !tensor->IsInitialized()) {
+      return false;
+    }
+  }
+  for (auto* out : node->outlinks) {
+    const auto& name = out->arg()->name;
+    if (FindTensor(scope, name) == nullptr) return false;
+    for (auto* in : node->inlinks) {
+      if (in->arg()->name == name) return false;
+    }
+    if (HasExtraProducers(graph, name, {op_type})) return false;
+  }
+  return true;
+}
+
+std::unique_ptr<KernelBase> ConstantFoldingPass::PickHostKernel(Node* node) {
+  auto& stmt = node->AsStmt();
+  const auto* op_info = stmt.op_info();
+  auto* scope = stmt.op()->scope();
+  auto kernels = stmt.op()->CreateKernels(HostPlaces());
+  for (auto& kernel : kernels) {
+    bool matched = true;
+    for (auto& arg : op_info->InputArgumentNames()) {
+      const auto* decl = ParamTypeRegistry::Global().RetrieveInArgument(
+          kernel->place(), kernel->GenParamTypeKey(), arg);
+      if (decl == nullptr) {
+        matched = false;
+        break;
+      }
+      auto decl_target = decl->type->target();
+      auto decl_precision = decl->type->precision();
+      if (decl_target != TARGET(kAny) && decl_target != TARGET(kHost) &&
+          decl_target != kernel->target()) {
+        matched = false;
+        break;
+      }
+      for (auto& name : op_info->Input(arg)) {
+        auto* tensor = FindTensor(scope, name);
+        if (tensor == nullptr || (decl_precision != PRECISION(kAny) &&
+                                  decl_precision != tensor->precision())) {
+          matched = false;
+          break;
+        }
+      }
+      if (!matched) break;
+    }
+    if (matched) return std::move(kernel);
+  }
+  return nullptr;
+}
+
+bool ConstantFoldingPass::Fold(Node* node, std::unique_ptr<KernelBase> kernel) {
+  auto& stmt = node->AsStmt();
+  auto* op = stmt.op().get();
+  auto* scope = op->scope();
+  auto op_type = stmt.op_type();
+  if (!op->CheckShape()) return false;
+  op->InferShape();
+  kernel->SetContext(ContextScheduler::Global().NewContext(kernel->target()));
+  auto start = Timer::GetCurrentUS();
+  kernel->Launch();
+  auto time_us = Timer::GetCurrentUS() - start;
+
+  size_t input_bytes = 0;
+  for (auto* in : node->inlinks) {
+    input_bytes += TensorBytes(*FindTensor(scope, in->arg()->name));
+  }
+  // A kernel which leaves any output unwritten can't be trusted, its outputs
+  // would be saved as empty weights.
+  bool initialized = true;
+  size_t output_bytes = 0;
+  for (auto* out : node->outlinks) {
+    auto* tensor = FindTensor(scope, out->arg()->name);
+    initialized = initialized && tensor->IsInitialized();
+    output_bytes += TensorBytes(*tensor);
+  }
+  if (!initialized || (output_bytes > kMaxFoldedBytes &&
+                       output_bytes > kMaxFoldedRatio * input_bytes)) {
+    VLOG(4) << "Skip folding " << op_type << " with "
+            << (initialized ? std::to_string(output_bytes) + " bytes"
+                            : std::string("uninitialized"))
+            << " outputs";
+    for (auto* out : node->outlinks) {
+      FindTensor(scope, out->arg()->name)->clear();
+    }
+    return false;
+  }
+
+  for (auto* out : node->outlinks) {
+    FindTensor(scope, out->arg()->name)->set_persistable(true);
+  }
+  folded_ops_[op_type]++;
+  folded_time_us_[op_type] += time_us;
+  VLOG(4) << "Folded " << op_type << " in " << time_us << " us";
+  return true;
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(constant_folding_pass, paddle::lite::mir::ConstantFoldingPass)
+    .BindTargets({TARGET(kAny)})
+    .ExcludeTargets({TARGET(kXPU), TARGET(kNNAdapter)});
@@ -0,0 +1,60 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lite/core/kernel.h"
+#include "lite/core/optimizer/mir/pass.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/tensor.h"
+#include "lite/core/types.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+/*
+ * Generic constant folding: the ops whose inputs are all persistable and
+ * not produced by any op are executed with their host kernels at optimize
+ * time, and their outputs are replaced by weights. The folding goes on along
+ * the topological order, so the whole constant subgraphs are removed.
+ *
+ * The ops with side effects or random outputs, and the ops whose folded
+ * outputs are much larger than their inputs are kept.
+ */
+class ConstantFoldingPass : public mir::StmtPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override;
+
+ private:
+  bool IsFoldable(SSAGraph* graph, Node* node);
+  // Pick a host kernel whose input declarations match the precisions of
+  // the input tensors, return nullptr if there is none.
+  std::unique_ptr<KernelBase> PickHostKernel(Node* node);
+  // Run the op and return true if the outputs are kept as weights.
+  bool Fold(Node* node, std::unique_ptr<KernelBase> kernel);
+
+  // The number of the folded ops of each op type and the time in
+  // microseconds spent on running them.
+  std::map<std::string, int> folded_ops_;
+  std::map<std::string, double> folded_time_us_;
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
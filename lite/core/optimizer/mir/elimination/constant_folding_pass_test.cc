@@ -0,0 +1,89 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/pass_tester.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+// out = x * ((w0 + w1) * 2 + 1), the subgraph of w0 and w1 is constant.
+void BuildConstSubgraph(PassTester* tester) {
+  tester->AddWeight("w0", DDim({2, 3}), {1, 2, 3, 4, 5, 6});
+  tester->AddWeight("w1", DDim({2, 3}), {-1, 0.5, 2, 0, 1, -3});
+  auto* add = tester->AddOp(
+      "elementwise_add", {{"X", {"w0"}}, {"Y", {"w1"}}}, {{"Out", {"c0"}}});
+  add->SetAttr<int>("axis", -1);
+  auto* scale = tester->AddOp("scale", {{"X", {"c0"}}}, {{"Out", {"c1"}}});
+  scale->SetAttr<float>("scale", 2.f);
+  scale->SetAttr<float>("bias", 1.f);
+  scale->SetAttr<bool>("bias_after_scale", true);
+  auto* mul = tester->AddOp(
+      "elementwise_mul", {{"X", {"x"}}, {"Y", {"c1"}}}, {{"Out", {"out"}}});
+  mul->SetAttr<int>("axis", -1);
+  tester->Build();
+  auto* x = tester->GetTensor("x");
+  x->Resize({2, 3});
+  auto* x_data = x->mutable_data<float>();
+  for (int i = 0; i < 6; i++) {
+    x_data[i] = 0.5f * i - 1.f;
+  }
+}
+
+TEST(ConstantFoldingPass, fold_const_subgraph) {
+  std::vector<Place> places{Place{TARGET(kX86), PRECISION(kFloat)},
+                            Place{TARGET(kHost), PRECISION(kAny)}};
+  PassTester unfolded(places);
+  BuildConstSubgraph(&unfolded);
+  unfolded.Run();
+
+  PassTester folded(places);
+  BuildConstSubgraph(&folded);
+  folded.Apply("constant_folding_pass");
+  // Only the op which consumes the non-persistable input is left.
+  EXPECT_EQ(folded.CountStmts("elementwise_add"), 0);
+  EXPECT_EQ(folded.CountStmts("scale"), 0);
+  EXPECT_EQ(folded.CountStmts("elementwise_mul"), 1);
+  auto* c1 = folded.GetTensor("c1");
+  EXPECT_TRUE(c1->persistable());
+  for (auto& node : folded.graph()->nodes()) {
+    if (node.IsArg() && node.arg()->name == "c1") {
+      EXPECT_TRUE(node.arg()->is_weight);
+    }
+  }
+  folded.Run();
+
+  auto* expected = unfolded.GetTensor("out");
+  auto* out = folded.GetTensor("out");
+  ASSERT_EQ(out->dims(), expected->dims());
+  for (int64_t i = 0; i < out->numel(); i++) {
+    EXPECT_NEAR(out->data<float>()[i], expected->data<float>()[i], 1e-6);
+  }
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(elementwise_add);
+USE_LITE_OP(elementwise_mul);
+USE_LITE_OP(scale);
+USE_LITE_KERNEL(elementwise_add, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(elementwise_mul, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(scale, kX86, kFloat, kNCHW, def);
+USE_MIR_PASS(constant_folding_pass);
@@ -0,0 +1,91 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/elimination/dead_code_elimination_pass.h"
+#include <set>
+#include <string>
+#include <vector>
+#include "lite/core/optimizer/mir/pattern_matcher.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+// The ops which have side effects or sub-blocks.
+const std::set<std::string> kSideEffectOps({"feed",
+                                            "fetch",
+                                            "while",
+                                            "conditional_block",
+                                            "increment",
+                                            "print",
+                                            "write_to_array",
+                                            "assign",
+                                            "share_data",
+                                            "subgraph"});
+
+}  // namespace
+
+void DeadCodeEliminationPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+  auto nodes = graph->StmtTopologicalOrder();
+  int num_removed = 0;
+  for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) {
+    auto* node = *it;
+    if (!node->IsStmt() || !IsDead(*node)) continue;
+    VLOG(4) << "Remove the dead " << node->AsStmt().op_type();
+    std::set<const Node*> nodes2rm{node};
+    for (auto* out : node->outlinks) {
+      nodes2rm.insert(out);
+    }
+    // The inputs which are not produced by any op, such as the weights, have
+    // no use any more if they are only consumed by this op.
+    for (auto* in : node->inlinks) {
+      if (in->outlinks.size() == 1 && in->inlinks.empty()) {
+        nodes2rm.insert(in);
+      }
+    }
+    GraphSafeRemoveNodes(graph.get(), nodes2rm);
+    num_removed++;
+  }
+  if (num_removed > 0) {
+    LOG(INFO) << "dead code elimination: removed " << num_removed << " ops";
+  }
+}
+
+bool DeadCodeEliminationPass::IsDead(const Node& node) {
+  const auto* op_info = node.stmt()->op_info();
+  if (kSideEffectOps.count(op_info->Type()) || op_info->HasAttr("sub_block") ||
+      node.outlinks.empty()) {
+    return false;
+  }
+  // The persistable outputs, e.g. the states updated by the op, are kept as
+  // well as the used ones.
+  for (auto* out : node.outlinks) {
+    const auto* arg = out->arg();
+    if (!out->outlinks.empty() || arg->is_weight || arg->is_persist) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(dead_code_elimination_pass,
+                  paddle::lite::mir::DeadCodeEliminationPass)
+    .BindTargets({TARGET(kAny)})
+    .ExcludeTargets({TARGET(kXPU), TARGET(kNNAdapter)});
@@ -0,0 +1,127 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/pass_tester.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+void AddMul(PassTester* tester,
+            const std::string& x,
+            const std::string& y,
+            const std::string& out) {
+  tester->AddOp("elementwise_mul", {{"X", {x}}, {"Y", {y}}}, {{"Out", {out}}})
+      ->SetAttr<int>("axis", -1);
+}
+
+void AddScale(PassTester* tester,
+              const std::string& x,
+              const std::string& out) {
+  auto* op_desc = tester->AddOp("scale", {{"X", {x}}}, {{"Out", {out}}});
+  op_desc->SetAttr<float>("scale", 2.f);
+  op_desc->SetAttr<float>("bias", 0.5f);
+  op_desc->SetAttr<bool>("bias_after_scale", true);
+}
+
+// out = x * w is fetched, state = scale(x) is persistable, the outputs of
+// assign(x) and write_to_array(x, i) are unused, and so is the branch of
+// scale(x * w_dead).
+void BuildGraph(PassTester* tester) {
+  tester->AddWeight("w", DDim({2, 3}), {1, 2, 3, 4, 5, 6});
+  tester->AddWeight("w_dead", DDim({2, 3}), {-1, 0.5, 2, 0, 1, -3});
+  tester->AddWeight("state", DDim({2, 3}), {0, 0, 0, 0, 0, 0});
+  tester->AddTensorArray("array");
+  AddMul(tester, "x", "w", "out");
+  tester->AddOp("fetch", {{"X", {"out"}}}, {{"Out", {"fetch"}}})
+      ->SetAttr<int>("col", 0);
+  AddMul(tester, "x", "w_dead", "dead");
+  AddScale(tester, "dead", "dead_scaled");
+  AddScale(tester, "x", "state");
+  tester->AddOp("assign", {{"X", {"x"}}}, {{"Out", {"assigned"}}});
+  tester->AddOp("write_to_array",
+                {{"X", {"x"}}, {"I", {"i"}}},
+                {{"Out", {"array"}}});
+  tester->Build();
+
+  auto* x = tester->GetTensor("x");
+  x->Resize({2, 3});
+  auto* x_data = x->mutable_data<float>();
+  for (int i = 0; i < 6; i++) {
+    x_data[i] = 0.5f * i - 1.f;
+  }
+  auto* i = tester->GetTensor("i");
+  i->Resize({1});
+  i->mutable_data<int64_t>()[0] = 0;
+}
+
+TEST(DeadCodeEliminationPass, remove_dead_branch) {
+  std::vector<Place> places{Place{TARGET(kX86), PRECISION(kFloat)},
+                            Place{TARGET(kHost), PRECISION(kAny)}};
+  PassTester unpruned(places);
+  BuildGraph(&unpruned);
+  unpruned.Run();
+
+  PassTester pruned(places);
+  BuildGraph(&pruned);
+  pruned.Apply("dead_code_elimination_pass");
+  // Only the dead branch is removed, along with the weight it reads.
+  EXPECT_EQ(pruned.CountStmts("elementwise_mul"), 1);
+  EXPECT_EQ(pruned.CountStmts("scale"), 1);
+  EXPECT_EQ(pruned.CountStmts("fetch"), 1);
+  EXPECT_EQ(pruned.CountStmts("assign"), 1);
+  EXPECT_EQ(pruned.CountStmts("write_to_array"), 1);
+  std::set<std::string> var_names;
+  for (auto& node : pruned.graph()->nodes()) {
+    if (node.IsArg()) var_names.insert(node.arg()->name);
+  }
+  for (auto name : {"w_dead", "dead", "dead_scaled"}) {
+    EXPECT_EQ(var_names.count(name), 0u) << name;
+  }
+  for (auto name : {"w", "out", "state", "assigned", "array"}) {
+    EXPECT_EQ(var_names.count(name), 1u) << name;
+  }
+  pruned.Run();
+
+  for (auto name : {"out", "state", "assigned"}) {
+    auto* expected = unpruned.GetTensor(name);
+    auto* out = pruned.GetTensor(name);
+    ASSERT_EQ(out->dims(), expected->dims()) << name;
+    for (int64_t i = 0; i < out->numel(); i++) {
+      EXPECT_EQ(out->data<float>()[i], expected->data<float>()[i]) << name;
+    }
+  }
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(elementwise_mul);
+USE_LITE_OP(scale);
+USE_LITE_OP(fetch);
+USE_LITE_OP(assign);
+USE_LITE_OP(write_to_array);
+USE_LITE_KERNEL(elementwise_mul, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(scale, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(fetch, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(assign, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(write_to_array, kHost, kAny, kAny, def);
+USE_MIR_PASS(dead_code_elimination_pass);
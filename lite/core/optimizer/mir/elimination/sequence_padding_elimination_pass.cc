@@ -0,0 +1,163 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/elimination/sequence_padding_elimination_pass.h"
+#include <map>
+#include <set>
+#include <string>
+#include "lite/core/optimizer/mir/pattern_matcher.h"
+#include "lite/core/optimizer/mir/ssa_graph_utils.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+struct RoundTrip {
+  std::string pad_type;
+  // The padded output of the padding op and the padded input of the
+  // unpadding op.
+  std::string padded_out;
+  std::string padded_in;
+  // The input of the unpadding op which gives the sequence lengths.
+  std::string length_in;
+};
+
+// The round trips keyed by the type of the unpadding op.
+const std::map<std::string, RoundTrip> kRoundTrips(
+    {{"sequence_unpad", {"sequence_pad", "Out", "X", "Length"}},
+     {"search_seq_depadding",
+      {"search_group_padding", "Out_emb_padding", "Pad", "Src"}}});
+
+std::string OpType(Node* node) { return node->AsStmt().op_type(); }
+
+Node* Producer(Node* var) {
+  return var->inlinks.size() == 1 ? var->inlinks.front() : nullptr;
+}
+
+Node* InputVar(Node* stmt, const std::string& argname) {
+  const auto* op_info = stmt->AsStmt().op_info();
+  if (!op_info->HasInput(argname) || op_info->Input(argname).empty()) {
+    return nullptr;
+  }
+  auto name = op_info->Input(argname).front();
+  for (auto* in : stmt->inlinks) {
+    if (in->arg()->name == name) return in;
+  }
+  return nullptr;
+}
+
+Node* OutputVar(Node* stmt, const std::string& argname) {
+  const auto* op_info = stmt->AsStmt().op_info();
+  if (!op_info->HasOutput(argname) || op_info->Output(argname).empty()) {
+    return nullptr;
+  }
+  auto name = op_info->Output(argname).front();
+  for (auto* out : stmt->outlinks) {
+    if (out->arg()->name == name) return out;
+  }
+  return nullptr;
+}
+
+// Remove `stmt` and its outputs which have no consumers.
+void RemoveOp(SSAGraph* graph, Node* stmt) {
+  std::set<const Node*> nodes2rm{stmt};
+  for (auto* out : stmt->outlinks) {
+    if (out->outlinks.empty()) nodes2rm.insert(out);
+  }
+  GraphSafeRemoveNodes(graph, nodes2rm);
+}
+
+}  // namespace
+
+void SequencePaddingEliminationPass::Apply(
+    const std::unique_ptr<SSAGraph>& graph) {
+  extra_produced_ = ExtraProducedVars(graph.get());
+  int num_removed = 0;
+  // The consumers of a removed round trip read x instead, and the round
+  // trips below them are found later in the same walk. Only the visited
+  // nodes are removed.
+  for (auto* node : graph->StmtTopologicalOrder()) {
+    if (!node->IsStmt() || !kRoundTrips.count(OpType(node))) continue;
+    if (EliminateRoundTrip(graph.get(), node)) num_removed++;
+  }
+  if (num_removed > 0) {
+    LOG(INFO) << "sequence padding elimination: removed " << num_removed
+              << " padding round trips";
+  }
+}
+
+// Whether the var may be renamed or removed.
+bool SequencePaddingEliminationPass::IsInternalVar(Node* var) {
+  if (var->arg()->is_weight || var->arg()->is_persist) return false;
+  for (auto* consumer : var->outlinks) {
+    if (OpType(consumer) == "fetch") return false;
+  }
+  return !extra_produced_.count(var->arg()->name);
+}
+
+bool SequencePaddingEliminationPass::EliminateRoundTrip(SSAGraph* graph,
+                                                        Node* unpad) {
+  auto unpad_type = OpType(unpad);
+  const auto& trip = kRoundTrips.at(unpad_type);
+  auto* padded = InputVar(unpad, trip.padded_in);
+  auto* length = InputVar(unpad, trip.length_in);
+  auto* y = OutputVar(unpad, "Out");
+  if (!padded || !length || !y || padded->outlinks.size() != 1 ||
+      !IsInternalVar(padded) || !IsInternalVar(y)) {
+    return false;
+  }
+  auto* pad = Producer(padded);
+  if (!pad || OpType(pad) != trip.pad_type ||
+      OutputVar(pad, trip.padded_out) != padded) {
+    return false;
+  }
+  auto* x = InputVar(pad, "X");
+  if (!x || extra_produced_.count(x->arg()->name)) return false;
+
+  // The lengths of the unpadded sequences should be the ones of x.
+  if (trip.pad_type == "sequence_pad") {
+    if (length != OutputVar(pad, "Length")) return false;
+  } else if (length != x && length != OutputVar(pad, "Out_new")) {
+    return false;
+  }
+
+  auto consumers = y->outlinks;
+  for (auto* consumer : consumers) {
+    auto op_desc = *consumer->AsStmt().op_info();
+    op_desc.UpdateAllInputs(y->arg()->name, x->arg()->name);
+    consumer->AsStmt().ResetOp(op_desc, graph->valid_places());
+    RemoveDirectedLink(y, consumer);
+    DirectedLink(x, consumer);
+  }
+  RemoveOp(graph, unpad);
+  VLOG(4) << "Remove the round trip " << trip.pad_type << " -> "
+          << unpad_type;
+
+  for (auto* out : pad->outlinks) {
+    if (!out->outlinks.empty() || !IsInternalVar(out)) return true;
+  }
+  RemoveOp(graph, pad);
+  return true;
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(sequence_padding_elimination_pass,
+                  paddle::lite::mir::SequencePaddingEliminationPass)
+    .BindTargets({TARGET(kAny)})
+    .ExcludeTargets({TARGET(kXPU), TARGET(kNNAdapter)});
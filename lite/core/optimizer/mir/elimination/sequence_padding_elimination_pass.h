@@ -0,0 +1,55 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <set>
+#include <string>
+#include "lite/core/optimizer/mir/pass.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+/*
+ * Remove the round trips between the LoD sequences and the padded tensors:
+ *
+ *   sequence_unpad(sequence_pad(x), length) -> x
+ *   search_seq_depadding(search_group_padding(x), src) -> x
+ *
+ * where `length` is the Length output of the same sequence_pad, and `src` is
+ * x or the Out_new output of the same search_group_padding. The padded tensor
+ * should be used by the unpadding op only, and the padding op is removed as
+ * well if none of its outputs are used any more.
+ *
+ * The unpadded sequences only carry the first level of the LoD of x, so the
+ * pass assumes x is a LoD tensor of a single level, as the padding ops do.
+ */
+class SequencePaddingEliminationPass : public mir::StmtPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override;
+
+ private:
+  bool EliminateRoundTrip(SSAGraph* graph, Node* unpad);
+  bool IsInternalVar(Node* var);
+
+  // The names of the vars written by while, conditional_block or increment.
+  std::set<std::string> extra_produced_;
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,159 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/pass_tester.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+const std::vector<Place> kPlaces{Place{TARGET(kX86), PRECISION(kFloat)},
+                                 Place{TARGET(kHost), PRECISION(kFloat)},
+                                 Place{TARGET(kHost), PRECISION(kAny)}};
+
+// y = sequence_unpad(sequence_pad(x), length)
+void AddSequencePadRoundTrip(PassTester* tester) {
+  tester->AddWeight("pad_value", DDim({1}), {0.f});
+  tester
+      ->AddOp("sequence_pad",
+              {{"X", {"x"}}, {"PadValue", {"pad_value"}}},
+              {{"Out", {"padded"}}, {"Length", {"length"}}})
+      ->SetAttr<int>("padded_length", -1);
+  tester->AddOp("sequence_unpad",
+                {{"X", {"padded"}}, {"Length", {"length"}}},
+                {{"Out", {"y"}}});
+}
+
+// y = search_seq_depadding(search_group_padding(x), x)
+void AddSearchPaddingRoundTrip(PassTester* tester) {
+  tester
+      ->AddOp("search_group_padding",
+              {{"X", {"x"}}},
+              {{"Out_emb_padding", {"padded"}},
+               {"Out_new", {"x_new"}},
+               {"Out_padding", {"padding"}}})
+      ->SetAttr<int>("pad_id", 0);
+  tester->AddOp("search_seq_depadding",
+                {{"Pad", {"padded"}}, {"Src", {"x"}}},
+                {{"Out", {"y"}}});
+}
+
+void AddScale(PassTester* tester,
+              const std::string& x,
+              const std::string& out) {
+  auto* op_desc = tester->AddOp("scale", {{"X", {x}}}, {{"Out", {out}}});
+  op_desc->SetAttr<float>("scale", 2.f);
+  op_desc->SetAttr<float>("bias", 0.5f);
+  op_desc->SetAttr<bool>("bias_after_scale", true);
+}
+
+void FillInput(PassTester* tester) {
+  auto* x = tester->GetTensor("x");
+  x->Resize({5, 2});
+  x->set_lod({{0, 2, 5}});
+  auto* x_data = x->mutable_data<float>();
+  for (int i = 0; i < 10; i++) {
+    x_data[i] = 0.25f * i - 1.f;
+  }
+}
+
+const std::vector<void (*)(PassTester*)> kRoundTrips{
+    AddSequencePadRoundTrip, AddSearchPaddingRoundTrip};
+
+TEST(SequencePaddingEliminationPass, remove_round_trips) {
+  for (auto add_round_trip : kRoundTrips) {
+    PassTester tester(kPlaces);
+    add_round_trip(&tester);
+    AddScale(&tester, "y", "out");
+    tester.Build();
+    tester.Apply("sequence_padding_elimination_pass");
+    // The padding op goes as well, since none of its outputs are used.
+    for (auto op_type : {"sequence_pad",
+                         "sequence_unpad",
+                         "search_group_padding",
+                         "search_seq_depadding"}) {
+      EXPECT_EQ(tester.CountStmts(op_type), 0) << op_type;
+    }
+    // The scale reads x instead.
+    for (auto& node : tester.graph()->nodes()) {
+      if (!node.IsStmt()) continue;
+      ASSERT_EQ(node.inlinks.size(), 1u);
+      EXPECT_EQ(node.inlinks.front()->arg()->name, "x");
+      EXPECT_EQ(node.stmt()->op_info()->Input("X"),
+                std::vector<std::string>{"x"});
+    }
+    FillInput(&tester);
+    tester.Run();
+    auto* x = tester.GetTensor("x");
+    auto* out = tester.GetTensor("out");
+    ASSERT_EQ(out->dims(), x->dims());
+    for (int64_t i = 0; i < out->numel(); i++) {
+      EXPECT_NEAR(
+          out->data<float>()[i], 2.f * x->data<float>()[i] + 0.5f, 1e-6);
+    }
+  }
+}
+
+TEST(SequencePaddingEliminationPass, keep_fetched_output) {
+  for (auto add_round_trip : kRoundTrips) {
+    PassTester tester(kPlaces);
+    add_round_trip(&tester);
+    tester.AddOp("fetch", {{"X", {"y"}}}, {{"Out", {"fetch"}}})
+        ->SetAttr<int>("col", 0);
+    tester.Build();
+    tester.Apply("sequence_padding_elimination_pass");
+    EXPECT_EQ(tester.CountStmts("sequence_unpad") +
+                  tester.CountStmts("search_seq_depadding"),
+              1);
+  }
+}
+
+TEST(SequencePaddingEliminationPass, keep_shared_padded_input) {
+  for (auto add_round_trip : kRoundTrips) {
+    PassTester tester(kPlaces);
+    add_round_trip(&tester);
+    AddScale(&tester, "y", "out");
+    AddScale(&tester, "padded", "padded_out");
+    tester.Build();
+    tester.Apply("sequence_padding_elimination_pass");
+    EXPECT_EQ(tester.CountStmts("sequence_unpad") +
+                  tester.CountStmts("search_seq_depadding"),
+              1);
+    EXPECT_EQ(tester.CountStmts("sequence_pad") +
+                  tester.CountStmts("search_group_padding"),
+              1);
+  }
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(sequence_pad);
+USE_LITE_OP(sequence_unpad);
+USE_LITE_OP(search_group_padding);
+USE_LITE_OP(search_seq_depadding);
+USE_LITE_OP(scale);
+USE_LITE_OP(fetch);
+USE_LITE_KERNEL(sequence_pad, kHost, kFloat, kNCHW, def);
+USE_LITE_KERNEL(sequence_unpad, kHost, kFloat, kAny, float32);
+USE_LITE_KERNEL(search_group_padding, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(search_seq_depadding, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(scale, kX86, kFloat, kNCHW, def);
+USE_MIR_PASS(sequence_padding_elimination_pass);
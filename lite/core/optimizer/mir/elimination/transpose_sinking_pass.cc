@@ -0,0 +1,340 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/elimination/transpose_sinking_pass.h"
+#include <algorithm>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "lite/core/optimizer/mir/pattern_matcher.h"
+#include "lite/core/optimizer/mir/ssa_graph_utils.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+const std::set<std::string> kTransposeOps({"transpose", "transpose2"});
+const std::set<std::string> kReshapeOps({"reshape", "reshape2"});
+
+// The element-wise ops with the single input `X` and output `Out`.
+const std::set<std::string> kUnaryOps({"relu",
+                                       "relu6",
+                                       "leaky_relu",
+                                       "sigmoid",
+                                       "tanh",
+                                       "swish",
+                                       "hard_swish",
+                                       "hard_sigmoid",
+                                       "gelu",
+                                       "elu",
+                                       "softplus",
+                                       "mish",
+                                       "exp",
+                                       "log",
+                                       "abs",
+                                       "sqrt",
+                                       "rsqrt",
+                                       "square",
+                                       "floor",
+                                       "scale",
+                                       "cast"});
+
+const std::set<std::string> kElementwiseOps({"elementwise_add",
+                                             "elementwise_sub",
+                                             "elementwise_mul",
+                                             "elementwise_div",
+                                             "elementwise_max",
+                                             "elementwise_min",
+                                             "elementwise_pow"});
+
+std::string OpType(Node* node) { return node->AsStmt().op_type(); }
+
+Node* Producer(Node* var) {
+  return var->inlinks.size() == 1 ? var->inlinks.front() : nullptr;
+}
+
+Node* InputVar(Node* stmt, const std::string& argname) {
+  auto name = stmt->AsStmt().op_info()->Input(argname).front();
+  for (auto* in : stmt->inlinks) {
+    if (in->arg()->name == name) return in;
+  }
+  return nullptr;
+}
+
+Node* OutputVar(Node* stmt, const std::string& argname) {
+  auto name = stmt->AsStmt().op_info()->Output(argname).front();
+  for (auto* out : stmt->outlinks) {
+    if (out->arg()->name == name) return out;
+  }
+  return nullptr;
+}
+
+std::vector<int> Perm(Node* transpose) {
+  return transpose->AsStmt().op_info()->GetAttr<std::vector<int>>("axis");
+}
+
+// Reset the op of `stmt` with `op_desc`, which reads the vars `inputs` and
+// writes the vars `outputs`. The vars are copied since they may be the links
+// of `stmt`.
+void UpdateOp(SSAGraph* graph,
+              Node* stmt,
+              const cpp::OpDesc& op_desc,
+              std::list<Node*> inputs,
+              std::list<Node*> outputs) {
+  auto inlinks = stmt->inlinks;
+  for (auto* in : inlinks) {
+    RemoveDirectedLink(in, stmt);
+  }
+  auto outlinks = stmt->outlinks;
+  for (auto* out : outlinks) {
+    RemoveDirectedLink(stmt, out);
+  }
+  stmt->AsStmt().ResetOp(op_desc, graph->valid_places());
+  for (auto* in : inputs) {
+    DirectedLink(in, stmt);
+  }
+  for (auto* out : outputs) {
+    DirectedLink(stmt, out);
+  }
+}
+
+}  // namespace
+
+void TransposeSinkingPass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+  extra_produced_ = ExtraProducedVars(graph.get());
+  removed_.clear();
+  num_removed_transposes_ = 0;
+  num_removed_reshapes_ = 0;
+  // A transpose is rewritten until it can't be sunk any further, it is then
+  // below all the nodes it has passed, so one walk along the topological
+  // order finds all the patterns. The removed nodes are skipped.
+  for (auto* node : graph->StmtTopologicalOrder()) {
+    if (removed_.count(node) || !node->IsStmt()) continue;
+    auto op_type = OpType(node);
+    if (kTransposeOps.count(op_type)) {
+      while (!removed_.count(node) && (MergeTransposes(graph.get(), node) ||
+                                       SinkTranspose(graph.get(), node))) {
+      }
+    } else if (kReshapeOps.count(op_type)) {
+      MergeReshapes(graph.get(), node);
+    }
+  }
+  if (num_removed_transposes_ > 0 || num_removed_reshapes_ > 0) {
+    LOG(INFO) << "transpose sinking: removed " << num_removed_transposes_
+              << " transpose ops and " << num_removed_reshapes_
+              << " reshape ops";
+  }
+}
+
+Node* TransposeSinkingPass::SoleConsumer(Node* var) {
+  if (var->outlinks.size() != 1 || var->arg()->is_weight ||
+      var->arg()->is_persist || extra_produced_.count(var->arg()->name)) {
+    return nullptr;
+  }
+  return var->outlinks.front();
+}
+
+void TransposeSinkingPass::RemoveOp(SSAGraph* graph, Node* stmt) {
+  auto op_type = OpType(stmt);
+  if (kTransposeOps.count(op_type)) num_removed_transposes_++;
+  if (kReshapeOps.count(op_type)) num_removed_reshapes_++;
+  std::set<const Node*> nodes2rm{stmt};
+  for (auto* out : stmt->outlinks) {
+    if (out->outlinks.empty()) nodes2rm.insert(out);
+  }
+  removed_.insert(nodes2rm.begin(), nodes2rm.end());
+  GraphSafeRemoveNodes(graph, nodes2rm);
+}
+
+bool TransposeSinkingPass::SinkTranspose(SSAGraph* graph, Node* transpose) {
+  auto* x = InputVar(transpose, "X");
+  auto* out = OutputVar(transpose, "Out");
+  if (!x || !out) return false;
+  auto* consumer = SoleConsumer(out);
+  if (!consumer) return false;
+  auto consumer_type = OpType(consumer);
+  auto perm = Perm(transpose);
+  const auto* consumer_info = consumer->AsStmt().op_info();
+  if (consumer->outlinks.size() != 1) return false;
+  auto* y = consumer->outlinks.front();
+  if (consumer_info->Output("Out").front() != y->arg()->name) return false;
+
+  cpp::OpDesc consumer_desc = *consumer_info;
+  std::list<Node*> consumer_inputs;
+  std::vector<Node*> transposes2rm;
+  if (kUnaryOps.count(consumer_type)) {
+    if (consumer->inlinks.size() != 1) return false;
+    consumer_desc.SetInput("X", {x->arg()->name});
+    consumer_inputs.push_back(x);
+  } else if (kElementwiseOps.count(consumer_type)) {
+    if (consumer->inlinks.size() != 2) return false;
+    if (consumer_info->HasAttr("axis") &&
+        consumer_info->GetAttr<int>("axis") != -1) {
+      return false;
+    }
+    // Both of the inputs should be transposed by the same permutation.
+    auto* other_var = consumer->inlinks.front() == out
+                          ? consumer->inlinks.back()
+                          : consumer->inlinks.front();
+    auto* other = Producer(other_var);
+    if (!other || !kTransposeOps.count(OpType(other)) ||
+        Perm(other) != perm || SoleConsumer(other_var) != consumer) {
+      return false;
+    }
+    auto* other_x = InputVar(other, "X");
+    if (!other_x) return false;
+    bool out_is_x = consumer_info->Input("X").front() == out->arg()->name;
+    consumer_desc.SetInput("X",
+                           {out_is_x ? x->arg()->name : other_x->arg()->name});
+    consumer_desc.SetInput("Y",
+                           {out_is_x ? other_x->arg()->name : x->arg()->name});
+    consumer_inputs = {x, other_x};
+    transposes2rm.push_back(other);
+  } else if (consumer_type == "concat") {
+    if (consumer_info->HasInput("AxisTensor") &&
+        !consumer_info->Input("AxisTensor").empty()) {
+      return false;
+    }
+    std::map<std::string, Node*> vars;
+    for (auto* in : consumer->inlinks) {
+      vars[in->arg()->name] = in;
+    }
+    std::vector<std::string> inputs;
+    for (auto& name : consumer_info->Input("X")) {
+      auto* var = vars[name];
+      auto* producer = var ? Producer(var) : nullptr;
+      if (!producer || !kTransposeOps.count(OpType(producer)) ||
+          Perm(producer) != perm || SoleConsumer(var) != consumer) {
+        return false;
+      }
+      auto* producer_x = InputVar(producer, "X");
+      if (!producer_x) return false;
+      inputs.push_back(producer_x->arg()->name);
+      consumer_inputs.push_back(producer_x);
+      if (producer != transpose) transposes2rm.push_back(producer);
+    }
+    int rank = static_cast<int>(perm.size());
+    int axis = consumer_info->GetAttr<int>("axis");
+    if (axis < 0) axis += rank;
+    if (axis < 0 || axis >= rank) return false;
+    consumer_desc.SetInput("X", inputs);
+    consumer_desc.SetAttr<int>("axis", perm[axis]);
+  } else {
+    return false;
+  }
+
+  // x -> consumer -> out -> transpose -> y
+  consumer_desc.SetOutput("Out", {out->arg()->name});
+  cpp::OpDesc transpose_desc = *transpose->AsStmt().op_info();
+  transpose_desc.SetInput("X", {out->arg()->name});
+  transpose_desc.SetOutput("Out", {y->arg()->name});
+  // The other outputs of the transpose like `XShape` are kept.
+  auto transpose_outputs = transpose->outlinks;
+  std::replace(transpose_outputs.begin(), transpose_outputs.end(), out, y);
+  UpdateOp(graph, consumer, consumer_desc, consumer_inputs, {out});
+  UpdateOp(graph, transpose, transpose_desc, {out}, transpose_outputs);
+  for (auto* node : transposes2rm) {
+    RemoveOp(graph, node);
+  }
+  VLOG(4) << "Sink " << OpType(transpose) << " through " << consumer_type;
+  return true;
+}
+
+bool TransposeSinkingPass::MergeTransposes(SSAGraph* graph, Node* transpose) {
+  auto* v = InputVar(transpose, "X");
+  auto* producer = v ? Producer(v) : nullptr;
+  if (!producer || !kTransposeOps.count(OpType(producer)) ||
+      SoleConsumer(v) != transpose) {
+    return false;
+  }
+  auto* x = InputVar(producer, "X");
+  if (!x) return false;
+  // y[i] = v[perm2[i]] = x[perm1[perm2[i]]]
+  auto perm1 = Perm(producer);
+  auto perm2 = Perm(transpose);
+  if (perm1.size() != perm2.size()) return false;
+  std::vector<int> perm(perm2.size());
+  bool identity = true;
+  for (size_t i = 0; i < perm2.size(); i++) {
+    perm[i] = perm1[perm2[i]];
+    identity = identity && perm[i] == static_cast<int>(i);
+  }
+  cpp::OpDesc transpose_desc = *transpose->AsStmt().op_info();
+  transpose_desc.SetInput("X", {x->arg()->name});
+  transpose_desc.SetAttr<std::vector<int>>("axis", perm);
+  UpdateOp(graph, transpose, transpose_desc, {x}, transpose->outlinks);
+  RemoveOp(graph, producer);
+  VLOG(4) << "Merge the consecutive transposes";
+
+  // Relink the consumers of an identity transpose to its input, unless its
+  // output is fetched or persistable.
+  auto* y = OutputVar(transpose, "Out");
+  if (!identity || !y || y->arg()->is_persist ||
+      extra_produced_.count(y->arg()->name)) {
+    return true;
+  }
+  for (auto* consumer : y->outlinks) {
+    if (OpType(consumer) == "fetch") return true;
+  }
+  auto consumers = y->outlinks;
+  for (auto* consumer : consumers) {
+    auto op_desc = *consumer->AsStmt().op_info();
+    op_desc.UpdateAllInputs(y->arg()->name, x->arg()->name);
+    consumer->AsStmt().ResetOp(op_desc, graph->valid_places());
+    RemoveDirectedLink(y, consumer);
+    DirectedLink(x, consumer);
+  }
+  RemoveOp(graph, transpose);
+  VLOG(4) << "Remove the identity transpose";
+  return true;
+}
+
+bool TransposeSinkingPass::MergeReshapes(SSAGraph* graph, Node* reshape) {
+  // The shape of the second reshape should not depend on its input shape
+  // except the inferred -1.
+  const auto* op_info = reshape->AsStmt().op_info();
+  if (reshape->inlinks.size() != 1 || !op_info->HasAttr("shape")) {
+    return false;
+  }
+  for (auto dim : op_info->GetAttr<std::vector<int>>("shape")) {
+    if (dim == 0) return false;
+  }
+  auto* v = reshape->inlinks.front();
+  auto* producer = Producer(v);
+  if (!producer || !kReshapeOps.count(OpType(producer)) ||
+      producer->inlinks.size() != 1 || SoleConsumer(v) != reshape) {
+    return false;
+  }
+  auto* x = InputVar(producer, "X");
+  if (!x) return false;
+  cpp::OpDesc reshape_desc = *op_info;
+  reshape_desc.SetInput("X", {x->arg()->name});
+  UpdateOp(graph, reshape, reshape_desc, {x}, reshape->outlinks);
+  RemoveOp(graph, producer);
+  VLOG(4) << "Merge the consecutive reshapes";
+  return true;
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(transpose_sinking_pass,
+                  paddle::lite::mir::TransposeSinkingPass)
+    .BindTargets({TARGET(kAny)})
+    .ExcludeTargets({TARGET(kXPU), TARGET(kNNAdapter)});
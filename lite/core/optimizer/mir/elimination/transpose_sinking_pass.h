@@ -0,0 +1,66 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <set>
+#include <string>
+#include "lite/core/optimizer/mir/pass.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+/*
+ * Reduce the data movement ops by propagating the layout permutations:
+ *
+ * 1. Sink a transpose through its only consumer if it's layout-agnostic:
+ *    act(transpose(x)) -> transpose(act(x)),
+ *    elementwise(transpose(x), transpose(y)) -> transpose(elementwise(x, y)),
+ *    concat(transpose(x), ..., axis) -> transpose(concat(x, ..., perm[axis])).
+ * 2. Merge the consecutive transposes into one, and remove it if the merged
+ *    permutation is an identity.
+ * 3. Merge the consecutive reshapes into one.
+ *
+ * Each transpose is rewritten until no more patterns are found, so the
+ * transposes are sunk until they meet their inverses. The number of the
+ * removed transposes and reshapes is reported.
+ */
+class TransposeSinkingPass : public mir::StmtPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override;
+
+ private:
+  // Return the only consumer of `var` if it may be rewritten, otherwise
+  // return nullptr.
+  Node* SoleConsumer(Node* var);
+  // Remove `stmt` and its outputs which have no consumers.
+  void RemoveOp(SSAGraph* graph, Node* stmt);
+  bool SinkTranspose(SSAGraph* graph, Node* transpose);
+  bool MergeTransposes(SSAGraph* graph, Node* transpose);
+  bool MergeReshapes(SSAGraph* graph, Node* reshape);
+
+  // The vars written by the control flow ops, which are never rewritten.
+  std::set<std::string> extra_produced_;
+  // The nodes removed in the current walk of the graph.
+  std::set<const Node*> removed_;
+  int num_removed_transposes_{0};
+  int num_removed_reshapes_{0};
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
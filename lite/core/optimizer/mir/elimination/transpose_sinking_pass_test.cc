@@ -0,0 +1,114 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/pass_tester.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+void AddTranspose(PassTester* tester,
+                  const std::string& x,
+                  const std::string& out,
+                  const std::vector<int>& perm) {
+  tester
+      ->AddOp("transpose2",
+              {{"X", {x}}},
+              {{"Out", {out}}, {"XShape", {out + "_xshape"}}})
+      ->SetAttr<std::vector<int>>("axis", perm);
+}
+
+void AddReshape(PassTester* tester,
+                const std::string& x,
+                const std::string& out,
+                const std::vector<int>& shape) {
+  tester
+      ->AddOp("reshape2",
+              {{"X", {x}}},
+              {{"Out", {out}}, {"XShape", {out + "_xshape"}}})
+      ->SetAttr<std::vector<int>>("shape", shape);
+}
+
+void FillInput(PassTester* tester, const std::string& name, float offset) {
+  auto* x = tester->GetTensor(name);
+  x->Resize({1, 2, 3, 4});
+  auto* x_data = x->mutable_data<float>();
+  for (int i = 0; i < 24; i++) {
+    x_data[i] = 0.5f * i - offset;
+  }
+}
+
+// out = reshape(reshape(transpose(relu(transpose(x)) + transpose(y)))), the
+// last transpose is the inverse of the first two.
+void BuildTransposedModel(PassTester* tester) {
+  AddTranspose(tester, "x", "tx", {0, 2, 3, 1});
+  tester->AddOp("relu", {{"X", {"tx"}}}, {{"Out", {"rx"}}});
+  AddTranspose(tester, "y", "ty", {0, 2, 3, 1});
+  tester
+      ->AddOp("elementwise_add",
+              {{"X", {"rx"}}, {"Y", {"ty"}}},
+              {{"Out", {"sum"}}})
+      ->SetAttr<int>("axis", -1);
+  AddTranspose(tester, "sum", "tsum", {0, 3, 1, 2});
+  AddReshape(tester, "tsum", "r0", {1, -1});
+  AddReshape(tester, "r0", "out", {4, 6});
+  tester->Build();
+  FillInput(tester, "x", 5.f);
+  FillInput(tester, "y", 3.f);
+}
+
+TEST(TransposeSinkingPass, remove_inverse_transposes) {
+  std::vector<Place> places{
+      Place{TARGET(kX86), PRECISION(kFloat)},
+      Place{TARGET(kHost), PRECISION(kAny)},
+      Place{TARGET(kHost), PRECISION(kAny), DATALAYOUT(kAny)}};
+  PassTester origin(places);
+  BuildTransposedModel(&origin);
+  origin.Run();
+
+  PassTester sunk(places);
+  BuildTransposedModel(&sunk);
+  sunk.Apply("transpose_sinking_pass");
+  EXPECT_EQ(sunk.CountStmts("transpose2"), 0);
+  EXPECT_EQ(sunk.CountStmts("reshape2"), 1);
+  EXPECT_EQ(sunk.CountStmts("relu"), 1);
+  EXPECT_EQ(sunk.CountStmts("elementwise_add"), 1);
+  sunk.Run();
+
+  auto* expected = origin.GetTensor("out");
+  auto* out = sunk.GetTensor("out");
+  ASSERT_EQ(out->dims(), expected->dims());
+  for (int64_t i = 0; i < out->numel(); i++) {
+    EXPECT_NEAR(out->data<float>()[i], expected->data<float>()[i], 1e-6);
+  }
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(transpose2);
+USE_LITE_OP(reshape2);
+USE_LITE_OP(relu);
+USE_LITE_OP(elementwise_add);
+USE_LITE_KERNEL(transpose2, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(reshape2, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(relu, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(elementwise_add, kX86, kFloat, kNCHW, def);
+USE_MIR_PASS(transpose_sinking_pass);
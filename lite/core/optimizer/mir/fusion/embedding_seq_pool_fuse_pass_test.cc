@@ -0,0 +1,136 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/pass_tester.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+const int kVocabSize = 12;
+const int kWidth = 5;
+const int64_t kPaddingIdx = 3;
+const std::vector<uint64_t> kOffsets{0, 3, 4, 9};
+
+const std::vector<Place> kPlaces{Place{TARGET(kX86), PRECISION(kFloat)},
+                                 Place{TARGET(kHost), PRECISION(kFloat)},
+                                 Place{TARGET(kHost), PRECISION(kAny)}};
+
+// out = sequence_pool(lookup_type(w, ids)), the ids are of `ids_dims` and
+// int64 if `int64_ids`, otherwise int32.
+void BuildEmbeddingPool(PassTester* tester,
+                        const std::string& lookup_type,
+                        const std::string& pool_type,
+                        const DDim& ids_dims,
+                        bool int64_ids) {
+  std::vector<float> w_data(kVocabSize * kWidth);
+  for (size_t i = 0; i < w_data.size(); i++) {
+    w_data[i] = static_cast<float>((i * 37) % 23) / 23.f - 0.5f;
+  }
+  tester->AddWeight("w", DDim({kVocabSize, kWidth}), w_data);
+  tester
+      ->AddOp(lookup_type, {{"W", {"w"}}, {"Ids", {"ids"}}}, {{"Out", {"emb"}}})
+      ->SetAttr<int64_t>("padding_idx", kPaddingIdx);
+  tester
+      ->AddOp("sequence_pool",
+              {{"X", {"emb"}}},
+              {{"Out", {"out"}}, {"MaxIndex", {"max_index"}}})
+      ->SetAttr<std::string>("pooltype", pool_type);
+  tester->Build();
+
+  // The ids are set before the pass, which checks their shape and type.
+  auto* ids = tester->GetTensor("ids");
+  ids->Resize(ids_dims);
+  ids->set_lod({kOffsets});
+  for (int64_t i = 0; i < ids->numel(); i++) {
+    int64_t id = (i * 5) % kVocabSize;
+    if (int64_ids) {
+      ids->mutable_data<int64_t>()[i] = id;
+    } else {
+      ids->mutable_data<int32_t>()[i] = static_cast<int32_t>(id);
+    }
+  }
+}
+
+void TestFuse(const std::string& lookup_type,
+              const std::string& pool_type,
+              const DDim& ids_dims) {
+  PassTester unfused(kPlaces);
+  BuildEmbeddingPool(&unfused, lookup_type, pool_type, ids_dims, true);
+  unfused.Run();
+
+  PassTester fused(kPlaces);
+  BuildEmbeddingPool(&fused, lookup_type, pool_type, ids_dims, true);
+  fused.Apply("lite_embedding_seq_pool_fuse_pass");
+  EXPECT_EQ(fused.CountStmts("fused_embedding_seq_pool"), 1);
+  EXPECT_EQ(fused.CountStmts(lookup_type), 0);
+  EXPECT_EQ(fused.CountStmts("sequence_pool"), 0);
+  fused.Run();
+
+  auto* expected = unfused.GetTensor("out");
+  auto* out = fused.GetTensor("out");
+  ASSERT_EQ(out->dims(), expected->dims()) << lookup_type << " " << pool_type;
+  for (int64_t i = 0; i < out->numel(); i++) {
+    EXPECT_NEAR(out->data<float>()[i], expected->data<float>()[i], 1e-5)
+        << lookup_type << " " << pool_type;
+  }
+}
+
+void TestNotFuse(const std::string& lookup_type,
+                 const DDim& ids_dims,
+                 bool int64_ids) {
+  PassTester tester(kPlaces);
+  BuildEmbeddingPool(&tester, lookup_type, "SUM", ids_dims, int64_ids);
+  tester.Apply("lite_embedding_seq_pool_fuse_pass");
+  EXPECT_EQ(tester.CountStmts("fused_embedding_seq_pool"), 0) << lookup_type;
+  EXPECT_EQ(tester.CountStmts(lookup_type), 1) << lookup_type;
+  EXPECT_EQ(tester.CountStmts("sequence_pool"), 1) << lookup_type;
+}
+
+TEST(EmbeddingSeqPoolFusePass, fuse_lookup_table) {
+  int64_t num_ids = kOffsets.back();
+  for (auto pool_type : {"SUM", "AVERAGE"}) {
+    TestFuse("lookup_table", pool_type, DDim({num_ids, 1}));
+    TestFuse("lookup_table_v2", pool_type, DDim({num_ids}));
+  }
+}
+
+TEST(EmbeddingSeqPoolFusePass, keep_unsupported_ids) {
+  int64_t num_ids = kOffsets.back();
+  // The embeddings would not be [N, width].
+  TestNotFuse("lookup_table", DDim({num_ids}), true);
+  TestNotFuse("lookup_table_v2", DDim({num_ids, 1}), true);
+  // The fused kernel only reads the int64 ids.
+  TestNotFuse("lookup_table", DDim({num_ids, 1}), false);
+  TestNotFuse("lookup_table_v2", DDim({num_ids}), false);
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(lookup_table);
+USE_LITE_OP(lookup_table_v2);
+USE_LITE_OP(sequence_pool);
+USE_LITE_OP(fused_embedding_seq_pool);
+USE_LITE_KERNEL(lookup_table, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(lookup_table_v2, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(sequence_pool, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(fused_embedding_seq_pool, kX86, kFloat, kNCHW, def);
+USE_MIR_PASS(lite_embedding_seq_pool_fuse_pass);
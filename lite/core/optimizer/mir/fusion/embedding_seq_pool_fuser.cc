@@ -0,0 +1,115 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/fusion/embedding_seq_pool_fuser.h"
+#include <memory>
+#include <vector>
+
+namespace paddle {
+namespace lite {
+namespace mir {
+namespace fusion {
+
+void EmbeddingSeqPoolFuser::BuildPattern() {
+  // The ids are int64 [N, 1], or [N] for lookup_table_v2, so that the
+  // embeddings are [N, width].
+  auto ids_teller = [this](const Node* node) -> bool {
+    auto* op = node->stmt()->op().get();
+    auto* var = op->scope()->FindVar(op->op_info()->Input("Ids").front());
+    if (var == nullptr || !var->IsType<lite::Tensor>()) return false;
+    const auto& ids = var->Get<lite::Tensor>();
+    if (ids.precision() != PRECISION(kInt64)) return false;
+    const auto& dims = ids.dims();
+    if (lookup_type_ == "lookup_table") {
+      return dims.size() == 2 && dims[1] == 1;
+    }
+    return dims.size() == 1;
+  };
+  auto pool_type_teller = [](const std::string& pool_type) -> bool {
+    return pool_type == "SUM" || pool_type == "AVERAGE";
+  };
+
+  // create nodes.
+  auto* w = VarNode("w")
+                ->assert_is_op_input(lookup_type_, "W")
+                ->assert_is_persistable_var()
+                ->AsInput();
+  auto* ids =
+      VarNode("ids")->assert_is_op_input(lookup_type_, "Ids")->AsInput();
+  auto* lookup = OpNode("lookup", lookup_type_)
+                     ->assert_node_satisfied(ids_teller)
+                     ->AsIntermediate();
+  auto* emb = VarNode("emb")
+                  ->assert_is_op_output(lookup_type_, "Out")
+                  ->assert_is_op_input("sequence_pool", "X")
+                  ->AsIntermediate();
+  auto* pool = OpNode("pool", "sequence_pool")
+                   ->assert_op_attr_satisfied<std::string>("pooltype",
+                                                           pool_type_teller)
+                   ->AsIntermediate();
+  auto* out =
+      VarNode("out")->assert_is_op_output("sequence_pool", "Out")->AsOutput();
+  auto* max_index = VarNode("max_index")
+                        ->assert_is_op_output("sequence_pool", "MaxIndex")
+                        ->AsIntermediate();
+
+  // create topology.
+  std::vector<PMNode*> lookup_inputs{w, ids};
+  lookup_inputs >> *lookup >> *emb >> *pool >> *out;
+  *pool >> *max_index;
+}
+
+void EmbeddingSeqPoolFuser::InsertNewNode(SSAGraph* graph,
+                                          const key2nodes_t& matched) {
+  auto op_desc = GenOpDesc(matched);
+  auto fused_op = LiteOpRegistry::Global().Create("fused_embedding_seq_pool");
+  auto lookup = matched.at("lookup")->stmt()->op();
+  auto* scope = lookup->scope();
+  auto& valid_places = lookup->valid_places();
+  fused_op->Attach(op_desc, scope);
+
+  auto* new_op_node = graph->GraphCreateInstructNode(fused_op, valid_places);
+
+  IR_NODE_LINK_TO(matched.at("w"), new_op_node);
+  IR_NODE_LINK_TO(matched.at("ids"), new_op_node);
+  IR_NODE_LINK_TO(new_op_node, matched.at("out"));
+}
+
+cpp::OpDesc EmbeddingSeqPoolFuser::GenOpDesc(const key2nodes_t& matched) {
+  auto* lookup_info = matched.at("lookup")->stmt()->op_info();
+  auto* pool_info = matched.at("pool")->stmt()->op_info();
+  cpp::OpDesc op_desc;
+  op_desc.SetType("fused_embedding_seq_pool");
+  op_desc.SetInput("W", {matched.at("w")->arg()->name});
+  op_desc.SetInput("Ids", {matched.at("ids")->arg()->name});
+  op_desc.SetOutput("Out", {matched.at("out")->arg()->name});
+  int64_t padding_idx = -1;
+  if (lookup_info->HasAttr("padding_idx")) {
+    padding_idx = lookup_info->GetAttr<int64_t>("padding_idx");
+  }
+  op_desc.SetAttr<int64_t>("padding_idx", padding_idx);
+  auto pool_type = pool_info->GetAttr<std::string>("pooltype");
+  op_desc.SetAttr<std::string>("combiner", pool_type == "SUM" ? "sum" : "avg");
+  float pad_value = 0.f;
+  if (pool_info->HasAttr("pad_value")) {
+    pad_value = pool_info->GetAttr<float>("pad_value");
+  }
+  op_desc.SetAttr<float>("pad_value", pad_value);
+  return op_desc;
+}
+
+}  // namespace fusion
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
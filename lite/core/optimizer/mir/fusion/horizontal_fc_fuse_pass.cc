@@ -0,0 +1,327 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/fusion/horizontal_fc_fuse_pass.h"
+#include <list>
+#include <map>
+#include <utility>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pattern_matcher.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+struct GemmOpArgs {
+  std::string input;
+  std::string weight;
+  // The attributes which must be the same for the fused ops.
+  std::vector<std::string> attrs;
+};
+
+const std::map<std::string, GemmOpArgs> kGemmOps(
+    {{"fc",
+      {"Input",
+       "W",
+       {"in_num_col_dims", "activation_type", "alpha", "padding_weights"}}},
+     {"mul", {"X", "Y", {"x_num_col_dims", "y_num_col_dims"}}},
+     {"matmul", {"X", "Y", {"transpose_X", "transpose_Y", "alpha"}}},
+     {"matmul_v2", {"X", "Y", {"trans_x", "trans_y", "alpha"}}}});
+
+lite::Tensor* FindTensor(Scope* scope, const std::string& name) {
+  auto* var = scope->FindVar(name);
+  if (var == nullptr || !var->IsType<lite::Tensor>()) return nullptr;
+  return var->GetMutable<lite::Tensor>();
+}
+
+// Return the persistable float tensor of the only argument `param` of `op`,
+// or nullptr if there is none.
+lite::Tensor* FindWeight(const OpInfo* op_info,
+                         Scope* scope,
+                         const std::string& param) {
+  if (!op_info->HasInput(param) || op_info->Input(param).size() != 1) {
+    return nullptr;
+  }
+  auto* tensor = FindTensor(scope, op_info->Input(param).front());
+  if (tensor == nullptr || !tensor->persistable() ||
+      tensor->precision() != PRECISION(kFloat)) {
+    return nullptr;
+  }
+  return tensor;
+}
+
+std::string AttrString(const OpInfo* op_info, const std::string& name) {
+  if (!op_info->HasAttr(name)) return "";
+  switch (op_info->GetAttrType(name)) {
+    case OpAttrType::INT:
+      return std::to_string(op_info->GetAttr<int>(name));
+    case OpAttrType::FLOAT:
+      return std::to_string(op_info->GetAttr<float>(name));
+    case OpAttrType::BOOLEAN:
+      return std::to_string(op_info->GetAttr<bool>(name));
+    case OpAttrType::STRING:
+      return op_info->GetAttr<std::string>(name);
+    default:
+      return "?";
+  }
+}
+
+bool GetBoolAttr(const OpInfo* op_info, const std::string& name) {
+  return op_info->HasAttr(name) && op_info->GetAttr<bool>(name);
+}
+
+Node* ArgNode(const std::list<Node*>& links, const std::string& name) {
+  for (auto* node : links) {
+    if (node->arg()->name == name) return node;
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+void HorizontalFcFusePass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+  // Group the ops by their inputs and fusion keys, in the topological order.
+  std::map<std::pair<Node*, std::string>, std::vector<Node*>> groups;
+  std::vector<std::pair<Node*, std::string>> group_keys;
+  for (auto* node : graph->StmtTopologicalOrder()) {
+    if (!node->IsStmt()) continue;
+    auto key = FusionKey(node);
+    if (key.empty()) continue;
+    const auto* op_info = node->AsStmt().op_info();
+    const auto& input_name =
+        op_info->Input(kGemmOps.at(op_info->Type()).input).front();
+    auto group_key = std::make_pair(ArgNode(node->inlinks, input_name), key);
+    if (!groups.count(group_key)) group_keys.push_back(group_key);
+    groups[group_key].push_back(node);
+  }
+
+  int fused_ops = 0;
+  int fused_groups = 0;
+  std::set<const Node*> nodes2rm;
+  for (auto& group_key : group_keys) {
+    const auto& group = groups[group_key];
+    if (group.size() < 2) continue;
+    Fuse(graph.get(), group, &nodes2rm);
+    fused_ops += group.size();
+    fused_groups++;
+  }
+  GraphSafeRemoveNodes(graph.get(), nodes2rm);
+  if (fused_groups > 0) {
+    LOG(INFO) << "horizontal fc fusion: fused " << fused_ops << " ops into "
+              << fused_groups << " ops";
+  }
+}
+
+std::string HorizontalFcFusePass::FusionKey(Node* node) {
+  auto& stmt = node->AsStmt();
+  const auto* op_info = stmt.op_info();
+  auto op_type = op_info->Type();
+  auto it = kGemmOps.find(op_type);
+  if (it == kGemmOps.end()) return "";
+  const auto& args = it->second;
+  if (GetBoolAttr(op_info, "enable_int8") ||
+      GetBoolAttr(op_info, "padding_weights") ||
+      GetBoolAttr(op_info, "transpose_Y") || GetBoolAttr(op_info, "trans_y")) {
+    return "";
+  }
+  if (op_type == "mul" && op_info->GetAttr<int>("y_num_col_dims") != 1) {
+    return "";
+  }
+  if (!op_info->HasInput(args.input) ||
+      op_info->Input(args.input).size() != 1 ||
+      op_info->Output("Out").size() != 1) {
+    return "";
+  }
+  auto* x = ArgNode(node->inlinks, op_info->Input(args.input).front());
+  auto* out = ArgNode(node->outlinks, op_info->Output("Out").front());
+  if (x == nullptr || x->arg()->is_weight || out == nullptr ||
+      out->arg()->is_persist) {
+    return "";
+  }
+
+  auto* scope = stmt.op()->scope();
+  auto* weight = FindWeight(op_info, scope, args.weight);
+  if (weight == nullptr || weight->dims().size() != 2) return "";
+  int64_t n = weight->dims()[1];
+  bool with_bias =
+      op_info->HasInput("Bias") && !op_info->Input("Bias").empty();
+  if (with_bias) {
+    auto* bias = FindWeight(op_info, scope, "Bias");
+    if (bias == nullptr || bias->numel() != n) return "";
+  }
+
+  // The ops with the same input channels and attributes can be fused.
+  std::string key = op_type + ":" + std::to_string(weight->dims()[0]);
+  for (auto& attr : args.attrs) {
+    key += ":" + AttrString(op_info, attr);
+  }
+  return key;
+}
+
+void HorizontalFcFusePass::Fuse(SSAGraph* graph,
+                                const std::vector<Node*>& group,
+                                std::set<const Node*>* nodes2rm) {
+  auto* head = group.front();
+  const auto* head_info = head->AsStmt().op_info();
+  auto op_type = head_info->Type();
+  const auto& args = kGemmOps.at(op_type);
+  auto* scope = head->AsStmt().op()->scope();
+  auto* root_scope = scope->MutableParent() ? scope->MutableParent() : scope;
+  auto* x = ArgNode(head->inlinks, head_info->Input(args.input).front());
+
+  // Collect the weights, biases and outputs of the ops.
+  std::vector<lite::Tensor*> weights;
+  std::vector<lite::Tensor*> biases;
+  std::vector<Node*> outs;
+  std::vector<int> sections;
+  bool with_bias = false;
+  for (auto* node : group) {
+    const auto* op_info = node->AsStmt().op_info();
+    weights.push_back(FindWeight(op_info, scope, args.weight));
+    sections.push_back(weights.back()->dims()[1]);
+    lite::Tensor* bias = nullptr;
+    if (op_info->HasInput("Bias") && !op_info->Input("Bias").empty()) {
+      bias = FindWeight(op_info, scope, "Bias");
+      with_bias = true;
+    }
+    biases.push_back(bias);
+    outs.push_back(ArgNode(node->outlinks, op_info->Output("Out").front()));
+  }
+  int64_t k = weights.front()->dims()[0];
+  int64_t n = 0;
+  for (auto section : sections) {
+    n += section;
+  }
+
+  // Concatenate the weights along the output channels.
+  const auto& prefix = outs.front()->arg()->name;
+  auto fused_weight_name = prefix + "_horizontal_fused_weight";
+  auto* fused_weight = root_scope->Var(fused_weight_name)
+                           ->GetMutable<lite::Tensor>();
+  fused_weight->Resize({k, n});
+  auto* fused_weight_data = fused_weight->mutable_data<float>();
+  int64_t offset = 0;
+  for (size_t i = 0; i < group.size(); i++) {
+    const auto* weight_data = weights[i]->data<float>();
+    for (int64_t j = 0; j < k; j++) {
+      std::copy(weight_data + j * sections[i],
+                weight_data + (j + 1) * sections[i],
+                fused_weight_data + j * n + offset);
+    }
+    offset += sections[i];
+  }
+  fused_weight->set_persistable(true);
+  auto* fused_weight_node = graph->NewArgumentNode(fused_weight_name);
+  fused_weight_node->arg()->is_weight = true;
+  fused_weight_node->arg()->is_persist = true;
+
+  // Concatenate the biases, the missing ones are filled by zeros.
+  Node* fused_bias_node = nullptr;
+  std::string fused_bias_name = prefix + "_horizontal_fused_bias";
+  if (with_bias) {
+    auto* fused_bias =
+        root_scope->Var(fused_bias_name)->GetMutable<lite::Tensor>();
+    fused_bias->Resize({n});
+    auto* fused_bias_data = fused_bias->mutable_data<float>();
+    for (size_t i = 0; i < group.size(); i++) {
+      if (biases[i]) {
+        const auto* bias_data = biases[i]->data<float>();
+        std::copy(bias_data, bias_data + sections[i], fused_bias_data);
+      } else {
+        std::fill(fused_bias_data, fused_bias_data + sections[i], 0.f);
+      }
+      fused_bias_data += sections[i];
+    }
+    fused_bias->set_persistable(true);
+    fused_bias_node = graph->NewArgumentNode(fused_bias_name);
+    fused_bias_node->arg()->is_weight = true;
+    fused_bias_node->arg()->is_persist = true;
+  }
+
+  auto fused_out_name = prefix + "_horizontal_fused_out";
+  scope->Var(fused_out_name)->GetMutable<lite::Tensor>();
+  auto* fused_out_node = graph->NewArgumentNode(fused_out_name);
+
+  // The fused op, which has the same attributes as the original ones.
+  cpp::OpDesc fused_desc = *head_info;
+  fused_desc.SetInput(args.weight, {fused_weight_name});
+  if (with_bias) {
+    fused_desc.SetInput("Bias", {fused_bias_name});
+  }
+  fused_desc.SetOutput("Out", {fused_out_name});
+  auto fused_op = LiteOpRegistry::Global().Create(op_type);
+  fused_op->Attach(fused_desc, scope);
+  auto* fused_node =
+      graph->GraphCreateInstructNode(fused_op, graph->valid_places());
+  DirectedLink(x, fused_node);
+  DirectedLink(fused_weight_node, fused_node);
+  if (fused_bias_node) {
+    DirectedLink(fused_bias_node, fused_node);
+  }
+  DirectedLink(fused_node, fused_out_node);
+
+  // Split the fused output along the last dim.
+  int axis = -1;
+  if (op_type == "fc") {
+    axis = head_info->GetAttr<int>("in_num_col_dims");
+  } else if (op_type == "mul") {
+    axis = head_info->GetAttr<int>("x_num_col_dims");
+  }
+  std::vector<std::string> out_names;
+  for (auto* out : outs) {
+    out_names.push_back(out->arg()->name);
+  }
+  cpp::OpDesc split_desc;
+  split_desc.SetType("split");
+  split_desc.SetInput("X", {fused_out_name});
+  split_desc.SetOutput("Out", out_names);
+  split_desc.SetAttr<int>("axis", axis);
+  split_desc.SetAttr<int>("num", 0);
+  split_desc.SetAttr<std::vector<int>>("sections", sections);
+  split_desc.SetAttr<bool>("inplace", true);
+  auto split_op = LiteOpRegistry::Global().Create("split");
+  split_op->Attach(split_desc, scope);
+  auto* split_node =
+      graph->GraphCreateInstructNode(split_op, graph->valid_places());
+  DirectedLink(fused_out_node, split_node);
+
+  // Remove the original ops and their weights which aren't used by others,
+  // the memory of the weights is released since they're copied to the fused
+  // ones.
+  for (size_t i = 0; i < group.size(); i++) {
+    RemoveDirectedLink(group[i], outs[i]);
+    DirectedLink(split_node, outs[i]);
+    nodes2rm->insert(group[i]);
+    for (auto* in : group[i]->inlinks) {
+      if (in == x || in->outlinks.size() != 1) continue;
+      nodes2rm->insert(in);
+      auto* tensor = FindTensor(scope, in->arg()->name);
+      if (tensor != nullptr && tensor->persistable()) tensor->clear();
+    }
+  }
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(lite_horizontal_fc_fuse_pass,
+                  paddle::lite::mir::HorizontalFcFusePass)
+    .BindTargets({TARGET(kX86), TARGET(kARM)})
+    .ExcludeTargets({TARGET(kXPU),
+                     TARGET(kNNAdapter),
+                     TARGET(kOpenCL),
+                     TARGET(kMetal)});
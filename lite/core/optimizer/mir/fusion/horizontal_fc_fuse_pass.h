@@ -0,0 +1,63 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "lite/core/optimizer/mir/pass.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+/*
+ * Fuse the sibling GEMMs which read the same input, such as the Q, K and V
+ * projections of the attention blocks and the multi-task heads:
+ *
+ *       x                       x
+ *    /  |  \                    |
+ *  fc0 fc1 fc2      ->   fc(W0|W1|W2, b0|b1|b2)
+ *   |   |   |                   |
+ *  out0 out1 out2             split
+ *                            /  |  \
+ *                        out0 out1 out2
+ *
+ * The weights are concatenated along the output channels, so one larger
+ * GEMM is run instead of several small ones. The split is in-place, the
+ * outputs share the memory of the fused output if the leading dims are 1,
+ * e.g. the batch size is 1.
+ *
+ * The `fc`, `mul`, `matmul` and `matmul_v2` ops with the 2-D persistable
+ * float weights are fused if their types and attributes are the same.
+ */
+class HorizontalFcFusePass : public mir::StmtPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override;
+
+ private:
+  // Return the key of the ops which can be fused together, or an empty
+  // string if `node` can't be fused.
+  std::string FusionKey(Node* node);
+  void Fuse(SSAGraph* graph,
+            const std::vector<Node*>& group,
+            std::set<const Node*>* nodes2rm);
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
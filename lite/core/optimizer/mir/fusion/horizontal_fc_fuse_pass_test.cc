@@ -0,0 +1,137 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/pass_tester.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+const int kBatch = 3;
+const int kInChannels = 4;
+const int kNumSiblings = 3;
+
+const std::vector<Place> kPlaces{Place{TARGET(kX86), PRECISION(kFloat)},
+                                 Place{TARGET(kHost), PRECISION(kFloat)},
+                                 Place{TARGET(kHost), PRECISION(kAny)}};
+
+std::vector<float> MakeData(int64_t size, int seed) {
+  std::vector<float> data(size);
+  for (int64_t i = 0; i < size; i++) {
+    data[i] = static_cast<float>((i * 37 + seed * 101) % 23) / 23.f - 0.5f;
+  }
+  return data;
+}
+
+// out_i = op_type(x, w_i) + b_i for the siblings of 2, 3 and 4 output
+// channels, only the first and the last have the biases if `with_bias`.
+void BuildSiblings(PassTester* tester,
+                   const std::string& op_type,
+                   bool with_bias) {
+  for (int i = 0; i < kNumSiblings; i++) {
+    int n = i + 2;
+    auto w = "w" + std::to_string(i);
+    auto b = "b" + std::to_string(i);
+    auto out = "out" + std::to_string(i);
+    tester->AddWeight(
+        w, DDim({kInChannels, n}), MakeData(kInChannels * n, i + 1));
+    if (op_type == "fc") {
+      std::map<std::string, std::vector<std::string>> inputs{
+          {"Input", {"x"}}, {"W", {w}}};
+      if (with_bias && i != 1) {
+        tester->AddWeight(b, DDim({n}), MakeData(n, i + 10));
+        inputs["Bias"] = {b};
+      }
+      auto* fc = tester->AddOp("fc", inputs, {{"Out", {out}}});
+      fc->SetAttr<int>("in_num_col_dims", 1);
+      fc->SetAttr<std::string>("activation_type", "");
+    } else if (op_type == "mul") {
+      auto* mul =
+          tester->AddOp("mul", {{"X", {"x"}}, {"Y", {w}}}, {{"Out", {out}}});
+      mul->SetAttr<int>("x_num_col_dims", 1);
+      mul->SetAttr<int>("y_num_col_dims", 1);
+    } else {
+      auto* matmul = tester->AddOp(
+          "matmul_v2", {{"X", {"x"}}, {"Y", {w}}}, {{"Out", {out}}});
+      matmul->SetAttr<bool>("trans_x", false);
+      matmul->SetAttr<bool>("trans_y", false);
+    }
+  }
+  tester->Build();
+
+  auto* x = tester->GetTensor("x");
+  x->Resize({kBatch, kInChannels});
+  auto data = MakeData(kBatch * kInChannels, 0);
+  std::copy(data.begin(), data.end(), x->mutable_data<float>());
+}
+
+void TestFuseSiblings(const std::string& op_type, bool with_bias) {
+  PassTester unfused(kPlaces);
+  BuildSiblings(&unfused, op_type, with_bias);
+  unfused.Run();
+
+  PassTester fused(kPlaces);
+  BuildSiblings(&fused, op_type, with_bias);
+  fused.Apply("lite_horizontal_fc_fuse_pass");
+  EXPECT_EQ(fused.CountStmts(op_type), 1);
+  EXPECT_EQ(fused.CountStmts("split"), 1);
+  // The original weights are released, the fused ones are used instead.
+  for (int i = 0; i < kNumSiblings; i++) {
+    auto w = "w" + std::to_string(i);
+    EXPECT_FALSE(fused.GetTensor(w)->IsInitialized()) << w;
+  }
+  fused.Run();
+
+  for (int i = 0; i < kNumSiblings; i++) {
+    auto name = "out" + std::to_string(i);
+    auto* expected = unfused.GetTensor(name);
+    auto* out = fused.GetTensor(name);
+    ASSERT_EQ(out->dims(), expected->dims()) << op_type << " " << name;
+    for (int64_t j = 0; j < out->numel(); j++) {
+      EXPECT_NEAR(out->data<float>()[j], expected->data<float>()[j], 1e-5)
+          << op_type << " " << name;
+    }
+  }
+}
+
+TEST(HorizontalFcFusePass, fuse_fc) {
+  TestFuseSiblings("fc", true);
+  TestFuseSiblings("fc", false);
+}
+
+TEST(HorizontalFcFusePass, fuse_mul) { TestFuseSiblings("mul", false); }
+
+TEST(HorizontalFcFusePass, fuse_matmul_v2) {
+  TestFuseSiblings("matmul_v2", false);
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(fc);
+USE_LITE_OP(mul);
+USE_LITE_OP(matmul_v2);
+USE_LITE_OP(split);
+USE_LITE_KERNEL(fc, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(mul, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(matmul_v2, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(split, kHost, kFloat, kNCHW, def);
+USE_MIR_PASS(lite_horizontal_fc_fuse_pass);
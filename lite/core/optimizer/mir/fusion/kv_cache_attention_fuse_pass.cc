@@ -0,0 +1,310 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/core/optimizer/mir/fusion/kv_cache_attention_fuse_pass.h"
+#include <list>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pattern_matcher.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+namespace {
+
+lite::Tensor* FindTensor(Scope* scope, const std::string& name) {
+  auto* var = scope->FindVar(name);
+  if (var == nullptr || !var->IsType<lite::Tensor>()) return nullptr;
+  return var->GetMutable<lite::Tensor>();
+}
+
+template <typename T>
+T AttrOr(const OpInfo* op_info, const std::string& name, T default_value) {
+  return op_info->HasAttr(name) ? op_info->GetAttr<T>(name) : default_value;
+}
+
+bool IsOp(Node* node, const std::string& type) {
+  return node != nullptr && node->IsStmt() && node->AsStmt().op_type() == type;
+}
+
+Node* ArgNode(const std::list<Node*>& links, const std::string& name) {
+  for (auto* node : links) {
+    if (node->arg()->name == name) return node;
+  }
+  return nullptr;
+}
+
+// Return the node of the only input argument `param` of `op`, or nullptr.
+Node* InputNode(Node* op, const std::string& param) {
+  const auto* op_info = op->AsStmt().op_info();
+  if (!op_info->HasInput(param) || op_info->Input(param).size() != 1) {
+    return nullptr;
+  }
+  return ArgNode(op->inlinks, op_info->Input(param).front());
+}
+
+// Return the node of the only output argument `param` of `op`, or nullptr.
+Node* OutputNode(Node* op, const std::string& param) {
+  const auto* op_info = op->AsStmt().op_info();
+  if (!op_info->HasOutput(param) || op_info->Output(param).size() != 1) {
+    return nullptr;
+  }
+  return ArgNode(op->outlinks, op_info->Output(param).front());
+}
+
+Node* Producer(Node* var) {
+  return var != nullptr && var->inlinks.size() == 1 ? var->inlinks.front()
+                                                     : nullptr;
+}
+
+// Whether `var` is the intermediate result which is only used by `op`.
+bool IsIntermediate(Node* var, Node* op) {
+  return var != nullptr && !var->arg()->is_weight && !var->arg()->is_persist &&
+         var->outlinks.size() == 1 && var->outlinks.front() == op;
+}
+
+// Return the rank of `var`, or -1 if it's unknown.
+int Rank(Node* var, Scope* scope) {
+  auto* tensor = FindTensor(scope, var->arg()->name);
+  if (tensor == nullptr || tensor->dims().empty()) return -1;
+  return static_cast<int>(tensor->dims().size());
+}
+
+// Whether `op` is a float matmul whose X isn't transposed and Y is
+// transposed as `trans_y`.
+bool IsMatmul(Node* op, bool trans_y) {
+  if (!IsOp(op, "matmul") && !IsOp(op, "matmul_v2")) return false;
+  const auto* op_info = op->AsStmt().op_info();
+  if (AttrOr<bool>(op_info, "enable_int8", false)) return false;
+  if (op_info->Type() == "matmul") {
+    return !AttrOr<bool>(op_info, "transpose_X", false) &&
+           AttrOr<bool>(op_info, "transpose_Y", false) == trans_y;
+  }
+  return !AttrOr<bool>(op_info, "trans_x", false) &&
+         AttrOr<bool>(op_info, "trans_y", false) == trans_y;
+}
+
+// Whether `op` concatenates two tensors along the sequence axis, which is
+// the second to last one.
+bool IsSequenceConcat(Node* op) {
+  if (!IsOp(op, "concat")) return false;
+  const auto* op_info = op->AsStmt().op_info();
+  if (op_info->HasInput("AxisTensor") &&
+      !op_info->Input("AxisTensor").empty()) {
+    return false;
+  }
+  const auto& names = op_info->Input("X");
+  auto* out = OutputNode(op, "Out");
+  if (names.size() != 2 || names[0] == names[1] || out == nullptr) {
+    return false;
+  }
+  int axis = op_info->GetAttr<int>("axis");
+  if (axis == -2) return true;
+  int rank = Rank(out, op->AsStmt().op()->scope());
+  return rank >= 3 && axis == rank - 2;
+}
+
+}  // namespace
+
+void KVCacheAttentionFusePass::Apply(const std::unique_ptr<SSAGraph>& graph) {
+  int fused = 0;
+  std::set<const Node*> nodes2rm;
+  for (auto* node : graph->StmtTopologicalOrder()) {
+    if (!IsOp(node, "softmax")) continue;
+    Attention attention;
+    if (!Match(node, &attention)) continue;
+    Fuse(graph.get(), attention, &nodes2rm);
+    fused++;
+  }
+  GraphSafeRemoveNodes(graph.get(), nodes2rm);
+  if (fused > 0) {
+    LOG(INFO) << "kv cache attention fusion: fused " << fused << " attentions";
+  }
+}
+
+bool KVCacheAttentionFusePass::Match(Node* softmax, Attention* attention) {
+  auto* scope = softmax->AsStmt().op()->scope();
+  const auto* softmax_info = softmax->AsStmt().op_info();
+  auto* x = InputNode(softmax, "X");
+  auto* probs = OutputNode(softmax, "Out");
+  if (x == nullptr || probs == nullptr || probs->outlinks.size() != 1) {
+    return false;
+  }
+  int axis = AttrOr<int>(softmax_info, "axis", -1);
+  if (axis != -1 && axis != Rank(x, scope) - 1) return false;
+  attention->softmax = softmax;
+
+  auto* qkv_matmul = probs->outlinks.front();
+  if (!IsMatmul(qkv_matmul, false) || InputNode(qkv_matmul, "X") != probs ||
+      AttrOr<float>(qkv_matmul->AsStmt().op_info(), "alpha", 1.f) != 1.f ||
+      !IsIntermediate(probs, qkv_matmul)) {
+    return false;
+  }
+  attention->qkv_matmul = qkv_matmul;
+
+  // Walk up from softmax through the optional mask and scale.
+  float alpha = 1.f;
+  Node* var = x;
+  Node* consumer = softmax;
+  Node* op = Producer(var);
+  if (IsOp(op, "elementwise_add")) {
+    const auto* op_info = op->AsStmt().op_info();
+    if (!IsIntermediate(var, consumer) || InputNode(op, "Y") == nullptr ||
+        AttrOr<int>(op_info, "axis", -1) != -1) {
+      return false;
+    }
+    attention->add = op;
+    consumer = op;
+    var = InputNode(op, "X");
+    op = Producer(var);
+  }
+  if (IsOp(op, "scale")) {
+    const auto* op_info = op->AsStmt().op_info();
+    if (!IsIntermediate(var, consumer) ||
+        op_info->GetAttr<float>("bias") != 0.f ||
+        !AttrOr<std::string>(op_info, "activation_type", "").empty()) {
+      return false;
+    }
+    alpha *= op_info->GetAttr<float>("scale");
+    attention->scale = op;
+    consumer = op;
+    var = InputNode(op, "X");
+    op = Producer(var);
+  }
+  if (!IsMatmul(op, true) || !IsIntermediate(var, consumer) ||
+      InputNode(op, "X") == nullptr) {
+    return false;
+  }
+  alpha *= AttrOr<float>(op->AsStmt().op_info(), "alpha", 1.f);
+  attention->qk_matmul = op;
+  attention->alpha = alpha;
+
+  attention->k_concat = Producer(InputNode(op, "Y"));
+  attention->v_concat = Producer(InputNode(qkv_matmul, "Y"));
+  return IsSequenceConcat(attention->k_concat) &&
+         IsSequenceConcat(attention->v_concat) &&
+         attention->k_concat != attention->v_concat;
+}
+
+void KVCacheAttentionFusePass::Fuse(SSAGraph* graph,
+                                    const Attention& attention,
+                                    std::set<const Node*>* nodes2rm) {
+  auto* scope = attention.qk_matmul->AsStmt().op()->scope();
+  auto* q = InputNode(attention.qk_matmul, "X");
+  auto* out = OutputNode(attention.qkv_matmul, "Out");
+  Node* concats[2] = {attention.k_concat, attention.v_concat};
+  Node* matmuls[2] = {attention.qk_matmul, attention.qkv_matmul};
+  Node* pasts[2];
+  Node* curs[2];
+  Node* concat_outs[2];
+  bool with_present = false;
+  for (int i = 0; i < 2; i++) {
+    const auto& names = concats[i]->AsStmt().op_info()->Input("X");
+    pasts[i] = ArgNode(concats[i]->inlinks, names[0]);
+    curs[i] = ArgNode(concats[i]->inlinks, names[1]);
+    concat_outs[i] = OutputNode(concats[i], "Out");
+    if (!IsIntermediate(concat_outs[i], matmuls[i])) with_present = true;
+  }
+
+  // The presents are the concatenated keys and values, or the pasts if
+  // they're only assigned back to the pasts, which aren't used by others.
+  Node* presents[2] = {nullptr, nullptr};
+  Node* present_producers[2] = {nullptr, nullptr};
+  for (int i = 0; i < 2 && with_present; i++) {
+    presents[i] = concat_outs[i];
+    present_producers[i] = concats[i];
+    auto* concat_out = concat_outs[i];
+    if (concat_out->arg()->is_persist || concat_out->outlinks.size() != 2 ||
+        pasts[i]->outlinks.size() != 1) {
+      continue;
+    }
+    auto* assign = concat_out->outlinks.front() == matmuls[i]
+                       ? concat_out->outlinks.back()
+                       : concat_out->outlinks.front();
+    if (!IsOp(assign, "assign")) continue;
+    auto* assign_out = OutputNode(assign, "Out");
+    if (assign_out == nullptr ||
+        assign_out->arg()->name != pasts[i]->arg()->name) {
+      continue;
+    }
+    presents[i] = assign_out;
+    present_producers[i] = assign;
+    nodes2rm->insert(assign);
+    nodes2rm->insert(concat_out);
+  }
+
+  cpp::OpDesc fused_desc;
+  fused_desc.SetType("kv_cache_attention");
+  fused_desc.SetInput("Q", {q->arg()->name});
+  fused_desc.SetInput("K", {curs[0]->arg()->name});
+  fused_desc.SetInput("V", {curs[1]->arg()->name});
+  fused_desc.SetInput("PastK", {pasts[0]->arg()->name});
+  fused_desc.SetInput("PastV", {pasts[1]->arg()->name});
+  Node* mask = nullptr;
+  if (attention.add) {
+    mask = InputNode(attention.add, "Y");
+    fused_desc.SetInput("Mask", {mask->arg()->name});
+  }
+  fused_desc.SetOutput("Out", {out->arg()->name});
+  if (with_present) {
+    fused_desc.SetOutput("PresentK", {presents[0]->arg()->name});
+    fused_desc.SetOutput("PresentV", {presents[1]->arg()->name});
+  }
+  fused_desc.SetAttr<float>("alpha", attention.alpha);
+  auto fused_op = LiteOpRegistry::Global().Create("kv_cache_attention");
+  fused_op->Attach(fused_desc, scope);
+  auto* fused_node =
+      graph->GraphCreateInstructNode(fused_op, graph->valid_places());
+
+  for (auto* in : {q, curs[0], curs[1], pasts[0], pasts[1], mask}) {
+    if (in) DirectedLink(in, fused_node);
+  }
+  RemoveDirectedLink(attention.qkv_matmul, out);
+  DirectedLink(fused_node, out);
+  for (int i = 0; i < 2; i++) {
+    if (with_present) {
+      RemoveDirectedLink(present_producers[i], presents[i]);
+      DirectedLink(fused_node, presents[i]);
+    } else {
+      nodes2rm->insert(concat_outs[i]);
+    }
+    nodes2rm->insert(concats[i]);
+  }
+
+  // Remove the ops of the attention and their intermediate results.
+  for (auto* op : {attention.qk_matmul,
+                   attention.scale,
+                   attention.add,
+                   attention.softmax,
+                   attention.qkv_matmul}) {
+    if (op == nullptr) continue;
+    nodes2rm->insert(op);
+    if (op != attention.qkv_matmul) nodes2rm->insert(OutputNode(op, "Out"));
+  }
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_MIR_PASS(kv_cache_attention_fuse_pass,
+                  paddle::lite::mir::KVCacheAttentionFusePass)
+    .BindTargets({TARGET(kX86), TARGET(kARM)})
+    .ExcludeTargets({TARGET(kXPU),
+                     TARGET(kNNAdapter),
+                     TARGET(kOpenCL),
+                     TARGET(kMetal)})
+    .BindKernel("kv_cache_attention");
@@ -0,0 +1,75 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <set>
+#include "lite/core/optimizer/mir/pass.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+/*
+ * Fuse the attention over the concatenated past keys and values of the
+ * autoregressive decoders into `kv_cache_attention`:
+ *
+ *   past_k  k                 past_v  v
+ *       \  /                      \  /
+ *      concat(axis=-2)           concat(axis=-2)
+ *         |                         |
+ *  q -> matmul(trans_y)             |
+ *         |                         |
+ *      [scale]                      |
+ *         |                         |
+ *   [elementwise_add(mask)]         |
+ *         |                         |
+ *      softmax(axis=-1) -------> matmul -> out
+ *
+ * The fused kernel reads the past and new keys and values without
+ * concatenating them. The concatenated ones are kept as the PresentK and
+ * PresentV outputs only if they're used by other ops. If they're only
+ * assigned back to the past ones, as the loop-carried caches of `while`,
+ * the assigns are removed and the caches are appended in place, in the
+ * memory reserved by the fused kernel so they aren't reallocated per token.
+ * They stay dense, so they're still read as they are after the loop.
+ */
+class KVCacheAttentionFusePass : public mir::StmtPass {
+ public:
+  void Apply(const std::unique_ptr<SSAGraph>& graph) override;
+
+ private:
+  struct Attention {
+    Node* qk_matmul{nullptr};
+    Node* scale{nullptr};
+    Node* add{nullptr};
+    Node* softmax{nullptr};
+    Node* qkv_matmul{nullptr};
+    Node* k_concat{nullptr};
+    Node* v_concat{nullptr};
+    float alpha{1.f};
+  };
+
+  // Match the attention pattern ending with `softmax`.
+  bool Match(Node* softmax, Attention* attention);
+  void Fuse(SSAGraph* graph,
+            const Attention& attention,
+            std::set<const Node*>* nodes2rm);
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,181 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+#include "lite/core/optimizer/mir/pass_registry.h"
+#include "lite/core/optimizer/mir/pass_tester.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+const int kHeads = 2;
+const int kPastLen = 3;
+const int kNewLen = 1;
+const int kHeadDim = 4;
+
+void FillTensor(PassTester* tester,
+                const std::string& name,
+                const DDim& dims,
+                int seed) {
+  auto* x = tester->GetTensor(name);
+  x->Resize(dims);
+  auto* data = x->mutable_data<float>();
+  for (int64_t i = 0; i < x->numel(); i++) {
+    data[i] = static_cast<float>((i * 37 + seed * 101) % 23) / 23.f - 0.5f;
+  }
+}
+
+// out = softmax(0.5 * q * concat(past_k, k)^T + mask) * concat(past_v, v),
+// and the concatenated caches are assigned back to the past ones if
+// `assign_back`, as the loop-carried caches of `while`.
+void BuildAttention(PassTester* tester, bool assign_back) {
+  auto* k_concat = tester->AddOp(
+      "concat", {{"X", {"past_k", "k"}}}, {{"Out", {"present_k"}}});
+  k_concat->SetAttr<int>("axis", -2);
+  auto* v_concat = tester->AddOp(
+      "concat", {{"X", {"past_v", "v"}}}, {{"Out", {"present_v"}}});
+  v_concat->SetAttr<int>("axis", -2);
+  auto* qk_matmul = tester->AddOp(
+      "matmul", {{"X", {"q"}}, {"Y", {"present_k"}}}, {{"Out", {"qk"}}});
+  qk_matmul->SetAttr<bool>("transpose_X", false);
+  qk_matmul->SetAttr<bool>("transpose_Y", true);
+  qk_matmul->SetAttr<float>("alpha", 1.f);
+  auto* scale = tester->AddOp("scale", {{"X", {"qk"}}}, {{"Out", {"scores"}}});
+  scale->SetAttr<float>("scale", 0.5f);
+  scale->SetAttr<float>("bias", 0.f);
+  scale->SetAttr<bool>("bias_after_scale", true);
+  auto* add = tester->AddOp("elementwise_add",
+                            {{"X", {"scores"}}, {"Y", {"mask"}}},
+                            {{"Out", {"masked_scores"}}});
+  add->SetAttr<int>("axis", -1);
+  auto* softmax = tester->AddOp(
+      "softmax", {{"X", {"masked_scores"}}}, {{"Out", {"probs"}}});
+  softmax->SetAttr<int>("axis", -1);
+  auto* qkv_matmul = tester->AddOp(
+      "matmul", {{"X", {"probs"}}, {"Y", {"present_v"}}}, {{"Out", {"out"}}});
+  qkv_matmul->SetAttr<bool>("transpose_X", false);
+  qkv_matmul->SetAttr<bool>("transpose_Y", false);
+  qkv_matmul->SetAttr<float>("alpha", 1.f);
+  if (assign_back) {
+    tester->AddOp("assign", {{"X", {"present_k"}}}, {{"Out", {"past_k"}}});
+    tester->AddOp("assign", {{"X", {"present_v"}}}, {{"Out", {"past_v"}}});
+  }
+  tester->Build();
+
+  FillTensor(tester, "q", DDim({1, kHeads, kNewLen, kHeadDim}), 0);
+  FillTensor(tester, "k", DDim({1, kHeads, kNewLen, kHeadDim}), 1);
+  FillTensor(tester, "v", DDim({1, kHeads, kNewLen, kHeadDim}), 2);
+  FillTensor(tester, "past_k", DDim({1, kHeads, kPastLen, kHeadDim}), 3);
+  FillTensor(tester, "past_v", DDim({1, kHeads, kPastLen, kHeadDim}), 4);
+  FillTensor(
+      tester, "mask", DDim({1, kHeads, kNewLen, kPastLen + kNewLen}), 5);
+}
+
+void ExpectFused(PassTester* tester) {
+  EXPECT_EQ(tester->CountStmts("kv_cache_attention"), 1);
+  for (auto op_type :
+       {"concat", "matmul", "scale", "elementwise_add", "softmax"}) {
+    EXPECT_EQ(tester->CountStmts(op_type), 0) << op_type;
+  }
+}
+
+void ExpectNear(Tensor* out, Tensor* expected) {
+  ASSERT_EQ(out->dims(), expected->dims());
+  for (int64_t i = 0; i < out->numel(); i++) {
+    EXPECT_NEAR(out->data<float>()[i], expected->data<float>()[i], 1e-5);
+  }
+}
+
+const std::vector<Place> kPlaces{Place{TARGET(kX86), PRECISION(kFloat)},
+                                 Place{TARGET(kHost), PRECISION(kFloat)},
+                                 Place{TARGET(kHost), PRECISION(kAny)}};
+
+TEST(KVCacheAttentionFusePass, fuse_attention) {
+  PassTester unfused(kPlaces);
+  BuildAttention(&unfused, false);
+  unfused.Run();
+
+  PassTester fused(kPlaces);
+  BuildAttention(&fused, false);
+  fused.Apply("kv_cache_attention_fuse_pass");
+  ExpectFused(&fused);
+  // The concatenated caches aren't kept, since no other op uses them.
+  for (auto& node : fused.graph()->nodes()) {
+    if (!node.IsStmt()) continue;
+    EXPECT_FALSE(node.stmt()->op_info()->HasOutput("PresentK"));
+  }
+  fused.Run();
+  ExpectNear(fused.GetTensor("out"), unfused.GetTensor("out"));
+}
+
+TEST(KVCacheAttentionFusePass, append_in_place) {
+  PassTester unfused(kPlaces);
+  BuildAttention(&unfused, true);
+  unfused.Run();
+
+  PassTester fused(kPlaces);
+  BuildAttention(&fused, true);
+  fused.Apply("kv_cache_attention_fuse_pass");
+  ExpectFused(&fused);
+  // The assigns are removed, the past caches are appended in place.
+  EXPECT_EQ(fused.CountStmts("assign"), 0);
+  for (auto& node : fused.graph()->nodes()) {
+    if (!node.IsStmt()) continue;
+    const auto* op_info = node.stmt()->op_info();
+    EXPECT_EQ(op_info->Output("PresentK"), std::vector<std::string>{"past_k"});
+    EXPECT_EQ(op_info->Output("PresentV"), std::vector<std::string>{"past_v"});
+  }
+  fused.Run();
+  ExpectNear(fused.GetTensor("out"), unfused.GetTensor("out"));
+
+  // Decode the next token from the caches of both, which are read after the
+  // step as the dense ones.
+  for (auto* tester : {&unfused, &fused}) {
+    FillTensor(tester, "q", DDim({1, kHeads, kNewLen, kHeadDim}), 6);
+    FillTensor(tester, "k", DDim({1, kHeads, kNewLen, kHeadDim}), 7);
+    FillTensor(tester, "v", DDim({1, kHeads, kNewLen, kHeadDim}), 8);
+    FillTensor(tester,
+               "mask",
+               DDim({1, kHeads, kNewLen, kPastLen + 2 * kNewLen}),
+               9);
+    tester->Run();
+  }
+  ExpectNear(fused.GetTensor("out"), unfused.GetTensor("out"));
+  ExpectNear(fused.GetTensor("past_k"), unfused.GetTensor("past_k"));
+  ExpectNear(fused.GetTensor("past_v"), unfused.GetTensor("past_v"));
+}
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_OP(concat);
+USE_LITE_OP(matmul);
+USE_LITE_OP(scale);
+USE_LITE_OP(elementwise_add);
+USE_LITE_OP(softmax);
+USE_LITE_OP(assign);
+USE_LITE_OP(kv_cache_attention);
+USE_LITE_KERNEL(concat, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(matmul, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(scale, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(elementwise_add, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(softmax, kX86, kFloat, kNCHW, def);
+USE_LITE_KERNEL(assign, kHost, kAny, kAny, def);
+USE_LITE_KERNEL(kv_cache_attention, kHost, kFloat, kAny, def);
+USE_MIR_PASS(kv_cache_attention_fuse_pass);
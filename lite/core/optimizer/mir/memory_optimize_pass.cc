@@ -109,6 +109,24 @@ void MemoryOptimizePass::CollectLifeCycleByDevice(
 
   // Collect the invalid input and output variables that will not be reused.
   std::set<std::string> invalid_var_names;
+  auto insert_invalid_var_names =
+      [&](const OpInfo* op_info,
+          const std::pair<std::set<std::string>, std::set<std::string>>&
+              params) {
+        for (auto& in_param_name : params.first) {
+          if (op_info->HasInput(in_param_name)) {
+            const auto& in_arg_names = op_info->Input(in_param_name);
+            invalid_var_names.insert(in_arg_names.begin(), in_arg_names.end());
+          }
+        }
+        for (auto& out_param_name : params.second) {
+          if (op_info->HasOutput(out_param_name)) {
+            const auto& out_arg_names = op_info->Output(out_param_name);
+            invalid_var_names.insert(out_arg_names.begin(),
+                                     out_arg_names.end());
+          }
+        }
+      };
   for (auto& op_node : graph->StmtTopologicalOrder()) {
     // variables of invalid_op_nodes wil not be reused
     if (!op_node->IsStmt()) continue;
@@ -126,6 +144,23 @@ void MemoryOptimizePass::CollectLifeCycleByDevice(
       }
       continue;
     }
+    // The outputs of the sequence padding ops may share the storage of their
+    // inputs if the layouts coincide (see host/math/sequence_view.h), and the
+    // output of tensor_array_to_tensor may view the arena of its input array,
+    // so the specified input and output variables will not be reused
+    std::map<std::string,
+             std::pair<std::set<std::string>, std::set<std::string>>>
+        view_op_nodes = {{"sequence_pad", {{"X"}, {"Out"}}},
+                         {"sequence_unpad", {{"X"}, {"Out"}}},
+                         {"sequence_expand", {{"X"}, {"Out"}}},
+                         {"search_group_padding", {{"X"}, {"Out_emb_padding"}}},
+                         {"search_seq_depadding", {{"Pad"}, {"Out"}}},
+                         {"tensor_array_to_tensor", {{"X"}, {"Out"}}}};
+    auto view_op_node = view_op_nodes.find(op_type);
+    if (view_op_node != view_op_nodes.end()) {
+      insert_invalid_var_names(op_info, view_op_node->second);
+      continue;
+    }
     // The specified input and output variables of the Ops whose 'inplace' attr
     // is true will not be reused, such as reshape/reshape2's X and Out
     // variables
@@ -135,6 +170,7 @@ void MemoryOptimizePass::CollectLifeCycleByDevice(
                             {"reshape2", {{"X"}, {"Out"}}},
                             {"flatten", {{"X"}, {"Out"}}},
                             {"flatten2", {{"X"}, {"Out"}}},
+                            {"split", {{"X"}, {"Out"}}},
                             {"squeeze", {{"X"}, {"Out"}}},
                             {"squeeze2", {{"X"}, {{"Out"}, {"XShape"}}}},
                             {"unsqueeze", {{"X"}, {"Out"}}},
@@ -146,19 +182,7 @@ void MemoryOptimizePass::CollectLifeCycleByDevice(
         inplace = op_info->GetAttr<bool>("inplace");
       }
       if (inplace) {
-        for (auto& in_param_name : inplace_op_node->second.first) {
-          if (op_info->HasInput(in_param_name)) {
-            const auto& in_arg_names = op_info->Input(in_param_name);
-            invalid_var_names.insert(in_arg_names.begin(), in_arg_names.end());
-          }
-        }
-        for (auto& out_param_name : inplace_op_node->second.second) {
-          if (op_info->HasOutput(out_param_name)) {
-            const auto& out_arg_names = op_info->Output(out_param_name);
-            invalid_var_names.insert(out_arg_names.begin(),
-                                     out_arg_names.end());
-          }
-        }
+        insert_invalid_var_names(op_info, inplace_op_node->second);
       }
     }
   }
@@ -0,0 +1,162 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "lite/core/context.h"
+#include "lite/core/optimizer/mir/pass_manager.h"
+#include "lite/core/optimizer/mir/ssa_graph.h"
+#include "lite/core/program.h"
+#include "lite/model_parser/cpp_desc.h"
+
+namespace paddle {
+namespace lite {
+namespace mir {
+
+/*
+ * The helper of the pass tests: a one block program is described op by op,
+ * converted to a graph, transformed by the passes under test, then the
+ * statements left in the graph are run in topological order with the
+ * kernels of `places`, so that the outputs can be compared with the ones of
+ * the untransformed program.
+ */
+class PassTester {
+ public:
+  explicit PassTester(const std::vector<Place>& places)
+      : places_(places),
+        program_desc_(std::make_shared<cpp::ProgramDesc>()),
+        scope_(std::make_shared<Scope>()) {
+    block_desc_ = program_desc_->AddBlock<cpp::BlockDesc>();
+    block_desc_->ClearOps();
+    block_desc_->ClearVars();
+  }
+
+  // Add a persistable float tensor, which is visible to all the ops.
+  void AddWeight(const std::string& name,
+                 const DDim& dims,
+                 const std::vector<float>& data) {
+    CHECK_EQ(static_cast<int64_t>(data.size()), dims.production());
+    auto* var_desc = AddVarDesc(name);
+    var_desc->SetPersistable(true);
+    auto* tensor = scope_->Var(name)->GetMutable<Tensor>();
+    tensor->Resize(dims);
+    std::copy(data.begin(), data.end(), tensor->mutable_data<float>());
+    tensor->set_persistable(true);
+  }
+
+  // Add a non-persistable tensor array, such as the output of
+  // write_to_array.
+  void AddTensorArray(const std::string& name) {
+    AddVarDesc(name)->SetType(VarDescAPI::Type::LOD_TENSOR_ARRAY);
+  }
+
+  // Add an op, the vars which are not added yet are added as the
+  // non-persistable ones, except `feed` and `fetch` which are created by the
+  // program.
+  cpp::OpDesc* AddOp(
+      const std::string& op_type,
+      const std::map<std::string, std::vector<std::string>>& inputs,
+      const std::map<std::string, std::vector<std::string>>& outputs) {
+    auto* op_desc = block_desc_->AddOp<cpp::OpDesc>();
+    op_desc->SetType(op_type);
+    for (auto& it : inputs) {
+      for (auto& name : it.second) AddVarDesc(name);
+      op_desc->SetInput(it.first, it.second);
+    }
+    for (auto& it : outputs) {
+      for (auto& name : it.second) AddVarDesc(name);
+      op_desc->SetOutput(it.first, it.second);
+    }
+    return op_desc;
+  }
+
+  // Create the ops and the graph, the attributes of the ops should be set
+  // before.
+  void Build() {
+    program_.reset(new Program(program_desc_, scope_, places_));
+    graph_.reset(new SSAGraph);
+    graph_->Build(*program_, places_);
+  }
+
+  void Apply(const std::string& pass_name) {
+    auto* pass = PassManager::Global().LookUp(pass_name);
+    CHECK(pass) << "No pass called " << pass_name;
+    pass->Apply(graph_);
+  }
+
+  // Run the statements of the graph in topological order.
+  void Run() {
+    for (auto* node : graph_->StmtTopologicalOrder()) {
+      auto* op = node->AsStmt().op().get();
+      CHECK(op->CheckShape());
+      op->InferShape();
+      auto kernels = op->CreateKernels(places_);
+      CHECK(!kernels.empty()) << "No kernel for " << node->AsStmt().op_type();
+      size_t picked = 0;
+      for (size_t i = 0; i < kernels.size(); i++) {
+        if (kernels[i]->alias() == "def") picked = i;
+      }
+      auto& kernel = kernels[picked];
+      kernel->SetContext(
+          ContextScheduler::Global().NewContext(kernel->target()));
+      kernel->Launch();
+    }
+  }
+
+  Tensor* GetTensor(const std::string& name) {
+    auto* var = program_->exec_scope()->FindVar(name);
+    CHECK(var) << "No var called " << name;
+    return var->GetMutable<Tensor>();
+  }
+
+  // The number of the statements of `op_type` in the graph.
+  int CountStmts(const std::string& op_type) {
+    int count = 0;
+    for (auto& node : graph_->nodes()) {
+      if (node.IsStmt() && node.stmt()->op_type() == op_type) count++;
+    }
+    return count;
+  }
+
+  const std::unique_ptr<SSAGraph>& graph() { return graph_; }
+
+ private:
+  cpp::VarDesc* AddVarDesc(const std::string& name) {
+    if (name == "feed" || name == "fetch") return nullptr;
+    if (var_descs_.count(name)) return var_descs_[name];
+    auto* var_desc = block_desc_->AddVar<cpp::VarDesc>();
+    var_desc->SetName(name);
+    var_desc->SetType(VarDescAPI::Type::LOD_TENSOR);
+    var_desc->SetPersistable(false);
+    var_descs_[name] = var_desc;
+    return var_desc;
+  }
+
+  std::vector<Place> places_;
+  std::shared_ptr<cpp::ProgramDesc> program_desc_;
+  cpp::BlockDesc* block_desc_{nullptr};
+  std::shared_ptr<Scope> scope_;
+  std::map<std::string, cpp::VarDesc*> var_descs_;
+  std::unique_ptr<Program> program_;
+  std::unique_ptr<SSAGraph> graph_;
+};
+
+}  // namespace mir
+}  // namespace lite
+}  // namespace paddle
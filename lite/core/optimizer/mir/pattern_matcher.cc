@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <array>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -116,10 +117,43 @@ void PatternMatcher::operator()(SSAGraph *graph,
 bool PatternMatcher::MarkPMNodesInGraph(SSAGraph *graph) {
   VLOG(3) << "mark pmnodes in graph";
   if (graph->nodes().empty()) return false;
-  for (auto &node : graph->mutable_nodes()) {
-    for (const auto &pmnode : pattern_.nodes()) {
-      if (pmnode->Tell(&node)) {
-        pmnodes2nodes_[pmnode.get()].insert(&node);
+  // Index the ops by type, so that the PMNodes with the candidate hints only
+  // tell the nodes around the ops of the type instead of the whole graph.
+  std::map<std::string, std::vector<Node *>> ops_by_type;
+  for (const auto &pmnode : pattern_.nodes()) {
+    if (pmnode->candidates() == PMNode::Candidates::kAll) continue;
+    for (auto &node : graph->mutable_nodes()) {
+      if (node.IsStmt() && node.AsStmt().op()) {
+        ops_by_type[node.AsStmt().op_type()].push_back(&node);
+      }
+    }
+    break;
+  }
+  for (const auto &pmnode : pattern_.nodes()) {
+    auto candidates = pmnode->candidates();
+    if (candidates == PMNode::Candidates::kAll) {
+      for (auto &node : graph->mutable_nodes()) {
+        if (pmnode->Tell(&node)) {
+          pmnodes2nodes_[pmnode.get()].insert(&node);
+        }
+      }
+      continue;
+    }
+    auto it = ops_by_type.find(pmnode->candidate_op_type());
+    if (it == ops_by_type.end()) continue;
+    for (auto *op : it->second) {
+      if (candidates == PMNode::Candidates::kOp) {
+        if (pmnode->Tell(op)) {
+          pmnodes2nodes_[pmnode.get()].insert(op);
+        }
+        continue;
+      }
+      auto &vars = candidates == PMNode::Candidates::kOpInput ? op->inlinks
+                                                               : op->outlinks;
+      for (auto *var : vars) {
+        if (pmnode->Tell(var)) {
+          pmnodes2nodes_[pmnode.get()].insert(var);
+        }
       }
     }
   }
@@ -230,24 +264,66 @@ std::vector<PatternMatcher::subgraph_t> PatternMatcher::DetectPatterns() {
     cur_groups.clear();
     if (pre_groups.empty()) break;
     // source -> target
-    for (Node *source : pmnodes2nodes_[edge.first]) {
-      for (Node *target : pmnodes2nodes_[edge.second]) {
-        // TODO(Superjomn) add some prune strategies.
-        for (const auto &group : pre_groups) {
-          if (IsNodesLink(source, target)) {
-            HitGroup new_group = group;
-            bool flag = new_group.Match(source, edge.first) &&
-                        new_group.Match(target, edge.second);
-            if (flag) {
-              new_group.Register(source, edge.first);
-              new_group.Register(target, edge.second);
-              cur_groups.push_back(new_group);
-              // TODO(Superjomn) need to unique
+    // Only the neighbors of the nodes already in a group are visited, and the
+    // new groups are sorted as if all the candidate pairs are enumerated, so
+    // that the overlapped matches are resolved in the same order.
+    auto &sources = pmnodes2nodes_[edge.first];
+    auto &targets = pmnodes2nodes_[edge.second];
+    struct Hit {
+      Node *source;
+      Node *target;
+      HitGroup group;
+    };
+    std::vector<Hit> hits;
+    auto try_hit = [&](const HitGroup &group, Node *source, Node *target) {
+      HitGroup new_group = group;
+      bool flag = new_group.Match(source, edge.first) &&
+                  new_group.Match(target, edge.second);
+      if (flag) {
+        new_group.Register(source, edge.first);
+        new_group.Register(target, edge.second);
+        hits.push_back(Hit{source, target, std::move(new_group)});
+        // TODO(Superjomn) need to unique
+      }
+    };
+    for (const auto &group : pre_groups) {
+      auto source_it = group.roles.find(edge.first);
+      auto target_it = group.roles.find(edge.second);
+      if (source_it != group.roles.end()) {
+        Node *source = source_it->second;
+        if (!sources.count(source)) continue;
+        std::set<Node *> visited;
+        for (auto *target : source->outlinks) {
+          if (targets.count(target) && visited.insert(target).second) {
+            try_hit(group, source, target);
+          }
+        }
+      } else if (target_it != group.roles.end()) {
+        Node *target = target_it->second;
+        if (!targets.count(target)) continue;
+        std::set<Node *> visited;
+        for (auto *source : target->inlinks) {
+          if (sources.count(source) && visited.insert(source).second &&
+              IsNodesLink(source, target)) {
+            try_hit(group, source, target);
+          }
+        }
+      } else {
+        for (Node *source : sources) {
+          for (Node *target : targets) {
+            if (IsNodesLink(source, target)) {
+              try_hit(group, source, target);
             }
           }
         }
       }
     }
+    std::stable_sort(hits.begin(), hits.end(), [](const Hit &a, const Hit &b) {
+      return a.source != b.source ? a.source < b.source : a.target < b.target;
+    });
+    for (auto &hit : hits) {
+      cur_groups.push_back(std::move(hit.group));
+    }
     VLOG(3) << "step " << step << " get records: " << cur_groups.size();
   }
 
@@ -371,6 +447,7 @@ PMNode *PMNode::assert_only_one_output() {
 }
 
 PMNode *PMNode::assert_is_op(const std::string &op_type) {
+  HintCandidates(Candidates::kOp, op_type);
   asserts_.emplace_back([op_type](const Node *x) {
     if (x && x->IsStmt()) {
       auto *op_info = x->stmt()->op_info();
@@ -416,6 +493,7 @@ PMNode *PMNode::assert_is_persistable_var() {
 
 PMNode *PMNode::assert_is_op_output(const std::string &op_type) {
   assert_is_var();
+  HintCandidates(Candidates::kOpOutput, op_type);
   asserts_.emplace_back([=](const Node *x) {
     for (auto *op : x->inlinks) {
       if (op && op->IsStmt()) {
@@ -486,6 +564,7 @@ PMNode *PMNode::assert_is_op_nth_output(const std::string &op_type,
                                         const std::string &argument,
                                         int nth) {
   assert_is_var();
+  HintCandidates(Candidates::kOpOutput, op_type);
   asserts_.emplace_back([=](const Node *x) {
     for (auto *op : x->inlinks) {
       if (op && op->IsStmt() && op->stmt()->op_info()->Type() == op_type &&
@@ -499,6 +578,7 @@ PMNode *PMNode::assert_is_op_nth_output(const std::string &op_type,
 
 PMNode *PMNode::assert_is_op_input(const std::string &op_type) {
   assert_is_var();
+  HintCandidates(Candidates::kOpInput, op_type);
   asserts_.emplace_back([=](const Node *x) {
     for (auto *op : x->outlinks) {
       if (op && op->IsStmt()) {
@@ -48,6 +48,9 @@ struct PMNode {
   // tell whether an mir::Node* is a candidation for a PMNode.
   using teller_t = std::function<bool(const Node*)>;
   enum class Type { kOp, kVar };
+  // The candidates of this node hinted by the assertions: all the nodes, the
+  // ops of a type, or the inputs or outputs of the ops of a type.
+  enum class Candidates { kAll, kOp, kOpInput, kOpOutput };
   enum class Role {
     kUnknown,      // No role,
     kInput,        // an input and will be retained,
@@ -116,6 +119,11 @@ struct PMNode {
 
   void set_op_type(const std::string& op_type) { op_type_ = op_type; }
 
+  Candidates candidates() const {
+    return teller_ ? Candidates::kAll : candidates_;
+  }
+  const std::string& candidate_op_type() const { return candidate_op_type_; }
+
   bool IsIntermediate() const { return role_ == Role::kIntermediate; }
   bool IsInput() const { return role_ == Role::kInput; }
   bool IsOutput() const { return role_ == Role::kOutput; }
@@ -189,12 +197,22 @@ struct PMNode {
 
   friend class PMPattern;
 
+  // Only the first hint is kept, every assertion is a necessary condition.
+  void HintCandidates(Candidates candidates, const std::string& op_type) {
+    if (candidates_ == Candidates::kAll) {
+      candidates_ = candidates;
+      candidate_op_type_ = op_type;
+    }
+  }
+
   // Will removed latter.
   teller_t teller_;
   std::vector<teller_t> asserts_;
   PMPattern* pattern_;
   std::string name_;
   std::string op_type_;
+  Candidates candidates_{Candidates::kAll};
+  std::string candidate_op_type_;
   Type type_{};
   Role role_{Role::kUnknown};
 };
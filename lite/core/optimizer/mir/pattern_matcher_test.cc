@@ -15,6 +15,10 @@
 #include "lite/core/optimizer/mir/pattern_matcher.h"
 
 #include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include "lite/core/op_lite.h"
+#include "lite/utils/timer.h"
 
 namespace paddle {
 namespace lite {
@@ -228,6 +232,71 @@ TEST(PatternMatcher, IntermediateCheck) {
   ASSERT_EQ(count, 1);
 }
 
+class FakeOp : public OpLite {
+ public:
+  explicit FakeOp(const std::string& type) : OpLite(type) {}
+  bool CheckShape() const override { return true; }
+  bool InferShapeImpl() const override { return true; }
+  bool AttachImpl(const cpp::OpDesc& opdesc, lite::Scope* scope) override {
+    return true;
+  }
+  void AttachKernel(KernelBase* kernel) override {}
+  std::string DebugString() const override { return "fake"; }
+};
+
+// A chain of mul -> relu -> mul -> relu ... of `num_ops` ops.
+void BuildLargeGraph(SSAGraph* g, Scope* scope, int num_ops) {
+  g->mutable_nodes().emplace_back();
+  Node* in = &g->mutable_nodes().back();
+  in->AsArg("var0");
+  for (int i = 0; i < num_ops; ++i) {
+    std::string type = i % 2 ? "relu" : "mul";
+    std::string out_name = "var" + std::to_string(i + 1);
+    cpp::OpDesc desc;
+    desc.SetType(type);
+    desc.SetInput("X", {in->arg()->name});
+    desc.SetOutput("Out", {out_name});
+    auto op = std::make_shared<FakeOp>(type);
+    op->Attach(desc, scope);
+    g->mutable_nodes().emplace_back();
+    Node* op_node = &g->mutable_nodes().back();
+    op_node->AsStmt(type, {}, op);
+    g->mutable_nodes().emplace_back();
+    Node* out = &g->mutable_nodes().back();
+    out->AsArg(out_name);
+    DirectedLink(in, op_node);
+    DirectedLink(op_node, out);
+    in = out;
+  }
+}
+
+TEST(PatternMatcher, LargeGraph) {
+  const int num_ops = 20000;
+  SSAGraph graph;
+  Scope scope;
+  BuildLargeGraph(&graph, &scope, num_ops);
+
+  PatternMatcher matcher;
+  auto* mul = matcher.mutable_pattern()->NewNode("mul")->assert_is_op("mul");
+  auto* mul_out = matcher.mutable_pattern()
+                      ->NewNode("mul_out")
+                      ->assert_is_op_output("mul", "Out")
+                      ->assert_is_op_input("relu", "X")
+                      ->AsIntermediate();
+  auto* relu =
+      matcher.mutable_pattern()->NewNode("relu")->assert_is_op("relu");
+  mul_out->LinksFrom({mul}).LinksTo({relu});
+
+  int count = 0;
+  auto start = Timer::GetCurrentUS();
+  matcher(&graph, [&](const PatternMatcher::subgraph_t& g, SSAGraph* graph) {
+    ++count;
+  });
+  LOG(INFO) << "Matched " << count << " subgraphs in a graph of " << num_ops
+            << " ops, " << (Timer::GetCurrentUS() - start) / 1000.0 << " ms";
+  EXPECT_EQ(count, num_ops / 2);
+}
+
 }  // namespace mir
 }  // namespace lite
 }  // namespace paddle
@@ -41,6 +41,21 @@ bool HasExtraProducers(SSAGraph* graph,
   return false;
 }
 
+std::set<std::string> ExtraProducedVars(
+    SSAGraph* graph, const std::set<std::string>& candidate_op) {
+  std::set<std::string> var_names;
+  for (auto& op_node : graph->mutable_nodes()) {
+    if (!op_node.IsStmt()) continue;
+    auto op_type = op_node.AsStmt().op_info()->Type();
+    if (!candidate_op.empty() && !candidate_op.count(op_type)) continue;
+    for (auto& var_node : op_node.outlinks) {
+      const auto& name = var_node->AsArg().name;
+      var_names.insert(name.substr(0, name.find("__Mangled_")));
+    }
+  }
+  return var_names;
+}
+
 std::set<Node*> GetNodesFromConfigs(SSAGraph* graph,
                                     const std::string& configs) {
   std::set<Node*> nodes;
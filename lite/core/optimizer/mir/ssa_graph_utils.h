@@ -29,6 +29,14 @@ bool HasExtraProducers(SSAGraph *graph,
                        const std::set<std::string> &candidate_op = {
                            "while", "conditional_block", "increment"});
 
+// The names of the vars written by the ops of `candidate_op`, a mangled name
+// is recorded as the name it's mangled from. It answers `HasExtraProducers`
+// with an empty `exclude_op_list` for all the vars of the graph at once.
+std::set<std::string> ExtraProducedVars(
+    SSAGraph *graph,
+    const std::set<std::string> &candidate_op = {
+        "while", "conditional_block", "increment"});
+
 // Find target op nodes in the graph according to the configuration.
 // The configuration format is shown as follows:
 // op_type:in_var_name_0,in_var_name1:out_var_name_0,out_var_name1
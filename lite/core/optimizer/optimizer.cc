@@ -13,12 +13,15 @@
 // limitations under the License.
 
 #include "lite/core/optimizer/optimizer.h"
+#include <algorithm>
+#include <cstdlib>
 #include <fstream>
 #include "lite/core/optimizer/mir/__xpu__static_kernel_pick_pass.h"
 #include "lite/core/optimizer/mir/static_kernel_pick_pass.h"
 #include "lite/core/optimizer/mir/type_target_cast_pass.h"
 #include "lite/model_parser/model_parser.h"
 #include "lite/utils/all.h"
+#include "lite/utils/timer.h"
 
 namespace paddle {
 namespace lite {
@@ -99,7 +102,18 @@ void Optimizer::InitControlFlowOpSharedInputsAndOutputsPlaceSyncPass() {
 
 void Optimizer::ApplyPasses(
     std::vector<std::unique_ptr<mir::SSAGraph>>* graphes) {
+#ifdef LITE_WITH_LOG
+  const char* glog_v = std::getenv("GLOG_v");
+  const bool verbose = glog_v && std::atoi(glog_v) >= 3;
+#else
+  const bool verbose = false;
+#endif
+  // The total time in milliseconds and the number of runs of each pass.
+  std::map<std::string, std::pair<double, int>> pass_time;
   for (auto& pass : passes_) {
+    if (!verbose && kDebugOnlyPasses.count(pass->name())) {
+      continue;
+    }
     LOG(INFO) << "== Running pass: " << pass->name();
     std::set<TargetType> targets;
     for (const auto& place : valid_places_) {
@@ -111,6 +125,7 @@ void Optimizer::ApplyPasses(
       LOG(INFO) << "   - Skip " << pass->name()
                 << " because the target or kernel does not match.";
     } else {
+      auto start = Timer::GetCurrentUS();
       // Check the pass whether it is supported for processing subblocks
       if (kSubblockUnsupportedPasses.count(pass->name()) ||
           kSubblockSkippedPasses.count(pass->name())) {
@@ -120,9 +135,33 @@ void Optimizer::ApplyPasses(
           pass->Apply(graph);
         }
       }
-      LOG(INFO) << "== Finished running: " << pass->name();
+      double time_ms = (Timer::GetCurrentUS() - start) / 1000.0;
+      pass_time[pass->name()].first += time_ms;
+      pass_time[pass->name()].second++;
+      LOG(INFO) << "== Finished running: " << pass->name() << ", " << time_ms
+                << " ms";
     }
   }
+
+  // Report the most expensive passes.
+  std::vector<std::pair<std::string, std::pair<double, int>>> sorted_time(
+      pass_time.begin(), pass_time.end());
+  std::sort(sorted_time.begin(),
+            sorted_time.end(),
+            [](const std::pair<std::string, std::pair<double, int>>& a,
+               const std::pair<std::string, std::pair<double, int>>& b) {
+              return a.second.first > b.second.first;
+            });
+  double total_ms = 0;
+  for (auto& it : sorted_time) {
+    total_ms += it.second.first;
+  }
+  LOG(INFO) << "== Optimized in " << total_ms << " ms, the slowest passes:";
+  for (size_t i = 0; i < sorted_time.size() && i < 10; ++i) {
+    LOG(INFO) << "   " << sorted_time[i].first << " x "
+              << sorted_time[i].second.second << ": "
+              << sorted_time[i].second.first << " ms";
+  }
 }
 
 std::unique_ptr<RuntimeProgram> RunDefaultOptimizer(
@@ -146,6 +185,13 @@ std::unique_ptr<RuntimeProgram> RunDefaultOptimizer(
        "reshape_calc_offline_pass",
        "unsqueeze_calc_offline_pass",
        "scale_calc_offline_pass",
+       // Fold the rest ops whose inputs are all persistable with the host
+       // kernels.
+       "constant_folding_pass",
+       "common_subexpression_elimination_pass",
+       "dead_code_elimination_pass",
+       "transpose_sinking_pass",
+       "sequence_padding_elimination_pass",
        // A minimal set of op fusion pass.
        "op_fusion_minimal_set_pass",
        // For the fully quantization model, the quantization parameters of the
@@ -196,6 +242,9 @@ std::unique_ptr<RuntimeProgram> RunDefaultOptimizer(
        "transformer_attention_fuse_pass",
        "lite_greater_than_cast_fuse_pass",
        "identity_dropout_eliminate_pass",
+       "kv_cache_attention_fuse_pass",
+       "lite_horizontal_fc_fuse_pass",
+       "lite_embedding_seq_pool_fuse_pass",
        "sparse_conv_detect_pass",
        //  "keepdims_convert_pass",
        "__xpu__max_pooling_pad_zero_detect_fuse_pass",
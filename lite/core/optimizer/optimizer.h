@@ -47,8 +47,18 @@ const std::set<std::string> kSubblockSkippedPasses(
      "range_calc_offline_pass",
      "assign_value_calc_offline_pass",
      "ssd_boxes_calc_offline_pass",
+     "constant_folding_pass",
+     "common_subexpression_elimination_pass",
+     "dead_code_elimination_pass",
+     "transpose_sinking_pass",
+     "sequence_padding_elimination_pass",
      "p_norm_fill_constant_max_div_fuse_pass"});
 
+// The passes which only print the graph for debugging, they're skipped
+// unless the verbose logs are turned on by GLOG_v.
+const std::set<std::string> kDebugOnlyPasses(
+    {"argument_type_display_pass", "graph_visualize_pass"});
+
 /*
  * lite::Optimizer optimize a program. It utilize the mir passes to analysis the
  * program and export an optimized program.
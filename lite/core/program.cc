@@ -21,10 +21,13 @@
 #ifdef ENABLE_ARM_FP16
 #include "lite/backends/arm/math/fp16/funcs_fp16.h"
 #endif
+#include "lite/core/device_info.h"
 #include "lite/model_parser/cpp_desc.h"
 #include "lite/operators/conditional_block_op.h"
 #include "lite/operators/subgraph_op.h"
 #include "lite/operators/while_op.h"
+#include "lite/utils/float16.h"
+#include "lite/utils/mapped_file.h"
 #ifdef LITE_WITH_PRECISION_PROFILE
 #include "lite/core/profile/precision_profiler.h"
 #endif
@@ -32,6 +35,12 @@
 #include "lite/backends/xpu/target_wrapper.h"
 #include "lite/backends/xpu/tensor_dump.h"
 #endif
+#if (defined LITE_WITH_X86) && (defined PADDLE_WITH_MKLML)
+#if !defined(__APPLE__)
+#include <omp.h>
+#endif
+#include "lite/backends/x86/mklml.h"
+#endif
 
 namespace paddle {
 namespace lite {
@@ -590,7 +599,431 @@ void RuntimeProgram::SaveOutput() {
 }
 #endif
 
+namespace {
+
+// The ops whose output shapes depend on the input data, which can't be
+// replayed with the frozen shapes.
+const std::set<std::string> kDataDependentShapeOps({"where_index",
+                                                    "unique",
+                                                    "unique_with_counts",
+                                                    "masked_select",
+                                                    "multiclass_nms",
+                                                    "multiclass_nms2",
+                                                    "multiclass_nms3",
+                                                    "matrix_nms",
+                                                    "generate_proposals",
+                                                    "generate_proposals_v2",
+                                                    "distribute_fpn_proposals",
+                                                    "collect_fpn_proposals",
+                                                    "beam_search",
+                                                    "beam_search_decode",
+                                                    "lod_reset",
+                                                    "sequence_mask",
+                                                    "sequence_unpad",
+                                                    "range",
+                                                    "linspace"});
+
+// The inputs which hold the shapes, sizes or counts of the outputs as the
+// tensor values, e.g. the ShapeTensor of reshape2 computed in the graph. The
+// ops reading them can't be replayed with the frozen shapes either.
+const std::map<std::string, std::vector<std::string>> kShapeTensorInputs{
+    {"slice",
+     {"StartsTensor", "EndsTensor", "StartsTensorList", "EndsTensorList"}},
+    {"strided_slice",
+     {"StartsTensor",
+      "EndsTensor",
+      "StridesTensor",
+      "StartsTensorList",
+      "EndsTensorList",
+      "StridesTensorList"}},
+    {"reshape", {"Shape", "ShapeTensor"}},
+    {"reshape2", {"Shape", "ShapeTensor"}},
+    {"bilinear_interp", {"OutSize", "SizeTensor", "Scale"}},
+    {"nearest_interp", {"OutSize", "SizeTensor", "Scale"}},
+    {"bicubic_interp", {"OutSize", "SizeTensor", "Scale"}},
+    {"linear_interp", {"OutSize", "SizeTensor", "Scale"}},
+    {"trilinear_interp", {"OutSize", "SizeTensor", "Scale"}},
+    {"bilinear_interp_v2", {"OutSize", "SizeTensor", "Scale"}},
+    {"nearest_interp_v2", {"OutSize", "SizeTensor", "Scale"}},
+    {"bicubic_interp_v2", {"OutSize", "SizeTensor", "Scale"}},
+    {"linear_interp_v2", {"OutSize", "SizeTensor", "Scale"}},
+    {"trilinear_interp_v2", {"OutSize", "SizeTensor", "Scale"}},
+    {"fill_constant", {"ShapeTensor", "ShapeTensorList"}},
+    {"uniform_random", {"ShapeTensor", "ShapeTensorList"}},
+    {"gaussian_random", {"ShapeTensor", "ShapeTensorList"}},
+    {"expand", {"ExpandTimes", "expand_times_tensor"}},
+    {"expand_v2", {"Shape", "expand_shapes_tensor"}},
+    {"tile", {"RepeatTimes", "repeat_times_tensor"}},
+    {"unsqueeze", {"AxesTensor", "AxesTensorList"}},
+    {"unsqueeze2", {"AxesTensor", "AxesTensorList"}},
+    {"top_k", {"K"}},
+    {"top_k_v2", {"K"}}};
+
+// Whether the op reads any of the shape tensor inputs above.
+bool HasShapeTensorInputs(const OpInfo& op_info) {
+  auto it = kShapeTensorInputs.find(op_info.Type());
+  if (it == kShapeTensorInputs.end()) return false;
+  for (auto& param : it->second) {
+    if (op_info.HasInput(param) && !op_info.Input(param).empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Tensor* FindTensor(Scope* scope, const std::string& name) {
+  auto* var = scope->FindVar(name);
+  if (var == nullptr || !var->IsType<Tensor>()) return nullptr;
+  return var->GetMutable<Tensor>();
+}
+
+// The input args of the tables read by the lookup ops.
+const std::map<std::string, std::string> kEmbeddingTableArgs{
+    {"lookup_table", "W"},
+    {"lookup_table_v2", "W"},
+    {"lookup_table_dequant", "W"},
+    {"fused_embedding_seq_pool", "W"}};
+
+// The files of the mapped tables start with a header, which is checked
+// against the tensor before the file is reused.
+struct EmbeddingTableHeader {
+  char magic[8];
+  int32_t precision;
+  int32_t rank;
+  int64_t dims[6];
+  // The hash of the fp32 data of the table, so that the file saved from a
+  // table of the same name and shape in another model isn't reused.
+  uint64_t hash;
+  char reserved[56];
+};
+static_assert(sizeof(EmbeddingTableHeader) == 128,
+              "The table data should be aligned to 64 bytes.");
+
+uint64_t HashEmbeddingTable(const Tensor& tensor) {
+  const auto* data = static_cast<const uint8_t*>(tensor.raw_data());
+  size_t size = tensor.numel() * sizeof(float);
+  uint64_t hash = 14695981039346656037ULL;
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + i, sizeof(word));
+    hash = (hash ^ word) * 1099511628211ULL;
+    hash ^= hash >> 32;
+  }
+  for (; i < size; i++) {
+    hash = (hash ^ data[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+EmbeddingTableHeader MakeEmbeddingTableHeader(const Tensor& tensor,
+                                              PrecisionType precision) {
+  EmbeddingTableHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, "LITEEMB", 8);
+  header.precision = static_cast<int32_t>(precision);
+  header.rank = static_cast<int32_t>(tensor.dims().size());
+  for (int i = 0; i < header.rank; i++) {
+    header.dims[i] = tensor.dims()[i];
+  }
+  header.hash = HashEmbeddingTable(tensor);
+  return header;
+}
+
+// The buffer on a mapped table, which keeps the mapping alive as long as a
+// tensor uses it. The kernels only read the tables, so the read-only pages
+// are shared with the other processes.
+class MappedTableBuffer : public Buffer {
+ public:
+  MappedTableBuffer(std::unique_ptr<MappedFile> file, TargetType target)
+      : Buffer(const_cast<char*>(static_cast<const char*>(file->data())) +
+                   sizeof(EmbeddingTableHeader),
+               target,
+               file->size() - sizeof(EmbeddingTableHeader)),
+        file_(std::move(file)) {}
+
+ private:
+  std::unique_ptr<MappedFile> file_;
+};
+
+void ConvertTableToFP16(const Tensor& table, float16* out) {
+  const float* data = table.data<float>();
+  int64_t numel = table.numel();
+  for (int64_t i = 0; i < numel; i++) {
+    out[i] = float16(data[i]);
+  }
+}
+
+#if !defined(_WIN32)
+// Write the table to a temporary file and rename it, so that the processes
+// which are mapping the same path see either the old file or the new one.
+bool SaveEmbeddingTable(const std::string& path,
+                        const EmbeddingTableHeader& header,
+                        const Tensor& table,
+                        PrecisionType precision) {
+  std::vector<float16> fp16_data;
+  const void* data = table.raw_data();
+  size_t size = table.memory_size();
+  if (precision == PRECISION(kFP16)) {
+    fp16_data.resize(table.numel());
+    ConvertTableToFP16(table, fp16_data.data());
+    data = fp16_data.data();
+    size = fp16_data.size() * sizeof(float16);
+  }
+  auto tmp_path = path + ".tmp" + std::to_string(getpid());
+  FILE* fp = fopen(tmp_path.c_str(), "wb");
+  if (fp == nullptr) return false;
+  bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+            fwrite(data, 1, size, fp) == size;
+  ok = fclose(fp) == 0 && ok;
+  if (ok) ok = rename(tmp_path.c_str(), path.c_str()) == 0;
+  if (!ok) remove(tmp_path.c_str());
+  return ok;
+}
+
+// Map the file of the table if it's saved with `header`, i.e. from a table
+// of the same shape and content, otherwise it should be rebuilt.
+std::unique_ptr<MappedFile> OpenEmbeddingTable(
+    const std::string& path, const EmbeddingTableHeader& header, size_t size) {
+  std::unique_ptr<MappedFile> file(new MappedFile);
+  if (!file->Open(path)) return nullptr;
+  if (file->size() != sizeof(header) + size ||
+      memcmp(file->data(), &header, sizeof(header)) != 0) {
+    return nullptr;
+  }
+  return file;
+}
+#endif
+
+void ResetWorkSpaces() {
+  WorkSpace::Global_Host().AllocReset();
+#if defined(LITE_WITH_X86)
+  WorkSpace::Global_X86().AllocReset();
+#endif
+}
+
+}  // namespace
+
+void RuntimeProgram::EnableFrozenShape() {
+  frozen_shape_ = false;
+  replay_steps_.clear();
+  replay_inputs_.clear();
+#if defined(LITE_WITH_PROFILE) || defined(LITE_WITH_PRECISION_PROFILE) || \
+    defined(LITE_WITH_METAL)
+  LOG(WARNING) << "The frozen-shape mode isn't supported with the profilers "
+                  "or Metal.";
+  return;
+#endif
+  if (inter_op_executor_) {
+    LOG(WARNING) << "The frozen-shape mode isn't supported with the inter-op "
+                    "parallelism.";
+    return;
+  }
+  CHECK(exec_scope_) << "The exec scope should be set.";
+  for (auto& inst : instructions_[kRootBlockIdx]) {
+    if (inst.is_feed_fetch_op()) continue;
+    const auto* op_info = inst.op()->op_info();
+    if (op_info->HasAttr("sub_block") || op_info->HasAttr("sub_blocks") ||
+        kDataDependentShapeOps.count(op_info->Type()) ||
+        HasShapeTensorInputs(*op_info)) {
+      LOG(WARNING) << "The frozen-shape mode isn't supported by "
+                   << op_info->Type();
+      return;
+    }
+    for (auto& name : op_info->output_names()) {
+      auto* var = exec_scope_->FindVar(name);
+      if (var != nullptr && !var->IsType<Tensor>()) {
+        LOG(WARNING) << "The frozen-shape mode isn't supported by the "
+                        "non-tensor output "
+                     << name << " of " << op_info->Type();
+        return;
+      }
+    }
+  }
+  frozen_shape_ = true;
+}
+
+void RuntimeProgram::MapEmbeddingTables(const std::string& dir, bool fp16) {
+#if defined(_WIN32)
+  if (!dir.empty()) {
+    LOG(WARNING) << "The mapped embedding tables aren't supported on Windows.";
+    return;
+  }
+#endif
+  CHECK(exec_scope_) << "The exec scope should be set.";
+  // Find the tables which are only read by the lookup ops on the CPU, and
+  // whether all of them are the x86 lookup_table kernels supporting fp16.
+  std::map<std::string, bool> tables;
+  std::set<std::string> others;
+  for (auto& insts : instructions_) {
+    for (auto& inst : insts) {
+      const auto* op_info = inst.op()->op_info();
+      auto op_type = op_info->Type();
+      auto target = inst.kernel()->target();
+      bool on_cpu = target == TARGET(kHost) || target == TARGET(kX86) ||
+                    target == TARGET(kARM);
+      bool fp16_kernel =
+          target == TARGET(kX86) &&
+          (op_type == "lookup_table" || op_type == "lookup_table_v2");
+      auto it = kEmbeddingTableArgs.find(op_type);
+      for (auto& arg : op_info->InputArgumentNames()) {
+        bool is_table = on_cpu && it != kEmbeddingTableArgs.end() &&
+                        it->second == arg;
+        for (auto& name : op_info->Input(arg)) {
+          if (!is_table) {
+            others.insert(name);
+            continue;
+          }
+          auto res = tables.emplace(name, fp16_kernel);
+          res.first->second = res.first->second && fp16_kernel;
+        }
+      }
+      for (auto& name : op_info->output_vars()) {
+        others.insert(name);
+      }
+    }
+  }
+
+  for (auto& it : tables) {
+    const auto& name = it.first;
+    auto* table = FindTensor(exec_scope_, name);
+    if (others.count(name) || table == nullptr || !table->persistable() ||
+        table->precision() != PRECISION(kFloat) || table->dims().size() > 6 ||
+        !table->IsInitialized()) {
+      continue;
+    }
+    auto precision = fp16 && it.second ? PRECISION(kFP16) : PRECISION(kFloat);
+    size_t size = table->numel() * PrecisionTypeLength(precision);
+    if (dir.empty()) {
+      if (precision == PRECISION(kFP16)) {
+        Tensor fp32_table;
+        fp32_table.CopyDataFrom(*table);
+        table->clear();
+        ConvertTableToFP16(fp32_table, table->mutable_data<float16>());
+        table->set_precision(PRECISION(kFP16));
+      }
+      continue;
+    }
+#if !defined(_WIN32)
+    auto file_name = name;
+    std::replace(file_name.begin(), file_name.end(), '/', '_');
+    auto path = dir + "/" + file_name + ".table";
+    auto header = MakeEmbeddingTableHeader(*table, precision);
+    auto file = OpenEmbeddingTable(path, header, size);
+    if (file == nullptr) {
+      if (!SaveEmbeddingTable(path, header, *table, precision)) {
+        LOG(WARNING) << "Failed to save the embedding table " << name
+                     << " to " << path;
+        continue;
+      }
+      file = OpenEmbeddingTable(path, header, size);
+      CHECK(file) << "Failed to map the embedding table " << path;
+    }
+    VLOG(4) << "Map the embedding table " << name << " from " << path;
+    auto target = table->target();
+    table->ResetBuffer(
+        std::make_shared<MappedTableBuffer>(std::move(file), target), size);
+    table->set_precision(precision);
+#endif
+  }
+}
+
+void RuntimeProgram::RunAndRecord() {
+  replay_steps_.clear();
+  replay_inputs_.clear();
+  auto& insts = instructions_[kRootBlockIdx];
+  std::map<const Tensor*, int> num_writers;
+  for (auto& inst : insts) {
+    if (inst.is_feed_fetch_op()) continue;
+    for (auto& name : inst.op()->op_info()->output_names()) {
+      auto* tensor = FindTensor(exec_scope_, name);
+      if (tensor != nullptr) num_writers[tensor]++;
+    }
+  }
+
+  // The inputs are the non-persistable tensors which are read before being
+  // written.
+  std::set<const Tensor*> written;
+  std::set<const Tensor*> inputs;
+  int idx = -1;
+  for (auto& inst : insts) {
+    ++idx;
+    if (inst.is_feed_fetch_op()) continue;
+    const auto* op_info = inst.op()->op_info();
+    for (auto& name : op_info->input_names()) {
+      auto* tensor = FindTensor(exec_scope_, name);
+      if (tensor == nullptr || tensor->persistable() || written.count(tensor) ||
+          !inputs.insert(tensor).second) {
+        continue;
+      }
+      replay_inputs_.push_back({tensor, tensor->dims(), tensor->lod()});
+    }
+#ifdef LITE_WITH_OPENCL
+    inst.Flush(idx);
+#endif
+    inst.Run();
+    // The run-once ops are skipped in the replay.
+    if (!inst.op()->run_once()) {
+      ReplayStep step;
+      step.kernel = inst.mutable_kernel();
+#ifdef LITE_WITH_OPENCL
+      step.inst = &inst;
+      step.inst_idx = idx;
+#endif
+      for (auto& name : op_info->output_names()) {
+        auto* tensor = FindTensor(exec_scope_, name);
+        if (tensor == nullptr || num_writers[tensor] <= 1) continue;
+        step.outputs.push_back(tensor);
+        step.output_dims.push_back(tensor->dims());
+        step.output_lods.push_back(tensor->lod());
+      }
+      replay_steps_.push_back(std::move(step));
+    }
+    for (auto& name : op_info->output_names()) {
+      auto* tensor = FindTensor(exec_scope_, name);
+      if (tensor != nullptr) written.insert(tensor);
+    }
+  }
+  VLOG(4) << "Replay " << replay_steps_.size() << " kernels with "
+          << replay_inputs_.size() << " inputs";
+}
+
+bool RuntimeProgram::Replay() {
+  for (auto& input : replay_inputs_) {
+    if (input.tensor->dims() != input.dims ||
+        input.tensor->lod() != input.lod) {
+      VLOG(4) << "The input shapes are changed, record the replay again";
+      return false;
+    }
+  }
+  for (auto& step : replay_steps_) {
+    for (size_t i = 0; i < step.outputs.size(); i++) {
+      step.outputs[i]->Resize(step.output_dims[i]);
+      if (step.outputs[i]->lod() != step.output_lods[i]) {
+        step.outputs[i]->set_lod(step.output_lods[i]);
+      }
+    }
+    ResetWorkSpaces();
+#ifdef LITE_WITH_OPENCL
+    // The same as Run, the OpenCL commands are flushed in batches.
+    step.inst->Flush(step.inst_idx);
+#endif
+    step.kernel->Run();
+  }
+  return true;
+}
+
 void RuntimeProgram::Run() {
+  if (frozen_shape_) {
+    if (replay_steps_.empty() || !Replay()) RunAndRecord();
+    return;
+  }
+  if (inter_op_executor_) {
+    auto& insts = instructions_[kRootBlockIdx];
+    inter_op_executor_->Run([&](int i) { insts[inter_op_insts_[i]].Run(); });
+    return;
+  }
+
 #ifdef LITE_WITH_PRECISION_PROFILE
   auto inst_precision_profiler = paddle::lite::profile::PrecisionProfiler();
   std::string precision_profiler_summary =
@@ -634,6 +1067,68 @@ void RuntimeProgram::Run() {
 #endif
 }
 
+void RuntimeProgram::EnableInterOpParallel(int inter_op_threads,
+                                           int intra_op_threads,
+                                           lite_api::PowerMode mode) {
+  inter_op_executor_.reset();
+  inter_op_insts_.clear();
+  if (inter_op_threads <= 1) return;
+#if defined(LITE_WITH_PROFILE) || defined(LITE_WITH_PRECISION_PROFILE) || \
+    defined(LITE_USE_THREAD_POOL)
+  LOG(WARNING) << "The inter-op parallelism isn't supported with the "
+                  "profilers or the thread pool.";
+  return;
+#endif
+
+  // The ops with sub-blocks may access any vars, they're run alone.
+  std::vector<std::vector<std::string>> reads;
+  std::vector<std::vector<std::string>> writes;
+  std::vector<bool> barriers;
+  const auto& insts = instructions_[kRootBlockIdx];
+  for (size_t i = 0; i < insts.size(); i++) {
+    const auto& inst = insts[i];
+    if (inst.is_feed_fetch_op()) continue;
+    auto target = inst.kernel()->target();
+    if (target != TARGET(kHost) && target != TARGET(kX86) &&
+        target != TARGET(kARM) && target != TARGET(kAny)) {
+      LOG(WARNING) << "The inter-op parallelism isn't supported by the "
+                   << TargetToStr(target) << " kernel of "
+                   << inst.op()->Type();
+      inter_op_insts_.clear();
+      return;
+    }
+    const auto* op_info = inst.op()->op_info();
+    reads.push_back(op_info->input_names());
+    writes.push_back(op_info->output_names());
+    barriers.push_back(op_info->HasAttr("sub_block") ||
+                       op_info->HasAttr("sub_blocks"));
+    inter_op_insts_.push_back(static_cast<int>(i));
+  }
+
+  intra_op_threads = std::max(intra_op_threads, 1);
+  auto thread_init = [=]() {
+#ifdef LITE_WITH_ARM
+    DeviceInfo::Init();
+    DeviceInfo::Global().SetRunMode(mode, intra_op_threads);
+#endif
+#if (defined LITE_WITH_X86) && (defined PADDLE_WITH_MKLML)
+#ifdef LITE_WITH_STATIC_MKL
+    MKL_Set_Num_Threads(intra_op_threads);
+#else
+    x86::MKL_Set_Num_Threads(intra_op_threads);
+#endif
+#if !defined(__APPLE__)
+    omp_set_num_threads(intra_op_threads);
+#endif
+#endif
+  };
+  inter_op_executor_.reset(new InterOpExecutor(inter_op_threads, thread_init));
+  inter_op_executor_->Build(reads, writes, barriers);
+  LOG(INFO) << "Run " << inter_op_insts_.size() << " ops on "
+            << inter_op_threads << " threads, each of which uses "
+            << intra_op_threads << " threads";
+}
+
 void Program::Build(const std::shared_ptr<cpp::ProgramDesc>& program_desc) {
   CHECK(ops_.empty()) << "Executor duplicate Build found";
 
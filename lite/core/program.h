@@ -19,6 +19,7 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include "lite/core/inter_op_executor.h"
 #include "lite/core/kernel.h"
 #include "lite/core/op_lite.h"
 #include "lite/core/op_registry.h"
@@ -272,6 +273,34 @@ class LITE_API RuntimeProgram {
   void SaveOutput();
 #endif
 
+  // Run the independent instructions of the root block concurrently on
+  // `inter_op_threads` threads, each of which runs the ops with
+  // `intra_op_threads` threads. It's ignored if there are the kernels of
+  // the other targets than the CPU.
+  void EnableInterOpParallel(
+      int inter_op_threads,
+      int intra_op_threads,
+      lite_api::PowerMode mode = lite_api::PowerMode::LITE_POWER_NO_BIND);
+
+  // Enable the frozen-shape mode: after a full run, the instructions are
+  // replayed as the pre-bound kernel calls without the shape inference,
+  // until the dims or lods of the inputs are changed. The output shapes of
+  // the ops must only depend on the input shapes, so it's refused if any op
+  // reads its output shape from the tensor values, e.g. the ShapeTensor of
+  // reshape2.
+  void EnableFrozenShape();
+
+  bool inter_op_parallel() const { return inter_op_executor_ != nullptr; }
+  bool frozen_shape() const { return frozen_shape_; }
+
+  // Reduce the memory of the fp32 embedding tables which are only read by
+  // the lookup ops on the CPU. If `fp16` is true, the tables of the x86
+  // lookup_table kernels are stored in fp16 and converted when gathered. If
+  // `dir` isn't empty, the tables are saved to the files in `dir` and mapped
+  // read-only, so that the processes running the same model share them, and
+  // the existing files of the same tables are reused.
+  void MapEmbeddingTables(const std::string& dir, bool fp16);
+
   void set_exec_scope(Scope* x) { exec_scope_ = x; }
   Scope* exec_scope() { return exec_scope_; }
 
@@ -311,6 +340,39 @@ class LITE_API RuntimeProgram {
   std::vector<std::vector<Instruction>> instructions_;
   Scope* exec_scope_{};
   int64_t version_{0};
+  // The instructions run by `inter_op_executor_`, in the task order.
+  std::vector<int> inter_op_insts_;
+  std::unique_ptr<InterOpExecutor> inter_op_executor_;
+
+  // Run the instructions, and record the kernels and the output shapes for
+  // the replay.
+  void RunAndRecord();
+  // Run the recorded kernels, return false without running anything if the
+  // input shapes are changed.
+  bool Replay();
+
+  struct ReplayStep {
+    KernelBase* kernel{nullptr};
+#ifdef LITE_WITH_OPENCL
+    // To flush the OpenCL commands the same as Run.
+    const Instruction* inst{nullptr};
+    int inst_idx{-1};
+#endif
+    // The outputs which are written by the other ops too, e.g. the vars
+    // reused by the memory optimization, their shapes are restored before
+    // running the kernel.
+    std::vector<Tensor*> outputs;
+    std::vector<DDim> output_dims;
+    std::vector<LoD> output_lods;
+  };
+  struct ReplayInput {
+    const Tensor* tensor;
+    DDim dims;
+    LoD lod;
+  };
+  bool frozen_shape_{false};
+  std::vector<ReplayStep> replay_steps_;
+  std::vector<ReplayInput> replay_inputs_;
 
 #ifdef LITE_WITH_METAL
   std::unique_ptr<KernelContext> metal_ctx_{nullptr};
@@ -0,0 +1,353 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "lite/core/program.h"
+#include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+#include "lite/utils/timer.h"
+
+namespace paddle {
+namespace lite {
+
+struct FakePadParam {
+  const Tensor* x{};
+  const Tensor* pad_tensor{};
+  Tensor* out{};
+  int pad{0};
+};
+
+// Out = concat(X + 1, zeros(pad)), so that the ops reusing the same vars
+// have the different output shapes. The pad is read from the value of the
+// ShapeTensor input if it's given.
+class FakePadOp : public OpLite {
+ public:
+  explicit FakePadOp(const std::string& type) : OpLite(type) {}
+
+  bool CheckShape() const override { return param_.x && param_.out; }
+
+  bool InferShapeImpl() const override {
+    if (param_.pad_tensor) param_.pad = param_.pad_tensor->data<int>()[0];
+    param_.out->Resize({param_.x->numel() + param_.pad});
+    return true;
+  }
+
+  bool AttachImpl(const cpp::OpDesc& opdesc, Scope* scope) override {
+    auto x_name = opdesc.HasInput("X") ? "X" : opdesc.InputArgumentNames()[0];
+    param_.x = scope->FindTensor(opdesc.Input(x_name).front());
+    if (opdesc.HasInput("ShapeTensor")) {
+      param_.pad_tensor =
+          scope->FindTensor(opdesc.Input("ShapeTensor").front());
+    }
+    param_.out = scope->FindMutableTensor(opdesc.Output("Out").front());
+    param_.pad = opdesc.GetAttr<int>("pad");
+    return true;
+  }
+
+  void AttachKernel(KernelBase* kernel) override { kernel->SetParam(param_); }
+
+  std::string DebugString() const override { return "fake_pad"; }
+
+ private:
+  mutable FakePadParam param_;
+};
+
+class FakePadCompute : public KernelLite<TARGET(kHost), PRECISION(kFloat)> {
+ public:
+  void Run() override {
+    auto& param = Param<FakePadParam>();
+    auto* x_data = param.x->data<float>();
+    auto* out_data = param.out->mutable_data<float>();
+    int64_t x_size = param.x->numel();
+    for (int64_t i = 0; i < x_size; i++) {
+      out_data[i] = x_data[i] + 1.f;
+    }
+    for (int64_t i = x_size; i < param.out->numel(); i++) {
+      out_data[i] = 0.f;
+    }
+  }
+};
+
+// A chain of `num_ops` ops, whose outputs are written to the reused vars
+// "a" and "b" alternately.
+std::unique_ptr<RuntimeProgram> CreateProgram(Scope* scope,
+                                              int num_ops,
+                                              std::string* out_name) {
+  scope->Var("x")->GetMutable<Tensor>();
+  scope->Var("a")->GetMutable<Tensor>();
+  scope->Var("b")->GetMutable<Tensor>();
+  std::vector<std::vector<Instruction>> insts(1);
+  std::string in_name = "x";
+  for (int i = 0; i < num_ops; i++) {
+    *out_name = i % 2 == 0 ? "a" : "b";
+    cpp::OpDesc desc;
+    desc.SetType("fake_pad");
+    desc.SetInput("X", {in_name});
+    desc.SetOutput("Out", {*out_name});
+    desc.SetAttr<int>("pad", i % 3);
+    auto op = std::make_shared<FakePadOp>("fake_pad");
+    op->Attach(desc, scope);
+    std::unique_ptr<KernelBase> kernel(new FakePadCompute);
+    op->AttachKernel(kernel.get());
+    insts[0].emplace_back(op, std::move(kernel));
+    in_name = *out_name;
+  }
+  std::unique_ptr<RuntimeProgram> program(
+      new RuntimeProgram(std::move(insts)));
+  program->set_exec_scope(scope);
+  return program;
+}
+
+void FillInput(Scope* scope, int64_t size) {
+  auto* x = scope->FindMutableTensor("x");
+  x->Resize({size});
+  auto* x_data = x->mutable_data<float>();
+  for (int64_t i = 0; i < size; i++) {
+    x_data[i] = static_cast<float>(i);
+  }
+}
+
+TEST(RuntimeProgram, FrozenShape) {
+  const int kNumOps = 10;
+  Scope ref_scope;
+  Scope scope;
+  std::string ref_out_name;
+  std::string out_name;
+  auto ref_program = CreateProgram(&ref_scope, kNumOps, &ref_out_name);
+  auto program = CreateProgram(&scope, kNumOps, &out_name);
+  program->EnableFrozenShape();
+
+  for (int64_t size : {4, 4, 4, 7, 7, 4}) {
+    FillInput(&ref_scope, size);
+    FillInput(&scope, size);
+    ref_program->Run();
+    program->Run();
+    auto* ref_out = ref_scope.FindTensor(ref_out_name);
+    auto* out = scope.FindTensor(out_name);
+    ASSERT_EQ(out->dims(), ref_out->dims());
+    for (int64_t i = 0; i < out->numel(); i++) {
+      EXPECT_EQ(out->data<float>()[i], ref_out->data<float>()[i]);
+    }
+  }
+}
+
+// The ops reading the output shapes from the tensor values aren't replayed
+// with the frozen shapes, since the shape tensors may change with the same
+// input shapes.
+TEST(RuntimeProgram, FrozenShapeWithShapeTensor) {
+  Scope scope;
+  scope.Var("x")->GetMutable<Tensor>();
+  auto* shape = scope.Var("shape")->GetMutable<Tensor>();
+  shape->Resize({1});
+  scope.Var("out")->GetMutable<Tensor>();
+  cpp::OpDesc desc;
+  desc.SetType("reshape2");
+  desc.SetInput("X", {"x"});
+  desc.SetInput("ShapeTensor", {"shape"});
+  desc.SetOutput("Out", {"out"});
+  desc.SetAttr<int>("pad", 0);
+  auto op = std::make_shared<FakePadOp>("reshape2");
+  op->Attach(desc, &scope);
+  std::unique_ptr<KernelBase> kernel(new FakePadCompute);
+  op->AttachKernel(kernel.get());
+  std::vector<std::vector<Instruction>> insts(1);
+  insts[0].emplace_back(op, std::move(kernel));
+  RuntimeProgram program(std::move(insts));
+  program.set_exec_scope(&scope);
+  program.EnableFrozenShape();
+  EXPECT_FALSE(program.frozen_shape());
+
+  FillInput(&scope, 4);
+  for (int pad : {1, 1, 3}) {
+    shape->mutable_data<int>()[0] = pad;
+    program.Run();
+    auto* out = scope.FindTensor("out");
+    ASSERT_EQ(out->numel(), 4 + pad);
+    for (int i = 0; i < 4 + pad; i++) {
+      EXPECT_EQ(out->data<float>()[i], i < 4 ? i + 1.f : 0.f);
+    }
+  }
+}
+
+// The tables read by the lookup ops are mapped from the files, and the
+// existing files are reused by the other programs only if they're saved from
+// the tables of the same content.
+TEST(RuntimeProgram, MapEmbeddingTables) {
+  const std::string kDir = ".";
+  const std::string kPath = kDir + "/emb_w.table";
+  remove(kPath.c_str());
+  ino_t last_inode = 0;
+  float last_base = -1.f;
+  for (float base : {0.f, 100.f, 100.f}) {
+    Scope scope;
+    auto* table = scope.Var("emb/w")->GetMutable<Tensor>();
+    table->Resize({4, 3});
+    auto* table_data = table->mutable_data<float>();
+    for (int i = 0; i < 12; i++) {
+      table_data[i] = base + i;
+    }
+    table->set_persistable(true);
+    scope.Var("out")->GetMutable<Tensor>();
+
+    cpp::OpDesc desc;
+    desc.SetType("lookup_table");
+    desc.SetInput("W", {"emb/w"});
+    desc.SetOutput("Out", {"out"});
+    desc.SetAttr<int>("pad", 0);
+    auto op = std::make_shared<FakePadOp>("lookup_table");
+    op->Attach(desc, &scope);
+    std::unique_ptr<KernelBase> kernel(new FakePadCompute);
+    op->AttachKernel(kernel.get());
+    std::vector<std::vector<Instruction>> insts(1);
+    insts[0].emplace_back(op, std::move(kernel));
+    RuntimeProgram program(std::move(insts));
+    program.set_exec_scope(&scope);
+
+    program.MapEmbeddingTables(kDir, false);
+    EXPECT_NE(table->data<float>(), table_data);
+    program.Run();
+    auto* out = scope.FindTensor("out");
+    for (int i = 0; i < 12; i++) {
+      EXPECT_EQ(table->data<float>()[i], base + i);
+      EXPECT_EQ(out->data<float>()[i], base + i + 1);
+    }
+    // The file is replaced by a new one if it's rebuilt.
+    struct stat file_stat;
+    ASSERT_EQ(stat(kPath.c_str(), &file_stat), 0);
+    EXPECT_EQ(file_stat.st_ino == last_inode, base == last_base);
+    last_inode = file_stat.st_ino;
+    last_base = base;
+  }
+  remove(kPath.c_str());
+}
+
+// FakePadCompute which records how many of the kernels run at the same time.
+class ConcurrentPadCompute : public FakePadCompute {
+ public:
+  ConcurrentPadCompute(std::atomic<int>* running, std::atomic<int>* max_running)
+      : running_(running), max_running_(max_running) {}
+
+  void Run() override {
+    int cur = ++*running_;
+    int prev = max_running_->load();
+    while (prev < cur && !max_running_->compare_exchange_weak(prev, cur)) {
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+    FakePadCompute::Run();
+    --*running_;
+  }
+
+ private:
+  std::atomic<int>* running_;
+  std::atomic<int>* max_running_;
+};
+
+// `kNumBranches` independent branches of out_i = pad(pad(x)), whose middle
+// vars are reused by the branches of the same parity as the memory
+// optimization does, so the later branches wait for the earlier ones to read
+// them.
+std::unique_ptr<RuntimeProgram> CreateBranches(Scope* scope,
+                                               std::atomic<int>* running,
+                                               std::atomic<int>* max_running) {
+  const int kNumBranches = 4;
+  scope->Var("x")->GetMutable<Tensor>();
+  std::vector<std::vector<Instruction>> insts(1);
+  auto add_op = [&](const std::string& in, const std::string& out, int pad) {
+    scope->Var(out)->GetMutable<Tensor>();
+    cpp::OpDesc desc;
+    desc.SetType("fake_pad");
+    desc.SetInput("X", {in});
+    desc.SetOutput("Out", {out});
+    desc.SetAttr<int>("pad", pad);
+    auto op = std::make_shared<FakePadOp>("fake_pad");
+    op->Attach(desc, scope);
+    std::unique_ptr<KernelBase> kernel(
+        new ConcurrentPadCompute(running, max_running));
+    op->AttachKernel(kernel.get());
+    insts[0].emplace_back(op, std::move(kernel));
+  };
+  for (int i = 0; i < kNumBranches; i++) {
+    auto mid = "mid" + std::to_string(i % 2);
+    add_op("x", mid, i);
+    add_op(mid, "out" + std::to_string(i), 1);
+  }
+  std::unique_ptr<RuntimeProgram> program(
+      new RuntimeProgram(std::move(insts)));
+  program->set_exec_scope(scope);
+  return program;
+}
+
+TEST(RuntimeProgram, InterOpParallel) {
+  std::atomic<int> ref_running(0);
+  std::atomic<int> ref_max_running(0);
+  std::atomic<int> running(0);
+  std::atomic<int> max_running(0);
+  Scope ref_scope;
+  Scope scope;
+  auto ref_program = CreateBranches(&ref_scope, &ref_running, &ref_max_running);
+  auto program = CreateBranches(&scope, &running, &max_running);
+  program->EnableInterOpParallel(2, 1);
+  ASSERT_TRUE(program->inter_op_parallel());
+
+  for (int64_t size : {4, 4, 7, 4}) {
+    FillInput(&ref_scope, size);
+    FillInput(&scope, size);
+    ref_program->Run();
+    program->Run();
+    for (int i = 0; i < 4; i++) {
+      auto name = "out" + std::to_string(i);
+      auto* ref_out = ref_scope.FindTensor(name);
+      auto* out = scope.FindTensor(name);
+      ASSERT_EQ(out->dims(), ref_out->dims()) << name;
+      for (int64_t j = 0; j < out->numel(); j++) {
+        EXPECT_EQ(out->data<float>()[j], ref_out->data<float>()[j]) << name;
+      }
+    }
+  }
+  EXPECT_EQ(ref_max_running.load(), 1);
+  EXPECT_EQ(max_running.load(), 2);
+
+  // The sequential run is restored with one thread.
+  program->EnableInterOpParallel(1, 1);
+  EXPECT_FALSE(program->inter_op_parallel());
+}
+
+// Measure the dispatch overhead per op with the tiny tensors.
+TEST(RuntimeProgram, DispatchCost) {
+  const int kNumOps = 500;
+  const int kRepeats = 200;
+  for (bool frozen_shape : {false, true}) {
+    Scope scope;
+    std::string out_name;
+    auto program = CreateProgram(&scope, kNumOps, &out_name);
+    if (frozen_shape) program->EnableFrozenShape();
+    FillInput(&scope, 1);
+    program->Run();
+    auto start = Timer::GetCurrentUS();
+    for (int i = 0; i < kRepeats; i++) {
+      program->Run();
+    }
+    auto cost_ns = (Timer::GetCurrentUS() - start) * 1000 / kRepeats / kNumOps;
+    LOG(INFO) << "frozen_shape: " << frozen_shape << ", " << cost_ns
+              << " ns per op";
+  }
+}
+
+}  // namespace lite
+}  // namespace paddle
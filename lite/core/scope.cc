@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "lite/core/scope.h"
+#include <algorithm>
 #define SCOPE_KIDS_READER_LOCK \
   lite::fluid::AutoRDLock auto_lock(kids_lock_.get());
 #define SCOPE_KIDS_WRITER_LOCK \
@@ -131,5 +132,33 @@ std::vector<std::string> Scope::LocalVarNames() const {
   return keys;
 }
 
+size_t Scope::LocalTensorsMemorySize() const {
+  // The memory reuse pass lets tensors share buffers with different offsets,
+  // so the size of each buffer is the max end of the tensors sharing it.
+  std::map<const void *, size_t> buffer_sizes;
+  auto count_tensor = [&](const Tensor &tensor) {
+    if (tensor.persistable() || !tensor.IsInitialized()) return;
+    auto *base =
+        static_cast<const char *>(tensor.raw_data()) - tensor.offset();
+    auto &size = buffer_sizes[base];
+    size = (std::max)(size, tensor.offset() + tensor.memory_size());
+  };
+  for (const auto &var_name : LocalVarNames()) {
+    auto *var = FindLocalVar(var_name);
+    if (var->IsType<Tensor>()) {
+      count_tensor(var->Get<Tensor>());
+    } else if (var->IsType<std::vector<Tensor>>()) {
+      for (const auto &tensor : var->Get<std::vector<Tensor>>()) {
+        count_tensor(tensor);
+      }
+    }
+  }
+  size_t total_size = 0;
+  for (const auto &item : buffer_sizes) {
+    total_size += item.second;
+  }
+  return total_size;
+}
+
 }  // namespace lite
 }  // namespace paddle
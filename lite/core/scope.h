@@ -58,6 +58,9 @@ class Scope final {
   std::vector<std::string> AttributeVarNames() const;
   // Following the legacy scope interface.
   std::vector<std::string> LocalVarNames() const;
+  // Get the bytes of memory held by the non-persistable tensors and tensor
+  // arrays in this scope, tensors sharing one buffer are counted once.
+  size_t LocalTensorsMemorySize() const;
 
   /// ------------------------------------- helper functions for Tensor
   /// ----------------------------------
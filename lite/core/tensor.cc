@@ -36,7 +36,19 @@ void TensorLite::CopyDataFrom(const TensorLite &other) {
   memory_size_ = other.memory_size_;
   precision_ = other.precision_;
   persistable_ = other.persistable_;
-  buffer_->CopyDataFrom(*other.buffer_, memory_size_);
+  // Detach the view or the buffer shared with the other tensors, e.g. the
+  // output of tensor_array_to_tensor over the arena of the array, so that
+  // they are kept.
+  if (offset_ != 0 || buffer_.use_count() > 1) {
+    buffer_ = std::make_shared<Buffer>();
+    offset_ = 0;
+  }
+  if (other.offset_ == 0) {
+    buffer_->CopyDataFrom(*other.buffer_, memory_size_);
+  } else {
+    buffer_->ResetLazy(target_, memory_size_);
+    TargetCopy(target_, buffer_->data(), other.raw_data(), memory_size_);
+  }
 }
 
 void *TensorLite::mutable_data(size_t memory_size) {
@@ -59,12 +71,10 @@ void TensorLite::ResetBuffer(std::shared_ptr<Buffer> buffer,
                              size_t memory_size) {
   CHECK_EQ(offset_, 0u)
       << "Only the offset is supported to zero when the Buffer is reset.";
-  if (buffer_) {
-    CHECK_LE(memory_size_, buffer->space())
-        << "The space of buffer is not enough to store the tensor.";
-    CHECK_LE(memory_size, buffer->space())
-        << "The buffer is smaller than the specified minimum size.";
-  }
+  // The memory size of the previous buffer is not checked here, since the
+  // tensor may be resized to a smaller shape along with the new buffer.
+  CHECK_LE(memory_size, buffer->space())
+      << "The buffer is smaller than the specified minimum size.";
   buffer_ = buffer;
   memory_size_ = memory_size;
   target_ = buffer->target();
@@ -0,0 +1,232 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/host/kv_cache_attention_compute.h"
+#include <algorithm>
+#include <cstring>
+#include "lite/backends/host/math/kv_cache_attention.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace host {
+
+namespace {
+
+// Copy `len` rows of `dim` floats of `num` heads from `src` to `dst`, the
+// heads of which are `src_stride` and `dst_stride` rows apart.
+void CopyHeads(const float* src,
+               int64_t src_stride,
+               float* dst,
+               int64_t dst_stride,
+               int64_t num,
+               int64_t len,
+               int64_t dim) {
+  if (len == 0) return;
+  for (int64_t n = 0; n < num; n++) {
+    std::memcpy(dst + n * dst_stride * dim,
+                src + n * src_stride * dim,
+                len * dim * sizeof(float));
+  }
+}
+
+}  // namespace
+
+bool KVCacheAttentionCompute::IsReserved(
+    const lite::Tensor* cache, const std::shared_ptr<Buffer>& reserved) const {
+  return reserved != nullptr && cache->offset() == 0 &&
+         cache->raw_data() == reserved->data();
+}
+
+void KVCacheAttentionCompute::UpdateCache(const lite::Tensor* past,
+                                          const lite::Tensor* cur,
+                                          lite::Tensor* present,
+                                          std::shared_ptr<Buffer>* reserved) {
+  auto& param = this->Param<param_t>();
+  const auto& cur_dims = cur->dims();
+  int rank = static_cast<int>(cur_dims.size());
+  int64_t num = cur_dims.count(0, rank - 2);
+  int64_t past_len = past->dims()[rank - 2];
+  int64_t new_len = cur_dims[rank - 2];
+  int64_t seq_len = past_len + new_len;
+  int64_t dim = cur_dims[rank - 1];
+  auto present_dims = cur_dims;
+  present_dims[rank - 2] = seq_len;
+
+  if (present != past) {
+    present->Resize(present_dims);
+    CopyHeads(past->data<float>(),
+              past_len,
+              present->mutable_data<float>(),
+              seq_len,
+              num,
+              past_len,
+              dim);
+  } else if (IsReserved(past, *reserved) &&
+             num * seq_len * dim * sizeof(float) <= (*reserved)->space()) {
+    // Move the past heads apart from the last one, so none of them is
+    // overwritten before it's moved.
+    auto* data = static_cast<float*>((*reserved)->data());
+    for (int64_t n = num - 1; n > 0 && past_len > 0 && new_len > 0; n--) {
+      std::memmove(data + n * seq_len * dim,
+                   data + n * past_len * dim,
+                   past_len * dim * sizeof(float));
+    }
+    present->Resize(present_dims);
+  } else {
+    int64_t capacity = std::max<int64_t>(param.max_seq_len, 2 * seq_len);
+    size_t bytes = num * capacity * dim * sizeof(float);
+    auto buffer = std::make_shared<Buffer>();
+    buffer->ResetLazy(TARGET(kHost), bytes);
+    CopyHeads(past->data<float>(),
+              past_len,
+              static_cast<float*>(buffer->data()),
+              seq_len,
+              num,
+              past_len,
+              dim);
+    present->ResetBuffer(buffer, bytes);
+    present->Resize(present_dims);
+    *reserved = buffer;
+  }
+
+  CopyHeads(cur->data<float>(),
+            new_len,
+            present->mutable_data<float>() + past_len * dim,
+            seq_len,
+            num,
+            new_len,
+            dim);
+}
+
+void KVCacheAttentionCompute::Run() {
+  auto& param = this->Param<param_t>();
+  const auto& q_dims = param.q->dims();
+  int rank = static_cast<int>(q_dims.size());
+  int num = q_dims.count(0, rank - 2);
+  int q_len = q_dims[rank - 2];
+  int head_dim = q_dims[rank - 1];
+  int v_dim = param.v->dims()[rank - 1];
+  int past_len = param.past_k->dims()[rank - 2];
+  int new_len = param.k->dims()[rank - 2];
+  int seq_len = past_len + new_len;
+
+  // Read the keys and values from the updated caches if they're needed,
+  // otherwise read them from the past and new ones without concatenating.
+  const lite::Tensor* past_k = param.past_k;
+  const lite::Tensor* past_v = param.past_v;
+  if (param.present_k) {
+    UpdateCache(param.past_k, param.k, param.present_k, &reserved_k_);
+    UpdateCache(param.past_v, param.v, param.present_v, &reserved_v_);
+    past_k = param.present_k;
+    past_v = param.present_v;
+    past_len = seq_len;
+    new_len = 0;
+  }
+
+  const float* mask = nullptr;
+  int64_t mask_q_stride = 0;
+  int64_t mask_k_stride = 0;
+  if (param.mask) {
+    // The strides of the mask broadcast to [..., q_len, seq_len].
+    const auto& mask_dims = param.mask->dims();
+    int mask_rank = static_cast<int>(mask_dims.size());
+    std::vector<int64_t> strides(rank, 0);
+    int64_t stride = 1;
+    for (int i = mask_rank - 1; i >= 0; i--) {
+      if (mask_dims[i] != 1) strides[rank - mask_rank + i] = stride;
+      stride *= mask_dims[i];
+    }
+    mask_q_stride = strides[rank - 2];
+    mask_k_stride = strides[rank - 1];
+    mask_offsets_.assign(num, 0);
+    for (int n = 0; n < num; n++) {
+      int64_t index = n;
+      for (int axis = rank - 3; axis >= 0; axis--) {
+        mask_offsets_[n] += index % q_dims[axis] * strides[axis];
+        index /= q_dims[axis];
+      }
+    }
+    mask = param.mask->data<float>();
+  }
+
+  scores_.Resize({num, seq_len});
+  lite::host::math::kv_cache_attention(param.q->data<float>(),
+                                       past_k->data<float>(),
+                                       past_v->data<float>(),
+                                       param.k->data<float>(),
+                                       param.v->data<float>(),
+                                       mask,
+                                       mask_offsets_.data(),
+                                       mask_q_stride,
+                                       mask_k_stride,
+                                       scores_.mutable_data<float>(),
+                                       param.out->mutable_data<float>(),
+                                       num,
+                                       q_len,
+                                       past_len,
+                                       new_len,
+                                       head_dim,
+                                       v_dim,
+                                       param.alpha);
+}
+
+}  // namespace host
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_KERNEL(kv_cache_attention,
+                     kHost,
+                     kFloat,
+                     kAny,
+                     paddle::lite::kernels::host::KVCacheAttentionCompute,
+                     def)
+    .BindInput("Q",
+               {LiteType::GetTensorTy(TARGET(kHost),
+                                      PRECISION(kFloat),
+                                      DATALAYOUT(kAny))})
+    .BindInput("K",
+               {LiteType::GetTensorTy(TARGET(kHost),
+                                      PRECISION(kFloat),
+                                      DATALAYOUT(kAny))})
+    .BindInput("V",
+               {LiteType::GetTensorTy(TARGET(kHost),
+                                      PRECISION(kFloat),
+                                      DATALAYOUT(kAny))})
+    .BindInput("PastK",
+               {LiteType::GetTensorTy(TARGET(kHost),
+                                      PRECISION(kFloat),
+                                      DATALAYOUT(kAny))})
+    .BindInput("PastV",
+               {LiteType::GetTensorTy(TARGET(kHost),
+                                      PRECISION(kFloat),
+                                      DATALAYOUT(kAny))})
+    .BindInput("Mask",
+               {LiteType::GetTensorTy(TARGET(kHost),
+                                      PRECISION(kFloat),
+                                      DATALAYOUT(kAny))})
+    .BindOutput("Out",
+                {LiteType::GetTensorTy(TARGET(kHost),
+                                       PRECISION(kFloat),
+                                       DATALAYOUT(kAny))})
+    .BindOutput("PresentK",
+                {LiteType::GetTensorTy(TARGET(kHost),
+                                       PRECISION(kFloat),
+                                       DATALAYOUT(kAny))})
+    .BindOutput("PresentV",
+                {LiteType::GetTensorTy(TARGET(kHost),
+                                       PRECISION(kFloat),
+                                       DATALAYOUT(kAny))})
+    .Finalize();
@@ -0,0 +1,61 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace host {
+
+class KVCacheAttentionCompute
+    : public KernelLite<TARGET(kHost), PRECISION(kFloat), DATALAYOUT(kAny)> {
+ public:
+  using param_t = operators::KVCacheAttentionParam;
+
+  void Run() override;
+
+  virtual ~KVCacheAttentionCompute() = default;
+
+ private:
+  // Whether `cache` is held by `reserved`, the memory of an in-place cache
+  // with the room for max_seq_len or twice the rows when it's grown.
+  bool IsReserved(const lite::Tensor* cache,
+                  const std::shared_ptr<Buffer>& reserved) const;
+
+  // Write `past` followed by `cur` along the sequence axis to `present`,
+  // which stays dense as [..., seq_len, dim] for the other readers of it.
+  // If `present` is `past`, e.g. the loop-carried cache of a `while` block,
+  // the rows are grown in place in the memory held by `reserved`, the past
+  // heads are only moved apart rather than copied to a new cache.
+  void UpdateCache(const lite::Tensor* past,
+                   const lite::Tensor* cur,
+                   lite::Tensor* present,
+                   std::shared_ptr<Buffer>* reserved);
+
+  std::shared_ptr<Buffer> reserved_k_;
+  std::shared_ptr<Buffer> reserved_v_;
+  lite::Tensor scores_;
+  std::vector<int64_t> mask_offsets_;
+};
+
+}  // namespace host
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
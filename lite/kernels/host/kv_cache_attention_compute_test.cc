@@ -0,0 +1,191 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "lite/core/op_registry.h"
+#include "lite/kernels/host/kv_cache_attention_compute.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace host {
+
+const int kBatch = 2;
+const int kHeads = 3;
+const int kHeadDim = 4;
+const float kAlpha = 0.5f;
+
+void FillRandom(Tensor* x, const std::vector<int64_t>& dims, int seed) {
+  x->Resize(dims);
+  auto* data = x->mutable_data<float>();
+  for (int64_t i = 0; i < x->numel(); i++) {
+    data[i] = static_cast<float>((i * 37 + seed * 101) % 23) / 23.f - 0.5f;
+  }
+}
+
+// Append `cur` to `cache` along the sequence axis.
+void Concat(const Tensor& cur, Tensor* cache) {
+  int64_t past_len = cache->dims().empty() ? 0 : cache->dims()[2];
+  int64_t new_len = cur.dims()[2];
+  int64_t seq_len = past_len + new_len;
+  std::vector<float> past(cache->numel());
+  if (past_len > 0) {
+    std::copy(cache->data<float>(),
+              cache->data<float>() + cache->numel(),
+              past.begin());
+  }
+  cache->Resize({kBatch, kHeads, seq_len, kHeadDim});
+  auto* data = cache->mutable_data<float>();
+  for (int n = 0; n < kBatch * kHeads; n++) {
+    for (int64_t j = 0; j < seq_len; j++) {
+      for (int d = 0; d < kHeadDim; d++) {
+        int64_t row = j < past_len ? n * past_len + j
+                                   : n * new_len + j - past_len;
+        int64_t offset = row * kHeadDim + d;
+        data[(n * seq_len + j) * kHeadDim + d] =
+            j < past_len ? past[offset] : cur.data<float>()[offset];
+      }
+    }
+  }
+}
+
+// The attention over the concatenated keys and values with the mask of
+// [batch, 1, 1, seq_len].
+void Attention(const Tensor& q,
+               const Tensor& k,
+               const Tensor& v,
+               const Tensor& mask,
+               std::vector<float>* out) {
+  int q_len = q.dims()[2];
+  int seq_len = k.dims()[2];
+  out->assign(q.numel(), 0.f);
+  for (int n = 0; n < kBatch * kHeads; n++) {
+    for (int i = 0; i < q_len; i++) {
+      std::vector<float> scores(seq_len);
+      float max_score = -1e30f;
+      for (int j = 0; j < seq_len; j++) {
+        float dot = 0.f;
+        for (int d = 0; d < kHeadDim; d++) {
+          dot += q.data<float>()[(n * q_len + i) * kHeadDim + d] *
+                 k.data<float>()[(n * seq_len + j) * kHeadDim + d];
+        }
+        scores[j] = kAlpha * dot + mask.data<float>()[n / kHeads * seq_len + j];
+        max_score = std::max(max_score, scores[j]);
+      }
+      float sum = 0.f;
+      for (int j = 0; j < seq_len; j++) {
+        scores[j] = std::exp(scores[j] - max_score);
+        sum += scores[j];
+      }
+      for (int j = 0; j < seq_len; j++) {
+        for (int d = 0; d < kHeadDim; d++) {
+          float value = v.data<float>()[(n * seq_len + j) * kHeadDim + d];
+          (*out)[(n * q_len + i) * kHeadDim + d] += scores[j] / sum * value;
+        }
+      }
+    }
+  }
+}
+
+void ExpectEqual(const Tensor& cache, const Tensor& expected) {
+  ASSERT_EQ(cache.dims(), expected.dims());
+  for (int64_t i = 0; i < cache.numel(); i++) {
+    EXPECT_EQ(cache.data<float>()[i], expected.data<float>()[i]);
+  }
+}
+
+// Run a prompt of 3 tokens followed by the decoding steps of 1 token, with
+// the caches updated in place or passed as the pasts.
+void RunDecoding(bool in_place) {
+  KVCacheAttentionCompute attention;
+  Tensor q, k, v, mask, out, cache_k, cache_v, ref_k, ref_v;
+  cache_k.Resize({kBatch, kHeads, 0, kHeadDim});
+  cache_v.Resize({kBatch, kHeads, 0, kHeadDim});
+  operators::KVCacheAttentionParam param;
+  param.q = &q;
+  param.k = &k;
+  param.v = &v;
+  param.past_k = &cache_k;
+  param.past_v = &cache_v;
+  param.mask = &mask;
+  param.out = &out;
+  if (in_place) {
+    param.present_k = &cache_k;
+    param.present_v = &cache_v;
+  }
+  param.alpha = kAlpha;
+  attention.SetParam(param);
+
+  const float* cache_data = nullptr;
+  int allocations = 0;
+  int seq_len = 0;
+  for (int step = 0; step < 20; step++) {
+    int new_len = step == 0 ? 3 : 1;
+    seq_len += new_len;
+    FillRandom(&q, {kBatch, kHeads, new_len, kHeadDim}, step);
+    FillRandom(&k, {kBatch, kHeads, new_len, kHeadDim}, step + 100);
+    FillRandom(&v, {kBatch, kHeads, new_len, kHeadDim}, step + 200);
+    mask.Resize({kBatch, 1, 1, seq_len});
+    auto* mask_data = mask.mutable_data<float>();
+    for (int i = 0; i < kBatch * seq_len; i++) {
+      mask_data[i] = i % 7 == 1 ? -10000.f : 0.f;
+    }
+    out.Resize({kBatch, kHeads, new_len, kHeadDim});
+    attention.Run();
+
+    Concat(k, &ref_k);
+    Concat(v, &ref_v);
+    std::vector<float> ref_out;
+    Attention(q, ref_k, ref_v, mask, &ref_out);
+    for (int64_t i = 0; i < out.numel(); i++) {
+      EXPECT_NEAR(out.data<float>()[i], ref_out[i], 1e-5);
+    }
+
+    if (in_place) {
+      // The caches are appended without being reallocated per token, they
+      // are reallocated for twice the tokens when they're full.
+      if (cache_k.data<float>() != cache_data) allocations++;
+      cache_data = cache_k.data<float>();
+      ExpectEqual(cache_k, ref_k);
+      ExpectEqual(cache_v, ref_v);
+    } else {
+      Concat(k, &cache_k);
+      Concat(v, &cache_v);
+    }
+  }
+  // The caches are read after the loop as the dense ones, e.g. by the parent
+  // block of `while`.
+  Tensor last_k, last_v;
+  last_k.CopyDataFrom(cache_k);
+  last_v.CopyDataFrom(cache_v);
+  ExpectEqual(last_k, ref_k);
+  ExpectEqual(last_v, ref_v);
+  // The caches of 22 tokens are allocated for 3, 7 and 15 tokens.
+  if (in_place) EXPECT_EQ(allocations, 3);
+}
+
+TEST(kv_cache_attention, in_place) { RunDecoding(true); }
+
+TEST(kv_cache_attention, past) { RunDecoding(false); }
+
+}  // namespace host
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(kv_cache_attention, kHost, kFloat, kAny, def);
@@ -13,7 +13,9 @@
 // limitations under the License.
 
 #include "lite/kernels/host/sequence_expand_compute.h"
+#include <cstring>
 #include <vector>
+#include "lite/backends/host/math/sequence_view.h"
 
 namespace paddle {
 namespace lite {
@@ -40,12 +42,9 @@ void SequenceExpandFunc(const Tensor& x,
         out_start = out->lod()[0][out_offset];
       }
       for (uint64_t j = 0; j < repeat_num; j++) {
-        for (uint64_t k = 0; k < x_seq_len; k++) {
-          for (int l = 0; l < x_item_length; l++) {
-            out_data[(out_start + j * x_seq_len + k) * x_item_length + l] =
-                x_data[(x_start + k) * x_item_length + l];
-          }
-        }
+        memcpy(out_data + (out_start + j * x_seq_len) * x_item_length,
+               x_data + x_start * x_item_length,
+               x_seq_len * x_item_length * sizeof(T));
       }
     }
     out_offset += repeat_num;
@@ -64,11 +63,16 @@ void SequenceExpandCompute<T, PType>::Run() {
 
   if (ref_level == -1) ref_level = y_lod.size() - 1;
 
-  out->template mutable_data<T>();
+  // Out is X itself if nothing is expanded, share the storage of X instead
+  // of copying it.
   if (y_lod[ref_level].size() <= 1) {
-    out->CopyDataFrom(*x);
+    out->ShareDataWith(*x);
     return;
   }
+  bool expanded = false;
+  for (size_t i = 1; i < y_lod[ref_level].size(); ++i) {
+    expanded |= y_lod[ref_level][i] - y_lod[ref_level][i - 1] != 1;
+  }
 
   std::vector<uint64_t> out_lod;
   if (x_lod.size() == 1) {
@@ -97,6 +101,11 @@ void SequenceExpandCompute<T, PType>::Run() {
     std::iota(ref_x_lod.begin(), ref_x_lod.end(), 0);
   }
 
+  if (!expanded && out->numel() == x->numel()) {
+    lite::host::math::ShareSequences(*x, out);
+    return;
+  }
+  lite::host::math::DetachSequences(*x, out);
   SequenceExpandFunc<T>(*x, ref_x_lod, y_lod[ref_level], out);
 }
 
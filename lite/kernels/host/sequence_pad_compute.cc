@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #include "lite/kernels/host/sequence_pad_compute.h"
+#include <algorithm>
+#include <vector>
 #include "lite/backends/host/math/sequence_padding.h"
+#include "lite/backends/host/math/sequence_view.h"
 
 namespace paddle {
 namespace lite {
@@ -32,20 +35,42 @@ void SequencePadCompute<T>::Run() {
   CHECK(!x->lod().empty()) << "Input X should have lod data.";
   int padded_length = param.padded_length;
 
-  lite::host::math::PaddingLoDTensorFunctor<lite::TargetType::kHost, T>()(
-      ctx,
-      *x,
-      out,
-      *pad_value,
-      padded_length,
-      0,
-      false,
+  // The sequences of the same length fill the padded tensor exactly, share
+  // the storage of X instead of copying it.
+  const auto& x_lod0 = x->lod()[0];
+  int64_t step_width = x->numel() / x->dims()[0];
+  std::vector<uint64_t> lengths(x_lod0.size() - 1);
+  uint64_t max_length = 0;
+  for (size_t i = 0; i < lengths.size(); ++i) {
+    lengths[i] = x_lod0[i + 1] - x_lod0[i];
+    max_length = std::max(max_length, lengths[i]);
+  }
+  auto x_view = lite::host::math::LoDSequences(x_lod0, step_width);
+  auto out_view = lite::host::math::PaddedSequences(
+      lengths,
+      padded_length == -1 ? max_length : padded_length,
+      step_width,
       lite::host::math::kBatchLengthWidth);
+  if (x->lod().size() == 1 && x_lod0.back() == x->dims()[0] &&
+      out->numel() == x->numel() &&
+      lite::host::math::IsSameLayout(x_view, out_view)) {
+    lite::host::math::ShareSequences(*x, out);
+  } else {
+    lite::host::math::DetachSequences(*x, out);
+    lite::host::math::PaddingLoDTensorFunctor<lite::TargetType::kHost, T>()(
+        ctx,
+        *x,
+        out,
+        *pad_value,
+        padded_length,
+        0,
+        false,
+        lite::host::math::kBatchLengthWidth);
+  }
 
   auto* len_data = len_t->template mutable_data<int64_t>();
-  auto x_lod = x->lod();
-  for (size_t i = 1; i < x_lod[0].size(); i++) {
-    len_data[i - 1] = x_lod[0][i] - x_lod[0][i - 1];
+  for (size_t i = 0; i < lengths.size(); i++) {
+    len_data[i] = lengths[i];
   }
 }
 
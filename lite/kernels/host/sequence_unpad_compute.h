@@ -13,8 +13,10 @@
 // limitations under the License.
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include "lite/backends/host/math/sequence_padding.h"
+#include "lite/backends/host/math/sequence_view.h"
 #include "lite/core/kernel.h"
 #include "lite/core/op_registry.h"
 
@@ -59,8 +61,23 @@ class SequenceUnpadCompute
     param.Out->Resize(out_dims);
     param.Out->set_lod(out_lod);
 
-    param.Out->template mutable_data<T>();
+    // The sequences of the full padded length are laid out as the unpadded
+    // ones, share the storage of X instead of copying it.
     int64_t padded_length = param.X->dims()[1];
+    int64_t step_width =
+        param.X->numel() / std::max<int64_t>(x_dims[0] * padded_length, 1);
+    std::vector<uint64_t> lengths(seq_len_ptr, seq_len_ptr + batch_size);
+    auto out_view = math::LoDSequences(out_lod0, step_width);
+    auto x_view = math::PaddedSequences(
+        lengths, padded_length, step_width, math::kBatchLengthWidth);
+    if (param.X->numel() == param.Out->numel() &&
+        math::IsSameLayout(x_view, out_view)) {
+      math::ShareSequences(*param.X, param.Out);
+      return;
+    }
+
+    math::DetachSequences(*param.X, param.Out);
+    param.Out->template mutable_data<T>();
     math::UnpaddingLoDTensorFunctor<lite::TargetType::kHost, T>()(
         ctx,
         *param.X,
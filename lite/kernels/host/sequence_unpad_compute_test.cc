@@ -0,0 +1,101 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "lite/core/op_registry.h"
+#include "lite/kernels/host/sequence_unpad_compute.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace host {
+
+// Fill x of [lengths.size(), padded_length, 2] with the step t of the
+// sequence i as `base + 10 * i + t`.
+void FillPadded(const std::vector<int64_t>& lengths,
+                int64_t padded_length,
+                float base,
+                Tensor* x,
+                Tensor* length) {
+  const int64_t batch = lengths.size();
+  x->Resize({batch, padded_length, 2});
+  auto* x_data = x->mutable_data<float>();
+  for (int64_t i = 0; i < batch; i++) {
+    for (int64_t t = 0; t < padded_length; t++) {
+      for (int j = 0; j < 2; j++) {
+        x_data[(i * padded_length + t) * 2 + j] = base + 10 * i + t;
+      }
+    }
+  }
+  length->Resize({batch});
+  std::copy(lengths.begin(), lengths.end(), length->mutable_data<int64_t>());
+}
+
+void ExpectUnpadded(const std::vector<int64_t>& lengths,
+                    float base,
+                    const Tensor& out) {
+  int64_t row = 0;
+  for (size_t i = 0; i < lengths.size(); i++) {
+    EXPECT_EQ(out.lod()[0][i], static_cast<uint64_t>(row));
+    for (int64_t t = 0; t < lengths[i]; t++, row++) {
+      for (int j = 0; j < 2; j++) {
+        EXPECT_EQ(out.data<float>()[row * 2 + j], base + 10 * i + t);
+      }
+    }
+  }
+  EXPECT_EQ(out.dims()[0], row);
+}
+
+TEST(sequence_unpad_host, share_then_copy) {
+  Tensor x, length, out;
+  SequenceUnpadCompute<float> unpad;
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  ctx->As<HostContext>();
+  unpad.SetContext(std::move(ctx));
+  operators::SequenceUnpadParam param;
+  param.X = &x;
+  param.Length = &length;
+  param.Out = &out;
+  unpad.SetParam(param);
+
+  // None of the sequences is padded, Out shares the storage of X.
+  std::vector<int64_t> full{3, 3};
+  FillPadded(full, 3, 0.f, &x, &length);
+  unpad.Run();
+  EXPECT_EQ(out.raw_data(), x.raw_data());
+  ExpectUnpadded(full, 0.f, out);
+
+  // Out is given its own storage again before the padded sequences are
+  // copied, X is kept as it is.
+  std::vector<int64_t> padded{1, 2};
+  FillPadded(padded, 3, 100.f, &x, &length);
+  unpad.Run();
+  EXPECT_NE(out.raw_data(), x.raw_data());
+  ExpectUnpadded(padded, 100.f, out);
+  for (int64_t i = 0; i < x.numel(); i++) {
+    int64_t step = i / 2;
+    EXPECT_EQ(x.data<float>()[i], 100.f + 10 * (step / 3) + step % 3);
+  }
+}
+
+}  // namespace host
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
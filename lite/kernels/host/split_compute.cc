@@ -38,6 +38,39 @@ void SplitCompute<T, PType>::Run() {
     axis += static_cast<int>(param.x->dims().size());
   }
 
+  // The outputs are the contiguous slices of the input if all the dims
+  // before the axis are 1, so they share the memory of the input.
+  if (param.inplace && in_dim.count(0, axis) == 1) {
+    lite::Tensor flat_x;
+    flat_x.ShareDataWith(*param.x);
+    flat_x.Resize({param.x->numel()});
+    int64_t inner_size = in_dim.count(axis + 1, in_dim.size());
+    int64_t begin = 0;
+    for (auto* out : dout) {
+      auto out_dims = out->dims();
+      auto out_lod = out->lod();
+      int64_t size = out_dims[axis] * inner_size;
+      out->ShareDataWith(flat_x.template Slice<T>(begin, begin + size));
+      out->set_precision(param.x->precision());
+      out->Resize(out_dims);
+      out->set_lod(out_lod);
+      begin += size;
+    }
+    shared_ = true;
+    return;
+  }
+  if (shared_) {
+    // Detach the outputs from the input before writing them.
+    for (auto* out : dout) {
+      auto out_dims = out->dims();
+      auto out_lod = out->lod();
+      out->ShareDataWith(lite::Tensor());
+      out->Resize(out_dims);
+      out->set_lod(out_lod);
+    }
+    shared_ = false;
+  }
+
   lite::host::math::split(din, dout, axis, in_strides);
 }
 
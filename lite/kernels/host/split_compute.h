@@ -27,6 +27,10 @@ class SplitCompute : public KernelLite<TARGET(kHost), PType> {
   void Run() override;
 
   virtual ~SplitCompute() = default;
+
+ private:
+  // Whether the outputs share the memory of the input in the last run.
+  bool shared_{false};
 };
 
 }  // namespace host
@@ -22,10 +22,58 @@ namespace lite {
 namespace kernels {
 namespace host {
 
+namespace {
+
+// Share the inputs without copying if they're stored contiguously in order,
+// e.g. the entries written by write_to_array, and the output is their
+// concatenation or stacking along the first axis.
+bool ShareContiguousInputs(const std::vector<Tensor>& x,
+                           int axis,
+                           bool use_stack,
+                           Tensor* out) {
+  if (x.empty() || axis != 0 || x[0].dims().empty()) return false;
+  auto precision = x[0].precision();
+  size_t type_size = PrecisionTypeLength(precision);
+  if (type_size == 0) return false;
+  auto dims = x[0].dims();
+  int64_t rows = 0;
+  auto* next = static_cast<const char*>(x[0].raw_data());
+  for (auto& tensor : x) {
+    if (!tensor.IsInitialized() || tensor.precision() != precision ||
+        tensor.raw_data() != next || tensor.dims().size() != dims.size()) {
+      return false;
+    }
+    for (size_t i = use_stack ? 0 : 1; i < dims.size(); i++) {
+      if (tensor.dims()[i] != dims[i]) return false;
+    }
+    rows += tensor.dims()[0];
+    next += tensor.numel() * type_size;
+  }
+
+  auto out_dims = dims.Vectorize();
+  if (use_stack) {
+    out_dims.insert(out_dims.begin(), static_cast<int64_t>(x.size()));
+  } else {
+    out_dims[0] = rows;
+  }
+  auto lod = out->lod();
+  int64_t bytes = next - static_cast<const char*>(x[0].raw_data());
+  Tensor flat;
+  flat.ShareDataWith(x[0]);
+  flat.Resize({bytes});
+  *out = flat.Slice<int8_t>(0, bytes);
+  out->Resize(out_dims);
+  out->set_precision(precision);
+  out->set_lod(lod);
+  return true;
+}
+
+}  // namespace
+
 void TensorArrayToTensorCompute::Run() {
   auto& param = this->Param<param_t>();
   auto OutIndex = param.OutIndex;
-  auto X = *param.X;
+  auto& X = *param.X;
   int axis = param.axis;
   size_t n = X.size();
   auto OutIndex_data = OutIndex->mutable_data<float>();
@@ -39,10 +87,9 @@ void TensorArrayToTensorCompute::Run() {
 
   bool use_stack = param.use_stack;
   auto out = param.Out;
-  if (use_stack) {
-    lite::host::math::stack_func<float>(inputs, axis, out);
-  } else {
-    lite::host::math::concat_func<float>(inputs, axis, out);
+  // The entries are kept, the shared buffer is kept alive by the output.
+  if (ShareContiguousInputs(X, axis, use_stack, out)) {
+    return;
   }
 
 #define PROCESS(precision, dtype)                              \
@@ -65,7 +112,6 @@ void TensorArrayToTensorCompute::Run() {
     default:
       LOG(FATAL) << "unsupported input(x) type:" << static_cast<int>(precision);
   }
-  param.X->clear();
 #undef PROCESS
 }
 
@@ -13,21 +13,142 @@
 // limitations under the License.
 
 #include "lite/kernels/host/write_to_array_compute.h"
+#include <algorithm>
+#include <cstring>
 
 namespace paddle {
 namespace lite {
 namespace kernels {
 namespace host {
 
+namespace {
+
+const size_t kMinArenaBytes = 4096;
+
+// Create a view of `bytes` bytes at `offset` of `buffer` with the dims,
+// precision and lod of `meta`.
+Tensor ArenaView(const std::shared_ptr<Buffer>& buffer,
+                 size_t offset,
+                 size_t bytes,
+                 const Tensor& meta) {
+  Tensor arena(buffer);
+  arena.Resize({static_cast<int64_t>(buffer->space())});
+  auto view = arena.Slice<int8_t>(offset, offset + bytes);
+  view.Resize(meta.dims());
+  view.set_precision(meta.precision());
+  view.set_lod(meta.lod());
+  return view;
+}
+
+size_t DataBytes(const Tensor& tensor) {
+  return tensor.numel() * PrecisionTypeLength(tensor.precision());
+}
+
+}  // namespace
+
+bool WriteToArrayCompute::IsView(const Tensor& entry) const {
+  if (!arena_ || arena_size_ == 0) return false;
+  auto* begin = static_cast<const char*>(arena_->data());
+  auto* data = static_cast<const char*>(entry.raw_data());
+  return data >= begin && data < begin + arena_size_;
+}
+
+bool WriteToArrayCompute::IsTail(const std::vector<Tensor>& out) const {
+  if (out.empty() || !IsView(out.back())) return false;
+  auto* end = static_cast<const char*>(out.back().raw_data()) +
+              DataBytes(out.back());
+  return end == static_cast<const char*>(arena_->data()) + arena_size_;
+}
+
+void WriteToArrayCompute::ResetArena() {
+  // Keep the buffer shared by the others, e.g. the entries of the previous
+  // array or the output of tensor_array_to_tensor.
+  if (arena_ && arena_.use_count() > 1) {
+    reserved_bytes_ = std::max(reserved_bytes_, arena_->space());
+    std::swap(arena_, spare_arena_);
+    if (arena_ && arena_.use_count() > 1) arena_.reset();
+  }
+  arena_size_ = 0;
+  num_views_ = 0;
+}
+
+void WriteToArrayCompute::Append(const Tensor& x,
+                                 size_t bytes,
+                                 std::vector<Tensor>* out) {
+  size_t required = arena_size_ + bytes;
+  if (!arena_ || arena_->space() < required) {
+    size_t capacity = arena_ ? 2 * arena_->space()
+                             : std::max(kMinArenaBytes, reserved_bytes_);
+    capacity = std::max(capacity, required);
+    auto arena = std::make_shared<Buffer>();
+    arena->ResetLazy(TARGET(kHost), capacity);
+    if (arena_size_ > 0) {
+      std::memcpy(arena->data(), arena_->data(), arena_size_);
+    }
+    // Move the views to the new buffer, the old one is released unless it's
+    // shared by the others.
+    auto* begin = static_cast<const char*>(arena_ ? arena_->data() : nullptr);
+    for (auto& entry : *out) {
+      if (!IsView(entry)) continue;
+      size_t offset = static_cast<const char*>(entry.raw_data()) - begin;
+      entry = ArenaView(arena, offset, DataBytes(entry), entry);
+    }
+    arena_ = arena;
+  }
+  out->push_back(ArenaView(arena_, arena_size_, bytes, x));
+  std::memcpy(out->back().raw_data(), x.raw_data(), bytes);
+  arena_size_ += bytes;
+  num_views_++;
+}
+
 void WriteToArrayCompute::Run() {
   auto& param = this->template Param<operators::WriteToArrayParam>();
   CHECK_EQ(param.I->numel(), 1) << "input2 should have only one element";
 
   int id = param.I->data<int64_t>()[0];
-  if (param.Out->size() < id + 1) {
-    param.Out->resize(id + 1);
+  auto* out = param.Out;
+  const auto& x = *param.X;
+  // The arrays live across the runs, a write at index 0 to the array started
+  // by this kernel starts it again, the same as the arrays which are created
+  // by every run of Paddle.
+  if (id == 0 && !out->empty() && arena_ && arena_size_ > 0 &&
+      out->front().raw_data() == arena_->data()) {
+    out->clear();
+  }
+  // The appended views are only valid if the end of the buffer is still the
+  // end of the array, it's not if the array is cleared or written by the
+  // other kernels.
+  if (!IsTail(*out)) {
+    ResetArena();
+  }
+
+  size_t bytes = DataBytes(x);
+  auto target = x.target();
+  bool is_host = target == TARGET(kHost) || target == TARGET(kX86) ||
+                 target == TARGET(kARM);
+  bool viewable = is_host && bytes > 0 && x.IsInitialized();
+  if (viewable && id == static_cast<int>(out->size())) {
+    Append(x, bytes, out);
+    return;
+  }
+  if (out->size() < id + 1) {
+    out->resize(id + 1);
+  }
+  auto& entry = out->at(id);
+  if (IsView(entry)) {
+    // Overwrite the view in place if the buffer isn't shared by the others.
+    if (viewable && DataBytes(entry) == bytes &&
+        arena_.use_count() == 1 + num_views_) {
+      std::memcpy(entry.raw_data(), x.raw_data(), bytes);
+      entry.Resize(x.dims());
+      entry.set_precision(x.precision());
+      entry.set_lod(x.lod());
+      return;
+    }
+    entry = Tensor();
+    num_views_--;
   }
-  param.Out->at(id).CopyDataFrom(*param.X);
+  entry.CopyDataFrom(x);
 }
 
 }  // namespace host
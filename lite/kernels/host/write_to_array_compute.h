@@ -13,7 +13,10 @@
 // limitations under the License.
 
 #pragma once
+#include <memory>
+#include <vector>
 #include "lite/core/kernel.h"
+#include "lite/core/memory.h"
 #include "lite/core/op_registry.h"
 
 namespace paddle {
@@ -29,6 +32,25 @@ class WriteToArrayCompute
   ~WriteToArrayCompute() {}
 
  private:
+  // The entries appended in order are the views of a contiguous buffer,
+  // which grows by doubling and is reused by the following arrays, so that
+  // tensor_array_to_tensor can share it without copying.
+  void Append(const Tensor& x, size_t bytes, std::vector<Tensor>* out);
+  bool IsView(const Tensor& entry) const;
+  // Whether the last entry of `out` ends at the end of the used buffer.
+  bool IsTail(const std::vector<Tensor>& out) const;
+  // Restart the buffer, switch to another one if it's shared by the others.
+  void ResetArena();
+
+  std::shared_ptr<Buffer> arena_;
+  // The buffer of the previous array, which may be still shared by the
+  // output of tensor_array_to_tensor.
+  std::shared_ptr<Buffer> spare_arena_;
+  size_t arena_size_{0};
+  // The capacity of the previous buffer, used to allocate the new one.
+  size_t reserved_bytes_{0};
+  // The number of the entries which are the views of `arena_`.
+  int num_views_{0};
 };
 
 }  // namespace host
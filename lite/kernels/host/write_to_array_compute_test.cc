@@ -0,0 +1,176 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "lite/core/op_registry.h"
+#include "lite/kernels/host/tensor_array_to_tensor_compute.h"
+#include "lite/kernels/host/write_to_array_compute.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace host {
+
+// Write the entries [begin, end) of [1, 3] like a decoding loop, entry i is
+// filled with `base + i`.
+void WriteSteps(WriteToArrayCompute* write,
+                std::vector<Tensor>* array,
+                int begin,
+                int end,
+                float base) {
+  Tensor x, id;
+  x.Resize({1, 3});
+  id.Resize({1});
+  operators::WriteToArrayParam param;
+  param.X = &x;
+  param.I = &id;
+  param.Out = array;
+  write->SetParam(param);
+  for (int i = begin; i < end; i++) {
+    auto* x_data = x.mutable_data<float>();
+    for (int j = 0; j < 3; j++) x_data[j] = base + i;
+    id.mutable_data<int64_t>()[0] = i;
+    write->Run();
+  }
+}
+
+void WriteSteps(WriteToArrayCompute* write,
+                std::vector<Tensor>* array,
+                int steps,
+                float base) {
+  WriteSteps(write, array, 0, steps, base);
+}
+
+void ToTensor(std::vector<Tensor>* array, bool use_stack, Tensor* out) {
+  // The output shape inferred by the op.
+  auto out_dims = array->at(0).dims().Vectorize();
+  if (use_stack) {
+    out_dims.insert(out_dims.begin(), static_cast<int64_t>(array->size()));
+  } else {
+    for (size_t i = 1; i < array->size(); i++) {
+      out_dims[0] += array->at(i).dims()[0];
+    }
+  }
+  out->Resize(out_dims);
+  Tensor out_index;
+  out_index.Resize({static_cast<int64_t>(array->size())});
+  TensorArrayToTensorCompute to_tensor;
+  operators::TensorArrayToTensorParam param;
+  param.X = array;
+  param.Out = out;
+  param.OutIndex = &out_index;
+  param.axis = 0;
+  param.use_stack = use_stack;
+  to_tensor.SetParam(param);
+  to_tensor.Run();
+}
+
+void CheckSteps(const Tensor& out, int steps, float base) {
+  ASSERT_EQ(out.numel(), steps * 3);
+  for (int i = 0; i < steps; i++) {
+    for (int j = 0; j < 3; j++) {
+      EXPECT_EQ(out.data<float>()[i * 3 + j], base + i);
+    }
+  }
+}
+
+TEST(write_to_array, contiguous) {
+  const int kSteps = 1000;
+  WriteToArrayCompute write;
+  std::vector<Tensor> array;
+  WriteSteps(&write, &array, kSteps, 0.f);
+  ASSERT_EQ(array.size(), static_cast<size_t>(kSteps));
+  for (int i = 0; i < kSteps; i++) {
+    EXPECT_EQ(array[i].dims(), DDim({1, 3}));
+    EXPECT_EQ(array[i].data<float>(), array[0].data<float>() + i * 3);
+    EXPECT_EQ(array[i].data<float>()[0], i);
+  }
+
+  // Overwrite the entries in place.
+  WriteSteps(&write, &array, 1, 3, 100.f);
+  EXPECT_EQ(array[1].data<float>(), array[0].data<float>() + 3);
+  EXPECT_EQ(array[1].data<float>()[0], 101.f);
+  EXPECT_EQ(array[2].data<float>()[0], 102.f);
+  EXPECT_EQ(array[3].data<float>()[0], 3.f);
+
+  // A write at index 0 starts the array again in the same buffer.
+  const float* array_data = array[0].data<float>();
+  WriteSteps(&write, &array, 2, 200.f);
+  ASSERT_EQ(array.size(), 2u);
+  EXPECT_EQ(array[0].data<float>(), array_data);
+  EXPECT_EQ(array[1].data<float>(), array_data + 3);
+  EXPECT_EQ(array[1].data<float>()[0], 201.f);
+}
+
+TEST(tensor_array_to_tensor, zero_copy) {
+  const int kSteps = 100;
+  WriteToArrayCompute write;
+  for (bool use_stack : {false, true}) {
+    std::vector<Tensor> array;
+    WriteSteps(&write, &array, kSteps, 0.f);
+    const float* array_data = array[0].data<float>();
+    Tensor out;
+    ToTensor(&array, use_stack, &out);
+    // The input is kept.
+    ASSERT_EQ(array.size(), static_cast<size_t>(kSteps));
+    EXPECT_EQ(array[kSteps - 1].data<float>()[0], kSteps - 1);
+    EXPECT_EQ(out.data<float>(), array_data);
+    EXPECT_EQ(out.dims(), use_stack ? DDim({kSteps, 1, 3}) : DDim({kSteps, 3}));
+    CheckSteps(out, kSteps, 0.f);
+
+    // The next array can't overwrite the shared output.
+    WriteSteps(&write, &array, kSteps, 1000.f);
+    CheckSteps(out, kSteps, 0.f);
+    Tensor copied;
+    copied.CopyDataFrom(array[kSteps / 2]);
+    EXPECT_EQ(copied.data<float>()[0], 1000.f + kSteps / 2);
+    ToTensor(&array, use_stack, &out);
+    CheckSteps(out, kSteps, 1000.f);
+  }
+}
+
+// The array is written by two kernels, the first entry before the loop and
+// the others in the loop, and converted to a tensor in every run, the runs
+// are shorter or longer than the previous ones.
+TEST(tensor_array_to_tensor, two_writers_runs) {
+  WriteToArrayCompute write_first, write_loop;
+  std::vector<Tensor> array;
+  std::vector<Tensor> outs;
+  std::vector<int> all_steps{5, 3, 8, 8, 1, 6};
+  for (size_t run = 0; run < all_steps.size(); run++) {
+    int steps = all_steps[run];
+    float base = 100.f * run;
+    WriteSteps(&write_first, &array, 0, 1, base);
+    WriteSteps(&write_loop, &array, 1, steps, base);
+    ASSERT_EQ(array.size(), static_cast<size_t>(steps));
+    outs.emplace_back();
+    ToTensor(&array, false, &outs.back());
+    CheckSteps(outs.back(), steps, base);
+    ASSERT_EQ(array.size(), static_cast<size_t>(steps));
+    for (int i = 0; i < steps; i++) {
+      EXPECT_EQ(array[i].data<float>()[0], base + i);
+    }
+  }
+  // The outputs of the previous runs aren't overwritten.
+  for (size_t run = 0; run < all_steps.size(); run++) {
+    CheckSteps(outs[run], all_steps[run], 100.f * run);
+  }
+}
+
+}  // namespace host
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
@@ -14,6 +14,7 @@
 
 #include "lite/kernels/x86/fc_compute.h"
 #include "lite/backends/x86/math/gemm_s8u8_compute.h"
+#include "lite/backends/x86/math/jit_gemm.h"
 #include "lite/backends/x86/math/saturate.h"
 
 namespace paddle {
@@ -139,6 +140,33 @@ class FCFunctor {
   }
 };
 
+static bool UseJitGemm(const operators::FcParam& param, int m) {
+  if (param.padding_weights || !param.w->persistable()) {
+    return false;
+  }
+  if (!param.activation_type.empty() && param.activation_type != "relu") {
+    return false;
+  }
+  return lite::x86::math::JitGemmPreferred(m);
+}
+
+template <PrecisionType PType, PrecisionType OutType>
+void FcCompute<PType, OutType>::PrepareForRun() {}
+
+template <>
+void FcCompute<PRECISION(kFloat), PRECISION(kFloat)>::PrepareForRun() {
+  // Generate the jit code of the bias epilogue at the first run, it's shared
+  // by all the threads.
+  auto& param = *param_.get_mutable<param_t>();
+  const auto& w_dims = param.w->dims();
+  int n = param.padding_weights ? w_dims[1] - 4 : w_dims[1];
+  if (param.activation_type == "relu") {
+    jit::KernelFuncs<jit::VAddReluTuple<float>, fluid::CPUPlace>::Cache().At(n);
+  } else {
+    jit::KernelFuncs<jit::VAddTuple<float>, fluid::CPUPlace>::Cache().At(n);
+  }
+}
+
 template <>
 void FcCompute<PRECISION(kFloat), PRECISION(kFloat)>::Run() {
   auto& param = *param_.get_mutable<param_t>();
@@ -159,6 +187,25 @@ void FcCompute<PRECISION(kFloat), PRECISION(kFloat)>::Run() {
   const float* w_data = w->template data<float>();
   float* output_data = output->template mutable_data<float>();
 
+  if (UseJitGemm(param, M)) {
+    if (!packed_w_) {
+      packed_w_ = lite::x86::math::JitGemmPackedWeight(*w, w_dims0, w_dims1);
+    }
+    lite::x86::math::JitGemm(M,
+                             w_dims1,
+                             w_dims0,
+                             input_data,
+                             w_dims0,
+                             packed_w_->data<float>(),
+                             output_data,
+                             w_dims1,
+                             bias ? bias->template data<float>() : nullptr,
+                             nullptr,
+                             0,
+                             with_relu ? jit::kVRelu : jit::kVIdentity);
+    return;
+  }
+
   auto& context = ctx_->As<X86Context>();
   FCFunctor<lite::TargetType::kX86, float> fc;
   fc(context,
@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 #include "lite/backends/x86/jit/helper.h"
 #include "lite/backends/x86/jit/kernel_base.h"
@@ -35,9 +36,16 @@ class FcCompute : public KernelLite<TARGET(kX86), PType> {
  public:
   using param_t = operators::FcParam;
 
+  void PrepareForRun() override;
+
   virtual void Run();
 
   virtual ~FcCompute() = default;
+
+ private:
+  // The weight packed for the jit gemm microkernels at the first run, it's
+  // shared with the cloned predictors.
+  std::shared_ptr<const lite::Tensor> packed_w_;
 };
 
 }  // namespace x86
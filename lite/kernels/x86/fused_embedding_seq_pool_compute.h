@@ -0,0 +1,111 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include "lite/backends/x86/jit/kernels.h"
+#include "lite/core/kernel.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+template <typename T>
+class FusedEmbeddingSeqPoolCompute
+    : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
+ public:
+  using param_t = operators::FusedEmbeddingSeqPoolParam;
+
+  void Run() override {
+    auto &param = *param_.get_mutable<operators::FusedEmbeddingSeqPoolParam>();
+    auto *table_t = param.W;
+    auto *ids_t = param.Ids;
+    auto *out_t = param.Out;
+    int64_t padding_idx = param.padding_idx;
+    int64_t row_number = table_t->dims()[0];
+    int64_t row_width = table_t->dims()[1];
+    const T *table = table_t->template data<T>();
+    const int64_t *ids = ids_t->template data<int64_t>();
+    T *out = out_t->template mutable_data<T>();
+
+    // The generated code doesn't check the ids.
+    int64_t ids_numel = ids_t->numel();
+    for (int64_t i = 0; i < ids_numel; ++i) {
+      if (padding_idx != -1 && ids[i] == padding_idx) continue;
+      CHECK_LT(ids[i], row_number) << "i = " << i;
+      CHECK_GE(ids[i], 0) << "i = " << i;
+    }
+
+    jit::emb_seq_pool_attr_t attr(
+        row_number, row_width, 1, 1, row_width, jit::SeqPoolType::kSum);
+    auto emb_seq_pool =
+        jit::KernelFuncs<jit::EmbSeqPoolTuple<T>, fluid::CPUPlace>::Cache().At(
+            attr);
+    auto vadd = jit::KernelFuncs<jit::VAddTuple<T>, fluid::CPUPlace>::Cache()
+                    .At(row_width);
+    auto vscal = jit::KernelFuncs<jit::VScalTuple<T>, fluid::CPUPlace>::Cache()
+                     .At(row_width);
+
+    const auto &lod = ids_t->lod().back();
+    int64_t batch_size = static_cast<int64_t>(lod.size()) - 1;
+    for (int64_t i = 0; i < batch_size; ++i) {
+      const int64_t *seq_ids = ids + lod[i];
+      int64_t seq_len = lod[i + 1] - lod[i];
+      T *dst = out + i * row_width;
+      if (seq_len == 0) {
+        std::fill(dst, dst + row_width, static_cast<T>(param.pad_value));
+        continue;
+      }
+      if (padding_idx == -1) {
+        attr.index_height = seq_len;
+        emb_seq_pool(table, seq_ids, dst, &attr);
+      } else {
+        // The embeddings of padding_idx are zeros.
+        std::fill(dst, dst + row_width, static_cast<T>(0));
+        for (int64_t j = 0; j < seq_len; ++j) {
+          if (seq_ids[j] == padding_idx) continue;
+          vadd(table + seq_ids[j] * row_width, dst, dst, row_width);
+        }
+      }
+      if (param.combiner == "avg") {
+        T scale = static_cast<T>(1) / static_cast<T>(seq_len);
+        vscal(&scale, dst, dst, row_width);
+      }
+    }
+
+    // The same as sequence_pool, the outputs are the sequences of the first
+    // LoD level if there are two levels.
+    std::vector<uint64_t> out_lod;
+    if (ids_t->lod().size() == 2) {
+      out_lod = ids_t->lod()[0];
+    } else {
+      for (int64_t i = 0; i <= batch_size; ++i) {
+        out_lod.push_back(i);
+      }
+    }
+    out_t->mutable_lod()->clear();
+    out_t->mutable_lod()->push_back(out_lod);
+  }
+
+  virtual ~FusedEmbeddingSeqPoolCompute() = default;
+};
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
@@ -0,0 +1,107 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/fused_embedding_seq_pool_compute.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+void fused_embedding_seq_pool_ref(const lite::Tensor& w,
+                                  const lite::Tensor& ids,
+                                  int64_t padding_idx,
+                                  const std::string& combiner,
+                                  float pad_value,
+                                  std::vector<float>* out) {
+  int64_t width = w.dims()[1];
+  const auto& lod = ids.lod().back();
+  out->assign((lod.size() - 1) * width, 0.f);
+  for (size_t i = 0; i + 1 < lod.size(); i++) {
+    float* dst = out->data() + i * width;
+    int64_t seq_len = lod[i + 1] - lod[i];
+    if (seq_len == 0) {
+      std::fill(dst, dst + width, pad_value);
+      continue;
+    }
+    for (uint64_t j = lod[i]; j < lod[i + 1]; j++) {
+      int64_t id = ids.data<int64_t>()[j];
+      if (id == padding_idx) continue;
+      for (int64_t k = 0; k < width; k++) {
+        dst[k] += w.data<float>()[id * width + k];
+      }
+    }
+    if (combiner == "avg") {
+      for (int64_t k = 0; k < width; k++) {
+        dst[k] /= seq_len;
+      }
+    }
+  }
+}
+
+TEST(fused_embedding_seq_pool_x86, compute) {
+  const int vocab_size = 40;
+  const std::vector<uint64_t> offsets{0, 3, 3, 10, 11, 30};
+  for (int width : {10, 16, 64}) {
+    for (int64_t padding_idx : {-1, 5}) {
+      for (std::string combiner : {"sum", "avg"}) {
+        FusedEmbeddingSeqPoolCompute<float> fused;
+        operators::FusedEmbeddingSeqPoolParam param;
+        lite::Tensor w, ids, out;
+        w.Resize({vocab_size, width});
+        auto* w_data = w.mutable_data<float>();
+        for (int i = 0; i < vocab_size * width; i++) {
+          w_data[i] = static_cast<float>(i % 17) / 17.f - 0.5f;
+        }
+        int64_t ids_num = offsets.back();
+        ids.Resize({ids_num, 1});
+        auto* ids_data = ids.mutable_data<int64_t>();
+        for (int64_t i = 0; i < ids_num; i++) {
+          ids_data[i] = (i * 7) % vocab_size;
+        }
+        ids.set_lod({offsets});
+        out.Resize({static_cast<int64_t>(offsets.size()) - 1, width});
+
+        param.W = &w;
+        param.Ids = &ids;
+        param.Out = &out;
+        param.padding_idx = padding_idx;
+        param.combiner = combiner;
+        param.pad_value = 1.f;
+        fused.SetParam(param);
+        fused.Run();
+
+        std::vector<float> out_ref;
+        fused_embedding_seq_pool_ref(
+            w, ids, padding_idx, combiner, 1.f, &out_ref);
+        ASSERT_EQ(out.numel(), static_cast<int64_t>(out_ref.size()));
+        for (size_t i = 0; i < out_ref.size(); i++) {
+          EXPECT_NEAR(out.data<float>()[i], out_ref[i], 1e-5);
+        }
+        EXPECT_EQ(out.lod()[0].size(), offsets.size());
+      }
+    }
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(fused_embedding_seq_pool, kX86, kFloat, kNCHW, def);
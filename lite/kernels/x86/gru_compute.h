@@ -17,6 +17,7 @@
 #include <vector>
 #include "lite/backends/x86/fluid/eigen.h"
 #include "lite/backends/x86/math/blas.h"
+#include "lite/backends/x86/math/fused_rnn.h"
 #include "lite/backends/x86/math/gru_compute.h"
 #include "lite/backends/x86/math/gru_cpu_kernel.h"
 #include "lite/backends/x86/math/gru_kernel.h"
@@ -55,7 +56,20 @@ static inline int64_t CalculateSeqWidth(const DDim& dims) {
 template <typename T>
 class GRUCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
  public:
+  void PrepareForRun() override {
+    if (!lite::x86::math::FusedRnnEnabled()) return;
+    auto& param = *param_.get_mutable<operators::GRUParam>();
+    int frame_size = param.weight->dims()[0];
+    const float* weight_data = param.weight->template data<float>();
+    fused_gru_.Pack(
+        weight_data, weight_data + 2 * frame_size * frame_size, frame_size);
+  }
+
   void Run() override {
+    if (fused_gru_.packed()) {
+      RunFused();
+      return;
+    }
     auto& context = ctx_->As<X86Context>();
     auto& param = *param_.get_mutable<operators::GRUParam>();
 
@@ -218,6 +232,37 @@ class GRUCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
     batch_hidden->set_lod(batch_gate->lod());
     to_seq(context, *batch_hidden, hidden);
   }
+
+ private:
+  // Run the sequences in place of their LoD order with the prepacked
+  // weights, the batch outputs are only used by the training and not
+  // computed.
+  void RunFused() {
+    auto& param = *param_.get_mutable<operators::GRUParam>();
+    const auto& lod = param.input->lod();
+    CHECK(!lod.empty()) << "The input of gru should be a LoDTensor.";
+    lite::x86::math::RnnSequences sequences;
+    for (size_t i = 0; i + 1 < lod[0].size(); i++) {
+      sequences.offset.push_back(lod[0][i]);
+      sequences.length.push_back(lod[0][i + 1] - lod[0][i]);
+    }
+    sequences.is_reverse = param.is_reverse;
+    param.batch_gate->template mutable_data<float>();
+    param.batch_reset_hidden_prev->template mutable_data<float>();
+    param.batch_hidden->template mutable_data<float>();
+
+    fused_gru_.Run(
+        param.input->template data<float>(),
+        param.bias ? param.bias->template data<float>() : nullptr,
+        param.h0 ? param.h0->template data<float>() : nullptr,
+        sequences,
+        lite::x86::math::detail::GetActivationType(param.activation),
+        lite::x86::math::detail::GetActivationType(param.gate_activation),
+        param.origin_mode,
+        param.hidden->template mutable_data<float>());
+  }
+
+  lite::x86::math::FusedGRU fused_gru_;
 };
 
 }  // namespace x86
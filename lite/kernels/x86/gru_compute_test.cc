@@ -16,6 +16,7 @@
 
 #include <iostream>
 #include <memory>
+#include <random>
 #include <utility>
 #include <vector>
 
@@ -148,6 +149,69 @@ TEST(gru_x86, run_test) {
   }
 }
 
+// The fused engine runs with PrepareForRun, and is compared with the batch
+// computing on the sequences of different lengths.
+TEST(gru_x86, fused_test) {
+  const int frame_size = 11;
+  std::vector<std::vector<uint64_t>> lod{{0, 3, 10, 11, 17, 19}};
+  const int64_t total = lod[0].back();
+  const int64_t num_seqs = lod[0].size() - 1;
+  std::default_random_engine engine(0);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  auto fill = [&](lite::Tensor* tensor, std::vector<int64_t> shape) {
+    tensor->Resize(lite::DDim(shape));
+    auto* data = tensor->mutable_data<float>();
+    for (int64_t i = 0; i < tensor->numel(); i++) data[i] = dist(engine);
+  };
+
+  lite::Tensor input, h0, weight, bias;
+  fill(&input, {total, 3 * frame_size});
+  fill(&h0, {num_seqs, frame_size});
+  fill(&weight, {frame_size, 3 * frame_size});
+  fill(&bias, {1, 3 * frame_size});
+  input.set_lod(lod);
+
+  for (bool is_reverse : {false, true}) {
+    for (bool origin_mode : {false, true}) {
+      lite::Tensor outputs[2][4];
+      for (int fused = 0; fused < 2; fused++) {
+        auto* out = outputs[fused];
+        out[0].Resize({total, 3 * frame_size});
+        out[1].Resize({total, frame_size});
+        out[2].Resize({total, frame_size});
+        out[3].Resize({total, frame_size});
+        operators::GRUParam param;
+        param.input = &input;
+        param.h0 = &h0;
+        param.weight = &weight;
+        param.bias = &bias;
+        param.batch_gate = &out[0];
+        param.batch_reset_hidden_prev = &out[1];
+        param.batch_hidden = &out[2];
+        param.hidden = &out[3];
+        param.gate_activation = "sigmoid";
+        param.activation = "tanh";
+        param.is_reverse = is_reverse;
+        param.origin_mode = origin_mode;
+
+        GRUCompute<float> gru;
+        std::unique_ptr<KernelContext> ctx(new KernelContext);
+        ctx->As<X86Context>();
+        gru.SetContext(std::move(ctx));
+        gru.SetParam(param);
+        if (fused) gru.PrepareForRun();
+        gru.Run();
+      }
+      const float* ref = outputs[0][3].data<float>();
+      const float* res = outputs[1][3].data<float>();
+      for (int64_t i = 0; i < total * frame_size; i++) {
+        EXPECT_NEAR(res[i], ref[i], 1e-5) << "is_reverse: " << is_reverse
+                                          << ", origin_mode: " << origin_mode;
+      }
+    }
+  }
+}
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
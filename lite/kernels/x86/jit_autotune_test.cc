@@ -0,0 +1,117 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "lite/backends/x86/jit/autotune.h"
+#include "lite/backends/x86/jit/helper.h"
+#include "lite/backends/x86/jit/kernel_base.h"
+#include "lite/backends/x86/jit/kernels.h"
+
+namespace paddle {
+namespace lite {
+namespace jit {
+
+std::vector<std::string> ReadLines(const std::string& file) {
+  std::ifstream fin(file);
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(fin, line)) lines.push_back(line);
+  return lines;
+}
+
+void WriteLines(const std::string& file,
+                const std::vector<std::string>& lines) {
+  std::ofstream fout(file, std::ios::trunc);
+  for (auto& line : lines) fout << line << "\n";
+}
+
+TEST(Autotuner, persist_and_load) {
+  const std::string header = "#host " + Autotuner::HostIdentity();
+  const std::string file = "jit_autotune_persist.txt";
+  std::remove(file.c_str());
+  auto& tuner = Autotuner::Global();
+  // A new decision file starts with the identity of the host.
+  tuner.Enable(file);
+  tuner.Record("persist_key0", "Refer");
+  EXPECT_EQ(ReadLines(file),
+            std::vector<std::string>({header, "persist_key0 Refer"}));
+
+  // The decisions saved on the same host are loaded.
+  WriteLines(file, {header, "persist_key1 JitCode", "persist_key2 Refer"});
+  tuner.Enable(file);
+  std::string impl_type;
+  ASSERT_TRUE(tuner.Find("persist_key1", &impl_type));
+  EXPECT_EQ(impl_type, "JitCode");
+  ASSERT_TRUE(tuner.Find("persist_key2", &impl_type));
+  EXPECT_EQ(impl_type, "Refer");
+  tuner.Disable();
+  std::remove(file.c_str());
+}
+
+TEST(Autotuner, discard_other_hosts) {
+  const std::string header = "#host " + Autotuner::HostIdentity();
+  const std::string file = "jit_autotune_other_host.txt";
+  auto& tuner = Autotuner::Global();
+  std::string impl_type;
+  // The decisions saved on another host, or without the identity of the
+  // host, are discarded and the file is reset.
+  WriteLines(file, {"#host isa=;cpu=other", "other_key0 JitCode"});
+  tuner.Enable(file);
+  EXPECT_FALSE(tuner.Find("other_key0", &impl_type));
+  EXPECT_EQ(ReadLines(file), std::vector<std::string>({header}));
+
+  WriteLines(file, {"other_key1 JitCode"});
+  tuner.Enable(file);
+  EXPECT_FALSE(tuner.Find("other_key1", &impl_type));
+  EXPECT_EQ(ReadLines(file), std::vector<std::string>({header}));
+  tuner.Disable();
+  std::remove(file.c_str());
+}
+
+TEST(Autotuner, tuned_funcs) {
+  const std::string file = "jit_autotune_funcs.txt";
+  std::remove(file.c_str());
+  auto& tuner = Autotuner::Global();
+  tuner.Enable(file);
+  const int max_size = 33;
+  std::vector<float> x(max_size), y(max_size), z(max_size);
+  for (int i = 0; i < max_size; i++) {
+    x[i] = 0.25f * i;
+    y[i] = 2.f - i;
+  }
+  for (int n = 1; n <= max_size; n += 8) {
+    auto func = KernelFuncs<VAddTuple<float>, fluid::CPUPlace>::Cache().At(n);
+    func(x.data(), y.data(), z.data(), n);
+    for (int i = 0; i < n; i++) {
+      EXPECT_FLOAT_EQ(z[i], x[i] + y[i]);
+    }
+  }
+  // The decisions, if there are more than one candidates, follow the
+  // identity of the host.
+  auto lines = ReadLines(file);
+  ASSERT_GE(lines.size(), 1u);
+  EXPECT_EQ(lines[0], "#host " + Autotuner::HostIdentity());
+  tuner.Disable();
+  std::remove(file.c_str());
+}
+
+}  // namespace jit
+}  // namespace lite
+}  // namespace paddle
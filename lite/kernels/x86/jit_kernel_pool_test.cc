@@ -0,0 +1,120 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "lite/backends/x86/jit/helper.h"
+#include "lite/backends/x86/jit/kernel_base.h"
+#include "lite/backends/x86/jit/kernel_pool.h"
+#include "lite/backends/x86/jit/kernels.h"
+
+namespace paddle {
+namespace lite {
+namespace jit {
+
+TEST(ReadMostlyMap, concurrent_find_insert) {
+  const int num_threads = 8;
+  const int num_keys = 1000;
+  ReadMostlyMap<int64_t, int> map;
+  std::atomic<int> num_errors{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&map, &num_errors, t]() {
+      for (int i = 0; i < num_keys; i++) {
+        // The threads walk the keys in the different orders, so that the
+        // lookups and the inserts of the same key race with each other.
+        int64_t key = (i * 7 + t * 131) % num_keys;
+        int value = -1;
+        if (map.Find(key, &value) && value / num_threads != key) num_errors++;
+        int inserted = map.Insert(key, key * num_threads + t);
+        if (inserted / num_threads != key) num_errors++;
+        // Once inserted, the value of a key never changes.
+        if (!map.Find(key, &value) || value != inserted) num_errors++;
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(num_errors.load(), 0);
+  EXPECT_EQ(map.size(), static_cast<size_t>(num_keys));
+  for (int64_t key = 0; key < num_keys; key++) {
+    int value = -1;
+    ASSERT_TRUE(map.Find(key, &value));
+    EXPECT_EQ(value / num_threads, key);
+  }
+}
+
+TEST(ReadMostlyMap, cache_per_map) {
+  ReadMostlyMap<int64_t, int> map;
+  map.Insert(1, 10);
+  int value = -1;
+  ASSERT_TRUE(map.Find(1, &value));
+  // The items found by this thread aren't found in the other maps, neither
+  // in a new map at the address of a destroyed one.
+  ReadMostlyMap<int64_t, int> other;
+  EXPECT_FALSE(other.Find(1, &value));
+  other.Insert(1, 20);
+  ASSERT_TRUE(other.Find(1, &value));
+  EXPECT_EQ(value, 20);
+  ASSERT_TRUE(map.Find(1, &value));
+  EXPECT_EQ(value, 10);
+  std::unique_ptr<ReadMostlyMap<int64_t, int>> temp(
+      new ReadMostlyMap<int64_t, int>);
+  temp->Insert(2, 30);
+  ASSERT_TRUE(temp->Find(2, &value));
+  temp.reset();
+  temp.reset(new ReadMostlyMap<int64_t, int>);
+  EXPECT_FALSE(temp->Find(2, &value));
+}
+
+TEST(KernelFuncs, concurrent_cache) {
+  const int num_threads = 8;
+  const int max_size = 64;
+  std::vector<std::vector<VAddTuple<float>::func_type>> funcs(
+      num_threads, std::vector<VAddTuple<float>::func_type>(max_size + 1));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&funcs, t]() {
+      for (int n = 1; n <= max_size; n++) {
+        funcs[t][n] =
+            KernelFuncs<VAddTuple<float>, fluid::CPUPlace>::Cache().At(n);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  std::vector<float> x(max_size), y(max_size), z(max_size);
+  for (int i = 0; i < max_size; i++) {
+    x[i] = 0.5f * i;
+    y[i] = 1.f - i;
+  }
+  for (int n = 1; n <= max_size; n++) {
+    // All the threads get the same function of an attribute.
+    for (int t = 1; t < num_threads; t++) {
+      EXPECT_EQ(funcs[t][n], funcs[0][n]);
+    }
+    funcs[0][n](x.data(), y.data(), z.data(), n);
+    for (int i = 0; i < n; i++) {
+      EXPECT_FLOAT_EQ(z[i], x[i] + y[i]);
+    }
+  }
+}
+
+}  // namespace jit
+}  // namespace lite
+}  // namespace paddle
@@ -33,6 +33,16 @@ class LayerNormCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
  public:
   using param_t = operators::LayerNormParam;
 
+  void PrepareForRun() override {
+    // Generate the jit code at the first run, it's shared by all the threads.
+    auto &param = *param_.get_mutable<param_t>();
+    if (param.Scale) {
+      paddle::lite::jit::KernelFuncs<jit::LayerNormTuple<T>,
+                                     lite::fluid::CPUPlace>::Cache()
+          .At(param.Scale->numel());
+    }
+  }
+
   void Run() override {
     auto &param = *param_.get_mutable<param_t>();
     float epsilon = param.epsilon;
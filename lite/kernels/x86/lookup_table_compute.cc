@@ -21,14 +21,14 @@ using LookupTableFloatInt32 =
 
 REGISTER_LITE_KERNEL(
     lookup_table, kX86, kFloat, kNCHW, LookupTableFloatInt64, def)
-    .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kAny))})
     .BindInput("Ids", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt64))})
     .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86))})
     .Finalize();
 
 REGISTER_LITE_KERNEL(
     lookup_table_v2, kX86, kFloat, kNCHW, LookupTableFloatInt64, def)
-    .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kAny))})
     .BindInput("Ids", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt64))})
     .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86))})
     .BindPaddleOpVersion("lookup_table_v2", 1)
@@ -36,14 +36,14 @@ REGISTER_LITE_KERNEL(
 
 REGISTER_LITE_KERNEL(
     lookup_table, kX86, kFloat, kNCHW, LookupTableFloatInt32, float_int32)
-    .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kAny))})
     .BindInput("Ids", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt32))})
     .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86))})
     .Finalize();
 
 REGISTER_LITE_KERNEL(
     lookup_table_v2, kX86, kFloat, kNCHW, LookupTableFloatInt32, float_int32)
-    .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kAny))})
     .BindInput("Ids", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt32))})
     .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86))})
     .BindPaddleOpVersion("lookup_table_v2", 1)
@@ -17,12 +17,60 @@
 #include "lite/backends/x86/fluid/eigen.h"
 #include "lite/core/kernel.h"
 #include "lite/core/op_registry.h"
+#include "lite/utils/float16.h"
 
 namespace paddle {
 namespace lite {
 namespace kernels {
 namespace x86 {
 
+// Copy the rows of the table to the output, the rows of the fp16 tables are
+// converted on the fly. The ids are gathered in parallel when there are
+// enough of them, and the next rows are prefetched since the table is
+// usually too large to stay in the caches.
+template <typename T_IDS>
+void GatherRows(const lite::Tensor &table_t,
+                const T_IDS *ids,
+                int64_t ids_numel,
+                int64_t padding_idx,
+                float *output) {
+  int64_t row_number = table_t.dims()[0];
+  int64_t row_width = table_t.dims()[1];
+  for (int64_t i = 0; i < ids_numel; ++i) {
+    if (padding_idx != -1 && ids[i] == padding_idx) continue;
+    CHECK_LT(ids[i], row_number) << "i = " << i;
+    CHECK_GE(ids[i], 0) << "i = " << i;
+  }
+
+  bool is_fp16 = table_t.precision() == PRECISION(kFP16);
+  const char *table = static_cast<const char *>(table_t.raw_data());
+  size_t row_bytes = row_width * (is_fp16 ? sizeof(float16) : sizeof(float));
+  const int64_t kPrefetchDistance = 4;
+#pragma omp parallel for if (ids_numel * row_width >= 65536)
+  for (int64_t i = 0; i < ids_numel; ++i) {
+#if defined(__GNUC__)
+    if (i + kPrefetchDistance < ids_numel) {
+      auto next = ids[i + kPrefetchDistance];
+      if (next >= 0 && next < row_number) {
+        __builtin_prefetch(table + next * row_bytes);
+      }
+    }
+#endif
+    float *out = output + i * row_width;
+    if (padding_idx != -1 && ids[i] == padding_idx) {
+      memset(out, 0, row_width * sizeof(float));
+    } else if (is_fp16) {
+      const float16 *row =
+          reinterpret_cast<const float16 *>(table + ids[i] * row_bytes);
+      for (int64_t j = 0; j < row_width; ++j) {
+        out[j] = static_cast<float>(row[j]);
+      }
+    } else {
+      memcpy(out, table + ids[i] * row_bytes, row_bytes);
+    }
+  }
+}
+
 template <typename T_W, typename T_IDS>
 class LookupTableCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
  public:
@@ -32,28 +80,10 @@ class LookupTableCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
     auto &param = *param_.get_mutable<operators::LookupTableParam>();
     auto *ids_t = param.Ids;
     auto *output_t = param.Out;
-    int64_t padding_idx = param.padding_idx;
     const T_IDS *ids = ids_t->template data<T_IDS>();
     int64_t ids_numel = ids_t->dims().production();
-
-    auto *table_t = param.W;
-    int64_t row_number = table_t->dims()[0];
-    int64_t row_width = table_t->dims()[1];
-
-    const T_W *table = table_t->template data<T_W>();
     T_W *output = output_t->template mutable_data<T_W>();
-    memset(output, 0, output_t->dims().production() * sizeof(T_W));
-    for (int64_t i = 0; i < ids_numel; ++i) {
-      if (padding_idx != -1 && ids[i] == padding_idx) {
-        memset(output + i * row_width, 0, row_width * sizeof(T_W));
-      } else {
-        CHECK_LT(ids[i], row_number) << "i = " << i;
-        CHECK_GE(ids[i], 0) << "i = " << i;
-        memcpy(output + i * row_width,
-               table + ids[i] * row_width,
-               row_width * sizeof(T_W));
-      }
-    }
+    GatherRows<T_IDS>(*param.W, ids, ids_numel, param.padding_idx, output);
   }
 
   virtual ~LookupTableCompute() = default;
@@ -74,6 +74,45 @@ TEST(lookup_table_x86, compute) {
   }
 }
 
+TEST(lookup_table_x86, fp16_table) {
+  LookupTableCompute<float, int64_t> lookup_table;
+  operators::LookupTableParam param;
+  lite::Tensor w, ids, out;
+  int64_t padding_idx = 3;
+  int vocab_size = 40;
+  int emb_size = 50;
+  int ids_num = 300;
+
+  w.Resize({vocab_size, emb_size});
+  ids.Resize({ids_num, 1});
+  out.Resize({ids_num, 1, emb_size});
+  auto* w_data = w.mutable_data<float16>();
+  auto* ids_data = ids.mutable_data<int64_t>();
+  for (int i = 0; i < vocab_size * emb_size; i++) {
+    w_data[i] = float16(static_cast<float>(i % 97) / 8.f - 6.f);
+  }
+  w.set_precision(PRECISION(kFP16));
+  for (int i = 0; i < ids_num; i++) {
+    ids_data[i] = (i * 7) % vocab_size;
+  }
+
+  param.W = &w;
+  param.Ids = &ids;
+  param.Out = &out;
+  param.padding_idx = padding_idx;
+  lookup_table.SetParam(param);
+  lookup_table.Run();
+  auto* out_data = out.data<float>();
+  for (int i = 0; i < ids_num; i++) {
+    for (int j = 0; j < emb_size; j++) {
+      float ref = ids_data[i] == padding_idx
+                      ? 0.f
+                      : static_cast<float>(w_data[ids_data[i] * emb_size + j]);
+      EXPECT_EQ(out_data[i * emb_size + j], ref);
+    }
+  }
+}
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
@@ -0,0 +1,83 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/lookup_table_dequant_compute.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+void LookupTableDequantCompute::Run() {
+  auto &param = this->Param<param_t>();
+  auto *w = param.W;
+  auto *ids = param.Ids;
+  auto *out = param.Out;
+  int64_t padding_idx = param.padding_idx;
+
+  const int64_t *ids_data = ids->data<int64_t>();
+  int64_t ids_numel = ids->numel();
+  int64_t row_number = w->dims()[0];
+  int64_t quant_number = w->dims()[1];
+  int64_t row_width = (quant_number - 2) * 4;
+  for (int64_t i = 0; i < ids_numel; ++i) {
+    if (padding_idx != -1 && ids_data[i] == padding_idx) continue;
+    CHECK_LT(ids_data[i], row_number) << "i = " << i;
+    CHECK_GE(ids_data[i], 0) << "i = " << i;
+  }
+
+  const float *table = w->data<float>();
+  float *output = out->mutable_data<float>();
+  const int64_t kPrefetchDistance = 4;
+#pragma omp parallel for if (ids_numel * row_width >= 65536)
+  for (int64_t i = 0; i < ids_numel; ++i) {
+#if defined(__GNUC__)
+    if (i + kPrefetchDistance < ids_numel) {
+      int64_t next = ids_data[i + kPrefetchDistance];
+      if (next >= 0 && next < row_number) {
+        __builtin_prefetch(table + next * quant_number);
+      }
+    }
+#endif
+    float *out_row = output + i * row_width;
+    if (padding_idx != -1 && ids_data[i] == padding_idx) {
+      memset(out_row, 0, row_width * sizeof(float));
+      continue;
+    }
+    const float *row = table + ids_data[i] * quant_number;
+    float min = row[0];
+    float scale = (row[1] - min) / 256;
+    const uint8_t *quant = reinterpret_cast<const uint8_t *>(row + 2);
+    for (int64_t j = 0; j < row_width; ++j) {
+      out_row[j] = scale * quant[j] + min;
+    }
+  }
+  *(out->mutable_lod()) = ids->lod();
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_KERNEL(lookup_table_dequant,
+                     kX86,
+                     kAny,
+                     kNCHW,
+                     paddle::lite::kernels::x86::LookupTableDequantCompute,
+                     def)
+    .BindInput("W", {LiteType::GetTensorTy(TARGET(kX86))})
+    .BindInput("Ids", {LiteType::GetTensorTy(TARGET(kX86), PRECISION(kInt64))})
+    .BindOutput("Out", {LiteType::GetTensorTy(TARGET(kX86))})
+    .Finalize();
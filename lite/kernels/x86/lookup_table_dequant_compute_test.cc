@@ -0,0 +1,78 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/kernels/x86/lookup_table_dequant_compute.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+TEST(lookup_table_dequant_x86, compute) {
+  LookupTableDequantCompute lookup_table;
+  operators::LookupTableDequantParam param;
+  lite::Tensor w, ids, out;
+  int64_t padding_idx = 2;
+  int vocab_size = 30;
+  int quant_number = 6;
+  int row_width = (quant_number - 2) * 4;
+  int ids_num = 200;
+
+  w.Resize({vocab_size, quant_number});
+  ids.Resize({ids_num, 1});
+  out.Resize({ids_num, row_width});
+  auto* w_data = w.mutable_data<float>();
+  auto* ids_data = ids.mutable_data<int64_t>();
+  for (int i = 0; i < vocab_size; i++) {
+    float* row = w_data + i * quant_number;
+    row[0] = -1.f * i;
+    row[1] = 2.f * i;
+    auto* quant = reinterpret_cast<uint8_t*>(row + 2);
+    for (int j = 0; j < row_width; j++) {
+      quant[j] = static_cast<uint8_t>((i * 31 + j * 17) % 256);
+    }
+  }
+  for (int i = 0; i < ids_num; i++) {
+    ids_data[i] = (i * 11) % vocab_size;
+  }
+
+  param.W = &w;
+  param.Ids = &ids;
+  param.Out = &out;
+  param.padding_idx = padding_idx;
+  lookup_table.SetParam(param);
+  lookup_table.Run();
+  auto* out_data = out.data<float>();
+  for (int i = 0; i < ids_num; i++) {
+    const float* row = w_data + ids_data[i] * quant_number;
+    auto* quant = reinterpret_cast<const uint8_t*>(row + 2);
+    for (int j = 0; j < row_width; j++) {
+      float ref = ids_data[i] == padding_idx
+                      ? 0.f
+                      : (row[1] - row[0]) / 256 * quant[j] + row[0];
+      EXPECT_NEAR(out_data[i * row_width + j], ref, 1e-5);
+    }
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(lookup_table_dequant, kX86, kAny, kNCHW, def);
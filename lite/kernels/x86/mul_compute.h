@@ -13,7 +13,10 @@
 // limitations under the License.
 #pragma once
 
+#include <memory>
+#include <type_traits>
 #include "lite/backends/x86/math/blas.h"
+#include "lite/backends/x86/math/jit_gemm.h"
 #include "lite/core/kernel.h"
 #include "lite/core/op_registry.h"
 #include "lite/core/types.h"
@@ -70,15 +73,39 @@ class MulCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
       z->Resize({x_matrix.dims()[0], y_matrix.dims()[1]});
     }
 
-    auto blas = lite::x86::math::GetBlas<lite::TargetType::kX86, T>(context);
-
-    blas.MatMul(x_matrix, y_matrix, z);
+    const int m = x_matrix.dims()[0];
+    const int k = x_matrix.dims()[1];
+    const int n = y_matrix.dims()[1];
+    if (std::is_same<T, float>::value && y->persistable() &&
+        lite::x86::math::JitGemmPreferred(m)) {
+      // Pack the weight once instead of passing it raw to the library.
+      if (!packed_y_) {
+        packed_y_ = lite::x86::math::JitGemmPackedWeight(*y, k, n);
+      }
+      lite::x86::math::JitGemm(m,
+                               n,
+                               k,
+                               x_matrix.template data<float>(),
+                               k,
+                               packed_y_->template data<float>(),
+                               z->template mutable_data<float>(),
+                               n);
+    } else {
+      auto blas =
+          lite::x86::math::GetBlas<lite::TargetType::kX86, T>(context);
+      blas.MatMul(x_matrix, y_matrix, z);
+    }
     if (z_dim.size() != 2) {
       z->Resize(z_dim);
     }
   }
 
   virtual ~MulCompute() = default;
+
+ private:
+  // The weight packed for the jit gemm microkernels at the first run, it's
+  // shared with the cloned predictors.
+  std::shared_ptr<const lite::Tensor> packed_y_;
 };
 
 }  // namespace x86
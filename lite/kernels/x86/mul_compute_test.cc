@@ -19,6 +19,8 @@
 #include <utility>
 #include <vector>
 
+#include "lite/backends/x86/math/jit_gemm.h"
+#include "lite/backends/x86/math/packed_weight_cache.h"
 #include "lite/core/op_registry.h"
 #include "lite/kernels/x86/mul_compute.h"
 
@@ -80,6 +82,107 @@ TEST(mul_x86, run_test) {
   }
 }
 
+TEST(mul_x86, packed_weight_cache) {
+  auto& cache = lite::x86::math::PackedWeightCache::Global();
+  const size_t base_size = cache.memory_size();
+  lite::Tensor w0, w1;
+  for (auto* w : {&w0, &w1}) {
+    w->Resize({4, 8});
+    w->mutable_data<float>();
+    w->set_persistable(true);
+  }
+  int num_packs = 0;
+  auto pack = [&num_packs](lite::Tensor* packed) {
+    packed->Resize({16});
+    packed->mutable_data<float>();
+    num_packs++;
+  };
+  {
+    auto packed0 = cache.GetOrPack(w0, "test", pack);
+    EXPECT_EQ(num_packs, 1);
+    // Hit by the same weight and format.
+    auto packed1 = cache.GetOrPack(w0, "test", pack);
+    EXPECT_EQ(num_packs, 1);
+    EXPECT_EQ(packed1.get(), packed0.get());
+    // Missed by the other weight or format.
+    auto packed2 = cache.GetOrPack(w0, "test_other", pack);
+    auto packed3 = cache.GetOrPack(w1, "test", pack);
+    EXPECT_EQ(num_packs, 3);
+    EXPECT_NE(packed2.get(), packed0.get());
+    EXPECT_NE(packed3.get(), packed0.get());
+    EXPECT_EQ(cache.memory_size(), base_size + 3 * 16 * sizeof(float));
+  }
+  // The copies are released along with the last holders, and packed again.
+  EXPECT_EQ(cache.memory_size(), base_size);
+  auto packed = cache.GetOrPack(w0, "test", pack);
+  EXPECT_EQ(num_packs, 4);
+}
+
+TEST(mul_x86, packed_weight_run) {
+  const int k = 19, n = 37;
+  lite::Tensor y;
+  y.Resize({k, n});
+  auto* y_data = y.mutable_data<float>();
+  for (int i = 0; i < k * n; i++) {
+    y_data[i] = static_cast<float>(i % 13) * 0.25f - 1.f;
+  }
+  y.set_persistable(true);
+  auto& cache = lite::x86::math::PackedWeightCache::Global();
+  const size_t base_size = cache.memory_size();
+  {
+    // The kernels sharing the weight share the packed copy.
+    MulCompute<float> muls[2];
+    for (int m : {1, 5, 3}) {
+      lite::Tensor x, outs[2];
+      x.Resize({m, k});
+      auto* x_data = x.mutable_data<float>();
+      for (int i = 0; i < m * k; i++) {
+        x_data[i] = static_cast<float>(i % 7) - 3.f;
+      }
+      for (int t = 0; t < 2; t++) {
+        operators::MulParam param;
+        param.x = &x;
+        param.y = &y;
+        param.output = &outs[t];
+        std::unique_ptr<KernelContext> ctx(new KernelContext);
+        ctx->As<X86Context>();
+        muls[t].SetContext(std::move(ctx));
+        muls[t].SetParam(param);
+        muls[t].Run();
+      }
+      for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+          float ref = 0.f;
+          for (int l = 0; l < k; l++) {
+            ref += x_data[i * k + l] * y_data[l * n + j];
+          }
+          EXPECT_NEAR(outs[0].data<float>()[i * n + j], ref, 1e-4);
+          EXPECT_NEAR(outs[1].data<float>()[i * n + j], ref, 1e-4);
+        }
+      }
+    }
+    // The packed copy of the cache, it runs the refer kernel if the jit code
+    // isn't available.
+    auto packed_y = lite::x86::math::JitGemmPackedWeight(y, k, n);
+    std::vector<float> x(2 * k, 0.5f), out(2 * n);
+    lite::x86::math::JitGemm(
+        2, n, k, x.data(), k, packed_y->data<float>(), out.data(), n);
+    for (int j = 0; j < n; j++) {
+      float ref = 0.f;
+      for (int l = 0; l < k; l++) {
+        ref += 0.5f * y_data[l * n + j];
+      }
+      EXPECT_NEAR(out[j], ref, 1e-4);
+      EXPECT_NEAR(out[n + j], ref, 1e-4);
+    }
+    // Only one copy is packed even if the kernels packed it before.
+    EXPECT_EQ(packed_y->memory_size(),
+              lite::x86::math::JitGemmPackedSize(k, n) * sizeof(float));
+    EXPECT_EQ(cache.memory_size(), base_size + packed_y->memory_size());
+  }
+  EXPECT_EQ(cache.memory_size(), base_size);
+}
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
@@ -41,7 +41,8 @@ namespace x86 {
               &gate_value,        \
               z,                  \
               w,                  \
-              mode)
+              mode,               \
+              fused_lstm(x, z, w))
 
 static void reset_parameter_vector(
     const std::vector<Tensor*>& raw_params_vec,
@@ -399,6 +400,38 @@ static void gru_cell(X86Context* ctx,
       ctx, gru_value, frame_size, batch_size, cand_act, gate_act);
 }
 
+// Run the steps of all of the batch with the fused engine, the sequences
+// are the columns of the [time_step, batch] gates.
+static void RunFusedLstmLayer(const lite::x86::math::FusedLSTM& fused,
+                              const Tensor& gate_value,
+                              const Tensor& init_h,
+                              const Tensor& init_c,
+                              bool is_reverse,
+                              Tensor* output,
+                              Tensor* last_h,
+                              Tensor* last_c) {
+  const int time_step = gate_value.dims()[0];
+  const int batch = gate_value.dims()[1];
+  lite::x86::math::RnnSequences sequences;
+  for (int b = 0; b < batch; b++) {
+    sequences.offset.push_back(b);
+    sequences.length.push_back(time_step);
+  }
+  sequences.stride = batch;
+  sequences.is_reverse = is_reverse;
+  fused.Run(gate_value.data<float>(),
+            nullptr,
+            init_h.data<float>(),
+            init_c.data<float>(),
+            sequences,
+            lite::x86::math::detail::ActivationType::kSigmoid,
+            lite::x86::math::detail::ActivationType::kTanh,
+            lite::x86::math::detail::ActivationType::kTanh,
+            output->mutable_data<float>(),
+            last_h->mutable_data<float>(),
+            last_c->mutable_data<float>());
+}
+
 static void RunRnnLayer(X86Context* ctx,
                         const Tensor* input,
                         std::vector<Tensor> vec,
@@ -412,7 +445,8 @@ static void RunRnnLayer(X86Context* ctx,
                         Tensor* gate_value,
                         bool is_bidirect,
                         int offset,
-                        std::string mode) {
+                        std::string mode,
+                        const lite::x86::math::FusedLSTM* fused) {
   bool is_reverse = false;
   if (is_bidirect) {
     layer_idx = 2 * layer_idx + offset;
@@ -429,6 +463,17 @@ static void RunRnnLayer(X86Context* ctx,
              vec[3 + offset * 4],
              mode,
              gate_value);
+  if (fused && "LSTM" == mode && sequence_length == nullptr) {
+    RunFusedLstmLayer(*fused,
+                      *gate_value,
+                      init_h[layer_idx],
+                      init_c[layer_idx],
+                      is_reverse,
+                      output,
+                      &(*last_h_ptr)[layer_idx],
+                      &(*last_c_ptr)[layer_idx]);
+    return;
+  }
 
   std::vector<Tensor> input_tensors, output_tensors;
   std::vector<Tensor *> input_tensors_t, output_tensors_t;
@@ -624,13 +669,37 @@ static void RunRnnLayer(X86Context* ctx,
       (*last_h_ptr)[layer_idx].CopyDataFrom(*last_h_holder);
     }
   } else {
-    (*last_h_ptr)[layer_idx].CopyDataFrom(output_tensors[time_step - 1]);
+    // the reverse direction ends at the first step
+    (*last_h_ptr)[layer_idx].CopyDataFrom(
+        output_tensors[is_reverse ? 0 : time_step - 1]);
   }
   if ((0 == (time_step % 2)) && ("LSTM" == mode)) {
     (*last_c_ptr)[layer_idx].CopyDataFrom(*last_c_holder);
   }
 }
 
+void RnnCompute::PrepareForRun() {
+  auto& param = this->Param<operators::RnnParam>();
+  fused_lstm_.clear();
+  if ("LSTM" != param.mode || !lite::x86::math::FusedRnnEnabled()) return;
+  std::vector<std::vector<Tensor>> parameter_lists;
+  reset_parameter_vector(param.WeightList,
+                         param.num_layers,
+                         4,
+                         param.is_bidirec,
+                         &parameter_lists);
+  const int direction_num = param.is_bidirec ? 2 : 1;
+  fused_lstm_.resize(param.num_layers * direction_num);
+  for (int i = 0; i < param.num_layers; i++) {
+    for (int j = 0; j < direction_num; j++) {
+      // weight_hh: [4 * hidden_size, hidden_size]
+      const Tensor& weight_hh = parameter_lists[i][1 + j * 4];
+      fused_lstm_[i * direction_num + j].Pack(
+          weight_hh.data<float>(), weight_hh.dims()[1], true);
+    }
+  }
+}
+
 void RnnCompute::Run() {
   auto& param = this->Param<operators::RnnParam>();
   auto& ctx = this->ctx_->As<X86Context>();
@@ -716,6 +785,15 @@ void RnnCompute::Run() {
         state[1]->data<float>(), last_c_unbind_t, 0, stride2);
   }
 
+  // the prepacked LSTM of the layer and the direction
+  auto fused_lstm = [&](int layer, bool is_bidirect, int offset) {
+    const lite::x86::math::FusedLSTM* fused = nullptr;
+    if (!fused_lstm_.empty()) {
+      fused = &fused_lstm_[is_bidirect ? 2 * layer + offset : layer];
+    }
+    return fused;
+  };
+
   std::vector<Tensor> output_vec(2);
   int time_step = input->dims()[0];
   int batch_size = input->dims()[1];
@@ -756,6 +834,12 @@ void RnnCompute::Run() {
   if (num_layers % 2 == 0) {
     output->CopyDataFrom(*output_holder);
   }
+  // bind the last states of the layers back
+  lite::x86::math::ConcatFunctor<lite::TargetType::kX86, float> concat_x86;
+  concat_x86(ctx, last_h_unbind, 0, state[0]);
+  if ("LSTM" == mode) {
+    concat_x86(ctx, last_c_unbind, 0, state[1]);
+  }
 }
 
 }  // namespace x86
@@ -14,6 +14,8 @@
 
 #pragma once
 #include <algorithm>
+#include <vector>
+#include "lite/backends/x86/math/fused_rnn.h"
 #include "lite/core/kernel.h"
 #include "lite/core/op_registry.h"
 
@@ -24,9 +26,16 @@ namespace x86 {
 
 class RnnCompute : public KernelLite<TARGET(kX86), PRECISION(kFloat)> {
  public:
+  void PrepareForRun() override;
+
   void Run() override;
 
   virtual ~RnnCompute() = default;
+
+ private:
+  // The prepacked LSTM of each layer and direction, empty if the fused
+  // engine is disabled or the mode is not LSTM.
+  std::vector<lite::x86::math::FusedLSTM> fused_lstm_;
 };
 
 }  // namespace x86
@@ -0,0 +1,115 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "lite/core/op_registry.h"
+#include "lite/kernels/x86/rnn_compute.h"
+
+namespace paddle {
+namespace lite {
+namespace kernels {
+namespace x86 {
+
+TEST(rnn_x86, retrive_op) {
+  auto rnn = KernelRegistry::Global().Create("rnn");
+  ASSERT_FALSE(rnn.empty());
+  ASSERT_TRUE(rnn.front());
+}
+
+// The fused LSTM runs with PrepareForRun, and is compared with the step by
+// step computing.
+TEST(rnn_x86, fused_lstm_test) {
+  const int time_step = 5;
+  const int batch = 3;
+  const int input_size = 7;
+  const int hidden_size = 10;
+  const int num_layers = 2;
+  std::default_random_engine engine(0);
+  std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+  auto fill = [&](lite::Tensor* tensor, std::vector<int64_t> shape) {
+    tensor->Resize(lite::DDim(shape));
+    auto* data = tensor->mutable_data<float>();
+    for (int64_t i = 0; i < tensor->numel(); i++) data[i] = dist(engine);
+  };
+
+  for (bool is_bidirec : {false, true}) {
+    const int direction_num = is_bidirec ? 2 : 1;
+    lite::Tensor input, init_h, init_c;
+    fill(&input, {time_step, batch, input_size});
+    fill(&init_h, {num_layers * direction_num, batch, hidden_size});
+    fill(&init_c, {num_layers * direction_num, batch, hidden_size});
+    // [weight_ih, weight_hh] of each layer and direction, then the biases.
+    std::vector<lite::Tensor> weights(4 * num_layers * direction_num);
+    for (int i = 0; i < num_layers; i++) {
+      for (int j = 0; j < direction_num; j++) {
+        int idx = (i * direction_num + j) * 2;
+        int in_size = i == 0 ? input_size : hidden_size * direction_num;
+        fill(&weights[idx], {4 * hidden_size, in_size});
+        fill(&weights[idx + 1], {4 * hidden_size, hidden_size});
+        fill(&weights[2 * num_layers * direction_num + idx], {4 * hidden_size});
+        fill(&weights[2 * num_layers * direction_num + idx + 1],
+             {4 * hidden_size});
+      }
+    }
+
+    lite::Tensor outputs[2], last_h[2], last_c[2];
+    for (int fused = 0; fused < 2; fused++) {
+      operators::RnnParam param;
+      param.Input = &input;
+      param.PreState = {&init_h, &init_c};
+      for (auto& weight : weights) param.WeightList.push_back(&weight);
+      outputs[fused].Resize({time_step, batch, hidden_size * direction_num});
+      last_h[fused].Resize(init_h.dims());
+      last_c[fused].Resize(init_c.dims());
+      param.Out = &outputs[fused];
+      param.State = {&last_h[fused], &last_c[fused]};
+      param.is_bidirec = is_bidirec;
+      param.input_size = input_size;
+      param.hidden_size = hidden_size;
+      param.num_layers = num_layers;
+      param.mode = "LSTM";
+      param.is_test = true;
+
+      RnnCompute rnn;
+      std::unique_ptr<KernelContext> ctx(new KernelContext);
+      ctx->As<X86Context>();
+      rnn.SetContext(std::move(ctx));
+      rnn.SetParam(param);
+      if (fused) rnn.PrepareForRun();
+      rnn.Run();
+    }
+    // The output and the last hidden and cell states of each layer.
+    for (auto* results : {outputs, last_h, last_c}) {
+      ASSERT_EQ(results[1].dims(), results[0].dims());
+      const float* ref = results[0].data<float>();
+      const float* res = results[1].data<float>();
+      for (int64_t i = 0; i < results[0].numel(); i++) {
+        EXPECT_NEAR(res[i], ref[i], 1e-5) << "is_bidirec: " << is_bidirec;
+      }
+    }
+  }
+}
+
+}  // namespace x86
+}  // namespace kernels
+}  // namespace lite
+}  // namespace paddle
+
+USE_LITE_KERNEL(rnn, kX86, kFloat, kNCHW, def);
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <vector>
+#include "lite/backends/host/math/sequence_view.h"
 #include "lite/core/kernel.h"
 #include "lite/core/op_registry.h"
 
@@ -75,19 +76,34 @@ class SearchGroupPaddingCompute
     top2_lod.push_back(new_offset);
     top2->set_lod(top2_lod);
     top2->Resize({batch * max_seq, 1});
-    // copy data
-    const auto* bottom_data = bottom0->template data<T>();
-    auto* top_data = top0->template mutable_data<T>();
+    // copy data, or share the storage of the input if none of the sequences
+    // is padded
+    std::vector<uint64_t> lengths(batch);
+    for (int i = 0; i < batch; i++) {
+      lengths[i] = offset[i + 1] - offset[i];
+    }
+    auto bottom_view = lite::host::math::LoDSequences(offset, dim1);
+    auto top_view = lite::host::math::PaddedSequences(lengths, max_seq, dim1);
+    if (dim0 == batch * max_seq &&
+        lite::host::math::IsSameLayout(bottom_view, top_view)) {
+      lite::host::math::ShareSequences(*bottom0, top0);
+    } else {
+      lite::host::math::DetachSequences(*bottom0, top0);
+      auto* top_data = top0->template mutable_data<T>();
+      lite::host::math::CopySequences<T>(
+          bottom0->template data<T>(), bottom_view, top_data, top_view);
+      for (int i = 0; i < batch; i++) {
+        const int copy_step = lengths[i];
+        const int start = i * max_seq;
+        memset(top_data + (start + copy_step) * dim1,
+               0,
+               (max_seq - copy_step) * dim1 * sizeof(T));
+      }
+    }
     auto* top_padding_input_data = top2->template mutable_data<T>();
     for (int i = 0; i < batch; i++) {
-      const int copy_step = offset[i + 1] - offset[i];
+      const int copy_step = lengths[i];
       const int start = i * max_seq;
-      memcpy(top_data + start * dim1,
-             bottom_data + offset[i] * dim1,
-             copy_step * dim1 * sizeof(T));
-      memset(top_data + (start + copy_step) * dim1,
-             0,
-             (max_seq - copy_step) * dim1 * sizeof(T));
       // for padding input id
       memset(top_padding_input_data + start, 0, copy_step * sizeof(T));
       for (int j = start + copy_step; j < start + max_seq; j++) {
@@ -85,6 +85,57 @@ TEST(search_group_padding_x86, run_test) {
   }
 }
 
+// The sequences of the same length are shared with X, then the padded ones
+// are copied to the storage of Out_emb_padding of its own.
+TEST(search_group_padding_x86, share_then_pad) {
+  lite::Tensor x, out_emb_padding, out_new, out_padding;
+  SearchGroupPaddingCompute<float> sgp_kernel;
+  operators::SearchGroupPaddingParam param;
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  ctx->As<X86Context>();
+  sgp_kernel.SetContext(std::move(ctx));
+  param.x = &x;
+  param.out_emb_padding = &out_emb_padding;
+  param.out_new = &out_new;
+  param.out_padding = &out_padding;
+  param.pad_id = 7;
+  sgp_kernel.SetParam(param);
+
+  x.Resize({4, 2});
+  x.set_lod({{0, 2, 4}});
+  auto* x_data = x.mutable_data<float>();
+  for (int64_t i = 0; i < x.numel(); i++) {
+    x_data[i] = static_cast<float>(i);
+  }
+  sgp_kernel.Run();
+  EXPECT_EQ(out_emb_padding.raw_data(), x.raw_data());
+  EXPECT_EQ(out_emb_padding.dims(), x.dims());
+  for (int i = 0; i < out_padding.numel(); i++) {
+    EXPECT_EQ(out_padding.data<float>()[i], 0.f);
+  }
+
+  x.Resize({3, 2});
+  x.set_lod({{0, 1, 3}});
+  x_data = x.mutable_data<float>();
+  for (int64_t i = 0; i < x.numel(); i++) {
+    x_data[i] = static_cast<float>(10 + i);
+  }
+  sgp_kernel.Run();
+  EXPECT_NE(out_emb_padding.raw_data(), x.raw_data());
+  std::vector<float> out_emb_padding_ref = {10, 11, 0, 0, 12, 13, 14, 15};
+  std::vector<float> out_padding_ref = {0, 7, 0, 0};
+  ASSERT_EQ(out_emb_padding.numel(), 8);
+  for (int i = 0; i < 8; i++) {
+    EXPECT_EQ(out_emb_padding.data<float>()[i], out_emb_padding_ref[i]);
+  }
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(out_padding.data<float>()[i], out_padding_ref[i]);
+  }
+  for (int64_t i = 0; i < x.numel(); i++) {
+    EXPECT_EQ(x.data<float>()[i], static_cast<float>(10 + i));
+  }
+}
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
@@ -14,6 +14,7 @@
 
 #include "lite/kernels/x86/search_seq_depadding_compute.h"
 #include <vector>
+#include "lite/backends/host/math/sequence_view.h"
 
 namespace paddle {
 namespace lite {
@@ -43,8 +44,6 @@ void SearchSeqDepaddingCompute<T>::Run() {
   out->set_lod(out_lod);
   out->Resize({src_cap_l, pad_cap_e});
 
-  const auto* pad_data = pad->template data<T>();
-  auto* out_data = out->template mutable_data<T>();
   for (int i = 0; i < src_batch; ++i) {
     const int src_i_l = src_offset[i + 1] - src_offset[i];
     const int pad_i_l = pad_offset[i + 1] - pad_offset[i];
@@ -52,10 +51,24 @@ void SearchSeqDepaddingCompute<T>::Run() {
       LOG(FATAL)
           << "the length of padding seq input is less than source seq input.";
     }
-    memcpy(out_data + src_offset[i] * pad_cap_e,
-           pad_data + pad_offset[i] * pad_cap_e,
-           src_i_l * pad_cap_e * sizeof(T));
   }
+
+  // Depadding the sequences which aren't padded at all is a no-op, share the
+  // storage of Pad instead of copying it.
+  auto out_view = lite::host::math::LoDSequences(src_offset, pad_cap_e);
+  auto pad_view = out_view;
+  pad_view.offsets.assign(pad_offset.begin(), pad_offset.begin() + src_batch);
+  pad_view.rows = pad->dims()[0];
+  if (lite::host::math::IsSameLayout(pad_view, out_view)) {
+    lite::host::math::ShareSequences(*pad, out);
+    return;
+  }
+
+  lite::host::math::DetachSequences(*pad, out);
+  lite::host::math::CopySequences<T>(pad->template data<T>(),
+                                     pad_view,
+                                     out->template mutable_data<T>(),
+                                     out_view);
 }
 
 }  // namespace x86
@@ -75,6 +75,33 @@ TEST(search_seq_depadding_x86, run_test) {
   }
 }
 
+// Depadding the sequences which aren't padded shares the storage of Pad.
+TEST(search_seq_depadding_x86, share_unpadded) {
+  lite::Tensor pad, src, out;
+  pad.Resize({4, 3});
+  pad.set_lod({{0, 2, 4}});
+  src.Resize({4, 1});
+  src.set_lod({{0, 2, 4}});
+  auto* pad_data = pad.mutable_data<float>();
+  for (int64_t i = 0; i < pad.numel(); i++) {
+    pad_data[i] = static_cast<float>(i);
+  }
+  SearchSeqDepaddingCompute<float> ssdc;
+  operators::SearchSeqDepaddingParam param;
+  std::unique_ptr<KernelContext> ctx(new KernelContext);
+  ctx->As<X86Context>();
+  ssdc.SetContext(std::move(ctx));
+  param.pad = &pad;
+  param.src = &src;
+  param.out = &out;
+  ssdc.SetParam(param);
+  ssdc.Run();
+
+  EXPECT_EQ(out.raw_data(), pad.raw_data());
+  EXPECT_EQ(out.dims(), pad.dims());
+  EXPECT_EQ(out.lod(), src.lod());
+}
+
 }  // namespace x86
 }  // namespace kernels
 }  // namespace lite
@@ -0,0 +1,70 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/operators/fused_embedding_seq_pool_op.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace operators {
+
+bool FusedEmbeddingSeqPoolOpLite::CheckShape() const {
+  CHECK_OR_FALSE(param_.W);
+  CHECK_OR_FALSE(param_.Ids);
+  CHECK_OR_FALSE(param_.Out);
+  CHECK_OR_FALSE(param_.combiner == "sum" || param_.combiner == "avg");
+
+  const auto &table_dims = param_.W->dims();
+  const auto &ids_dims = param_.Ids->dims();
+  CHECK_EQ_OR_FALSE(table_dims.size(), 2UL);
+  CHECK_OR_FALSE(ids_dims.size() == 1 ||
+                 (ids_dims.size() == 2 && ids_dims[1] == 1));
+  const auto &lod = param_.Ids->lod();
+  CHECK_OR_FALSE(!lod.empty());
+  CHECK_GE_OR_FALSE(2UL, lod.size());
+  return true;
+}
+
+bool FusedEmbeddingSeqPoolOpLite::InferShapeImpl() const {
+  const auto &lod = param_.Ids->lod();
+  int64_t batch_size = static_cast<int64_t>(lod.back().size()) - 1;
+  param_.Out->Resize({batch_size, param_.W->dims()[1]});
+  return true;
+}
+
+bool FusedEmbeddingSeqPoolOpLite::AttachImpl(const cpp::OpDesc &opdesc,
+                                             lite::Scope *scope) {
+  param_.W = scope->FindVar(opdesc.Input("W").front())->GetMutable<Tensor>();
+  param_.Ids =
+      scope->FindVar(opdesc.Input("Ids").front())->GetMutable<Tensor>();
+  param_.Out =
+      scope->FindVar(opdesc.Output("Out").front())->GetMutable<Tensor>();
+  if (opdesc.HasAttr("padding_idx")) {
+    param_.padding_idx = opdesc.GetAttr<int64_t>("padding_idx");
+  }
+  if (opdesc.HasAttr("combiner")) {
+    param_.combiner = opdesc.GetAttr<std::string>("combiner");
+  }
+  if (opdesc.HasAttr("pad_value")) {
+    param_.pad_value = opdesc.GetAttr<float>("pad_value");
+  }
+  return true;
+}
+
+}  // namespace operators
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_OP(fused_embedding_seq_pool,
+                 paddle::lite::operators::FusedEmbeddingSeqPoolOpLite);
@@ -0,0 +1,113 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/operators/kv_cache_attention_op.h"
+#include "lite/core/op_registry.h"
+
+namespace paddle {
+namespace lite {
+namespace operators {
+
+bool KVCacheAttentionOpLite::CheckShape() const {
+  CHECK_OR_FALSE(param_.q);
+  CHECK_OR_FALSE(param_.k);
+  CHECK_OR_FALSE(param_.v);
+  CHECK_OR_FALSE(param_.past_k);
+  CHECK_OR_FALSE(param_.past_v);
+  CHECK_OR_FALSE(param_.out);
+  CHECK_OR_FALSE((param_.present_k == nullptr) ==
+                 (param_.present_v == nullptr));
+
+  const auto &q_dims = param_.q->dims();
+  const auto &k_dims = param_.k->dims();
+  const auto &v_dims = param_.v->dims();
+  const auto &past_k_dims = param_.past_k->dims();
+  const auto &past_v_dims = param_.past_v->dims();
+  size_t rank = q_dims.size();
+  CHECK_GE_OR_FALSE(rank, 3UL);
+  CHECK_EQ_OR_FALSE(k_dims.size(), rank);
+  CHECK_EQ_OR_FALSE(v_dims.size(), rank);
+  CHECK_EQ_OR_FALSE(past_k_dims.size(), rank);
+  CHECK_EQ_OR_FALSE(past_v_dims.size(), rank);
+  for (size_t i = 0; i < rank - 2; i++) {
+    CHECK_EQ_OR_FALSE(k_dims[i], q_dims[i]);
+    CHECK_EQ_OR_FALSE(v_dims[i], q_dims[i]);
+    CHECK_EQ_OR_FALSE(past_k_dims[i], q_dims[i]);
+    CHECK_EQ_OR_FALSE(past_v_dims[i], q_dims[i]);
+  }
+  CHECK_EQ_OR_FALSE(k_dims[rank - 1], q_dims[rank - 1]);
+  CHECK_EQ_OR_FALSE(past_k_dims[rank - 1], q_dims[rank - 1]);
+  CHECK_EQ_OR_FALSE(past_v_dims[rank - 1], v_dims[rank - 1]);
+  CHECK_EQ_OR_FALSE(v_dims[rank - 2], k_dims[rank - 2]);
+  CHECK_EQ_OR_FALSE(past_v_dims[rank - 2], past_k_dims[rank - 2]);
+
+  if (param_.mask) {
+    // The mask is broadcast to [..., q_len, seq_len] from the last dim.
+    const auto &mask_dims = param_.mask->dims();
+    CHECK_GE_OR_FALSE(rank, mask_dims.size());
+    int64_t seq_len = past_k_dims[rank - 2] + k_dims[rank - 2];
+    for (size_t i = 0; i < mask_dims.size(); i++) {
+      int64_t dim = mask_dims[mask_dims.size() - 1 - i];
+      int64_t full_dim = i == 0 ? seq_len : q_dims[rank - 1 - i];
+      CHECK_OR_FALSE(dim == 1 || dim == full_dim);
+    }
+  }
+  return true;
+}
+
+bool KVCacheAttentionOpLite::InferShapeImpl() const {
+  // The present caches are resized by the kernels, because they may be the
+  // past ones, which can't be resized before they're read.
+  auto out_dims = param_.q->dims();
+  out_dims[out_dims.size() - 1] = param_.v->dims()[out_dims.size() - 1];
+  param_.out->Resize(out_dims);
+  param_.out->set_lod(param_.q->lod());
+  return true;
+}
+
+bool KVCacheAttentionOpLite::AttachImpl(const cpp::OpDesc &op_desc,
+                                        lite::Scope *scope) {
+  auto GetTensor = [&](const std::string &name) -> lite::Tensor * {
+    return scope->FindVar(name)->GetMutable<lite::Tensor>();
+  };
+  param_.q = GetTensor(op_desc.Input("Q").front());
+  param_.k = GetTensor(op_desc.Input("K").front());
+  param_.v = GetTensor(op_desc.Input("V").front());
+  param_.past_k = GetTensor(op_desc.Input("PastK").front());
+  param_.past_v = GetTensor(op_desc.Input("PastV").front());
+  param_.out = GetTensor(op_desc.Output("Out").front());
+  if (op_desc.HasInput("Mask") && !op_desc.Input("Mask").empty()) {
+    param_.mask = GetTensor(op_desc.Input("Mask").front());
+  }
+  if (op_desc.HasOutput("PresentK") && !op_desc.Output("PresentK").empty()) {
+    param_.present_k = GetTensor(op_desc.Output("PresentK").front());
+  }
+  if (op_desc.HasOutput("PresentV") && !op_desc.Output("PresentV").empty()) {
+    param_.present_v = GetTensor(op_desc.Output("PresentV").front());
+  }
+  if (op_desc.HasAttr("alpha")) {
+    param_.alpha = op_desc.GetAttr<float>("alpha");
+  }
+  if (op_desc.HasAttr("max_seq_len")) {
+    param_.max_seq_len = op_desc.GetAttr<int>("max_seq_len");
+  }
+  return true;
+}
+
+}  // namespace operators
+}  // namespace lite
+}  // namespace paddle
+
+REGISTER_LITE_OP(kv_cache_attention,
+                 paddle::lite::operators::KVCacheAttentionOpLite);
@@ -0,0 +1,62 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include "lite/core/kernel.h"
+#include "lite/core/op_lite.h"
+#include "lite/core/scope.h"
+#include "lite/core/tensor.h"
+#include "lite/operators/op_params.h"
+#include "lite/utils/all.h"
+
+namespace paddle {
+namespace lite {
+namespace operators {
+
+/*
+ * The attention of the autoregressive decoders with the key/value caches:
+ *
+ *   PresentK = concat(PastK, K), PresentV = concat(PastV, V)
+ *   Out = softmax(alpha * Q * PresentK^T + Mask) * PresentV
+ *
+ * where the tensors are [..., seq_len, head_dim], and Mask is broadcast to
+ * [..., q_len, past_len + new_len]. PresentK and PresentV are optional, and
+ * they can be the same variables as PastK and PastV, so the caches are
+ * updated in place.
+ */
+class KVCacheAttentionOpLite : public OpLite {
+ public:
+  KVCacheAttentionOpLite() {}
+
+  explicit KVCacheAttentionOpLite(const std::string &type) : OpLite(type) {}
+
+  bool CheckShape() const override;
+
+  bool InferShapeImpl() const override;
+
+  bool AttachImpl(const cpp::OpDesc &op_desc, lite::Scope *scope) override;
+
+  void AttachKernel(KernelBase *kernel) override { kernel->SetParam(param_); }
+
+  std::string DebugString() const override { return "kv_cache_attention"; }
+
+ private:
+  mutable KVCacheAttentionParam param_;
+};
+
+}  // namespace operators
+}  // namespace lite
+}  // namespace paddle
@@ -147,6 +147,25 @@ struct FusedAttentionParam : ParamBase {
   float scale{1.f};
 };
 
+// The attention over the past keys and values followed by the new ones,
+// along the sequence axis (the second to last one).
+struct KVCacheAttentionParam : ParamBase {
+  const lite::Tensor* q{nullptr};
+  const lite::Tensor* k{nullptr};
+  const lite::Tensor* v{nullptr};
+  const lite::Tensor* past_k{nullptr};
+  const lite::Tensor* past_v{nullptr};
+  const lite::Tensor* mask{nullptr};
+  lite::Tensor* out{nullptr};
+  // The concatenated keys and values, which are optional.
+  lite::Tensor* present_k{nullptr};
+  lite::Tensor* present_v{nullptr};
+
+  float alpha{1.f};
+  // The sequence length reserved for the in-place caches, 0 if unknown.
+  int max_seq_len{0};
+};
+
 struct SearchSeqFcParam : ParamBase {
   lite::Tensor* x{nullptr};
   lite::Tensor* w{nullptr};
@@ -533,6 +552,8 @@ struct SplitParam : ParamBase {
   int axis{-1};
   int num{0};
   std::vector<int> sections;
+  // The outputs may share the memory of `x`.
+  bool inplace{false};
 };
 
 struct UnbindParam : ParamBase {
@@ -946,6 +967,9 @@ struct GRUParam : ParamBase {
   const lite::Tensor* h0{nullptr};
   const lite::Tensor* weight{nullptr};
   const lite::Tensor* bias{nullptr};
+  // The intermediates in the batch order, which are only used by the
+  // training. They're left unwritten by the kernels which don't compute in
+  // the batch order, e.g. the fused GRU of x86.
   lite::Tensor* batch_gate{nullptr};
   lite::Tensor* batch_reset_hidden_prev{nullptr};
   lite::Tensor* batch_hidden{nullptr};
@@ -1009,6 +1033,19 @@ struct LookupTableParam : ParamBase {
   std::string entry{"none"};
 };
 
+// The embeddings of the ids pooled over each sequence, which is the fusion
+// of lookup_table and sequence_pool.
+struct FusedEmbeddingSeqPoolParam : ParamBase {
+  const lite::Tensor* W{nullptr};
+  const lite::Tensor* Ids{nullptr};
+  lite::Tensor* Out{nullptr};
+  int64_t padding_idx{-1};
+  // "sum" or "avg".
+  std::string combiner{"sum"};
+  // The output of the empty sequences.
+  float pad_value{0.f};
+};
+
 struct LookupTableDequantParam : ParamBase {
   lite::Tensor* W{nullptr};
   lite::Tensor* Ids{nullptr};
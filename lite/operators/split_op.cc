@@ -94,6 +94,9 @@ bool SplitOp::AttachImpl(const cpp::OpDesc &opdesc, lite::Scope *scope) {
   param_.axis = opdesc.GetAttr<int>("axis");
   param_.num = opdesc.GetAttr<int>("num");
   param_.sections = opdesc.GetAttr<std::vector<int>>("sections");
+  if (opdesc.HasAttr("inplace")) {
+    param_.inplace = opdesc.GetAttr<bool>("inplace");
+  }
 
   param_.x = scope->FindTensor(opdesc.Input("X").front());
   if (opdesc.HasInput("AxisTensor") && !opdesc.Input("AxisTensor").empty()) {
@@ -0,0 +1,313 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "lite/tests/benchmark/src/kernel_bench.h"
+#include <gflags/gflags.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <utility>
+#include "lite/core/context.h"
+#include "lite/core/device_info.h"
+#include "lite/core/op_registry.h"
+#include "lite/core/program.h"
+#include "lite/core/scope.h"
+#if (defined LITE_WITH_X86) && (defined PADDLE_WITH_MKLML)
+#if !defined(__APPLE__)
+#include <omp.h>
+#endif
+#include "lite/backends/x86/mklml.h"
+#endif
+
+DEFINE_int32(warmup, 10, "warmup times of each case");
+DEFINE_int32(repeats, 100, "repeat times of each case");
+DEFINE_int32(threads, 1, "threads num");
+DEFINE_string(filter, "", "only run the cases whose names contain it");
+DEFINE_string(json, "", "the path of the json output");
+DEFINE_string(latency_table,
+              "",
+              "the path of the output in the format of "
+              "latency_lookup_table.txt");
+DEFINE_bool(list, false, "list the cases and exit");
+
+namespace paddle {
+namespace lite {
+namespace bench {
+
+namespace {
+
+std::string DimsToString(const DDim& dims) {
+  std::stringstream ss;
+  ss << "[";
+  for (size_t i = 0; i < dims.size(); i++) {
+    ss << (i > 0 ? " " : "") << dims[i];
+  }
+  ss << "]";
+  return ss.str();
+}
+
+size_t TensorBytes(const Tensor& tensor) {
+  return tensor.dims().production() * PrecisionTypeLength(tensor.precision());
+}
+
+void FillTensor(const BenchInput& input, std::mt19937* rng, Tensor* tensor) {
+  tensor->Resize(input.dims);
+  tensor->set_persistable(input.persistable);
+  if (input.fill) {
+    input.fill(tensor);
+    return;
+  }
+  std::uniform_real_distribution<float> dist(input.min, input.max);
+  auto* data = tensor->mutable_data<float>();
+  for (int64_t i = 0; i < tensor->numel(); i++) {
+    data[i] = dist(*rng);
+  }
+}
+
+// The kernel whose input declarations accept the precisions of the inputs.
+bool AcceptInputs(const KernelBase& kernel,
+                  const cpp::OpDesc& desc,
+                  Scope* scope) {
+  for (auto& arg : desc.InputArgumentNames()) {
+    const auto* type = kernel.GetInputDeclType(arg);
+    if (type == nullptr) return false;
+    auto precision = type->precision();
+    for (auto& name : desc.Input(arg)) {
+      auto* tensor = scope->FindTensor(name);
+      if (tensor == nullptr || (precision != PRECISION(kAny) &&
+                                precision != tensor->precision())) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+double Percentile(const std::vector<double>& sorted, double p) {
+  size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+  return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+std::string JsonEscape(const std::string& str) {
+  std::string res;
+  for (char c : str) {
+    if (c == '"' || c == '\\') res.push_back('\\');
+    res.push_back(c);
+  }
+  return res;
+}
+
+void WriteJson(const std::vector<BenchResult>& results,
+               const std::string& path) {
+  std::ofstream ofs(path);
+  CHECK(ofs.is_open()) << "Failed to open " << path;
+  ofs << "{\n  \"threads\": " << FLAGS_threads
+      << ",\n  \"warmup\": " << FLAGS_warmup
+      << ",\n  \"repeats\": " << FLAGS_repeats << ",\n  \"results\": [";
+  for (size_t i = 0; i < results.size(); i++) {
+    const auto& r = results[i];
+    ofs << (i > 0 ? "," : "") << "\n    {\"name\": \"" << JsonEscape(r.name)
+        << "\", \"op_type\": \"" << r.op_type << "\", \"kernel\": \""
+        << JsonEscape(r.kernel) << "\", \"input_dims\": \"" << r.input_dims
+        << "\", \"output_dims\": \"" << r.output_dims
+        << "\", \"repeats\": " << r.repeats << ", \"min_us\": " << r.min_us
+        << ", \"max_us\": " << r.max_us << ", \"mean_us\": " << r.mean_us
+        << ", \"stddev_us\": " << r.stddev_us << ", \"p50_us\": " << r.p50_us
+        << ", \"p90_us\": " << r.p90_us << ", \"p99_us\": " << r.p99_us
+        << ", \"gflops\": " << r.gflops << ", \"gbps\": " << r.gbps << "}";
+  }
+  ofs << "\n  ]\n}\n";
+}
+
+// The same columns as latency_lookup_table.txt, in milliseconds.
+void WriteLatencyTable(const std::vector<BenchResult>& results,
+                       const std::string& path) {
+  std::ofstream ofs(path);
+  CHECK(ofs.is_open()) << "Failed to open " << path;
+  ofs << "op_name\tinput_dims\toutput_dims\tparam_info\tmin_latency(ms)\t"
+         "max_latency(ms)\tavg_latency(ms)\n";
+  for (const auto& r : results) {
+    ofs << r.op_type << "\t" << r.input_dims << "\t" << r.output_dims << "\t("
+        << r.name << ", threads=" << FLAGS_threads << ")\t"
+        << r.min_us / 1000 << "\t" << r.max_us / 1000 << "\t"
+        << r.mean_us / 1000 << "\n";
+  }
+}
+
+std::vector<Place> CpuPlaces() {
+  std::vector<Place> places;
+#ifdef LITE_WITH_X86
+  places.emplace_back(TARGET(kX86), PRECISION(kFloat));
+  places.emplace_back(TARGET(kX86), PRECISION(kAny));
+#endif
+#ifdef LITE_WITH_ARM
+  places.emplace_back(TARGET(kARM), PRECISION(kFloat));
+  places.emplace_back(TARGET(kARM), PRECISION(kAny));
+#endif
+  places.emplace_back(TARGET(kHost), PRECISION(kFloat));
+  places.emplace_back(TARGET(kHost), PRECISION(kAny));
+  return places;
+}
+
+}  // namespace
+
+bool KernelBench::Run(const BenchCase& bench_case, BenchResult* result) {
+  Scope scope;
+  std::mt19937 rng(0);
+  cpp::OpDesc desc;
+  desc.SetType(bench_case.op_type);
+  for (auto& input : bench_case.inputs) {
+    FillTensor(input, &rng, scope.NewTensor(input.arg));
+    desc.SetInput(input.arg, {input.arg});
+  }
+  for (auto& output : bench_case.outputs) {
+    scope.NewTensor(output);
+    desc.SetOutput(output, {output});
+  }
+  if (bench_case.set_attrs) bench_case.set_attrs(&desc);
+
+  auto op = LiteOpRegistry::Global().Create(bench_case.op_type);
+  if (!op) {
+    LOG(WARNING) << "No op " << bench_case.op_type;
+    return false;
+  }
+  op->Attach(desc, &scope);
+  std::unique_ptr<KernelBase> kernel;
+  for (auto& place : places_) {
+    for (auto& candidate : op->CreateKernels({place})) {
+      if (AcceptInputs(*candidate, desc, &scope)) {
+        kernel = std::move(candidate);
+        break;
+      }
+    }
+    if (kernel) break;
+  }
+  if (!kernel) {
+    LOG(WARNING) << "No kernel to run " << bench_case.name;
+    return false;
+  }
+  op->AttachKernel(kernel.get());
+  kernel->SetContext(ContextScheduler::Global().NewContext(kernel->target()));
+  result->kernel = kernel->summary();
+  Instruction inst(op, std::move(kernel));
+#ifdef LITE_WITH_PROFILE
+  std::unique_ptr<profile::Profiler> profiler(new profile::Profiler());
+  inst.set_profiler(profiler.get());
+#endif
+
+  for (int i = 0; i < std::max(warmup_, 1); i++) {
+    inst.Run();
+  }
+  std::vector<double> samples(repeats_);
+  for (int i = 0; i < repeats_; i++) {
+    auto start = std::chrono::steady_clock::now();
+    inst.Run();
+    samples[i] = std::chrono::duration<double, std::micro>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  }
+
+  size_t bytes = 0;
+  std::string input_dims;
+  std::string output_dims;
+  for (auto& input : bench_case.inputs) {
+    auto* tensor = scope.FindTensor(input.arg);
+    bytes += TensorBytes(*tensor);
+    input_dims +=
+        (input_dims.empty() ? "" : " ") + DimsToString(tensor->dims());
+  }
+  for (auto& output : bench_case.outputs) {
+    auto* tensor = scope.FindTensor(output);
+    bytes += TensorBytes(*tensor);
+    output_dims +=
+        (output_dims.empty() ? "" : " ") + DimsToString(tensor->dims());
+  }
+
+  std::sort(samples.begin(), samples.end());
+  double sum = 0;
+  for (auto sample : samples) sum += sample;
+  double mean = sum / repeats_;
+  double var = 0;
+  for (auto sample : samples) var += (sample - mean) * (sample - mean);
+  result->name = bench_case.name;
+  result->op_type = bench_case.op_type;
+  result->input_dims = input_dims;
+  result->output_dims = output_dims;
+  result->repeats = repeats_;
+  result->min_us = samples.front();
+  result->max_us = samples.back();
+  result->mean_us = mean;
+  result->stddev_us = std::sqrt(var / repeats_);
+  result->p50_us = Percentile(samples, 0.5);
+  result->p90_us = Percentile(samples, 0.9);
+  result->p99_us = Percentile(samples, 0.99);
+  result->gflops = mean > 0 ? bench_case.flops / mean / 1e3 : 0;
+  result->gbps = mean > 0 ? bytes / mean / 1e3 : 0;
+  return true;
+}
+
+}  // namespace bench
+}  // namespace lite
+}  // namespace paddle
+
+int main(int argc, char** argv) {
+  using paddle::lite::bench::BenchResult;
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+  CHECK_GT(FLAGS_repeats, 0);
+#ifdef LITE_WITH_ARM
+  paddle::lite::DeviceInfo::Init();
+  paddle::lite::DeviceInfo::Global().SetRunMode(
+      paddle::lite_api::LITE_POWER_NO_BIND, FLAGS_threads);
+#endif
+#if (defined LITE_WITH_X86) && (defined PADDLE_WITH_MKLML)
+#ifdef LITE_WITH_STATIC_MKL
+  MKL_Set_Num_Threads(FLAGS_threads);
+#else
+  paddle::lite::x86::MKL_Set_Num_Threads(FLAGS_threads);
+#endif
+#if !defined(__APPLE__)
+  omp_set_num_threads(FLAGS_threads);
+#endif
+#endif
+
+  paddle::lite::bench::KernelBench bench(
+      paddle::lite::bench::CpuPlaces(), FLAGS_warmup, FLAGS_repeats);
+  std::vector<BenchResult> results;
+  for (auto& bench_case : paddle::lite::bench::DefaultBenchCases()) {
+    if (bench_case.name.find(FLAGS_filter) == std::string::npos) continue;
+    if (FLAGS_list) {
+      std::cout << bench_case.name << std::endl;
+      continue;
+    }
+    BenchResult result;
+    if (!bench.Run(bench_case, &result)) continue;
+    std::cout << result.name << "\t" << result.kernel
+              << "\tmean=" << result.mean_us << "us p50=" << result.p50_us
+              << "us p99=" << result.p99_us << "us gflops=" << result.gflops
+              << " gbps=" << result.gbps << std::endl;
+    results.push_back(result);
+  }
+  if (!FLAGS_json.empty()) {
+    paddle::lite::bench::WriteJson(results, FLAGS_json);
+  }
+  if (!FLAGS_latency_table.empty()) {
+    paddle::lite::bench::WriteLatencyTable(results, FLAGS_latency_table);
+  }
+  return 0;
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "lite/core/tensor.h"
+#include "lite/core/types.h"
+#include "lite/model_parser/cpp_desc.h"
+
+namespace paddle {
+namespace lite {
+namespace bench {
+
+// An input of a benchmark case, which is filled with the uniform random
+// values in [min, max) unless `fill` is set.
+struct BenchInput {
+  std::string arg;
+  DDim dims;
+  bool persistable{false};
+  float min{-1.f};
+  float max{1.f};
+  std::function<void(Tensor*)> fill;
+};
+
+// A benchmark case runs an op built from its OpDesc, so the same case runs
+// with the kernels of any CPU target. The var names are the arg names.
+struct BenchCase {
+  // "<op>/<variant>", matched by --filter.
+  std::string name;
+  std::string op_type;
+  std::vector<BenchInput> inputs;
+  std::vector<std::string> outputs;
+  std::function<void(cpp::OpDesc*)> set_attrs;
+  // The floating point operations of one run, 0 if not meaningful.
+  double flops{0};
+};
+
+struct BenchResult {
+  std::string name;
+  std::string op_type;
+  std::string kernel;
+  std::string input_dims;
+  std::string output_dims;
+  int repeats{0};
+  // The latencies in microseconds.
+  double min_us{0};
+  double max_us{0};
+  double mean_us{0};
+  double stddev_us{0};
+  double p50_us{0};
+  double p90_us{0};
+  double p99_us{0};
+  double gflops{0};
+  // The bytes of the inputs and the outputs divided by the mean latency.
+  double gbps{0};
+};
+
+class KernelBench {
+ public:
+  KernelBench(const std::vector<Place>& places, int warmup, int repeats)
+      : places_(places), warmup_(warmup), repeats_(repeats) {}
+
+  // Run the case with the first kernel of `places_` which accepts the
+  // inputs, return false if there is none.
+  bool Run(const BenchCase& bench_case, BenchResult* result);
+
+ private:
+  std::vector<Place> places_;
+  int warmup_;
+  int repeats_;
+};
+
+// The cases of the default suite, see kernel_bench_cases.cc.
+std::vector<BenchCase> DefaultBenchCases();
+
+}  // namespace bench
+}  // namespace lite
+}  // namespace paddle
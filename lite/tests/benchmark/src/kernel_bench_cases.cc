@@ -0,0 +1,320 @@
+// Copyright (c) 2019 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <random>
+#include <string>
+#include <vector>
+#include "lite/tests/benchmark/src/kernel_bench.h"
+
+namespace paddle {
+namespace lite {
+namespace bench {
+
+namespace {
+
+BenchInput Input(const std::string& arg,
+                 const std::vector<int64_t>& dims,
+                 bool persistable = false) {
+  BenchInput input;
+  input.arg = arg;
+  input.dims = DDim(dims);
+  input.persistable = persistable;
+  return input;
+}
+
+std::string Shape(const std::vector<int64_t>& dims) {
+  std::string res;
+  for (size_t i = 0; i < dims.size(); i++) {
+    res += (i > 0 ? "x" : "") + std::to_string(dims[i]);
+  }
+  return res;
+}
+
+void AddGemmCases(std::vector<BenchCase>* cases) {
+  const std::vector<std::vector<int64_t>> kShapes{
+      {1, 1024, 1024}, {64, 512, 512}, {256, 256, 256}, {512, 512, 512}};
+  for (auto& shape : kShapes) {
+    int64_t m = shape[0], n = shape[1], k = shape[2];
+    BenchCase matmul;
+    matmul.name = "matmul/" + Shape(shape);
+    matmul.op_type = "matmul";
+    matmul.inputs = {Input("X", {m, k}), Input("Y", {k, n})};
+    matmul.outputs = {"Out"};
+    matmul.set_attrs = [](cpp::OpDesc* desc) {
+      desc->SetAttr("transpose_X", false);
+      desc->SetAttr("transpose_Y", false);
+      desc->SetAttr("alpha", 1.f);
+    };
+    matmul.flops = 2.0 * m * n * k;
+    cases->push_back(matmul);
+
+    BenchCase fc;
+    fc.name = "fc/" + Shape(shape);
+    fc.op_type = "fc";
+    fc.inputs = {Input("Input", {m, k}),
+                 Input("W", {k, n}, true),
+                 Input("Bias", {n}, true)};
+    fc.outputs = {"Out"};
+    fc.set_attrs = [](cpp::OpDesc* desc) {
+      desc->SetAttr("in_num_col_dims", 1);
+    };
+    fc.flops = 2.0 * m * n * k;
+    cases->push_back(fc);
+  }
+
+  // The batched matmuls of the attention.
+  const std::vector<std::vector<int64_t>> kBatchedShapes{{12, 128, 128, 64},
+                                                         {16, 64, 64, 64}};
+  for (auto& shape : kBatchedShapes) {
+    int64_t b = shape[0], m = shape[1], n = shape[2], k = shape[3];
+    BenchCase matmul_v2;
+    matmul_v2.name = "matmul_v2/" + Shape(shape);
+    matmul_v2.op_type = "matmul_v2";
+    matmul_v2.inputs = {Input("X", {b, m, k}), Input("Y", {b, k, n})};
+    matmul_v2.outputs = {"Out"};
+    matmul_v2.set_attrs = [](cpp::OpDesc* desc) {
+      desc->SetAttr("trans_x", false);
+      desc->SetAttr("trans_y", false);
+    };
+    matmul_v2.flops = 2.0 * b * m * n * k;
+    cases->push_back(matmul_v2);
+  }
+}
+
+// {batch, channels, height, width, out channels, kernel, stride, groups}
+void AddConvCase(const std::string& op_type,
+                 const std::vector<int>& conf,
+                 std::vector<BenchCase>* cases) {
+  int n = conf[0], c = conf[1], h = conf[2], w = conf[3];
+  int oc = conf[4], kernel = conf[5], stride = conf[6], groups = conf[7];
+  int pad = kernel / 2;
+  int oh = (h + 2 * pad - kernel) / stride + 1;
+  int ow = (w + 2 * pad - kernel) / stride + 1;
+  BenchCase conv;
+  conv.name = op_type + "/" + std::to_string(kernel) + "x" +
+              std::to_string(kernel) + "s" + std::to_string(stride) + "g" +
+              std::to_string(groups) + "/" + Shape({n, c, h, w}) + "->" +
+              std::to_string(oc);
+  conv.op_type = op_type;
+  conv.inputs = {Input("Input", {n, c, h, w}),
+                 Input("Filter", {oc, c / groups, kernel, kernel}, true),
+                 Input("Bias", {oc}, true)};
+  conv.outputs = {"Output"};
+  conv.set_attrs = [=](cpp::OpDesc* desc) {
+    desc->SetAttr("strides", std::vector<int>{stride, stride});
+    desc->SetAttr("paddings", std::vector<int>{pad, pad});
+    desc->SetAttr("dilations", std::vector<int>{1, 1});
+    desc->SetAttr("groups", groups);
+  };
+  conv.flops = 2.0 * n * oc * oh * ow * (c / groups) * kernel * kernel;
+  cases->push_back(conv);
+}
+
+void AddConvCases(std::vector<BenchCase>* cases) {
+  AddConvCase("conv2d", {1, 64, 56, 56, 64, 1, 1, 1}, cases);
+  AddConvCase("conv2d", {1, 64, 56, 56, 64, 3, 1, 1}, cases);
+  AddConvCase("conv2d", {1, 64, 56, 56, 128, 3, 2, 1}, cases);
+  AddConvCase("conv2d", {1, 32, 28, 28, 32, 5, 1, 1}, cases);
+  AddConvCase("conv2d", {1, 64, 28, 28, 64, 3, 1, 4}, cases);
+  AddConvCase("depthwise_conv2d", {1, 128, 56, 56, 128, 3, 1, 128}, cases);
+  AddConvCase("depthwise_conv2d", {1, 128, 56, 56, 128, 3, 2, 128}, cases);
+  AddConvCase("depthwise_conv2d", {1, 96, 28, 28, 96, 5, 1, 96}, cases);
+}
+
+void AddNormCases(std::vector<BenchCase>* cases) {
+  const std::vector<std::vector<int64_t>> kSoftmaxShapes{{64, 1000},
+                                                         {16, 12, 128, 128}};
+  for (auto& shape : kSoftmaxShapes) {
+    BenchCase softmax;
+    softmax.name = "softmax/" + Shape(shape);
+    softmax.op_type = "softmax";
+    softmax.inputs = {Input("X", shape)};
+    softmax.outputs = {"Out"};
+    softmax.set_attrs = [](cpp::OpDesc* desc) { desc->SetAttr("axis", -1); };
+    cases->push_back(softmax);
+  }
+
+  const std::vector<std::vector<int64_t>> kLayerNormShapes{{64, 768},
+                                                           {512, 1024}};
+  for (auto& shape : kLayerNormShapes) {
+    BenchCase layer_norm;
+    layer_norm.name = "layer_norm/" + Shape(shape);
+    layer_norm.op_type = "layer_norm";
+    layer_norm.inputs = {Input("X", shape),
+                         Input("Scale", {shape[1]}, true),
+                         Input("Bias", {shape[1]}, true)};
+    layer_norm.outputs = {"Y", "Mean", "Variance"};
+    layer_norm.set_attrs = [](cpp::OpDesc* desc) {
+      desc->SetAttr("begin_norm_axis", 1);
+      desc->SetAttr("epsilon", 1e-5f);
+    };
+    cases->push_back(layer_norm);
+  }
+}
+
+void AddDataMovementCases(std::vector<BenchCase>* cases) {
+  const std::vector<std::pair<std::vector<int64_t>, std::vector<int>>>
+      kTransposes{{{1, 64, 56, 56}, {0, 2, 3, 1}},
+                  {{16, 12, 128, 64}, {0, 2, 1, 3}}};
+  for (auto& transpose : kTransposes) {
+    BenchCase transpose2;
+    transpose2.name = "transpose2/" + Shape(transpose.first);
+    transpose2.op_type = "transpose2";
+    transpose2.inputs = {Input("X", transpose.first)};
+    transpose2.outputs = {"Out", "XShape"};
+    auto axis = transpose.second;
+    transpose2.set_attrs = [=](cpp::OpDesc* desc) {
+      desc->SetAttr("axis", axis);
+    };
+    cases->push_back(transpose2);
+  }
+
+  // {name, y dims, axis}
+  const std::vector<int64_t> x_dims{8, 64, 56, 56};
+  const std::vector<
+      std::pair<std::string, std::pair<std::vector<int64_t>, int>>>
+      kBroadcasts{{"same", {x_dims, -1}},
+                  {"channel", {{64}, 1}},
+                  {"last", {{56}, -1}}};
+  for (auto& broadcast : kBroadcasts) {
+    BenchCase add;
+    add.name = "elementwise_add/" + broadcast.first;
+    add.op_type = "elementwise_add";
+    add.inputs = {Input("X", x_dims), Input("Y", broadcast.second.first)};
+    add.outputs = {"Out"};
+    int axis = broadcast.second.second;
+    add.set_attrs = [=](cpp::OpDesc* desc) { desc->SetAttr("axis", axis); };
+    add.flops = DDim(x_dims).production();
+    cases->push_back(add);
+  }
+}
+
+void AddSelectionCases(std::vector<BenchCase>* cases) {
+  const std::vector<std::pair<std::vector<int64_t>, int>> kTopKs{
+      {{32, 1000}, 5}, {{1, 50000}, 100}};
+  for (auto& topk : kTopKs) {
+    BenchCase top_k_v2;
+    top_k_v2.name = "top_k_v2/" + Shape(topk.first) + "k" +
+                    std::to_string(topk.second);
+    top_k_v2.op_type = "top_k_v2";
+    top_k_v2.inputs = {Input("X", topk.first)};
+    top_k_v2.outputs = {"Out", "Indices"};
+    int k = topk.second;
+    top_k_v2.set_attrs = [=](cpp::OpDesc* desc) {
+      desc->SetAttr("k", k);
+      desc->SetAttr("axis", -1);
+    };
+    cases->push_back(top_k_v2);
+  }
+
+  const int kNumBoxes = 2000;
+  const int kNumClasses = 80;
+  BenchCase nms;
+  nms.name = "multiclass_nms3/" + std::to_string(kNumClasses) + "x" +
+             std::to_string(kNumBoxes);
+  nms.op_type = "multiclass_nms3";
+  auto boxes = Input("BBoxes", {1, kNumBoxes, 4});
+  boxes.fill = [](Tensor* tensor) {
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> pos(0.f, 0.9f);
+    std::uniform_real_distribution<float> size(0.01f, 0.1f);
+    auto* data = tensor->mutable_data<float>();
+    for (int64_t i = 0; i < tensor->numel(); i += 4) {
+      data[i] = pos(rng);
+      data[i + 1] = pos(rng);
+      data[i + 2] = data[i] + size(rng);
+      data[i + 3] = data[i + 1] + size(rng);
+    }
+  };
+  auto scores = Input("Scores", {1, kNumClasses, kNumBoxes});
+  scores.min = 0.f;
+  nms.inputs = {boxes, scores};
+  nms.outputs = {"Out", "Index", "NmsRoisNum"};
+  nms.set_attrs = [](cpp::OpDesc* desc) {
+    desc->SetAttr("background_label", -1);
+    desc->SetAttr("score_threshold", 0.05f);
+    desc->SetAttr("nms_top_k", 1000);
+    desc->SetAttr("nms_threshold", 0.5f);
+    desc->SetAttr("nms_eta", 1.f);
+    desc->SetAttr("keep_top_k", 100);
+    desc->SetAttr("normalized", true);
+  };
+  cases->push_back(nms);
+}
+
+// The batches of the sequences of random lengths, run the x86 kernel with
+// paddle_fused_rnn=0 to compare the fused engine with the batch computing.
+void AddRecurrentCases(std::vector<BenchCase>* cases) {
+  // {batch, min length, max length, hidden size}
+  const std::vector<std::vector<int>> kBatches{
+      {16, 5, 50, 128}, {64, 1, 100, 256}};
+  for (auto& batch : kBatches) {
+    const int frame_size = batch[3];
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<int> length(batch[1], batch[2]);
+    std::vector<uint64_t> offsets{0};
+    for (int i = 0; i < batch[0]; i++) {
+      offsets.push_back(offsets.back() + length(rng));
+    }
+    const int64_t total = offsets.back();
+
+    BenchCase gru;
+    gru.name = "gru/b" + std::to_string(batch[0]) + "_len" +
+               std::to_string(batch[1]) + "-" + std::to_string(batch[2]) +
+               "_h" + std::to_string(frame_size);
+    gru.op_type = "gru";
+    auto input = Input("Input", {total, 3 * frame_size});
+    input.fill = [offsets](Tensor* tensor) {
+      std::mt19937 rng(0);
+      std::uniform_real_distribution<float> dist(-1.f, 1.f);
+      auto* data = tensor->mutable_data<float>();
+      for (int64_t i = 0; i < tensor->numel(); i++) {
+        data[i] = dist(rng);
+      }
+      tensor->set_lod({offsets});
+    };
+    auto weight = Input("Weight", {frame_size, 3 * frame_size}, true);
+    weight.min = -0.1f;
+    weight.max = 0.1f;
+    gru.inputs = {input, weight, Input("Bias", {1, 3 * frame_size}, true)};
+    gru.outputs = {
+        "BatchGate", "BatchResetHiddenPrev", "BatchHidden", "Hidden"};
+    gru.set_attrs = [](cpp::OpDesc* desc) {
+      desc->SetInput("H0", {});
+      desc->SetAttr<std::string>("activation", "tanh");
+      desc->SetAttr<std::string>("gate_activation", "sigmoid");
+      desc->SetAttr("is_reverse", false);
+      desc->SetAttr("origin_mode", false);
+    };
+    gru.flops = 6.0 * total * frame_size * frame_size;
+    cases->push_back(gru);
+  }
+}
+
+}  // namespace
+
+std::vector<BenchCase> DefaultBenchCases() {
+  std::vector<BenchCase> cases;
+  AddGemmCases(&cases);
+  AddConvCases(&cases);
+  AddNormCases(&cases);
+  AddDataMovementCases(&cases);
+  AddSelectionCases(&cases);
+  AddRecurrentCases(&cases);
+  return cases;
+}
+
+}  // namespace bench
+}  // namespace lite
+}  // namespace paddle
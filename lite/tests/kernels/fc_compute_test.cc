@@ -217,7 +217,7 @@ void TestFC2D(Place place,
               bool with_relu = false,
               bool padding = false) {
   for (auto& m : {1, 3, 16}) {
-    for (auto& n : {1, 4, 16, 128, 256, 1024}) {
+    for (auto& n : {1, 4, 16, 20, 128, 256, 1024}) {
       for (auto& k : {1, 16, 128, 1024}) {
         for (auto& bflag : {false, true}) {
           if (!bflag && with_relu) {
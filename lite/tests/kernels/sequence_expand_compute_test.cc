@@ -170,6 +170,13 @@ void test_sequence_expand(Place place) {
       }
     }
   }
+  // Every sequence is repeated once, Out shares the storage of X.
+  LoD lod_x{{0, 2, 3, 6}};
+  LoD lod_y{{0, 1, 2, 3}};
+  std::unique_ptr<arena::TestCase> tester(new SequenceExpandComputeTester(
+      place, "def", lod_x, lod_y, -1, DDim(std::vector<int64_t>({6, 3}))));
+  arena::Arena arena(std::move(tester), place, 2e-5);
+  arena.TestPrecision();
 }
 
 TEST(SequenceExpand, precision) {
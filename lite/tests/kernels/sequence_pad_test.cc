@@ -14,6 +14,7 @@
 
 #include <gtest/gtest.h>
 #include <cstring>
+#include <vector>
 #include "lite/api/paddle_use_kernels.h"
 #include "lite/api/paddle_use_ops.h"
 #include "lite/core/test/arena/framework.h"
@@ -35,8 +36,13 @@ class SequencePadTester : public arena::TestCase {
   int padded_length_ = 4;
 
  public:
-  SequencePadTester(const Place& place, const std::string& alias)
-      : TestCase(place, alias) {}
+  SequencePadTester(const Place& place,
+                    const std::string& alias,
+                    const LoD& x_lod,
+                    int padded_length)
+      : TestCase(place, alias), x_lod_(x_lod), padded_length_(padded_length) {
+    x_dims_[0] = static_cast<int64_t>(x_lod_[0].back());
+  }
 
   void RunBaseline(Scope* scope) override {
     auto* out = scope->NewTensor(out_);
@@ -92,10 +98,14 @@ template <class T>
 void TestSequencePad(const Place place,
                      const float abs_error,
                      const std::string alias) {
-  std::unique_ptr<arena::TestCase> tester(
-      new SequencePadTester<T>(place, alias));
-  arena::Arena arena(std::move(tester), place, abs_error);
-  arena.TestPrecision();
+  // The sequences of the same length as padded_length share the storage of
+  // the input.
+  for (auto& x_lod : std::vector<LoD>{{{0, 2, 5, 9}}, {{0, 4, 8, 12}}}) {
+    std::unique_ptr<arena::TestCase> tester(
+        new SequencePadTester<T>(place, alias, x_lod, 4));
+    arena::Arena arena(std::move(tester), place, abs_error);
+    arena.TestPrecision();
+  }
 }
 
 TEST(sequence_pad, precision) {
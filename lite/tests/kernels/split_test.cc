@@ -36,6 +36,7 @@ class SplitTester : public arena::TestCase {
 #endif
   int num_ = 1;
   std::vector<int> sections_;
+  bool inplace_{false};
 
  public:
   SplitTester(const Place& place,
@@ -45,12 +46,14 @@ class SplitTester : public arena::TestCase {
               const int num = 1,
               const std::vector<int> sections = {},
               const bool use_axis_tensor = false,
-              const bool use_sections_tensor_list = false)
+              const bool use_sections_tensor_list = false,
+              const bool inplace = false)
       : TestCase(place, alias),
         x_dims_(x_dims),
         axis_(axis),
         num_(num),
-        sections_(sections) {
+        sections_(sections),
+        inplace_(inplace) {
     if (use_axis_tensor) {
       axis_tensor_ = "axis";
     }
@@ -141,6 +144,9 @@ class SplitTester : public arena::TestCase {
     op_desc->SetAttr("axis", axis_);
     op_desc->SetAttr("num", num_);
     op_desc->SetAttr("sections", sections_);
+    if (inplace_) {
+      op_desc->SetAttr("inplace", true);
+    }
   }
 
   void PrepareData() override {
@@ -178,7 +184,8 @@ void TestSplit(Place place,
                const int num = 2,
                const std::vector<int>& sections = {},
                const bool use_axis_tensor = false,
-               const bool use_sections_tensor_list = false) {
+               const bool use_sections_tensor_list = false,
+               const bool inplace = false) {
   std::unique_ptr<arena::TestCase> tester(
       new SplitTester<T>(place,
                          alias,
@@ -187,7 +194,8 @@ void TestSplit(Place place,
                          num,
                          sections,
                          use_axis_tensor,
-                         use_sections_tensor_list));
+                         use_sections_tensor_list,
+                         inplace));
   arena::Arena arena(std::move(tester), place, abs_error);
   arena.TestPrecision();
 }
@@ -259,6 +267,43 @@ void TestSplitSectionsTensorList(Place place,
                true);
 }
 
+template <class T = float>
+void TestSplitInplace(Place place,
+                      float abs_error,
+                      const std::string& alias = "def") {
+  // The outputs share the input if the dims before the axis are 1.
+  TestSplit<T>(place,
+               abs_error,
+               alias,
+               DDim{{1, 1, 12}},
+               -1,
+               0,
+               {4, 8},
+               false,
+               false,
+               true);
+  TestSplit<T>(place,
+               abs_error,
+               alias,
+               DDim{{1, 6, 4}},
+               1,
+               0,
+               {2, 3, 1},
+               false,
+               false,
+               true);
+  TestSplit<T>(place,
+               abs_error,
+               alias,
+               DDim{{2, 12}},
+               -1,
+               0,
+               {4, 8},
+               false,
+               false,
+               true);
+}
+
 TEST(Split_test, precision) {
   float abs_error;
   Place place;
@@ -324,6 +369,7 @@ TEST(Split_test, precision) {
   TestSplitSections(place, abs_error);
   TestSplitAxisTensor(place, abs_error);
   TestSplitSectionsTensorList(place, abs_error);
+  TestSplitInplace(place, abs_error);
 #else
   return;
 #endif